@@ -0,0 +1,412 @@
+/////////////////////////////////////////////////////////////////////////////
+// compiled.cc
+//
+// SIMLIB version: 3.07
+// Copyright (c) 1999-2001  David Martinek, Dr. Ing. Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+// Warning: this is EXPERIMENTAL code, interfaces can be changed
+//
+// Fuzzy subsystem for SIMLIB
+//
+/////////////////////////////////////////////////////////////////////////////
+// FuzzyCompiledRules - inference rules converted into matrices of indexes
+// into vector of membership values, membership functions of inputs sampled
+// into lookup tables. Loops over rules have no branches and no virtual calls
+// (compiler can vectorize them).
+//
+// Vector mu:  0, 1, memberships of all inputs, 1-memberships of all inputs
+// Rule:       min (or max) of mu[lit[j]], j < width (unused operands point
+//             to neutral value 1 for min and 0 for max), optionally negated
+/////////////////////////////////////////////////////////////////////////////
+#include "fuzzy.h"
+#include <internal.h>
+#include <stdio.h>
+#include <typeinfo>
+
+namespace simlib3 {
+
+/** Rule with result in gmax group (before renumbering).<br>Pravidlo ze skupiny gmax. */
+static const unsigned MAXRULE = 0x80000000u;
+
+/**
+ * It compiles rules.<br>Pelo pravidla.
+ */
+FuzzyCompiledRules::FuzzyCompiledRules(FuzzyInferenceRules &source, unsigned samples)
+: samples(samples == 1 ? 2 : samples), total(0)
+{
+  if (!source.isComplete())
+    SIMLIB_error("FuzzyCompiledRules: source rules are not complete!");
+  in = source.in;
+  out = source.out;
+  compile(source);
+}
+
+/**
+ * Rules can not be added (error).<br>Pravidla nelze pidvat (chyba).
+ */
+void FuzzyCompiledRules::add(FuzzyRule *, bool)
+{
+  SIMLIB_error("FuzzyCompiledRules::add: compiled rules can not be changed!");
+}
+
+/**
+ * It creates lookup tables and converts all rules.<br>
+ * Vytvo tabulky a pevede vechna pravidla.
+ */
+void FuzzyCompiledRules::compile(FuzzyInferenceRules &source)
+{
+  inputs.resize(in.size());
+  for (unsigned k = 0; k < in.size(); k++)
+  {
+    inputs[k].first = total;
+    inputs[k].n = in[k]->count();
+    total += inputs[k].n;
+    compileTable(k);
+  }
+  mu.assign(2 + 2*total, 0.0);
+  mu[1] = 1.0;
+  for (unsigned o = 0; o < out.size(); o++)
+  {
+    ofirst.push_back(centers.size());
+    for (unsigned i = 0; i < out[o]->count(); i++)
+      centers.push_back(out[o]->center(i));
+  }
+  agg.resize(centers.size());
+  gmin.rules = gmin.width = gmax.rules = gmax.width = 0;
+
+  if (FuzzyIIORules *r = dynamic_cast<FuzzyIIORules *>(&source))
+  {
+    // the same indexing as FuzzyIIORules::evaluate()
+    std::vector<FPair *> none;
+    for (int i = 0; i < r->rules; i++)
+    {
+      std::vector<unsigned> lits(2);
+      lits[0] = inSlot(in[0], i % in[0]->count());
+      lits[1] = inSlot(in[1], i / in[0]->count());
+      switch (r->operation[i])
+      {
+        case opAND:  addRule(opAND, false, lits, none); break;
+        case opOR:   addRule(opOR,  false, lits, none); break;
+        case opNAND: addRule(opAND, true,  lits, none); break;
+        case opNOR:  addRule(opOR,  true,  lits, none); break;
+        default: continue;
+      }
+      cslot.push_back(ofirst[0] + r->outWV[i]);
+    }
+  }
+  else if (FuzzyGeneralRules *r = dynamic_cast<FuzzyGeneralRules *>(&source))
+  {
+    for (unsigned i = 0; i < r->rules.size(); i++)
+      addRule(r->rules[i]);
+  }
+  else
+    SIMLIB_error("FuzzyCompiledRules: unknown type of inference rules!");
+
+  // pad matrices to the same width, renumber activations: gmin, gmax
+  Group *g[2] = { &gmin, &gmax };
+  for (int k = 0; k < 2; k++)
+  {
+    std::vector<unsigned> lit(g[k]->width * g[k]->rules, k == 0 ? 1 : 0);
+    unsigned j = 0;
+    for (unsigned r = 0; r < g[k]->rules; r++, j++)
+      for (unsigned w = 0; g[k]->lit[j] != ~0u; w++, j++)
+        lit[w*g[k]->rules + r] = g[k]->lit[j];
+    g[k]->lit.swap(lit);
+  }
+  for (unsigned c = 0; c < cact.size(); c++)
+    if (cact[c] & MAXRULE)
+      cact[c] = gmin.rules + (cact[c] & ~MAXRULE);
+  act.resize(gmin.rules + gmax.rules);
+}
+
+/**
+ * It samples membership functions of k-th input. Singletons are computed exactly.<br>
+ * Navzorkuje funkce pslunosti k-tho vstupu. Singletony se potaj pesn.
+ */
+void FuzzyCompiledRules::compileTable(unsigned k)
+{
+  Input &p = inputs[k];
+  FuzzySet *m = in[k]->m;
+  p.xmin = m->min();
+  p.xmax = m->max();
+  p.scale = 0.0;
+  p.table.clear();
+  p.exact.clear();
+  if (samples == 0 || p.xmax <= p.xmin)
+  {
+    for (unsigned i = 0; i < p.n; i++)
+      p.exact.push_back(i);
+    return;
+  }
+  double h = (p.xmax - p.xmin) / (samples - 1);
+  p.scale = 1.0 / h;
+  p.table.resize(samples * p.n);
+  for (unsigned s = 0; s < samples; s++)
+  {
+    double x = (s == samples - 1) ? p.xmax : p.xmin + s*h;
+    for (unsigned i = 0; i < p.n; i++)
+      p.table[s*p.n + i] = m->Membership(i, x);
+  }
+  for (unsigned i = 0; i < p.n; i++)
+    if (dynamic_cast<const FuzzySingleton *>((*m)[i]) != 0)
+      p.exact.push_back(i);
+}
+
+/**
+ * It returns index of membership value in vector mu or -1.<br>
+ * Vrac index hodnoty pslunosti ve vektoru mu nebo -1.
+ */
+int FuzzyCompiledRules::inSlot(FuzzyVariable *var, int i)
+{
+  for (unsigned k = 0; k < in.size(); k++)
+    if (in[k] == var)
+      return 2 + inputs[k].first + i;
+  return -1;
+}
+
+/**
+ * It returns index of output value in vector agg or -1.<br>
+ * Vrac index hodnoty vstupu ve vektoru agg nebo -1.
+ */
+int FuzzyCompiledRules::outSlot(FuzzyVariable *var, int i)
+{
+  for (unsigned o = 0; o < out.size(); o++)
+    if (out[o] == var)
+      return ofirst[o] + i;
+  return -1;
+}
+
+/**
+ * It converts chain of operations op (AND or OR) into list of operands. It returns false
+ * for other structure of tree.<br>
+ * Pevede etzec operac op (AND nebo OR) na seznam operand. Pro jinou strukturu stromu
+ * vrac false.
+ */
+bool FuzzyCompiledRules::flatten(FONode *node, Operations op, std::vector<unsigned> &lits)
+{
+  if (node == NULL)
+    return false;
+  if (FPair *p = dynamic_cast<FPair *>(node))
+  {
+    // as FPair::getValue(): flag eq is not used
+    int slot = inSlot(p->var, p->indexWV);
+    if (slot < 0)
+      return false;
+    lits.push_back(slot);
+    return true;
+  }
+  FOperation *o = dynamic_cast<FOperation *>(node);
+  if (o == NULL)
+    return false;
+  if (o->op == opNOT)
+  {
+    // not(pair) is complement
+    FPair *p = dynamic_cast<FPair *>(o->L);
+    int slot = p ? inSlot(p->var, p->indexWV) : -1;
+    if (slot < 0)
+      return false;
+    lits.push_back(slot + total);
+    return true;
+  }
+  return o->op == op && flatten(o->L, op, lits) && flatten(o->R, op, lits);
+}
+
+/**
+ * It converts rule represented by tree. Rules with other structure then chains of AND or OR
+ * are evaluated by tree.<br>
+ * Pevede pravidlo reprezentovan stromem. Pravidla s jinou strukturou ne etzce AND nebo
+ * OR se vyhodnocuj stromem.
+ */
+void FuzzyCompiledRules::addRule(FuzzyRule *rule)
+{
+  FOperation *left = rule->left;
+  std::vector<unsigned> lits;
+  bool ok = false, negate = false;
+  Operations op = opAND;
+  if (left != NULL)
+  {
+    switch (left->op)
+    {
+      case opAND:  ok = flatten(left, opAND, lits); break;
+      case opOR:   op = opOR; ok = flatten(left, opOR, lits); break;
+      case opNAND:
+      case opNOR:
+        // not(a && b && ...) and not(a || b || ...)
+        op = (left->op == opNAND) ? opAND : opOR;
+        negate = true;
+        ok = flatten(left->L, op, lits) && flatten(left->R, op, lits);
+        break;
+      case opNOT:
+        if (FOperation *o = dynamic_cast<FOperation *>(left->L))
+        {
+          if (o->op == opAND || o->op == opOR)
+          {
+            op = o->op;
+            negate = true;
+            ok = flatten(o, op, lits);
+          }
+        }
+        else
+        {
+          negate = true;
+          ok = flatten(left->L, opAND, lits);
+        }
+        break;
+    }
+  }
+  for (unsigned i = 0; ok && i < rule->right.size(); i++)
+    ok = outSlot(rule->right[i]->var, rule->right[i]->indexWV) >= 0;
+  if (!ok)
+  {
+    tree.push_back(rule);
+    return;
+  }
+  addRule(op, negate, lits, rule->right);
+}
+
+/**
+ * It adds row into matrix of group and consequents of rule.<br>
+ * Pid dek do matice skupiny a dsledky pravidla.
+ */
+void FuzzyCompiledRules::addRule(Operations op, bool negate, const std::vector<unsigned> &lits,
+                                 const std::vector<FPair *> &cons)
+{
+  Group &g = (op == opAND) ? gmin : gmax;
+  unsigned index = g.rules++;
+  // rows are separated by ~0u, matrix is created in compile()
+  g.lit.insert(g.lit.end(), lits.begin(), lits.end());
+  g.lit.push_back(~0u);
+  if (lits.size() > g.width)
+    g.width = lits.size();
+  g.neg.push_back(negate ? 1.0 : 0.0);
+  if (op != opAND)
+    index |= MAXRULE;
+  if (cons.empty())
+    cact.push_back(index);      // IIO: slot is added by caller
+  for (unsigned i = 0; i < cons.size(); i++)
+  {
+    cact.push_back(index);
+    cslot.push_back(outSlot(cons[i]->var, cons[i]->indexWV));
+  }
+}
+
+/**
+ * It evaluates all rules of group (min for gmin, max for gmax).<br>
+ * Vyhodnot vechna pravidla skupiny (min pro gmin, max pro gmax).
+ */
+void FuzzyCompiledRules::evalGroup(const Group &g, double *a, double init)
+{
+  const unsigned R = g.rules;
+  const double *m = mu.data();
+  const unsigned *lit = g.lit.data();
+  const double *neg = g.neg.data();
+  for (unsigned r = 0; r < R; r++)
+    a[r] = init;
+  for (unsigned j = 0; j < g.width; j++, lit += R)
+  {
+    if (init > 0.0)
+      for (unsigned r = 0; r < R; r++)
+      {
+        double x = m[lit[r]];
+        a[r] = (x < a[r]) ? x : a[r];
+      }
+    else
+      for (unsigned r = 0; r < R; r++)
+      {
+        double x = m[lit[r]];
+        a[r] = (x > a[r]) ? x : a[r];
+      }
+  }
+  for (unsigned r = 0; r < R; r++)
+    a[r] += neg[r] * (1.0 - 2.0*a[r]);      // 1-a for negated rules
+}
+
+/**
+ * It makes the whole inference and sets values of outputs.<br>
+ * Provede celou inferenci a nastav hodnoty vstup.
+ */
+void FuzzyCompiledRules::evaluate()
+{
+  double *m = mu.data();
+  // fuzzification
+  for (unsigned k = 0; k < in.size(); k++)
+  {
+    FuzzyInput *v = in[k];
+    const Input &p = inputs[k];
+    double x = v->Value();
+    if ((x > p.xmax) || (x < p.xmin))
+      SIMLIB_error("Fuzzification error: value %lf out of range in fuzzy set \"%s\".", x, v->m->name());
+    double *d = m + 2 + p.first;
+    if (!p.table.empty())
+    {
+      double pos = (x - p.xmin) * p.scale;
+      unsigned s = unsigned(pos);
+      if (s > samples - 2)
+        s = samples - 2;
+      double f = pos - s;
+      const double *r0 = &p.table[s*p.n];
+      const double *r1 = r0 + p.n;
+      for (unsigned i = 0; i < p.n; i++)
+        d[i] = r0[i] + f*(r1[i] - r0[i]);
+    }
+    for (unsigned e = 0; e < p.exact.size(); e++)
+      d[p.exact[e]] = v->m->Membership(p.exact[e], x);
+    for (unsigned i = 0; i < p.n; i++)
+      v->mval[i] = d[i];
+  }
+  for (unsigned j = 0; j < total; j++)
+    m[2 + total + j] = 1.0 - m[2 + j];
+
+  // rules
+  double *a = act.data();
+  evalGroup(gmin, a, 1.0);
+  evalGroup(gmax, a + gmin.rules, 0.0);
+
+  // aggregation
+  for (unsigned i = 0; i < agg.size(); i++)
+    agg[i] = 0.0;
+  for (unsigned c = 0; c < cact.size(); c++)
+  {
+    double x = a[cact[c]];
+    double &y = agg[cslot[c]];
+    y = (x > y) ? x : y;
+  }
+  for (unsigned o = 0; o < out.size(); o++)
+    for (unsigned i = 0; i < out[o]->count(); i++)
+      out[o]->mval[i] = agg[ofirst[o] + i];
+  if (!tree.empty())
+  {
+    for (unsigned r = 0; r < tree.size(); r++)
+      tree[r]->evaluate();
+    for (unsigned o = 0; o < out.size(); o++)
+      for (unsigned i = 0; i < out[o]->count(); i++)
+        agg[ofirst[o] + i] = out[o]->mval[i];
+  }
+
+  // defuzzification
+  for (unsigned o = 0; o < out.size(); o++)
+  {
+    FuzzyOutput *y = out[o];
+    if (y->defuzzify == defuzDCOG)
+    {
+      const double *w = &agg[ofirst[o]];
+      const double *c = &centers[ofirst[o]];
+      double sum = 0.0, sumw = 0.0;
+      for (unsigned i = 0; i < y->count(); i++)
+      {
+        sum += c[i]*w[i];
+        sumw += w[i];
+      }
+      if (sumw > 0.0)
+      {
+        y->value = sum/sumw;
+        continue;
+      }
+    }
+    y->Defuzzify();
+  }
+}
+
+} // namespace
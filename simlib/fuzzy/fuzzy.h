@@ -34,10 +34,14 @@
 #endif
 
 #include "simlib.h"
+#include <list>
 #include <vector>
 
 namespace simlib3 {
 
+/** list of variables (formerly SIMLIB dlist template) */
+template<class T> using dlist = std::list<T>;
+
 /**
  * @mainpage FuzzySIMLIB 
  * @version 1.0
@@ -560,6 +564,8 @@ class FuzzyBlock; // forward
  */
 class FuzzyVariable : public aContiBlock 
 { 
+    friend class FuzzyCompiledRules;
+    friend class FuzzyIIORules;
     FuzzyBlock *where;  /**< location */ 
 //    const FuzzySet *m;	/**< pattern: n membership functions, parameters */ 
     FuzzySet *m;        /**< pattern: n membership functions, parameters */ 
@@ -696,6 +702,8 @@ class FuzzyInput : public FuzzyVariable {
  * @ingroup fuzzy
  */
 class FuzzyOutput: public FuzzyVariable {
+    friend class FuzzyCompiledRules;
+    friend class FuzzyIIORules;
     double value; /**? value after defuzzification */ 
     double (*defuzzify)(const FuzzyVariable&); /**< defuzzification function */  // remove!!!!!!!####
   public:
@@ -909,6 +917,9 @@ class FuzzySampledBlock
 // 
 class FuzzyRule;
 class FuzzyRuleFactory;
+class FuzzyCompiledRules;
+class FONode;
+class FPair;
 
 /**
  * Abstract class for representation and evaluation of inference rules.
@@ -926,6 +937,7 @@ class FuzzyRuleFactory;
 class FuzzyInferenceRules
 {
   friend class FuzzyRuleFactory;
+  friend class FuzzyCompiledRules;
   public:
     /** 
      * Operations for use inside inference rules.<br>
@@ -1004,6 +1016,14 @@ class FuzzyInferenceRules
      * FuzzyRSBlock.
      */
      virtual void evaluate() = 0;
+
+    /**
+     * It returns true if evaluate() makes the whole inference including fuzzification of
+     * inputs and defuzzification of outputs.<br>
+     * Vrac true, jestlie evaluate() provd celou inferenci vetn fuzzifikace vstup
+     * a defuzzifikace vstup.
+     */
+    virtual bool isWholeInference() { return false; }
   protected:
     /** Vector of input variables. <br> Vektor vstupnch promnnch. */
     std::vector<FuzzyInput *>in;
@@ -1030,7 +1050,14 @@ class FuzzyInferenceRules
 class FuzzyIIORules 
 : public FuzzyInferenceRules
 {
+  friend class FuzzyCompiledRules;
   public:
+    /**
+     * Interpolation of precomputed output surface.<br>
+     * Interpolace pedem vypoten vstupn plochy.
+     */
+    enum Surface { sfNone, sfBilinear, sfBicubic };
+
 /////////////////////////////////////////////////////////////////
 // rozhran FuzzyInferenceRules -- interface FuzzyInferenceRules
 /////////////////////////////////////////////////////////////////
@@ -1077,12 +1104,18 @@ class FuzzyIIORules
     virtual bool isComplete();
 
     /**
-     * It evaluates the rules.<br>
-     * Vyhodnot pravidla.
+     * It evaluates the rules. If the surface is set, it only interpolates output value from
+     * the surface (it is computed at first evaluation).<br>
+     * Vyhodnot pravidla. Je-li nastavena plocha, pouze interpoluje vstupn hodnotu z plochy
+     * (ta se vypote pi prvnm vyhodnocen).
+     * @see setSurface()
      */
      //implemented in rules.cc
     virtual void evaluate();
 
+    /** Evaluation by surface makes whole inference.<br>Vyhodnocen plochou provd celou inferenci. */
+    virtual bool isWholeInference() { return surface != sfNone; }
+
     /**
      * It adds next rule into list. If there is too much rules, an error is indicated.<br>
      * Pid dal pravidlo do seznamu. Pokud u je definovno pli pravidel, nastane chyba.
@@ -1137,6 +1170,38 @@ class FuzzyIIORules
               int in2WVIndex, 
               const char *outWordValue);
 
+    /**
+     * It sets precomputation of output surface. The output value is computed by exact inference
+     * on grid n1 x n2 over universums of inputs and evaluate() only interpolates it. If maxError
+     * is greater than 0, the grid is refined until the error checked in sample points inside of
+     * cells is lower than maxError/2 (at most MAX_SURFACE points), otherwise warning is printed.
+     * The error is estimated from samples, it is not a strict bound.<br>
+     * Nastav pedvpoet vstupn plochy. Vstupn hodnota je vypotena pesnou inferenc
+     * v mce n1 x n2 nad univerzy vstup a evaluate() ji pouze interpoluje. Je-li maxError
+     * vt ne 0, mka se zjemuje, dokud chyba kontrolovan ve vzorcch uvnit bunk nen
+     * men ne maxError/2 (nejve MAX_SURFACE bod), jinak se vype varovn. Chyba je
+     * odhadnuta ze vzork, nen to pesn mez.
+     * @param n1 Number of points for first input.<br>Poet bod pro prvn vstup.
+     * @param n2 Number of points for second input.<br>Poet bod pro druh vstup.
+     * @param method Interpolation (sfNone switches surface off).<br>Interpolace (sfNone plochu vypne).
+     * @param maxError Maximal error of interpolation.<br>Maximln chyba interpolace.
+     */
+    //implemented in rules.cc
+    void setSurface(unsigned n1, unsigned n2, Surface method=sfBilinear, double maxError=0.0);
+
+    /**
+     * It computes output surface by exact inference and checks error of interpolation.<br>
+     * Vypote vstupn plochu pesnou inferenc a zkontroluje chybu interpolace.
+     */
+    //implemented in rules.cc
+    void computeSurface();
+
+    /**
+     * Maximal error of interpolation found by computeSurface() (estimate).<br>
+     * Maximln chyba interpolace nalezen v computeSurface() (odhad).
+     */
+    double surfaceError() const { return surfError; }
+
   protected:
     /** Array of indexes into FuzzyOutput variable.<br> Pole index do promnn FuzzyOutput. */
     int *outWV; 
@@ -1150,6 +1215,27 @@ class FuzzyIIORules
     /** Maximum number of variables.<br> Maximln poet promnnch. */
     static const int MAX_INPUTS = 2;
     static const int MAX_OUTPUTS = 1;
+    /** Maximal number of surface points for one input.<br>Maximln poet bod plochy pro jeden vstup. */
+    static const unsigned MAX_SURFACE = 1025;
+
+    /** Interpolation of surface.<br>Interpolace plochy. */
+    Surface surface;
+    /** Output values in grid points (first input changes first).<br>Vstupn hodnoty v bodech mky. */
+    std::vector<double> surf;
+    unsigned surfN[MAX_INPUTS];                   /**< number of points */
+    double surfMin[MAX_INPUTS], surfScale[MAX_INPUTS];  /**< universum, points per unit */
+    double surfMaxError, surfError;               /**< required and found error */
+    bool surfValid;                               /**< surface is computed */
+
+    /** It evaluates all rules (exact inference).<br>Vyhodnot vechna pravidla (pesn inference). */
+    //implemented in rules.cc
+    void evaluateRules();
+    /** Exact inference for input values.<br>Pesn inference pro vstupn hodnoty. */
+    //implemented in rules.cc
+    double exact(double x1, double x2);
+    /** Interpolation of surface.<br>Interpolace plochy. */
+    //implemented in rules.cc
+    double lookup(double x1, double x2);
     
     /** It tests if all arrays are allocated.<br>Testuje, jestli u jsou alokovna pole. */
     //implemented in rules.cc
@@ -1179,6 +1265,7 @@ class FuzzyIIORules
 class FuzzyGeneralRules
 : public FuzzyInferenceRules
 {
+  friend class FuzzyCompiledRules;
   public:
     /**
      * It destroys vector of rules
@@ -1222,6 +1309,91 @@ class FuzzyGeneralRules
   private:
 }; // FuzzyGeneralRules
 
+/**
+ * Compiled inference rules. Rules of FuzzyIIORules or FuzzyGeneralRules object are converted
+ * into dense matrices of indexes into the vector of membership values (one row for each rule)
+ * and membership functions of inputs are sampled into lookup tables. Method evaluate() makes
+ * the whole inference: fuzzification, evaluation of rules (min/max), aggregation and
+ * defuzzification. Rules which can not be converted (e.g. (a && b) || c) are evaluated by the
+ * tree. Source rules must exist while this object is used.<br>
+ * Peloen inferenn pravidla. Pravidla objektu FuzzyIIORules nebo FuzzyGeneralRules jsou
+ * pevedena na hust matice index do vektoru hodnot pslunosti (jeden dek pro kad
+ * pravidlo) a funkce pslunosti vstup jsou navzorkovny do tabulek. Metoda evaluate() provede
+ * celou inferenci: fuzzifikaci, vyhodnocen pravidel (min/max), agregaci a defuzzifikaci.
+ * Pravidla, kter nelze pevst (nap. (a && b) || c), se vyhodnocuj stromem. Zdrojov
+ * pravidla mus existovat po celou dobu pouvn tohoto objektu.
+ * @ingroup fuzzy
+ */
+class FuzzyCompiledRules
+: public FuzzyInferenceRules
+{
+  public:
+    /**
+     * It compiles rules.<br>Pelo pravidla.
+     * @param source Complete inference rules.<br>pln inferenn pravidla.
+     * @param samples Number of samples of membership functions in lookup table (0 means
+     *        exact computation of membership functions).<br>
+     *        Poet vzork funkc pslunosti v tabulce (0 znamen pesn vpoet funkc
+     *        pslunosti).
+     */
+    // implemented in compiled.cc
+    FuzzyCompiledRules(FuzzyInferenceRules &source, unsigned samples=1024);
+    /** Destructor - destruktor. */
+    virtual ~FuzzyCompiledRules() { TRACE(printf("~FuzzyCompiledRules\n")); }
+    /** Compiled rules are always complete.<br>Peloen pravidla jsou vdy pln. */
+    virtual bool isComplete() { return true; }
+    /** Compiled rules make whole inference.<br>Peloen pravidla provd celou inferenci. */
+    virtual bool isWholeInference() { return true; }
+    /** Rules can not be added (error).<br>Pravidla nelze pidvat (chyba). */
+    // implemented in compiled.cc
+    virtual void add(FuzzyRule *rule, bool release=true);
+    /**
+     * It makes the whole inference and sets values of outputs.<br>
+     * Provede celou inferenci a nastav hodnoty vstup.
+     */
+    // implemented in compiled.cc
+    virtual void evaluate();
+    /** Number of rules evaluated by tree.<br>Poet pravidel vyhodnocovanch stromem. */
+    unsigned treeRules() const { return tree.size(); }
+  protected:
+    /** Input variable with lookup table.<br>Vstupn promnn s tabulkou. */
+    struct Input {
+      unsigned first;             /**< index of first value in mu */
+      unsigned n;                 /**< number of word values */
+      double xmin, xmax, scale;   /**< universum, samples per unit */
+      std::vector<double> table;  /**< samples x n values (or empty) */
+      std::vector<unsigned> exact;/**< singletons (computed exactly) */
+    };
+    /** Rules with the same operation (min or max).<br>Pravidla se stejnou operac. */
+    struct Group {
+      unsigned rules, width;      /**< number of rules, max. number of operands */
+      std::vector<unsigned> lit;  /**< width x rules indexes into mu (by columns) */
+      std::vector<double> neg;    /**< 1 for negated result (NAND, NOR, NOT) */
+    };
+    unsigned samples;             /**< size of lookup tables */
+    unsigned total;               /**< number of input word values */
+    std::vector<Input> inputs;
+    std::vector<double> mu;       /**< 0, 1, memberships, 1-memberships */
+    Group gmin, gmax;             /**< AND rules, OR rules */
+    std::vector<double> act;      /**< activations: gmin rules, gmax rules */
+    std::vector<unsigned> cact;   /**< consequents: index into act */
+    std::vector<unsigned> cslot;  /**< consequents: index into agg */
+    std::vector<unsigned> ofirst; /**< first value of output in agg */
+    std::vector<double> centers;  /**< centers of output functions */
+    std::vector<double> agg;      /**< aggregated values of outputs */
+    std::vector<FuzzyRule *> tree;/**< rules evaluated by tree */
+    // implemented in compiled.cc
+    void compile(FuzzyInferenceRules &source);
+    void compileTable(unsigned k);
+    bool flatten(FONode *node, Operations op, std::vector<unsigned> &lits);
+    void addRule(Operations op, bool negate, const std::vector<unsigned> &lits,
+                 const std::vector<FPair *> &cons);
+    void addRule(FuzzyRule *rule);
+    int inSlot(FuzzyVariable *var, int i);
+    int outSlot(FuzzyVariable *var, int i);
+    void evalGroup(const Group &g, double *a, double init);
+}; // FuzzyCompiledRules
+
 /**
  * FuzzyRSBlock is base class for inference blocks with sampled input and explicitly defined
  * inference rules.<br>
@@ -1250,6 +1422,15 @@ class FuzzyRSBlock
     virtual void Behavior()
     { rules.evaluate(); }  
 
+    /**
+     * It evaluates rules in sampled time steps. If rules make whole inference (compiled rules,
+     * surface), fuzzification and defuzzification of variables is skipped.<br>
+     * Vyhodnot pravidla ve vzorkovanch asovch okamicch. Jestlie pravidla provd celou
+     * inferenci (peloen pravidla, plocha), fuzzifikace a defuzzifikace promnnch se vynechv.
+     */
+    // implemented in fuzzyrul.cc
+    virtual void Evaluate();
+
   protected:
     FuzzyInferenceRules &rules;
 }; // FuzzyRSBlock
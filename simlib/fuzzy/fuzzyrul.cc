@@ -349,5 +349,25 @@ void FuzzySampledBlock::Evaluate()
   }
 }
 
+/**
+ * It evaluates rules in sampled time steps. If rules make whole inference (compiled rules,
+ * surface), fuzzification and defuzzification of variables is skipped.<br>
+ * Vyhodnot pravidla ve vzorkovanch asovch okamicch. Jestlie pravidla provd celou
+ * inferenci (peloen pravidla, plocha), fuzzifikace a defuzzifikace promnnch se vynechv.
+ */
+void FuzzyRSBlock::Evaluate()
+{
+  if (!rules.isWholeInference())
+  {
+    FuzzySampledBlock::Evaluate();
+    return;
+  }
+  if ((Time - lastTime >= getTimeStep()) || (Time == 0))
+  {
+    lastTime = Time;
+    rules.evaluate();
+  }
+}
+
 } // namespace 
 
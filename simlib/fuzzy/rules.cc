@@ -21,6 +21,8 @@
 #include <internal.h>
 #include <stdio.h>
 #include <typeinfo>
+#include <cmath>
+#include <algorithm>
 
 namespace simlib3 {
 
@@ -122,6 +124,10 @@ void FuzzyIIORules::init()
   out.reserve(1);
   in.reserve(2);
   inputs = outputs = rules = 0;
+  surface = sfNone;
+  surfN[0] = surfN[1] = 0;
+  surfMaxError = surfError = 0.0;
+  surfValid = false;
 }
 
 
@@ -193,6 +199,7 @@ void FuzzyIIORules::add (const FuzzyInferenceRules::Operations operation,
   unsigned index = in2WVIndex*in[1]->count()+in1WVIndex;
   this->operation[index] = operation;
   this->outWV[index] = outWVIndex;
+  surfValid = false;
 //  printf("add (in1WVIndex=%d, in2WVIndex=%d, outWVIndex=%d) at index %d\n", in1WVIndex, in2WVIndex, outWVIndex, index);
 }
 
@@ -233,10 +240,28 @@ inline double rmin(double x, double y) { return (x < y) ? x : y; }
 inline double rmax(double x, double y) { return (x > y) ? x : y; }
 
 /**
- * It evaluates the rules.<br>
- * Vyhodnot pravidla.
+ * It evaluates the rules. If the surface is set, it only interpolates output value from
+ * the surface (it is computed at first evaluation).<br>
+ * Vyhodnot pravidla. Je-li nastavena plocha, pouze interpoluje vstupn hodnotu z plochy
+ * (ta se vypote pi prvnm vyhodnocen).
  */
 void FuzzyIIORules::evaluate()
+{
+  if (surface == sfNone)
+  {
+    evaluateRules();
+    return;
+  }
+  if (!surfValid)
+    computeSurface();
+  out[0]->value = lookup(in[0]->Value(), in[1]->Value());
+}
+
+/**
+ * It evaluates all rules (exact inference).<br>
+ * Vyhodnot vechna pravidla (pesn inference).
+ */
+void FuzzyIIORules::evaluateRules()
 {
 //  if (rules >= in[2]->count*in[1]->count()) // chyba
   for (int i = 0; i < rules; i++)
@@ -267,6 +292,168 @@ void FuzzyIIORules::evaluate()
     }
   }
 }
+
+/**
+ * It sets precomputation of output surface.<br>
+ * Nastav pedvpoet vstupn plochy.
+ */
+void FuzzyIIORules::setSurface(unsigned n1, unsigned n2, Surface method, double maxError)
+{
+  surface = method;
+  surfN[0] = (n1 < 2) ? 2 : (n1 > MAX_SURFACE) ? MAX_SURFACE : n1;
+  surfN[1] = (n2 < 2) ? 2 : (n2 > MAX_SURFACE) ? MAX_SURFACE : n2;
+  surfMaxError = maxError;
+  surfValid = false;
+}
+
+/**
+ * Exact inference for input values.<br>
+ * Pesn inference pro vstupn hodnoty.
+ */
+double FuzzyIIORules::exact(double x1, double x2)
+{
+  in[0]->Fuzzify(x1);
+  in[1]->Fuzzify(x2);
+  out[0]->Init();
+  evaluateRules();
+  return out[0]->Defuzzify();
+}
+
+/**
+ * It computes output surface by exact inference and estimates error of interpolation
+ * in 17 points of all cells (middle and 4x4 inner points). The grid is refined while the
+ * estimate is greater than maxError/2 (the error between checked points can be greater).
+ * Fuzzy values of variables are restored.<br>
+ * Vypote vstupn plochu pesnou inferenc a odhadne chybu interpolace v 17 bodech vech
+ * bunk (sted a 4x4 vnitn body). Mka se zjemuje, dokud je odhad vt ne maxError/2
+ * (mezi kontrolovanmi body me bt chyba vt). Fuzzy hodnoty promnnch se obnov.
+ */
+void FuzzyIIORules::computeSurface()
+{
+  if (!isComplete() || !isAllCreated())
+    SIMLIB_error("FuzzyIIORules::computeSurface: rules are not complete!");
+  if (surface == sfNone)
+    return;
+  // fuzzy values of variables are changed by exact()
+  std::vector<double> saved[MAX_INPUTS + MAX_OUTPUTS];
+  FuzzyVariable *var[MAX_INPUTS + MAX_OUTPUTS] = { in[0], in[1], out[0] };
+  for (int k = 0; k < MAX_INPUTS + MAX_OUTPUTS; k++)
+    saved[k].assign(var[k]->mval, var[k]->mval + var[k]->n);
+  const double value = out[0]->value;
+  double xmin[MAX_INPUTS], xmax[MAX_INPUTS];
+  for (int k = 0; k < MAX_INPUTS; k++)
+  {
+    xmin[k] = in[k]->m->min();
+    xmax[k] = in[k]->m->max();
+  }
+  for (;;)
+  {
+    // output values in grid points
+    const unsigned n0 = surfN[0], n1 = surfN[1];
+    double h[MAX_INPUTS];
+    for (int k = 0; k < MAX_INPUTS; k++)
+    {
+      h[k] = (xmax[k] - xmin[k]) / (surfN[k] - 1);
+      surfMin[k] = xmin[k];
+      surfScale[k] = (h[k] > 0.0) ? 1.0/h[k] : 0.0;
+    }
+    surf.resize(n0*n1);
+    for (unsigned j = 0; j < n1; j++)
+    {
+      double x2 = (j == n1-1) ? xmax[1] : xmin[1] + j*h[1];
+      for (unsigned i = 0; i < n0; i++)
+        surf[j*n0 + i] = exact((i == n0-1) ? xmax[0] : xmin[0] + i*h[0], x2);
+    }
+    surfValid = true;
+    // error in the middle and in 4x4 inner points of cells
+    static const double check[5] = { 0.125, 0.375, 0.625, 0.875, 0.5 };
+    surfError = 0.0;
+    for (unsigned j = 0; j + 1 < n1; j++)
+      for (unsigned i = 0; i + 1 < n0; i++)
+        for (int c = 0; c < 17; c++)
+        {
+          double x1 = xmin[0] + (i + check[c < 16 ? c%4 : 4])*h[0];
+          double x2 = xmin[1] + (j + check[c < 16 ? c/4 : 4])*h[1];
+          double e = fabs(lookup(x1, x2) - exact(x1, x2));
+          if (e > surfError)
+            surfError = e;
+        }
+    // estimate only: refined until it is below half of maxError
+    if (surfMaxError <= 0.0 || surfError <= 0.5*surfMaxError ||
+        (n0 == MAX_SURFACE && n1 == MAX_SURFACE))
+      break;
+    for (int k = 0; k < MAX_INPUTS; k++)
+    {
+      surfN[k] = 2*surfN[k] - 1;
+      if (surfN[k] > MAX_SURFACE)
+        surfN[k] = MAX_SURFACE;
+    }
+  }
+  for (int k = 0; k < MAX_INPUTS + MAX_OUTPUTS; k++)
+    std::copy(saved[k].begin(), saved[k].end(), var[k]->mval);
+  out[0]->value = value;
+  if (surfMaxError > 0.0 && surfError > 0.5*surfMaxError)
+    SIMLIB_warning("FuzzyIIORules: estimated error of surface %g is greater than maxError/2 = %g", surfError, 0.5*surfMaxError);
+}
+
+/**
+ * Weights of cubic convolution (Catmull-Rom) for points -1, 0, 1, 2.<br>
+ * Vhy kubick konvoluce (Catmull-Rom) pro body -1, 0, 1, 2.
+ */
+static void cubicWeights(double t, double w[4])
+{
+  double t2 = t*t, t3 = t2*t;
+  w[0] = 0.5*(-t3 + 2*t2 - t);
+  w[1] = 0.5*(3*t3 - 5*t2 + 2);
+  w[2] = 0.5*(-3*t3 + 4*t2 + t);
+  w[3] = 0.5*(t3 - t2);
+}
+
+/**
+ * Interpolation of surface.<br>
+ * Interpolace plochy.
+ */
+double FuzzyIIORules::lookup(double x1, double x2)
+{
+  double x[MAX_INPUTS] = { x1, x2 };
+  unsigned c[MAX_INPUTS];
+  double f[MAX_INPUTS];
+  for (int k = 0; k < MAX_INPUTS; k++)
+  {
+    double pos = (x[k] - surfMin[k]) * surfScale[k];
+    if (pos < 0.0 || pos > surfN[k] - 1 + 1e-9)
+      SIMLIB_error("Fuzzification error: value %lf out of range in fuzzy set \"%s\".", x[k], in[k]->m->name());
+    c[k] = unsigned(pos);
+    if (c[k] > surfN[k] - 2)
+      c[k] = surfN[k] - 2;
+    f[k] = pos - c[k];
+  }
+  const unsigned n0 = surfN[0];
+  const double *p = &surf[c[1]*n0 + c[0]];
+  if (surface == sfBilinear)
+    return (1 - f[1])*((1 - f[0])*p[0] + f[0]*p[1]) +
+           f[1]*((1 - f[0])*p[n0] + f[0]*p[n0 + 1]);
+  // bicubic: points outside of grid are replaced by boundary points
+  double w0[4], w1[4];
+  cubicWeights(f[0], w0);
+  cubicWeights(f[1], w1);
+  double sum = 0.0;
+  for (int b = 0; b < 4; b++)
+  {
+    int j = int(c[1]) + b - 1;
+    j = (j < 0) ? 0 : (j > int(surfN[1]) - 1) ? surfN[1] - 1 : j;
+    const double *row = &surf[j*n0];
+    double r = 0.0;
+    for (int a = 0; a < 4; a++)
+    {
+      int i = int(c[0]) + a - 1;
+      i = (i < 0) ? 0 : (i > int(n0) - 1) ? n0 - 1 : i;
+      r += w0[a]*row[i];
+    }
+    sum += w1[b]*r;
+  }
+  return sum;
+}
 /////////////////////////////////////////////////////////////////////////////////////////
 // FuzzyGeneralRules
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -18,13 +18,15 @@ SIMLIB_IMPLEMENTATION;
 
 static const int MAX_ATEXIT = 10; // for internal use it is enough
 static int counter = 0; // internal module counter
-static SIMLIB_atexit_function_t atexit_array[MAX_ATEXIT] = { 0, };
+// functions registered by each thread (simulation context)
+static thread_local SIMLIB_atexit_function_t atexit_array[MAX_ATEXIT] = { 0, };
 
 // used in SIMLIB
 void SIMLIB_atexit(SIMLIB_atexit_function_t p) {
     DEBUG(DBG_ATEXIT,("SIMLIB_atexit(%p)", p ));
     int i;
     for(i=0; i<MAX_ATEXIT; i++) {
+       if(atexit_array[i]==p) return; // already registered
        if(atexit_array[i]==0) break;
     }
     if(i<MAX_ATEXIT)
@@ -33,13 +35,14 @@ void SIMLIB_atexit(SIMLIB_atexit_function_t p) {
        SIMLIB_internal_error();
 }
 
-// used here
-static void SIMLIB_atexit_call() {
+// used here and by Simulation destructor (thread exit)
+void SIMLIB_atexit_call() {
     DEBUG(DBG_ATEXIT,("ATEXIT:"));
     for(int i=0; i<MAX_ATEXIT; i++)
        if(atexit_array[i]) {
            DEBUG(DBG_ATEXIT,("ATEXIT_CALL#%d: %p ", i, atexit_array[i]));
            atexit_array[i]();
+           atexit_array[i] = 0;
     }
 }
 
@@ -0,0 +1,127 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file batchstat.cc  Statistics with batch means confidence interval
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+// class BatchStat implementation
+//
+// values of single long run are grouped into batches, batch means are
+// approximately independent for large batches; memory is constant:
+// the number of batches is kept between k and 2k by joining neighbour
+// batches and doubling the batch size
+//
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "internal.h"
+
+#include <cmath>     // sqrt()
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+////////////////////////////////////////////////////////////////////////////
+//  constructors
+//
+BatchStat::BatchStat(unsigned batches) :
+  bsum(0), k(batches), nb(0), bsize(1), cur(0), ncur(0)
+{
+  Dprintf(("BatchStat::BatchStat(%u)", batches));
+  if (k<2) SIMLIB_error(BatchStatError);
+  bsum = new double[2*k];
+}
+
+BatchStat::BatchStat(const char *name, unsigned batches) :
+  bsum(0), k(batches), nb(0), bsize(1), cur(0), ncur(0)
+{
+  Dprintf(("BatchStat::BatchStat(\"%s\",%u)", name, batches));
+  if (k<2) SIMLIB_error(BatchStatError);
+  bsum = new double[2*k];
+  SetName(name);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  destructor
+//
+BatchStat::~BatchStat()
+{
+  Dprintf(("BatchStat::~BatchStat() // \"%s\" ", Name()));
+  delete [] bsum;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  BatchStat::Clear --- initialize
+//
+void BatchStat::Clear()
+{
+  Stat::Clear();
+  nb = 0;
+  bsize = 1;
+  cur = 0;
+  ncur = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  operator ()  --- record value
+//
+void BatchStat::operator () (double x)
+{
+  Stat::operator()(x);
+  cur += x;
+  if (++ncur < bsize)
+    return;
+  bsum[nb++] = cur;             // batch completed
+  cur = 0;
+  ncur = 0;
+  if (nb < 2*k)
+    return;
+  for (unsigned i=0; i<k; i++)  // join neighbour batches
+    bsum[i] = bsum[2*i] + bsum[2*i+1];
+  nb = k;
+  bsize *= 2;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  BatchStat::BatchMean --- mean value of completed batch i
+//
+double BatchStat::BatchMean(unsigned i) const
+{
+  if (i>=nb) SIMLIB_error(StatNoRecError);
+  return bsum[i]/bsize;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  BatchStat::ConfidenceInterval  --- half-width of confidence interval
+//  of mean value computed from means of completed batches
+//
+double BatchStat::ConfidenceInterval(double level) const
+{
+  if (nb<2) SIMLIB_error(StatDispError);
+  double m = 0;
+  for (unsigned i=0; i<nb; i++)
+    m += BatchMean(i);
+  m /= nb;
+  double s2 = 0;
+  for (unsigned i=0; i<nb; i++) {
+    double d = BatchMean(i) - m;
+    s2 += d*d;
+  }
+  s2 /= nb-1;
+  return SIMLIB_StudentQuantile(level, nb-1) * sqrt(s2/nb);
+}
+
+}
+// end
@@ -96,14 +96,16 @@ class Calendar { // abstract base class
     static Calendar * instance();       //!< create/get single instance (singleton)
     /// check if the instance exists
     static bool instance_exists() {
-        return _instance != 0;
+        return _instance() != 0;
     }
+    /// free-list of activation records (owned by simulation context)
+    static EventNoticeAllocator & allocator();
   protected:
     Calendar(): _size(0), mintime(SIMLIB_MAXTIME) {}
     virtual ~Calendar() {} //!< clear is called in derived class dtr
     static void delete_instance();      //!< destroy single instance
   private:
-    static Calendar * _instance;        //!< pointer to single instance
+    static Calendar *& _instance();     //!< pointer to single instance
   ///////////////////////////////////////////////////////////////////////////
   friend void SetCalendar(const char *name); // sets _instance
 };
@@ -239,7 +241,7 @@ class EventNoticeAllocator {
             delete p;
         }
     }
-} allocator;  // global allocator TODO: improve -> singleton
+};  // single instance in each simulation context
 
 
 
@@ -335,7 +337,7 @@ public:
     }
     ~ CalendarListImplementation() {
         clear(true);
-        allocator.clear(); // clear freelist
+        Calendar::allocator().clear(); // clear freelist
     }
 #ifndef NDEBUG
     /// print of calendar contents - FOR DEBUGGING ONLY
@@ -419,7 +421,7 @@ inline EventNotice *EventNotice::Create(Entity *e, double t)
 //                evn->entity, evn->time, evn->priority, this));
   }
   else {
-    evn = allocator.alloc(e,t);
+    evn = Calendar::allocator().alloc(e,t);
 //  Dprintf(("EventNotice::Create(entity=%p, time=%g, [priority=%d]): %p [NEW]",
 //                evn->entity, evn->time, evn->priority, this));
   }
@@ -431,7 +433,7 @@ inline EventNotice *EventNotice::Create(Entity *e, double t)
 //
 inline void EventNotice::Destroy(EventNotice *en)
 {
-  allocator.free(en);   // disconnect, remove item
+  Calendar::allocator().free(en);   // disconnect, remove item
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -1119,7 +1121,7 @@ CalendarQueue::~CalendarQueue()
 {
     Dprintf(("CalendarQueue::~CalendarQueue()"));
     clear(true);
-    allocator.clear(); // clear freelist
+    Calendar::allocator().clear(); // clear freelist
 }
 
 
@@ -1194,28 +1196,42 @@ void CalendarQueue::visualize(const char *msg)
 
 ////////////////////////////////////////////////////////////////////////////
 
-/// static pointer to singleton instance
-Calendar * Calendar::_instance = 0;
+/// pointer to singleton instance (owned by simulation context)
+inline Calendar *& Calendar::_instance() {
+  return Simulation::Current().calendar;
+}
 
 /// interface to singleton instance
 inline Calendar * Calendar::instance() {
-  if(_instance==0) {
+  Calendar *&i = _instance();
+  if(i==0) {
 #if 1 // choose default
-      _instance = CalendarList::create(); // create default calendar
+      i = CalendarList::create(); // create default calendar
 #else
-      _instance = CalendarQueue::create(); // create default calendar
+      i = CalendarQueue::create(); // create default calendar
 #endif
   }
-  return _instance;
+  return i;
+}
+
+/// interface to allocator of activation records
+EventNoticeAllocator & Calendar::allocator() {
+  EventNoticeAllocator *&a = Simulation::Current().allocator;
+  if(a==0)
+      a = new EventNoticeAllocator;
+  return *a;
 }
 
 /// destroy single instance
 void Calendar::delete_instance() {
     Dprintf(("Calendar::delete_instance()"));
-    if(_instance) {
-        delete _instance;           // remove all, free
-        _instance = 0;
+    if(_instance()) {
+        delete _instance();         // remove all, free
+        _instance() = 0;
     }
+    EventNoticeAllocator *&a = Simulation::Current().allocator;
+    delete a;                       // free-list
+    a = 0;
 }
 
 
@@ -1248,14 +1264,14 @@ void SetCalendar(const char *name) {
   if( SIMLIB_Phase == INITIALIZATION ||
       SIMLIB_Phase == SIMULATION ) SIMLIB_error("SetCalendar() can't be used after Init()");
 
-    if(Calendar::_instance) // already initialized
+    if(Calendar::_instance()) // already initialized
         Calendar::delete_instance();
     if(name==0 || std::strcmp(name,"")==0 || std::strcmp(name,"default")==0)
-        Calendar::_instance = CalendarList::create();
+        Calendar::_instance() = CalendarList::create();
     else if(std::strcmp(name,"list")==0)
-        Calendar::_instance = CalendarList::create();
+        Calendar::_instance() = CalendarList::create();
     else if(std::strcmp(name,"cq")==0)
-        Calendar::_instance = CalendarQueue::create();
+        Calendar::_instance() = CalendarQueue::create();
     else
         SIMLIB_error("SetCalendar: bad argument");
 }
@@ -27,19 +27,20 @@ namespace simlib3 {
 SIMLIB_IMPLEMENTATION;
 
 
-bool SIMLIB_ConditionFlag = false;       // condition vector changed
-aCondition *aCondition::First = 0;       // condition list
+thread_local bool SIMLIB_ConditionFlag = false; // condition vector changed
+// condition list is owned by simulation context (Simulation::conditions)
 
 ////////////////////////////////////////////////////////////////////////////
 // aCondition implementation
 //
 aCondition::aCondition() :
-  Next(First)
+  Next(Simulation::Current().conditions)
 {
-  First = this;
+  Simulation::Current().conditions = this;
 }
 
 aCondition::~aCondition() {
+  aCondition *&First = Simulation::Current().conditions;
   if (this==First)
     First = Next;
   else
@@ -55,7 +56,7 @@ aCondition::~aCondition() {
 //
 void aCondition::InitAll() {
   SIMLIB_ConditionFlag = false;
-  for(aCondition *i=First; i; i=i->Next)
+  for(aCondition *i=Simulation::Current().conditions; i; i=i->Next)
     i->Init();
 }
 
@@ -63,11 +64,11 @@ void aCondition::InitAll() {
 // aCondition::SetAll
 //
 void aCondition::SetAll() {
-  for(aCondition *i=First; i; i=i->Next)
+  for(aCondition *i=Simulation::Current().conditions; i; i=i->Next)
     i->SetNewStatus();
 }
 
-bool aCondition::isAny()  { return First!=0; }
+bool aCondition::isAny()  { return Simulation::Current().conditions!=0; }
 
 ////////////////////////////////////////////////////////////////////////////
 // Condition implementation
@@ -104,32 +105,92 @@ void Condition::SetNewStatus()
 /// Condition::operator ()
 //
 bool Condition::Test() {
-  bool x = (in.Value()>=0.0);
+  double value = in.Value();
+  bool x = (value>=0.0);
   if(SIMLIB_DynamicFlag)       // inside numerical integration step
   {
     cc = x;                    // new condition status
     if(Change()) {             // is change of status?
       SIMLIB_ConditionFlag = true;  // global change flag
-      ContractStep();          // need to step contraction
+      if(SIMLIB_LocateFlag)
+        Locate(value);         // step to the crossing
+      else
+        ContractStep();        // need to step contraction
     }
     return false;              // test only
   }
   return Change();             // do actions if changed
 }
 
+////////////////////////////////////////////////////////////////////////////
+/// Condition::Locate -- find the change inside integration step
+//
+// Input is evaluated for interpolated states (dense output of the
+// integration method), the crossing is bracketed and found by
+// Illinois variant of regula falsi. The step is then repeated only once
+// with the end just after the crossing (instead of repeated halving).
+//
+void Condition::Locate(double value)
+{
+  const double h = SIMLIB_DeltaTime;          // length of the step
+  if(h <= SIMLIB_MinStep || !IntegratorContainer::isAny()) {
+    ContractStep();                           // default: halve step
+    return;
+  }
+  const double tol = 0.5*SIMLIB_MinStep/h;    // relative to step
+  double a = 0, b = 1;                        // bracket
+  double fb = value;
+  IntegrationMethod::DenseState(0.0);
+  double fa = in.Value();
+  if((fa>=0.0) != bool(ccl)) {                // inconsistent start
+    IntegrationMethod::EndState();
+    ContractStep();
+    return;
+  }
+  int side = 0;
+  double width = b - a;
+  for(int i=0; i<100 && b-a > tol; i++) {
+    double c = (a*fb - b*fa)/(fb - fa);      // regula falsi
+    if(i%3==2) {                              // slow convergence:
+      if(b-a > 0.5*width) c = 0.5*(a+b);      // bisection
+      width = b - a;
+    }
+    if(!(c > a + 0.25*tol && c < b - 0.25*tol))
+      c = 0.5*(a+b);
+    IntegrationMethod::DenseState(c);
+    double fc = in.Value();
+    if((fc>=0.0) == (fb>=0.0)) {              // crossing in [a,c]
+      b = c; fb = fc;
+      if(side == -1) fa *= 0.5;               // Illinois
+      side = -1;
+    } else {                                  // crossing in [c,b]
+      a = c; fa = fc;
+      if(side == +1) fb *= 0.5;
+      side = +1;
+    }
+  }
+  IntegrationMethod::EndState();
+  Dprintf(("Condition::Locate: crossing in [%g,%g] of step %g", a, b, h));
+  if((1 - a)*h <= SIMLIB_MinStep)
+    return;                                   // crossing at the end of step
+  double step = max(b*h, SIMLIB_MinStep);
+  if(step < SIMLIB_EventStep)
+    SIMLIB_EventStep = step;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  test or action
 //
 void aCondition::TestAll()
 {
   SIMLIB_ConditionFlag = false;
-  for(aCondition *i=aCondition::First; i ; i=i->Next)
+  for(aCondition *i=Simulation::Current().conditions; i ; i=i->Next)
     if(i->Test()) SIMLIB_ConditionFlag = true;
 }
 
 void aCondition::AllActions()
 {
-  for(aCondition *i=aCondition::First; i ; i=i->Next)
+  for(aCondition *i=Simulation::Current().conditions; i ; i=i->Next)
     if(i->Test()) i->Action(); /// Change???? ### !!!!
 }
 
@@ -20,6 +20,7 @@
 
 #include "simlib.h"
 #include "internal.h"
+#include "tape.h"
 
 namespace simlib3 {
 
@@ -141,6 +142,10 @@ public:
     Dprintf(("dtr: _Add[%p]", this));
   }
   virtual double Value() { return Input1Value() + Input2Value(); }
+  virtual unsigned Compile(SIMLIB_Tape &t) {
+      unsigned a = CompileInput1(t);
+      return t.Op(SIMLIB_Tape::ADD, a, CompileInput2(t));
+  }
   virtual const char *Name() const {
       if(HasName()) return _name;
       else return SIMLIB_create_tmp_name("_Add{%p}", this);
@@ -161,6 +166,10 @@ public:
     Dprintf(("dtr: _Sub[%p]", this));
   }
   virtual double Value() { return Input1Value() - Input2Value(); }
+  virtual unsigned Compile(SIMLIB_Tape &t) {
+      unsigned a = CompileInput1(t);
+      return t.Op(SIMLIB_Tape::SUB, a, CompileInput2(t));
+  }
   virtual const char *Name() const {
       if(HasName()) return _name;
       else return SIMLIB_create_tmp_name("_Sub{%p}", this);
@@ -181,6 +190,10 @@ public:
     Dprintf(("dtr: _Mul[%p]", this));
   }
   virtual double Value() { return Input1Value() * Input2Value(); }
+  virtual unsigned Compile(SIMLIB_Tape &t) {
+      unsigned a = CompileInput1(t);
+      return t.Op(SIMLIB_Tape::MUL, a, CompileInput2(t));
+  }
   virtual const char *Name() const {
       if(HasName()) return _name;
       else return SIMLIB_create_tmp_name("_Mul{%p}", this);
@@ -201,6 +214,10 @@ public:
     Dprintf(("dtr: _Div[%p]", this));
   }
   virtual double Value() { return Input1Value() / Input2Value(); }
+  virtual unsigned Compile(SIMLIB_Tape &t) {
+      unsigned a = CompileInput1(t);
+      return t.Op(SIMLIB_Tape::DIV, a, CompileInput2(t));
+  }
   virtual const char *Name() const {
       if(HasName()) return _name;
       else return SIMLIB_create_tmp_name("_Div{%p}", this);
@@ -237,6 +254,9 @@ public:
     Dprintf(("dtr: _UMinus[%p]", this));
   }
   virtual double Value()    { return -InputValue(); }
+  virtual unsigned Compile(SIMLIB_Tape &t) {
+      return t.Op(SIMLIB_Tape::NEG, CompileInput(t));
+  }
   virtual const char *Name() const {
       if(HasName()) return _name;
       else return SIMLIB_create_tmp_name("_UMinus{%p}", this);
@@ -257,6 +277,7 @@ class _Time: public aContiBlock {
  public:
   _Time() {}
   virtual double Value () { return Time; }
+  virtual unsigned Compile(SIMLIB_Tape &t) { return t.Time(); }
   virtual const char *Name() const { return "T(Time)"; }
 };
 
@@ -16,7 +16,8 @@
 //
 // LIMITS:
 //     dt <= MaxStep --- problem with too small delay time
-//     increasing dt --- problem with buffer length
+//     increasing dt --- history longer than dt should be kept
+//                       (see Delay::SetHistory)
 //
 
 ////////////////////////////////////////////////////////////////////////////
@@ -27,7 +28,7 @@
 #include "delay.h"              // extra header, TODO: move to simlib.h
 #include "internal.h"
 
-#include <deque>                // for buffer implementation
+#include <vector>               // for buffer implementation
 #include <list>                 // for registration list of all delay blocks
 
 
@@ -42,7 +43,7 @@ SIMLIB_IMPLEMENTATION;
 ////////////////////////////////////////////////////////////////////////////
 /// continuous delay block
 class SIMLIB_Delay {
-    static std::list<Delay *> *listptr; //!< list of delay objects -- singleton
+    static thread_local std::list<Delay *> *listptr; //!< list of delay objects -- singleton
   public:
     static void Register(Delay *p) {    //!< must be called by Delay ctr
         if( listptr == 0 ) Initialize();
@@ -83,7 +84,7 @@ class SIMLIB_Delay {
 };
 
 // static member must be initializad
-std::list<Delay *> *SIMLIB_Delay::listptr = 0;
+thread_local std::list<Delay *> *SIMLIB_Delay::listptr = 0;
 
 
 #ifndef SIMLIB_public_Delay_Buffer
@@ -92,6 +93,8 @@ struct Delay::Buffer {
     virtual void put(double value, double time) = 0;    //!< store value
     virtual double get(double time) = 0;        //!< read interpolated value
     virtual void clear() = 0;                   //!< initialize buffer
+    virtual void limits(double keep, size_t maxsize) = 0; //!< retention
+    virtual void order(int k) = 0;              //!< interpolation order
     virtual ~Buffer() {};
 };
 #endif
@@ -101,26 +104,96 @@ struct Delay::Buffer {
 ///
 /// This buffer inherits interface from Delay::Buffer (we can use various
 /// implementations later)
-/// method get() does linear interpolation ? TODO: should be split
+///
+/// Samples are stored in contiguous ring buffer (capacity 2^k, doubled when
+/// full). Method get() starts the search at the position found last time
+/// (the delayed time usually moves by one sample per step), binary search
+/// is used for bigger jumps. Samples older than `keep` time units before
+/// the last sample are removed by put().
 ///
 class SIMLIB_DelayBuffer : public Delay::Buffer { // memory for delayed signal
-    /// pair (t,val) for storing in buffer TODO: use std::tuple
+    /// pair (t,val) for storing in buffer
     struct Pair {
         double time;    //<! sample time
         double value;   //<! sampled value
+        Pair() {}
         Pair(double t, double v) : time(t), value(v) {}
         bool operator == (Pair &p) { return p.time==time && p.value==value; }
     };
-    std::deque<Pair> buf;       //!< storage for samples
+    std::vector<Pair> buf;      //!< storage for samples (size 2^k)
+    size_t head;                //!< index of the oldest sample in buf
+    size_t count;               //!< number of samples
+    size_t cursor;              //!< last found sample (0..count-1)
+    double keep;                //!< minimal length of history
+    size_t maxsize;             //!< maximal number of samples (0=any)
+    int k;                      //!< interpolation order 1..3
     Pair last_insert;           //!< last inserted value (for optimization)
 
+    /// i-th oldest sample
+    const Pair &at(size_t i) const { return buf[(head + i) & (buf.size()-1)]; }
+
+    /// remove the oldest sample
+    void pop_front() {
+        head = (head + 1) & (buf.size()-1);
+        count--;
+        if( cursor > 0 ) cursor--;
+    }
+
+    /// double the capacity (samples are moved to start of new buffer)
+    void grow() {
+        std::vector<Pair> b(2*buf.size());
+        for(size_t i=0; i<count; i++)
+            b[i] = at(i);
+        buf.swap(b);
+        head = 0;
+    }
+
+    /// linear interpolation between samples l and l+1
+    double linear(size_t l, double t) const {
+        const Pair &a = at(l), &b = at(l+1);
+        return a.value + (b.value - a.value)*(t - a.time)/(b.time - a.time);
+    }
+
+    /// index of the last sample with time <= t (t >= time of oldest sample)
+    size_t find(double t) {
+        size_t i = cursor;
+        if( i >= count ) i = count-1;
+        if( at(i).time <= t ) {         // usual case: move forward a bit
+            for(int n=0; n<4; n++, i++)
+                if( i+1 == count || at(i+1).time > t )
+                    return i;
+        } else
+            i = 0;
+        size_t hi = count;              // binary search: at(hi).time > t
+        while( hi - i > 1 ) {
+            size_t m = i + (hi - i)/2;
+            if( at(m).time <= t ) i = m;
+            else                  hi = m;
+        }
+        return i;
+    }
+
  public:
 
-    SIMLIB_DelayBuffer(): buf(), last_insert(-2,0) { /*empty*/ }
+    SIMLIB_DelayBuffer(): buf(16), head(0), count(0), cursor(0),
+        keep(0), maxsize(0), k(1), last_insert(-2,0) { /*empty*/ }
 
     virtual void clear() {
         last_insert = Pair(-2,0); // we need it for optimization
-        buf.clear();            // empty buffer
+        head = count = cursor = 0; // empty buffer
+    }
+
+    virtual void limits(double _keep, size_t _maxsize) {
+        keep = _keep;
+        maxsize = _maxsize;
+        if( maxsize > 0 && maxsize < 4 )
+            maxsize = 4;        // samples needed for cubic interpolation
+    }
+
+    virtual void order(int _k) {
+        if( _k < 1 || _k > 3 )
+            SIMLIB_error(DelayOrderErr);
+        k = _k;
     }
 
     virtual void put(double value, double time) {
@@ -131,44 +204,56 @@ class SIMLIB_DelayBuffer : public Delay::Buffer { // memory for delayed signal
             return;
         last_insert = p;
 #endif
-        buf.push_back(p);       // add at buffer end
+        // remove old samples (two samples before the horizon are kept
+        // for interpolation of order 3)
+        double horizon = time - keep;
+        while( count > 3 && at(2).time <= horizon )
+            pop_front();
+        if( maxsize > 0 )
+            while( count >= maxsize )
+                pop_front();
+        if( count == buf.size() )
+            grow();
+        buf[(head + count) & (buf.size()-1)] = p;      // add at buffer end
+        count++;
     }
 
     virtual double get(double time) // get delayed value (with interpolation)
     {
-        // TODO: this code is EXPERIMENTAL ### (needs optimization)
-        Pair p(-1,0);
-        Pair l(-1,0);
-        std::deque<Pair>::iterator i;
-        int n; // number of records (samples) skipped
         // ASSERT: there should be at least one record in the buffer
-        for( n=0, i=buf.begin(); i!=buf.end(); ++i ) {
-            l = p;
-            p = *i;
-            n++;
-            if( p.time > time ) break;
-        }
-        // ASSERT: n>0
-        if( n < 2 )     // we want time before first recorded sample
-            return p.value;     // use first buffer value as default
-        else {          // there are at least two samples recorded
-            if( p.time < time ) {          // delay too small ###
+        if( count == 0 )
+            return 0;
+        if( time < at(0).time ) // we want time before first recorded sample
+            return at(0).value; // use first buffer value as default
+        size_t l = find(time);
+        cursor = l;
+        if( l+1 == count ) {    // no sample after time
+            if( at(l).time < time )        // delay too small ###
                 SIMLIB_error(DelayTimeErr);// TODO: ### do it better
+            return at(l).value;
+        }
+        // standard situation: at(l).time <= time < at(l+1).time
+        int n = k;              // order of polynomial
+        if( (size_t)n >= count ) n = count-1;
+        size_t first = l > (size_t)(n-1)/2 ? l - (n-1)/2 : 0;
+        if( first + n >= count ) first = count-1 - n;
+        if( n == 1 )
+            return linear(l, time);
+        // Lagrange polynomial over samples first..first+n
+        double y = 0;
+        for(int i=0; i<=n; i++) {
+            const Pair &pi = at(first+i);
+            double w = 1;
+            for(int j=0; j<=n; j++) {
+                if( j == i ) continue;
+                const Pair &pj = at(first+j);
+                if( pi.time == pj.time )        // step change
+                    return linear(l, time);
+                w *= (time - pj.time)/(pi.time - pj.time);
             }
-            // standard situation
-            const int LIMIT=2; // >=2  --- allows change of delay if bigger
-                               // WARNING: slow for bigger LIMIT
-            // remove old items in buffer
-            for(; n>LIMIT; n--)
-                buf.pop_front(); // remove front records
-            // linear interpolation
-            double dt = p.time - l.time;
-            double dy = p.value - l.value;
-            if( dt <= 0.0) { // ASSERT: dt > 0
-                SIMLIB_error(DelayTimeErr);
-            }
-            return l.value + dy*(time-l.time)/dt;
+            y += w * pi.value;
         }
+        return y;
     } // get
 }; // class SIMLIB_DelayBuffer
 
@@ -181,9 +266,12 @@ Delay::Delay(Input i, double _dt, double ival) :
     last_value( ival ),                 // last sample value
     buffer( new SIMLIB_DelayBuffer ),   // allocate delay buffer
     dt( _dt ),                          // Parameter: delay time
-    initval( ival )                     // initial value of delay block
+    initval( ival ),                    // initial value of delay block
+    history( 0 ),                       // keep history of length dt
+    maxsamples( 0 )                     // unlimited number of samples
 {
     Dprintf(("Delay::Delay(in=%p, dt=%g, ival=%g)", &i, _dt, ival));
+    SetLimits();
     SIMLIB_Delay::Register( this );     // register delay in list of delays
     Init(); // initialize -- important for dynamically created delays
 }
@@ -241,8 +329,42 @@ double Delay::Set(double newdelay)
    double last = dt;
    if( newdelay>=0.0 && newdelay<=Time )  // FIXME: condition is too weak ###
       dt = newdelay;
+   SetLimits();
    return last;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+/// set retention bounds of buffer
+///
+/// History of length max(span,dt) is kept, so the delay time can be
+/// increased up to span later (by Set). If maxsamples>0, the number
+/// of samples is limited (older samples are removed even if in span).
+///
+void Delay::SetHistory(double span, size_t _maxsamples)
+{
+   history = span;
+   maxsamples = _maxsamples;
+   SetLimits();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// set order of interpolation between samples
+///
+/// 1 = linear (default), 2 = quadratic, 3 = cubic (Lagrange polynomial
+/// over neighbouring samples, linear at step changes)
+///
+void Delay::SetInterpolation(int order)
+{
+   buffer->order(order);
+   last_value = buffer->get( last_time );  // recompute output
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// pass retention bounds to buffer
+void Delay::SetLimits()
+{
+   buffer->limits(dt > history ? dt : history, maxsamples);
+}
+
 } // namespace
 
@@ -34,6 +34,8 @@ class Delay : public aContiBlock1 {
         virtual void put(double value, double time) = 0; //!< sample
         virtual double get(double time) = 0; //!< get interpolated value
         virtual void clear() = 0; //!< initialize buffer
+        virtual void limits(double keep, size_t maxsize) = 0; //!< retention
+        virtual void order(int k) = 0; //!< interpolation order
         virtual ~Buffer() {};
     };
 #else
@@ -46,6 +48,9 @@ class Delay : public aContiBlock1 {
   protected: // parameters
     double dt;                  //!< Parameter: delay time (should be > MaxStep)
     double initval;             //!< initial value (used at start)
+    double history;             //!< minimal length of kept history
+    size_t maxsamples;          //!< maximal number of kept samples (0=any)
+    void SetLimits();           //!< pass retention bounds to buffer
   public: // interface
     Delay(Input i, double dt, double initvalue=0); // dt > MaxStep
     ~Delay();
@@ -53,6 +58,8 @@ class Delay : public aContiBlock1 {
     void Sample();              //!< sample input (called automatically)
     virtual double Value();     //!< output of delay block
     double Set(double newDT);   //!< change delay time (EXPERIMENTAL)
+    void SetHistory(double span, size_t maxsamples=0); //!< retention bounds
+    void SetInterpolation(int order); //!< 1=linear (default), 2, 3
 }; // class Delay
 
 } // namespace
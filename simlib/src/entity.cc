@@ -14,6 +14,7 @@
 
 #include "simlib.h"
 #include "internal.h"
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////
 // implementation
@@ -24,9 +25,77 @@ namespace simlib3 {
 SIMLIB_IMPLEMENTATION;
 
 /// current number of entities in model
-static unsigned long SIMLIB_Entity_Count = 0L; // # of entities in model
+static thread_local unsigned long SIMLIB_Entity_Count = 0L; // # of entities in model
 /// serial number of created entity
-unsigned long Entity::_Number = 0L;     // # of entity creations
+thread_local unsigned long Entity::_Number = 0L;     // # of entity creations
+
+////////////////////////////////////////////////////////////////////////////
+/// table of entity slots for handles (owned by simulation context)
+/// slot is allocated at first Entity::Handle() call, released by ~Entity
+class EntityTable {
+    struct Slot {
+        Entity *entity;         // 0 if free
+        unsigned generation;    // incremented at release
+    };
+    std::vector<Slot> slots;            // slot 0 is null handle
+    std::vector<unsigned> free_slots;   // released slots
+    EntityTable(): slots(1) {
+        slots[0].entity = 0;
+        slots[0].generation = 0;
+    }
+    static void delete_instance() {     // called by SIMLIB_atexit_call()
+        Dprintf(("EntityTable::delete_instance()"));
+        delete Simulation::Current().entities;
+        Simulation::Current().entities = 0;
+    }
+  public:
+    static EntityTable *existing() { return Simulation::Current().entities; }
+    static EntityTable *instance() {
+        EntityTable *&t = Simulation::Current().entities;
+        if(t == 0) {
+            t = new EntityTable;
+            SIMLIB_atexit(delete_instance);
+        }
+        return t;
+    }
+    unsigned Alloc(Entity *e) {
+        unsigned i;
+        if(free_slots.empty()) {
+            i = slots.size();
+            Slot s = { e, 0 };
+            slots.push_back(s);
+        } else {
+            i = free_slots.back();
+            free_slots.pop_back();
+            slots[i].entity = e;
+        }
+        return i;
+    }
+    bool Owns(unsigned i, const Entity *e) const {  // table can be recreated
+        return i < slots.size() && slots[i].entity == e;
+    }
+    void Free(unsigned i) {
+        slots[i].entity = 0;
+        slots[i].generation++;
+        free_slots.push_back(i);
+    }
+    unsigned Generation(unsigned i) const { return slots[i].generation; }
+    Entity *Get(unsigned i, unsigned g) const {
+        if(i >= slots.size() || slots[i].generation != g)
+            return 0;
+        return slots[i].entity;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// entity referenced by handle (0 if it was destroyed)
+Entity *EntityHandle::get() const
+{
+  if(index == 0)
+      return 0;
+  EntityTable *t = EntityTable::existing();
+  return t ? t->Get(index, generation) : 0;
+}
 
 ////////////////////////////////////////////////////////////////////////////
 ///  constructor
@@ -35,6 +104,8 @@ Entity::Entity(Priority_t p) :
   _MarkTime(0.0),
   _SPrio(0),
   Priority(p),
+  _QKey(0),
+  _Slot(0),
   _evn(0) // pointer to calendar item
 {
   _Number++;                      // # of entities
@@ -49,6 +120,11 @@ Entity::~Entity() {
     SQS::Get(this);           // remove from calendar
 //  _warning(DeletingActive); // TODO:can be important? if sim SIMLIB_error else _warn
   }
+  if (_Slot) {
+    EntityTable *t = EntityTable::existing();
+    if (t && t->Owns(_Slot, this))
+      t->Free(_Slot);         // invalidate handles
+  }
   Entity::_Number--;          // # of entities in model
 }
 
@@ -63,6 +139,19 @@ void Entity::Activate(double t)
 }
 
 
+////////////////////////////////////////////////////////////////////////////
+/// get handle (weak reference) of entity, allocates slot at first use
+EntityHandle Entity::Handle()
+{
+  EntityTable *t = EntityTable::instance();
+  if (_Slot == 0 || !t->Owns(_Slot, this))
+      _Slot = t->Alloc(this);
+  EntityHandle h;
+  h.index = _Slot;
+  h.generation = t->Generation(_Slot);
+  return h;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Passivate - deactivation of process (entity)
 //
@@ -35,63 +35,78 @@ static char _Errors[] = {
 /* 21 */ "Procesis is not initialized\0"
 /* 22 */ "Bad histogram step (step<=0)\0"
 /* 23 */ "Bad histogram interval count (max=10000)\0"
-/* 24 */ "List does not have active item\0"
-/* 25 */ "Empty list\0"
-/* 26 */ "Bad queue reference\0"
-/* 27 */ "Empty WaitUntilList - can't Get() (internal error)\0"
-/* 28 */ "Bad entity reference\0"
-/* 29 */ "Entity not scheduled\0"
-/* 30 */ "Time statistic not initialized\0"
-/* 31 */ "Can't create new integrator in dynamic section\0"
-/* 32 */ "Can't destroy integrator in dynamic section\0"
-/* 33 */ "Can't create new status variable in dynamic section\0"
-/* 34 */ "Can't destroy status variable in dynamic section\0"
-/* 35 */ "Seize(): Can't interrupt facility service\0"
-/* 36 */ "Release(): Facility is released by other than currently serviced process\0"
-/* 37 */ "Release(): Can't release empty facility\0"
-/* 38 */ "Enter() request exceeded the store capacity\0"
-/* 39 */ "Leave() leaves more than currently used\0"
-/* 40 */ "SetCapacity(): can't reduce store capacity\0"
-/* 41 */ "SetQueue(): deleted (old) queue is not empty\0"
-/* 42 */ "Weibul(): lambda<=0.0 or alfa<=1.0\0"
-/* 43 */ "Erlang(): beta<1\0"
-/* 44 */ "NegBin(): q<=0 or k<=0\0"
-/* 45 */ "NegBinM(): m<=0\0"
-/* 46 */ "NegBinM(): p not in range 0..1\0"
-/* 47 */ "Poisson(lambda): lambda<=0\0"
-/* 48 */ "Geom(): q<=0\0"
-/* 49 */ "HyperGeom(): m<=0\0"
-/* 50 */ "HyperGeom(): p not in range 0..1\0"
-/* 51 */ "Can't write output file\0"
-/* 52 */ "Output file can't be open between Init() and Run()\0"
-/* 53 */ "Can't open output file\0"
-/* 54 */ "Can't close output file\0"
-/* 55 */ "Algebraic loop detected\0"
-/* 56 */ "Parameter low>=high\0"
-/* 57 */ "Parameter of quantizer <= 0\0"
-/* 58 */ "Library and header (simlib.h) version mismatch \0"
-/* 59 */ "Semaphore::V() -- bad call\0"
-/* 60 */ "Uniform(l,h) -- bad arguments\0"
-/* 61 */ "Stat::MeanValue()  No record in statistics\0"
-/* 62 */ "Stat::Disp()  Can't compute (n<2)\0"
-/* 63 */ "AlgLoop: t_min>=t_max\0"
-/* 64 */ "AlgLoop: t0 not in  <t_min,t_max>\0"
-/* 65 */ "AlgLoop: method not convergent\0"
-/* 66 */ "AlgLoop: iteration limit exceeded\0"
-/* 67 */ "AlgLoop: iterative block is not in loop\0"
-/* 68 */ "Unknown integration method\0"
-/* 69 */ "Integration method name not unique\0"
-/* 70 */ "Integration step <=0\0"
-/* 71 */ "Start-method is not single-step\0"
-/* 72 */ "Method is not multi-step\0"
-/* 73 */ "Can't switch methods in dynamic section\0"
-/* 74 */ "Can't switch start-methods in dynamic section\0"
-/* 75 */ "Rline: argument n<2\0"
-/* 76 */ "Rline: array is not sorted\0"
-/* 77 */ "Library compiled without debugging support\0"
-/* 78 */ "Dealy is too small (<=MaxStep)\0"
-/* 79 */ "Parameter can not be changed during simulation run\0"
-/* 80 */ "General error\0"
+/* 24 */ "LogHistogram: bad range (0<low<high) or bits (max=16)\0"
+/* 25 */ "LogHistogram::Percentile(): no record or bad percentile (0..100)\0"
+/* 26 */ "List does not have active item\0"
+/* 27 */ "Empty list\0"
+/* 28 */ "Bad queue reference\0"
+/* 29 */ "Empty WaitUntilList - can't Get() (internal error)\0"
+/* 30 */ "Signal deleted while processes are waiting on it\0"
+/* 31 */ "Bad entity reference\0"
+/* 32 */ "Entity not scheduled\0"
+/* 33 */ "Time statistic not initialized\0"
+/* 34 */ "Can't create new integrator in dynamic section\0"
+/* 35 */ "Can't destroy integrator in dynamic section\0"
+/* 36 */ "Can't create new status variable in dynamic section\0"
+/* 37 */ "Can't destroy status variable in dynamic section\0"
+/* 38 */ "Seize(): Can't interrupt facility service\0"
+/* 39 */ "Release(): Facility is released by other than currently serviced process\0"
+/* 40 */ "Release(): Can't release empty facility\0"
+/* 41 */ "Enter() request exceeded the store capacity\0"
+/* 42 */ "Leave() leaves more than currently used\0"
+/* 43 */ "SetCapacity(): can't reduce store capacity\0"
+/* 44 */ "SetQueue(): deleted (old) queue is not empty\0"
+/* 45 */ "Weibul(): lambda<=0.0 or alfa<=1.0\0"
+/* 46 */ "Erlang(): beta<1\0"
+/* 47 */ "NegBin(): q<=0 or k<=0\0"
+/* 48 */ "NegBinM(): m<=0\0"
+/* 49 */ "NegBinM(): p not in range 0..1\0"
+/* 50 */ "Poisson(lambda): lambda<=0\0"
+/* 51 */ "Geom(): q<=0\0"
+/* 52 */ "HyperGeom(): m<=0\0"
+/* 53 */ "HyperGeom(): p not in range 0..1\0"
+/* 54 */ "Can't write output file\0"
+/* 55 */ "Output file can't be open between Init() and Run()\0"
+/* 56 */ "Can't open output file\0"
+/* 57 */ "Can't close output file\0"
+/* 58 */ "Recorder: bad rate number or recording already started\0"
+/* 59 */ "Algebraic loop detected\0"
+/* 60 */ "Parameter low>=high\0"
+/* 61 */ "Parameter of quantizer <= 0\0"
+/* 62 */ "Library and header (simlib.h) version mismatch \0"
+/* 63 */ "Semaphore::V() -- bad call\0"
+/* 64 */ "Uniform(l,h) -- bad arguments\0"
+/* 65 */ "Stat::MeanValue()  No record in statistics\0"
+/* 66 */ "Stat::Disp()  Can't compute (n<2)\0"
+/* 67 */ "Confidence interval level should be in range (0,1)\0"
+/* 68 */ "BatchStat: number of batches should be at least 2\0"
+/* 69 */ "AlgLoop: t_min>=t_max\0"
+/* 70 */ "AlgLoop: t0 not in  <t_min,t_max>\0"
+/* 71 */ "AlgLoop: method not convergent\0"
+/* 72 */ "AlgLoop: iteration limit exceeded\0"
+/* 73 */ "AlgLoop: iterative block is not in loop\0"
+/* 74 */ "Unknown integration method\0"
+/* 75 */ "Integration method name not unique\0"
+/* 76 */ "Integration step <=0\0"
+/* 77 */ "Start-method is not single-step\0"
+/* 78 */ "Method is not multi-step\0"
+/* 79 */ "Can't switch methods in dynamic section\0"
+/* 80 */ "Can't switch start-methods in dynamic section\0"
+/* 81 */ "Rline: argument n<2\0"
+/* 82 */ "Rline: array is not sorted\0"
+/* 83 */ "Library compiled without debugging support\0"
+/* 84 */ "Dealy is too small (<=MaxStep)\0"
+/* 85 */ "Delay: interpolation order should be 1, 2 or 3\0"
+/* 86 */ "Parameter can not be changed during simulation run\0"
+/* 87 */ "Histogram: can't merge histograms with different intervals\0"
+/* 88 */ "RunReplications() can't be used in simulation run\0"
+/* 89 */ "RunPartitions() can't be used in simulation run\0"
+/* 90 */ "Channel: delay (lookahead) should be positive\0"
+/* 91 */ "Channel::Send() used outside of source partition\0"
+/* 92 */ "OptEvaluator: parallel evaluation can't be used in simulation run\0"
+/* 93 */ "Transport1D: number of cells should be at least 1\0"
+/* 94 */ "Transport1D: cell index out of range\0"
+/* 95 */ "General error\0"
 };
 
 char *_ErrMsg(enum _ErrEnum N)
@@ -31,63 +31,78 @@ enum _ErrEnum {
 /* 21 */ ProcessNotInitialized,
 /* 22 */ HistoStepError,
 /* 23 */ HistoCountError,
-/* 24 */ ListActivityError,
-/* 25 */ ListEmptyError,
-/* 26 */ QueueRefError,
-/* 27 */ EmptyWUListError,
-/* 28 */ EntityRefError,
-/* 29 */ EntityIsNotScheduled,
-/* 30 */ TStatNotInitialized,
-/* 31 */ CantCreateIntg,
-/* 32 */ CantDestroyIntg,
-/* 33 */ CantCreateStatus,
-/* 34 */ CantDestroyStatus,
-/* 35 */ FacInterruptError,
-/* 36 */ ReleaseError,
-/* 37 */ ReleaseNotSeized,
-/* 38 */ EnterCapError,
-/* 39 */ LeaveManyError,
-/* 40 */ SetCapacityError,
-/* 41 */ SetQueueError,
-/* 42 */ WeibullError,
-/* 43 */ ErlangError,
-/* 44 */ NegBinError,
-/* 45 */ NegBinMError1,
-/* 46 */ NegBinMError2,
-/* 47 */ PoissonError,
-/* 48 */ GeomError,
-/* 49 */ HyperGeomError1,
-/* 50 */ HyperGeomError2,
-/* 51 */ OutFilePutError,
-/* 52 */ OutFileOpenError,
-/* 53 */ CantOpenOutFile,
-/* 54 */ CantCloseOutFile,
-/* 55 */ AlgLoopDetected,
-/* 56 */ LowGreaterHigh,
-/* 57 */ BadQntzrStep,
-/* 58 */ InconsistentHeader,
-/* 59 */ SemaphoreError,
-/* 60 */ BadUniformParam,
-/* 61 */ StatNoRecError,
-/* 62 */ StatDispError,
-/* 63 */ AL_BadBounds,
-/* 64 */ AL_BadInitVal,
-/* 65 */ AL_Diverg,
-/* 66 */ AL_MaxCount,
-/* 67 */ AL_NotInLoop,
-/* 68 */ NI_UnknownMeth,
-/* 69 */ NI_MultDefMeth,
-/* 70 */ NI_IlStepSize,
-/* 71 */ NI_NotSingleStep,
-/* 72 */ NI_NotMultiStep,
-/* 73 */ NI_CantSetMethod,
-/* 74 */ NI_CantSetStarter,
-/* 75 */ RlineErr1,
-/* 76 */ RlineErr2,
-/* 77 */ NoDebugErr,
-/* 78 */ DelayTimeErr,
-/* 79 */ ParameterChangeErr,
-/* 80 */ UserError,
+/* 24 */ LogHistoParamError,
+/* 25 */ PercentileError,
+/* 26 */ ListActivityError,
+/* 27 */ ListEmptyError,
+/* 28 */ QueueRefError,
+/* 29 */ EmptyWUListError,
+/* 30 */ SignalDeleteError,
+/* 31 */ EntityRefError,
+/* 32 */ EntityIsNotScheduled,
+/* 33 */ TStatNotInitialized,
+/* 34 */ CantCreateIntg,
+/* 35 */ CantDestroyIntg,
+/* 36 */ CantCreateStatus,
+/* 37 */ CantDestroyStatus,
+/* 38 */ FacInterruptError,
+/* 39 */ ReleaseError,
+/* 40 */ ReleaseNotSeized,
+/* 41 */ EnterCapError,
+/* 42 */ LeaveManyError,
+/* 43 */ SetCapacityError,
+/* 44 */ SetQueueError,
+/* 45 */ WeibullError,
+/* 46 */ ErlangError,
+/* 47 */ NegBinError,
+/* 48 */ NegBinMError1,
+/* 49 */ NegBinMError2,
+/* 50 */ PoissonError,
+/* 51 */ GeomError,
+/* 52 */ HyperGeomError1,
+/* 53 */ HyperGeomError2,
+/* 54 */ OutFilePutError,
+/* 55 */ OutFileOpenError,
+/* 56 */ CantOpenOutFile,
+/* 57 */ CantCloseOutFile,
+/* 58 */ RecorderAddErr,
+/* 59 */ AlgLoopDetected,
+/* 60 */ LowGreaterHigh,
+/* 61 */ BadQntzrStep,
+/* 62 */ InconsistentHeader,
+/* 63 */ SemaphoreError,
+/* 64 */ BadUniformParam,
+/* 65 */ StatNoRecError,
+/* 66 */ StatDispError,
+/* 67 */ ConfidenceLevelError,
+/* 68 */ BatchStatError,
+/* 69 */ AL_BadBounds,
+/* 70 */ AL_BadInitVal,
+/* 71 */ AL_Diverg,
+/* 72 */ AL_MaxCount,
+/* 73 */ AL_NotInLoop,
+/* 74 */ NI_UnknownMeth,
+/* 75 */ NI_MultDefMeth,
+/* 76 */ NI_IlStepSize,
+/* 77 */ NI_NotSingleStep,
+/* 78 */ NI_NotMultiStep,
+/* 79 */ NI_CantSetMethod,
+/* 80 */ NI_CantSetStarter,
+/* 81 */ RlineErr1,
+/* 82 */ RlineErr2,
+/* 83 */ NoDebugErr,
+/* 84 */ DelayTimeErr,
+/* 85 */ DelayOrderErr,
+/* 86 */ ParameterChangeErr,
+/* 87 */ HistoMergeError,
+/* 88 */ ReplicationsError,
+/* 89 */ PartitionsError,
+/* 90 */ ChannelDelayError,
+/* 91 */ ChannelSendError,
+/* 92 */ OptEvaluatorError,
+/* 93 */ TransportSizeError,
+/* 94 */ TransportCellError,
+/* 95 */ UserError,
 };
 
 extern char *_ErrMsg(enum _ErrEnum N);
@@ -117,6 +117,7 @@ void Facility::Seize(Entity * e, ServicePriority_t sp)
     CHECKENTITY(e);
     if (e != Current)
         SIMLIB_error(EntityRefError);
+    Changed.Notify();           // state change (WaitUntilOn)
     e->_SPrio = sp;
     if (!Busy()) {
         in = e;                 // seize by entity
@@ -159,6 +160,7 @@ void Facility::Release(Entity * e)
         SIMLIB_error(ReleaseNotSeized); // not seized
     if (e != in)
         SIMLIB_error(ReleaseError);     // seized by other entity
+    Changed.Notify();           // state change (WaitUntilOn)
     in = NULL;                  // empty
     tstat(0);                   // record
     tstat.n--;                  // correction !!
@@ -205,39 +207,7 @@ void Facility::QueueIn(Entity * e, ServicePriority_t sp)
     Dprintf((" %s --> Q1 of %s ", e->Name(), Name()));
     CHECKENTITY(e);
     e->_SPrio = sp;
-#if  0                          // _INS_FROM_BEGIN_SLOWER
-    Queue::iterator p = Q1->begin();
-    Queue::iterator end = Q1->end();
-    ServicePriority_t Sprio = e->_SPrio;
-    for (; p != end && static_cast<Entity *>(*p)->_SPrio > Sprio;       // higher service priority first
-         ++p);
-    ServicePriority_t prio = e->Priority;
-    for (; p != end && static_cast<Entity *>(*p)->_SPrio == Sprio && static_cast<Entity *>(*p)->Priority >= prio;       // higher priority first
-         ++p);
-#else
-    Queue::iterator begin = Q1->begin();
-    Queue::iterator p = Q1->end();
-    ServicePriority_t Sprio = e->_SPrio;
-    while (p != begin) {
-        Queue::iterator q = p;
-        --p;
-        if (static_cast<Entity *>(*p)->_SPrio >= Sprio) {       // higher service priority first
-            p = q;
-            break;
-        }
-    }
-    ServicePriority_t prio = e->Priority;
-    while (p != begin) {
-        Queue::iterator q = p;
-        --p;
-        if (static_cast<Entity *>(*p)->_SPrio > Sprio ||
-            static_cast<Entity *>(*p)->Priority >= prio) { // higher priority first
-            p = q;
-            break;
-        }
-    }
-#endif
-    Q1->PredIns(e, p);
+    Q1->ServiceIns(e);          // higher service priority, priority first
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -246,18 +216,8 @@ void Facility::QueueIn(Entity * e, ServicePriority_t sp)
 void Facility::QueueIn2(Entity * e)
 {
     Dprintf((" %s --> Q2 of %s", e->Name(), Name()));
-    ServicePriority_t ps = e->_SPrio;
-    Queue::iterator p = Q2->begin();
-    for (; p != Q2->end()
-            && static_cast<Entity *>(*p)->_SPrio > ps;    // higher service priority first
-         ++p) { /*empty*/ }
-    ServicePriority_t prio = e->Priority;
-    for (; p != Q2->end()
-            && static_cast<Entity *>(*p)->_SPrio == ps
-            && static_cast<Entity *>(*p)->Priority >= prio;    // higher priority first
-         ++p) { /*empty*/ }
     // next sorting -- _RestTime????###
-    Q2->PredIns(e, p);
+    Q2->ServiceIns(e);          // higher service priority, priority first
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -274,6 +234,7 @@ void Facility::Clear()
     Q2->Clear();
     tstat.Clear();
     in = NULL;                  // empty
+    Changed.Notify();
 }
 
 
@@ -17,8 +17,10 @@
 
 #include "simlib.h"
 #include "internal.h"
+#include "tape.h"
 
 #include <cmath>          // functions
+#include <typeinfo>
 
 ////////////////////////////////////////////////////////////////////////////
 // implementation
@@ -42,6 +44,12 @@ double Function1::Value() {
   return ret;
 }
 
+unsigned Function1::Compile(SIMLIB_Tape &t) {
+  if(typeid(*this) != typeid(Function1))  // Value() can be redefined
+    return t.Call(this);
+  return t.Fun1(CompileInput(t), f);
+}
+
 const char *Function1::Name() const {
   if(HasName()) return _name;
   else return SIMLIB_create_tmp_name("Function1{%p}", this);
@@ -61,6 +69,13 @@ double Function2::Value() {
   return ret;
 }
 
+unsigned Function2::Compile(SIMLIB_Tape &t) {
+  if(typeid(*this) != typeid(Function2))  // Value() can be redefined
+    return t.Call(this);
+  unsigned a = CompileInput1(t);
+  return t.Fun2(a, CompileInput2(t), f);
+}
+
 const char *Function2::Name() const {
   if(HasName()) return _name;
   else return SIMLIB_create_tmp_name("Function2{%p}", this);
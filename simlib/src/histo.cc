@@ -114,6 +114,20 @@ void Histogram::operator () (double x)
     dptr[ix+1]++;
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  operator +=  - merge histogram of independent experiment
+//                 (e.g. replication, see RunReplications)
+//
+Histogram &Histogram::operator += (const Histogram &x)
+{
+  if(low!=x.low || step!=x.step || count!=x.count)
+    SIMLIB_error(HistoMergeError);
+  for(unsigned i=0; i<count+2; i++)
+    dptr[i] += x.dptr[i];
+  stat += x.stat;
+  return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Init
 //
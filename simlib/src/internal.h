@@ -10,7 +10,7 @@
  * @mainpage SIMLIB
  * @author Petr Peringer
  * @author David Martinek (fuzzy subsystem)
- * @author David Leka (numerical integration subsystem)
+ * @author David Le�ka (numerical integration subsystem)
  *
  * SIMLIB/C++ is the SIMulation LIBrary for C++ programming language
  *
@@ -81,7 +81,7 @@ enum SIMLIB_Phase_t {
 };
 //! This variable contains the current phase of experiment
 //! (used for internal checking)
-extern const SIMLIB_Phase_t &Phase;
+extern thread_local const SIMLIB_Phase_t &Phase;
 
 ////////////////////////////////////////////////////////////////////////////
 // debugging ...
@@ -93,7 +93,7 @@ extern const SIMLIB_Phase_t &Phase;
 #   define DEBUG(c,s)
 #   define DEBUG_INFO
 #else
-    extern double SIMLIB_Time;            // simulation time
+    extern thread_local double SIMLIB_Time; // simulation time
 #   define DEBUG_INFO "/debug"
     extern unsigned long SIMLIB_debug_flag; // debugging flags
 #   define Dprintf(f) \
@@ -146,8 +146,11 @@ extern const SIMLIB_Phase_t &Phase;
    _Pragma("GCC diagnostic pop") 
 
 // SIMLIB atexit function (for internal use only)
+// registration is per thread: functions are called at the end of program
+// (main thread) or by the simulation context destructor (other threads)
 typedef void (*SIMLIB_atexit_function_t)();
 void SIMLIB_atexit(SIMLIB_atexit_function_t p);
+void SIMLIB_atexit_call();
 
 ////////////////////////////////////////////////////////////////////////////
 // error handling functions
@@ -178,36 +181,39 @@ typedef void (*VoidFunctionPtr)(); // ptr to void function
 
 ////////////////////////////////////////////////////////////////////////////
 // internal variables:
+// all are thread-local --- each thread runs its own simulation
 //
 
-extern bool SIMLIB_DynamicFlag;             // in dynamic section
-extern bool SIMLIB_ResetStatus;             // restart flag
+extern thread_local bool SIMLIB_DynamicFlag;        // in dynamic section
+extern thread_local bool SIMLIB_ResetStatus;        // restart flag
 
-extern SIMLIB_Phase_t SIMLIB_Phase;         // phase of simulation experiment
+extern thread_local SIMLIB_Phase_t SIMLIB_Phase;    // phase of simulation experiment
 
-extern Entity *SIMLIB_Current;              // currently active entity
+extern thread_local Entity *SIMLIB_Current;         // currently active entity
 
-extern int SIMLIB_ERRNO;                    // error number
+extern thread_local int SIMLIB_ERRNO;               // error number
 
-extern bool SIMLIB_ConditionFlag;           // change of condition vector
-extern bool SIMLIB_ContractStepFlag;        // requests shorter step
-extern double SIMLIB_ContractStep;          // requested step size
+extern thread_local bool SIMLIB_ConditionFlag;      // change of condition vector
+extern thread_local bool SIMLIB_ContractStepFlag;   // requests shorter step
+extern thread_local double SIMLIB_ContractStep;     // requested step size
+extern thread_local bool SIMLIB_LocateFlag;         // conditions locate crossings
+extern thread_local double SIMLIB_EventStep;        // step to located crossing
 
-extern double SIMLIB_StepStartTime;         // last step time
-extern double SIMLIB_DeltaTime;             // Time-s_StepStartTime
+extern thread_local double SIMLIB_StepStartTime;    // last step time
+extern thread_local double SIMLIB_DeltaTime;        // Time-s_StepStartTime
 
-extern double SIMLIB_OptStep;               // optimal step
-extern double SIMLIB_MinStep;               // minimal step
-extern double SIMLIB_MaxStep;               // max. step
-extern double SIMLIB_StepSize;              // actual step
+extern thread_local double SIMLIB_OptStep;          // optimal step
+extern thread_local double SIMLIB_MinStep;          // minimal step
+extern thread_local double SIMLIB_MaxStep;          // max. step
+extern thread_local double SIMLIB_StepSize;         // actual step
 
-extern double SIMLIB_AbsoluteError;         // absolute error tolerance
-extern double SIMLIB_RelativeError;         // relative error
+extern thread_local double SIMLIB_AbsoluteError;    // absolute error tolerance
+extern thread_local double SIMLIB_RelativeError;    // relative error
 
-extern double SIMLIB_StartTime;       // time of simulation start
-extern double SIMLIB_Time;            // simulation time
-extern double SIMLIB_NextTime;        // next-event time
-extern double SIMLIB_EndTime;         // time of simulation end
+extern thread_local double SIMLIB_StartTime;  // time of simulation start
+extern thread_local double SIMLIB_Time;       // simulation time
+extern thread_local double SIMLIB_NextTime;   // next-event time
+extern thread_local double SIMLIB_EndTime;    // time of simulation end
 
 // TODO: move to context (public methods with prefix calendar::?)
 
@@ -232,11 +238,41 @@ void SIMLIB_ContinueInit();          // initialize variables
 void SIMLIB_DoConditions();          // perform state events
 void SIMLIB_WUClear();               // clear WUList
 
+// seed of independent random stream i of n (see RunReplications)
+long SIMLIB_RandomStreamSeed(unsigned long i, unsigned long n);
+
+// sources of uniform numbers for generators (random2.cc, random3.cc):
+// base generator Random() (see SetBaseRandomGenerator) or RandomStream
+struct SIMLIB_BaseGen {
+  double operator () () { return Random(); }
+};
+
+struct SIMLIB_StreamGen {
+  RandomStream &s;
+  SIMLIB_StreamGen(RandomStream &x) : s(x) {}
+  double operator () () { return s.Random(); }
+};
+
+// compensated summation (Kahan-Babuska): s+c is the sum of all x
+inline void SIMLIB_KahanAdd(double &s, double &c, double x)
+{
+    double t = s + x;
+    if((s<0 ? -s : s) >= (x<0 ? -x : x))
+        c += (s - t) + x;       // low-order bits of x lost
+    else
+        c += (x - t) + s;       // low-order bits of s lost
+    s = t;
+}
+
+// quantile of Student's t distribution for two-sided confidence
+// interval with given level (e.g. 0.95) and df degrees of freedom
+double SIMLIB_StudentQuantile(double level, unsigned long df);
+
 
 //////////////////////////////////////////////////////////////////////////
 // MACROS --- Hooks into simulation control algorithm
 //
-// we use static pointers to void function()
+// we use static (thread-local) pointers to void function()
 // function can be installed by calling INSTALL_HOOK(hook_name,function)
 // used mainly in run.cc
 
@@ -264,7 +300,7 @@ void SIMLIB_WUClear();               // clear WUList
 // can be used at global scope
 //
 #define DEFINE_HOOK(name)  \
-        static void (* HOOK_PTR_NAME(name) )() = 0; \
+        static thread_local void (* HOOK_PTR_NAME(name) )() = 0; \
         void HOOK_INST_NAME(name)(void (*f)())  { HOOK_PTR_NAME(name) = f; }
 
 
@@ -18,8 +18,12 @@
 
 #include "simlib.h"
 #include "internal.h"
+#include "tape.h"
 
 #include <cmath>
+#include <typeinfo>
+#include <cstdint>
+#include <cstring>
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -29,34 +33,36 @@ namespace simlib3 {
 
 SIMLIB_IMPLEMENTATION;
 
-int SIMLIB_ERRNO=0;
+// step control variables are thread-local (see class Simulation)
 
-double SIMLIB_StepStartTime;         //!< last step time
-double SIMLIB_DeltaTime;             //!< Time-SIMLIB_StepStartTime
+thread_local int SIMLIB_ERRNO=0;
 
-double SIMLIB_OptStep;               //!< optimal step
-double SIMLIB_MinStep=1e-10;         //!< minimal step
-double SIMLIB_MaxStep=1;             //!< max. step
-double SIMLIB_StepSize;              //!< actual step
+thread_local double SIMLIB_StepStartTime;    //!< last step time
+thread_local double SIMLIB_DeltaTime;        //!< Time-SIMLIB_StepStartTime
 
-double SIMLIB_AbsoluteError=0;       //!< absolute error
-double SIMLIB_RelativeError=0.001;   //!< relative error
+thread_local double SIMLIB_OptStep;          //!< optimal step
+thread_local double SIMLIB_MinStep=1e-10;    //!< minimal step
+thread_local double SIMLIB_MaxStep=1;        //!< max. step
+thread_local double SIMLIB_StepSize;         //!< actual step
+
+thread_local double SIMLIB_AbsoluteError=0;      //!< absolute error
+thread_local double SIMLIB_RelativeError=0.001;  //!< relative error
 
 // step limits
-const double &MinStep=SIMLIB_MinStep;        //!< minimal integration step
-const double &MaxStep=SIMLIB_MaxStep;        //!< maximal integration step
-const double &StepSize=SIMLIB_StepSize;      //!< actual integration step
-const double &OptStep=SIMLIB_OptStep;        //!< optimal integration step
+thread_local const double &MinStep=SIMLIB_MinStep;   //!< minimal integration step
+thread_local const double &MaxStep=SIMLIB_MaxStep;   //!< maximal integration step
+thread_local const double &StepSize=SIMLIB_StepSize; //!< actual integration step
+thread_local const double &OptStep=SIMLIB_OptStep;   //!< optimal integration step
 //const double &StepStartTime=SIMLIB_StepStartTime; // start of step
 
 // error params
-const double &AbsoluteError=SIMLIB_AbsoluteError; //!< max. abs. error of integration
-const double &RelativeError=SIMLIB_RelativeError; //!< max. rel. error
+thread_local const double &AbsoluteError=SIMLIB_AbsoluteError; //!< max. abs. error of integration
+thread_local const double &RelativeError=SIMLIB_RelativeError; //!< max. rel. error
 
-bool SIMLIB_DynamicFlag = false;          //!< in dynamic section
+thread_local bool SIMLIB_DynamicFlag = false;     //!< in dynamic section
 
-bool SIMLIB_ContractStepFlag = false;     //!< requests shorter step
-double  SIMLIB_ContractStep = SIMLIB_MAXTIME;    //!< requested step size
+thread_local bool SIMLIB_ContractStepFlag = false;         //!< requests shorter step
+thread_local double SIMLIB_ContractStep = SIMLIB_MAXTIME;  //!< requested step size
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -83,7 +89,7 @@ void ContractStep(double time)
 ////////////////////////////////////////////////////////////////////////////
 /// \var bool SIMLIB_ResetStatus
 /// flag set if there is a need for integration method restart
-bool SIMLIB_ResetStatus = false;
+thread_local bool SIMLIB_ResetStatus = false;
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -155,8 +161,8 @@ void Integrator::CtrInit() {
   if(SIMLIB_DynamicFlag) {
     SIMLIB_error(CantCreateIntg);  // can't in 'dynamic section' !!!
   }
-  // put integrator into list & retain position of it
-  it_list=IntegratorContainer::Insert(this);
+  // put integrator into container (sets arrays and slot)
+  IntegratorContainer::Insert(this);
   // Dprintf(("constructor: Integrator[%p]  #%d", this, Number));
   SIMLIB_ResetStatus = true; //???????????????????????????????
 }
@@ -213,14 +219,15 @@ Integrator::~Integrator()
   if(SIMLIB_DynamicFlag) {
     SIMLIB_error(CantDestroyIntg);  // can't in 'dynamic section' !!!
   }
-  IntegratorContainer::Erase(it_list);  // remove integrator from list
+  IntegratorContainer::Erase(this);  // remove integrator from container
 }
 
 
 ////////////////////////////////////////////////////////////////////////////
 /// set initial value of integrator
 void Integrator::Init(double initvalue) {
-  ss = initval = initvalue;
+  initval = initvalue;
+  SetState(initvalue);
   SIMLIB_ResetStatus = true; // if in simulation
 }
 
@@ -229,7 +236,7 @@ void Integrator::Init(double initvalue) {
 /// set the integrator status value (step change)
 void Integrator::Set(double value)
 {
-  ss = value;
+  SetState(value);
   SIMLIB_ResetStatus = true;  // always
 }
 
@@ -239,8 +246,30 @@ void Integrator::Set(double value)
 void Integrator::Eval()
 {
 //  Dprintf(("START: Integrator[%p]::Eval()", this));
-  dd = InputValue();
-//  Dprintf(("STOP: Integrator[%p]::Eval() %g ", this, dd));
+  SetDiff(InputValue());
+//  Dprintf(("STOP: Integrator[%p]::Eval() %g ", this, GetDiff()));
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// set integrator input block expression
+Input Integrator::SetInput(Input inp)
+{
+  if(arrays->tape!=0) {  // compile again
+    delete arrays->tape;
+    arrays->tape = 0;
+  }
+  return input.Set(inp);
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// add integrator output to evaluation tape (see tape.cc)
+unsigned Integrator::Compile(SIMLIB_Tape &t)
+{
+  if(typeid(*this) != typeid(Integrator))  // Value() can be redefined
+    return t.Call(this);
+  return t.State(slot);
 }
 
 
@@ -248,8 +277,8 @@ void Integrator::Eval()
 /// get integrator status (output value)
 double Integrator::Value()
 {
-//  Dprintf(("Integrator[%p]::Value() = %g ", this, ss));
-  return ss;
+//  Dprintf(("Integrator[%p]::Value() = %g ", this, GetState()));
+  return arrays->ss[slot];
 }
 
 
@@ -261,49 +290,275 @@ const char *Integrator::Name() const
         return SIMLIB_create_tmp_name("Integrator{%p}", this);
 }
 
+
+/*******************************************************/
+/*****  Outline members of class IntegratorVector  *****/
+/*******************************************************/
+
+////////////////////////////////////////////////////////////////////////////
+/// constructor: allocate n states (zero values)
+IntegratorVector::IntegratorVector(size_t n) : arrays(0), first(0), count(0)
+{
+  Dprintf(("IntegratorVector[%p]::IntegratorVector(%lu)",
+           this, (unsigned long)n));
+  if(SIMLIB_DynamicFlag) {
+    SIMLIB_error(CantCreateIntg);  // can't in 'dynamic section' !!!
+  }
+  IntegratorContainer::Insert(this, n);
+  SIMLIB_ResetStatus = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// destructor removes states from container
+IntegratorVector::~IntegratorVector()
+{
+  Dprintf(("destructor: IntegratorVector[%p]", this));
+  if(SIMLIB_DynamicFlag) {
+    SIMLIB_error(CantDestroyIntg);  // can't in 'dynamic section' !!!
+  }
+  IntegratorContainer::Erase(this);
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// get state i
+double IntegratorVector::Value(size_t i)
+{
+  return arrays->ss[first + i];
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// set state i (step change, like Integrator::Set)
+void IntegratorVector::Set(size_t i, double value)
+{
+  arrays->ss[first + i] = value;
+  SIMLIB_ResetStatus = true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// add state i to evaluation tape (for Compile of output blocks)
+unsigned IntegratorVector::CompileState(SIMLIB_Tape &t, size_t i)
+{
+  return t.State(first + i);
+}
+
+/*******************************************************/
+/*****  Outline members of class IntegratorArrays  *****/
+/*******************************************************/
+
+/// alignment of arrays (in doubles, 64 bytes = cache line, SIMD registers)
+static const size_t SIMLIB_IntegratorAlign = 8;
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorArrays::IntegratorArrays -- empty arrays
+//
+IntegratorArrays::IntegratorArrays():
+  mem(0), capacity(0), items(0), n(0), ss(0), dd(0), ssl(0), ddl(0), tape(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorArrays::~IntegratorArrays -- free memory
+//
+IntegratorArrays::~IntegratorArrays()
+{
+  delete [] mem;
+  delete [] items;
+  delete tape;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorArrays::Reserve
+//  allocate arrays for at least size integrators, keep values
+//  (called outside of the dynamic section only: integration methods
+//   can use pointers to arrays during the step)
+//
+void IntegratorArrays::Reserve(size_t size)
+{
+  if(size <= capacity)
+    return;
+  size_t cap = 2*capacity;
+  if(cap < 4*SIMLIB_IntegratorAlign)
+    cap = 4*SIMLIB_IntegratorAlign;
+  if(cap < size)
+    cap = size;
+  cap = (cap + SIMLIB_IntegratorAlign-1) / SIMLIB_IntegratorAlign
+        * SIMLIB_IntegratorAlign;   // all four arrays aligned
+  Dprintf(("IntegratorArrays::Reserve(%lu) capacity=%lu",
+           (unsigned long)size, (unsigned long)cap));
+  double *m = new double[4*cap + SIMLIB_IntegratorAlign];
+  std::uintptr_t a = reinterpret_cast<std::uintptr_t>(m);
+  const std::uintptr_t bytes = SIMLIB_IntegratorAlign*sizeof(double);
+  double *p = m + ((bytes - a%bytes) % bytes) / sizeof(double);
+  Integrator **it = new Integrator*[cap];
+  if(n > 0) {
+    std::memcpy(it,         items, n*sizeof(Integrator*));
+    std::memcpy(p,          ss,    n*sizeof(double));
+    std::memcpy(p + cap,    dd,    n*sizeof(double));
+    std::memcpy(p + 2*cap,  ssl,   n*sizeof(double));
+    std::memcpy(p + 3*cap,  ddl,   n*sizeof(double));
+  }
+  delete [] mem;
+  delete [] items;
+  mem = m;
+  items = it;
+  ss  = p;
+  dd  = p + cap;
+  ssl = p + 2*cap;
+  ddl = p + 3*cap;
+  capacity = cap;
+} // Reserve
+
+
 /**********************************************************/
 /*****  Outline members of class IntegratorContainer  *****/
 /**********************************************************/
 
-/// list of integrators
-std::list<Integrator*>* IntegratorContainer::ListPtr=NULL;
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorContainer::ListPtr
+//  return reference to the arrays pointer owned by the simulation context
+//
+IntegratorArrays *& IntegratorContainer::ListPtr(void)
+{
+  return Simulation::Current().integrators;
+} // ListPtr
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorContainer::isAny
+//  is there any element in the container?
+//
+bool IntegratorContainer::isAny(void)
+{
+  IntegratorArrays *a = ListPtr();
+  return a!=0 && a->n>0;
+} // isAny
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorContainer::Size
+//  number of elements in the container
+//
+size_t IntegratorContainer::Size(void)
+{
+  IntegratorArrays *a = ListPtr();
+  return (a!=0) ? (a->n) : 0;
+} // Size
+
 
 ////////////////////////////////////////////////////////////////////////////
 //  IntegratorContainer::Instance
-//  return pointer to list, also create list if it is not created
+//  return pointer to arrays, also create them if they are not created
 //
-std::list<Integrator*>* IntegratorContainer::Instance(void)
+IntegratorArrays* IntegratorContainer::Instance(void)
 {
-  Dprintf(("IntegratorContainer::Instance()(%p)",ListPtr));
-  if(ListPtr==NULL) {  // list is not created
-    ListPtr = new std::list<Integrator*>;  // create it
-    Dprintf(("created: %p", ListPtr));
+  Dprintf(("IntegratorContainer::Instance()(%p)",ListPtr()));
+  if(ListPtr()==NULL) {  // arrays are not created
+    ListPtr() = new IntegratorArrays;  // create them
+    Dprintf(("created: %p", ListPtr()));
   }
-  return ListPtr;
+  return ListPtr();
 } // Instance
 
 
 ////////////////////////////////////////////////////////////////////////////
 //  IntegratorContainer::Insert
-//  insert element into random (any) position in the container
+//  append element to the container, element gets the last slot
 //
-IntegratorContainer::iterator IntegratorContainer::Insert(Integrator* ptr)
+void IntegratorContainer::Insert(Integrator* ptr)
 {
   Dprintf(("IntegratorContainer::Insert(%p)",ptr));
-  (void)Instance();  // create list if it is not created
-  return ListPtr->insert(ListPtr->end(),ptr);  // insert element
+  IntegratorArrays *a = Instance();  // create arrays if they are not created
+  a->Reserve(a->n + 1);
+  size_t i = a->n++;
+  a->items[i] = ptr;
+  a->ss[i] = a->dd[i] = a->ssl[i] = a->ddl[i] = 0.0;
+  ptr->arrays = a;
+  ptr->slot = i;
+  delete a->tape;  // compile again
+  a->tape = 0;
 } // Insert
 
 
 ////////////////////////////////////////////////////////////////////////////
-//  IntegratorContainer::Erase - exclude element from container
+//  IntegratorContainer::Insert
+//  append count slots of vector block to the container
 //
-void IntegratorContainer::Erase(IntegratorContainer::iterator it)
+void IntegratorContainer::Insert(IntegratorVector* ptr, size_t count)
 {
-  Dprintf(("IntegratorContainer::Erase(...)"));
-  if(ListPtr!=NULL) {  // list is created
-    ListPtr->erase(it);  // exclude element
+  Dprintf(("IntegratorContainer::Insert(%p,%lu)",ptr,(unsigned long)count));
+  IntegratorArrays *a = Instance();  // create arrays if they are not created
+  a->Reserve(a->n + count);
+  for(size_t i=a->n; i<a->n+count; i++) {
+    a->items[i] = 0;  // no Integrator object
+    a->ss[i] = a->dd[i] = a->ssl[i] = a->ddl[i] = 0.0;
   }
+  ptr->arrays = a;
+  ptr->first = a->n;
+  ptr->count = count;
+  a->n += count;
+  a->vectors.push_back(ptr);
+  delete a->tape;  // compile again
+  a->tape = 0;
+} // Insert
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorContainer::RemoveSlots -- remove count slots from first,
+//  following elements are moved down (order of integrators is kept)
+//
+void IntegratorContainer::RemoveSlots(IntegratorArrays *a,
+                                      size_t first, size_t count)
+{
+  for(size_t i=first+count; i<a->n; i++) {
+    size_t j = i - count;
+    a->items[j] = a->items[i];
+    if(a->items[j])
+      a->items[j]->slot = j;
+    a->ss[j]  = a->ss[i];
+    a->dd[j]  = a->dd[i];
+    a->ssl[j] = a->ssl[i];
+    a->ddl[j] = a->ddl[i];
+  }
+  a->n -= count;
+  for(std::list<IntegratorVector*>::iterator it=a->vectors.begin();
+      it!=a->vectors.end(); ++it)
+    if((*it)->first > first)
+      (*it)->first -= count;
+  delete a->tape;  // compile again
+  a->tape = 0;
+} // RemoveSlots
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorContainer::Erase - exclude element from container
+//
+void IntegratorContainer::Erase(Integrator* ptr)
+{
+  Dprintf(("IntegratorContainer::Erase(%p)",ptr));
+  IntegratorArrays *a = ListPtr();
+  if(a==NULL || ptr->slot>=a->n || a->items[ptr->slot]!=ptr)
+    return;  // not in container (context was destroyed)
+  RemoveSlots(a, ptr->slot, 1);
+} // Erase
+
+
+////////////////////////////////////////////////////////////////////////////
+//  IntegratorContainer::Erase - exclude slots of vector block
+//
+void IntegratorContainer::Erase(IntegratorVector* ptr)
+{
+  Dprintf(("IntegratorContainer::Erase(%p) vector",ptr));
+  IntegratorArrays *a = ListPtr();
+  if(a==NULL || a!=ptr->arrays)
+    return;  // not in container (context was destroyed)
+  a->vectors.remove(ptr);
+  RemoveSlots(a, ptr->first, ptr->count);
 } // Erase
 
 
@@ -314,11 +569,10 @@ void IntegratorContainer::Erase(IntegratorContainer::iterator it)
 void IntegratorContainer::NtoL()
 {
   Dprintf(("IntegratorContainer::NtoL()"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator ip=ListPtr->begin(); ip!=end_it; ip++) {
-      (*ip)->Save();
-    }
+  IntegratorArrays *a = ListPtr();
+  if(a!=NULL && a->n>0) {  // arrays are created
+    std::memcpy(a->ssl, a->ss, a->n*sizeof(double));
+    std::memcpy(a->ddl, a->dd, a->n*sizeof(double));
   }
 } // NtoL
 
@@ -329,11 +583,10 @@ void IntegratorContainer::NtoL()
 void IntegratorContainer::LtoN()
 {
   Dprintf(("IntegratorContainer::LtoN)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator ip=ListPtr->begin(); ip!=end_it; ip++) {
-      (*ip)->Restore();
-    }
+  IntegratorArrays *a = ListPtr();
+  if(a!=NULL && a->n>0) {  // arrays are created
+    std::memcpy(a->ss, a->ssl, a->n*sizeof(double));
+    std::memcpy(a->dd, a->ddl, a->n*sizeof(double));
   }
 } // LtoN
 
@@ -344,32 +597,75 @@ void IntegratorContainer::LtoN()
 void IntegratorContainer::InitAll()
 {
   Dprintf(("IntegratorContainer::InitAll)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator ip=ListPtr->begin(); ip!=end_it; ip++) {
-      (*ip)->SetState(0.0);  // zero values
-      (*ip)->SetDiff(0.0);
-      (*ip)->Init();
+  IntegratorArrays *a = ListPtr();
+  if(a!=NULL) {  // arrays are created
+    for(size_t i=0; i<a->n; i++) {
+      a->ss[i] = 0.0;  // zero values
+      a->dd[i] = 0.0;
     }
+    for(size_t i=0; i<a->n; i++)
+      if(a->items[i])
+        a->items[i]->Init();
+    for(std::list<IntegratorVector*>::iterator it=a->vectors.begin();
+        it!=a->vectors.end(); ++it)
+      (*it)->Init();
+    delete a->tape;  // compile block expressions of inputs
+    a->tape = SIMLIB_TapeFlag ? SIMLIB_Tape::Compile(a) : 0;
   }
 } // InitAll
 
 
 ////////////////////////////////////////////////////////////////////////////
 // static IntegratorContainer::EvaluateAll -- without loop detection
+//  uses compiled tape (see tape.cc), if it is possible,
+//  vectors compute their derivatives after integrators
 //
 void IntegratorContainer::EvaluateAll()
 {
   Dprintf(("IntegratorContainer::EvaluateAll)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator ip=ListPtr->begin(); ip!=end_it; ip++) {
-      (*ip)->Eval();  // evaluate inputs ...
+  IntegratorArrays *a = ListPtr();
+  if(a!=NULL) {  // arrays are created
+    bool done = false;
+    if(SIMLIB_TapeFlag) {
+      if(a->tape==0)  // changed after Init
+        a->tape = SIMLIB_Tape::Compile(a);
+      if(a->tape->OK()) {
+        if(SIMLIB_TapeThreads > 1)
+          a->tape->RunParallel(a->ss, a->dd);
+        else
+          a->tape->Run(a->ss, a->dd);
+        done = true;
+      }
+    }
+    if(!done) {
+      Integrator **items = a->items;
+      for(size_t i=0, n=a->n; i<n; i++) {
+        if(items[i])
+          items[i]->Eval();  // evaluate inputs ...
+      }
     }
+    for(std::list<IntegratorVector*>::iterator it=a->vectors.begin();
+        it!=a->vectors.end(); ++it)
+      (*it)->Eval();
   }
 } // EvaluateAll
 
 
+////////////////////////////////////////////////////////////////////////////
+// static IntegratorContainer::Tape -- compiled inputs of integrators
+//  (used by implicit methods for structure of Jacobian matrix)
+//
+SIMLIB_Tape *IntegratorContainer::Tape()
+{
+  IntegratorArrays *a = ListPtr();
+  if(a==NULL || !SIMLIB_TapeFlag)
+    return 0;
+  if(a->tape==0)
+    a->tape = SIMLIB_Tape::Compile(a);
+  return a->tape->OK() ? a->tape : 0;
+} // Tape
+
+
 /*********************************************/
 /*****  Outline members of class Status  *****/
 /*********************************************/
@@ -473,8 +769,36 @@ void Status::Eval()
 /*****  Outline members of class StatusContainer  *****/
 /******************************************************/
 
-/// list of status variables
-std::list<Status*>* StatusContainer::ListPtr=NULL;
+////////////////////////////////////////////////////////////////////////////
+//  StatusContainer::ListPtr
+//  return reference to the list pointer owned by the simulation context
+//
+std::list<Status*> *& StatusContainer::ListPtr(void)
+{
+  return Simulation::Current().status;
+} // ListPtr
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StatusContainer::isAny
+//  is there any element in the container?
+//
+bool StatusContainer::isAny(void)
+{
+  std::list<Status*> *l = ListPtr();
+  return l!=0 && !(l->empty());
+} // isAny
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StatusContainer::Size
+//  number of elements in the container
+//
+size_t StatusContainer::Size(void)
+{
+  std::list<Status*> *l = ListPtr();
+  return (l!=0) ? (l->size()) : 0;
+} // Size
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -483,12 +807,12 @@ std::list<Status*>* StatusContainer::ListPtr=NULL;
 //
 std::list<Status*>* StatusContainer::Instance(void)
 {
-  Dprintf(("StatusContainer::Instance()(%p)",ListPtr));
-  if(ListPtr==NULL) {  // list is not created
-    ListPtr = new std::list<Status*>;  // create it
-    Dprintf(("created: %p", ListPtr));
+  Dprintf(("StatusContainer::Instance()(%p)",ListPtr()));
+  if(ListPtr()==NULL) {  // list is not created
+    ListPtr() = new std::list<Status*>;  // create it
+    Dprintf(("created: %p", ListPtr()));
   }
-  return ListPtr;
+  return ListPtr();
 } // Instance
 
 
@@ -500,7 +824,7 @@ StatusContainer::iterator StatusContainer::Insert(Status* ptr)
 {
   Dprintf(("StatusContainer::Insert(%p)",ptr));
   (void)Instance();  // create list if it is not created
-  return ListPtr->insert(ListPtr->end(),ptr);  // insert element
+  return ListPtr()->insert(ListPtr()->end(),ptr);  // insert element
 } // Insert
 
 
@@ -510,8 +834,8 @@ StatusContainer::iterator StatusContainer::Insert(Status* ptr)
 void StatusContainer::Erase(StatusContainer::iterator it)
 {
   Dprintf(("StatusContainer::Erase(...)"));
-  if(ListPtr!=NULL) {  // list is created
-    ListPtr->erase(it);  // exclude element
+  if(ListPtr()!=NULL) {  // list is created
+    ListPtr()->erase(it);  // exclude element
   }
 } // Erase
 
@@ -523,9 +847,9 @@ void StatusContainer::Erase(StatusContainer::iterator it)
 void StatusContainer::NtoL()
 {
   Dprintf(("StatusContainer::NtoL()"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator sp=ListPtr->begin(); sp!=end_it; sp++) {
+  if(ListPtr()!=NULL) {  // list is created
+    iterator end_it=ListPtr()->end();
+    for(iterator sp=ListPtr()->begin(); sp!=end_it; sp++) {
       (*sp)->Save();
     }
   }
@@ -538,9 +862,9 @@ void StatusContainer::NtoL()
 void StatusContainer::LtoN()
 {
   Dprintf(("StatusContainer::LtoN)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator sp=ListPtr->begin(); sp!=end_it; sp++) {
+  if(ListPtr()!=NULL) {  // list is created
+    iterator end_it=ListPtr()->end();
+    for(iterator sp=ListPtr()->begin(); sp!=end_it; sp++) {
       (*sp)->Restore();
     }
   }
@@ -553,9 +877,9 @@ void StatusContainer::LtoN()
 void StatusContainer::InitAll()
 {
   Dprintf(("StatusContainer::InitAll)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator sp=ListPtr->begin(); sp!=end_it; sp++) {
+  if(ListPtr()!=NULL) {  // list is created
+    iterator end_it=ListPtr()->end();
+    for(iterator sp=ListPtr()->begin(); sp!=end_it; sp++) {
       (*sp)->SetState(0.0);  // zero values
       (*sp)->Init();
     }
@@ -569,9 +893,9 @@ void StatusContainer::InitAll()
 void StatusContainer::EvaluateAll()
 {
   Dprintf(("StatusContainer::EvaluateAll)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator sp=ListPtr->begin(); sp!=end_it; sp++) {
+  if(ListPtr()!=NULL) {  // list is created
+    iterator end_it=ListPtr()->end();
+    for(iterator sp=ListPtr()->begin(); sp!=end_it; sp++) {
       (*sp)->_Eval();  // evaluate inputs with loop detection
     }
   }
@@ -585,9 +909,9 @@ void StatusContainer::EvaluateAll()
 void StatusContainer::ClearAllValueOK()
 {
   Dprintf(("StatusContainer::EvaluateAll)"));
-  if(ListPtr!=NULL) {  // list is created
-    iterator end_it=ListPtr->end();
-    for(iterator sp=ListPtr->begin(); sp!=end_it; sp++) {
+  if(ListPtr()!=NULL) {  // list is created
+    iterator end_it=ListPtr()->end();
+    for(iterator sp=ListPtr()->begin(); sp!=end_it; sp++) {
       (*sp)->SetValid(false);  // invalidate values
     }
   }
@@ -0,0 +1,218 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file loghisto.cc   Log-linear histogram implementation
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  LogHistogram implementation
+//
+//  interval of value x >= low is given directly by the binary
+//  representation of v=x/low: exponent selects order of magnitude,
+//  first bits of mantissa select one of 2^bits equal subintervals
+//
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "internal.h"
+
+#include <cmath>     // ldexp(), ceil(), log2()
+#include <cstring>   // memcpy()
+#include <cstdint>   // uint64_t
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+// LIMIT: maximum number of bits of relative precision
+const unsigned MAXLOGHISTOBITS = 16;
+
+////////////////////////////////////////////////////////////////////////////
+//  Index --- interval numbers of n values (loop without branches)
+//
+static inline void Index(const double *x, unsigned long n, unsigned *ix,
+                         double scale, unsigned bits, unsigned exps,
+                         unsigned count)
+{
+  const uint64_t mask = (uint64_t(1) << bits) - 1;
+  for(unsigned long j=0; j<n; j++) {
+    double v = x[j]*scale;
+    uint64_t b;
+    std::memcpy(&b, &v, sizeof(b));
+    int64_t e = int64_t(b >> 52) - 1023;    // exponent (sign if v<0)
+    unsigned i = unsigned(1 + (uint64_t(e) << bits)
+                            + ((b >> (52-bits)) & mask));
+    i = (e < int64_t(exps)) ? i : count+1;  // overflow
+    ix[j] = (v >= 1) ? i : 0;               // underflow, negative, NaN
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  constructors
+//
+LogHistogram::LogHistogram(double l, double h, unsigned b) :
+  dptr(0)
+{
+  Dprintf(("LogHistogram::LogHistogram(%g,%g,%u)",l,h,b));
+  Init(l, h, b);
+}
+
+LogHistogram::LogHistogram(const char *n, double l, double h, unsigned b) :
+  dptr(0)
+{
+  Dprintf(("LogHistogram::LogHistogram(\"%s\",%g,%g,%u)",n,l,h,b));
+  SetName(n);                   // set object name
+  Init(l, h, b);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  destructor
+//
+LogHistogram::~LogHistogram()
+{
+  Dprintf(("LogHistogram::~LogHistogram() // \"%s\" ", Name()));
+  delete[] dptr;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Init --- set range and precision (high is rounded up to low*2^k)
+//
+void LogHistogram::Init(double l, double h, unsigned b)
+{
+  Dprintf(("LogHistogram::Init(%g,%g,%u)",l,h,b));
+  if(!(l>0 && h>l) || b>MAXLOGHISTOBITS)
+    SIMLIB_error(LogHistoParamError);
+  unsigned e = unsigned(std::ceil(std::log2(h/l)));
+  if(e==0) e = 1;
+  if(e > 1000 || (unsigned long long)e << b > 100000000ULL)
+    SIMLIB_error(LogHistoParamError);   // too many intervals
+  unsigned c = e << b;
+  if(dptr && count!=c) {
+    delete[] dptr;
+    dptr = 0;
+  }
+  low = l;
+  scale = 1/l;
+  bits = b;
+  exps = e;
+  count = c;
+  if(!dptr)
+    dptr = new unsigned long[count+2];
+  Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  From --- low bound of interval i (1..Count()+1)
+//
+double LogHistogram::From(unsigned i) const
+{
+  if(i==0) return -HUGE_VAL;
+  if(i>count+1) i = count+1;
+  i--;
+  unsigned e = i >> bits;
+  unsigned m = i & ((1U << bits) - 1);
+  return std::ldexp(low * double((1UL << bits) + m), int(e) - int(bits));
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  operator []
+//
+unsigned long LogHistogram::operator [] (unsigned i) const
+{
+  if (i>count) i = count+1;
+  return dptr[i];
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  operator ()  - value recording
+//
+void LogHistogram::operator () (double x)
+{
+  stat(x);
+  unsigned i;
+  Index(&x, 1, &i, scale, bits, exps, count);
+  dptr[i]++;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Record --- record array of values
+//  interval numbers of a block are computed first (branch-free loop)
+//
+void LogHistogram::Record(const double *x, unsigned long n)
+{
+  const unsigned long BLOCK = 256;
+  unsigned ix[BLOCK];
+  while(n>0) {
+    unsigned long k = n<BLOCK ? n : BLOCK;
+    Index(x, k, ix, scale, bits, exps, count);
+    for(unsigned long j=0; j<k; j++) {
+      dptr[ix[j]]++;
+      stat(x[j]);
+    }
+    x += k;
+    n -= k;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  operator +=  - merge histogram of independent experiment
+//                 (e.g. replication, see RunReplications)
+//
+LogHistogram &LogHistogram::operator += (const LogHistogram &x)
+{
+  if(low!=x.low || bits!=x.bits || exps!=x.exps)
+    SIMLIB_error(HistoMergeError);
+  for(unsigned i=0; i<count+2; i++)
+    dptr[i] += x.dptr[i];
+  stat += x.stat;
+  return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Percentile --- value under which p % of recorded values lie
+//  result is the upper bound of interval (relative error <= 2^-bits),
+//  limited by minimal and maximal recorded values
+//
+double LogHistogram::Percentile(double p) const
+{
+  unsigned long n = stat.Number();
+  if(n==0 || !(p>=0 && p<=100))
+    SIMLIB_error(PercentileError);
+  double rank = std::ceil(p/100*n);     // rank of value (1..n)
+  if(rank<1) rank = 1;
+  unsigned long s = 0;
+  unsigned i;
+  for(i=0; i<=count; i++) {
+    s += dptr[i];
+    if(s>=rank) break;
+  }
+  if(i==0) return stat.Min();
+  if(i>count) return stat.Max();
+  double x = From(i+1);
+  if(x>stat.Max()) x = stat.Max();
+  if(x<stat.Min()) x = stat.Min();
+  return x;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Clear
+//
+void LogHistogram::Clear()
+{
+  Dprintf(("LogHistogram::Clear()"));
+  for(unsigned i=0; i<count+2; i++)
+    dptr[i] = 0;
+  stat.Clear();
+}
+
+}
+// end
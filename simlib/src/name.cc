@@ -81,8 +81,8 @@ const char *GetName(SimObject * o)
 const char *SIMLIB_create_tmp_name(const char *fmt, ...)
 {
     const int number = 4;
-    static char s[number][128]; // for small models only
-    static int index = 0;
+    static thread_local char s[number][128]; // for small models only
+    static thread_local int index = 0;
     int i = index;
     index = (index+1) % number; // circular buffer pointer
 
@@ -0,0 +1,275 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file nbody3D.cc  N-body system with gravity (Barnes-Hut)
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+// 3D extension
+//
+//  - NBody3D: positions and velocities of bodies in Integrator3DArray,
+//             accelerations computed by octree
+//
+
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "simlib3D.h"
+#include "internal.h"
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+/*  Barnes-Hut algorithm:
+
+    The cube containing all bodies is divided recursively into 8 octants
+    until each leaf contains at most one body (bodies at the same position
+    are chained in leaf of maximal depth). Each node has the mass and the
+    center of mass of its bodies (computed bottom-up: children are always
+    after their parent in the array of nodes).
+
+    Acceleration of body i: nodes are visited from the root, the node
+    with size s in distance d is used as a single body if s < theta*d,
+    else its children are visited. Nodes containing body i are always
+    visited (else the body would attract itself for large theta).
+
+    a[i] = sum G * m * (p - p[i]) / (|p - p[i]|^2 + eps^2)^(3/2)
+*/
+
+////////////////////////////////////////////////////////////////////////////
+/// octree of bodies (rebuilt for each evaluation)
+struct NBody3D::Tree {
+    struct Node {
+        Value3D com;            // center of mass
+        double m;               // mass of all bodies in node
+        Value3D center;         // center of cube
+        double half;            // half of cube size
+        int first;              // first of 8 children (-1 = leaf)
+        int body;               // first body in leaf (-1 = empty)
+        Node(const Value3D &c, double h) :
+            com(c), m(0), center(c), half(h), first(-1), body(-1) {}
+    };
+    static const int max_depth = 40;    // deeper: bodies are chained
+    std::vector<Node> nodes;
+    std::vector<int> next;              // chain of bodies in leaf
+    std::vector<Value3D> pos;           // positions of bodies
+    std::vector<int> stack;             // nodes to visit
+
+    static int Octant(const Value3D &p, const Value3D &c) {
+        return (p.x() > c.x()) | (p.y() > c.y()) << 1 | (p.z() > c.z()) << 2;
+    }
+    void Split(int k);
+    void Insert(int i);
+    void Build(const std::vector<double> &mass);
+    static bool Contains(const Node &nd, const Value3D &p) {
+        Value3D d = p - nd.center;
+        return std::fabs(d.x()) <= nd.half && std::fabs(d.y()) <= nd.half &&
+               std::fabs(d.z()) <= nd.half;
+    }
+    Value3D Acceleration(int i, const std::vector<double> &mass,
+                         double theta2, double eps2);
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// create 8 children of leaf k
+void NBody3D::Tree::Split(int k)
+{
+  double h = 0.5*nodes[k].half;
+  Value3D c = nodes[k].center;
+  nodes[k].first = nodes.size();
+  for(int o=0; o<8; o++)
+    nodes.push_back(Node(c + Value3D(o&1 ? h : -h,
+                                     o&2 ? h : -h,
+                                     o&4 ? h : -h), h));
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// insert body i into the tree
+void NBody3D::Tree::Insert(int i)
+{
+  int k = 0;
+  for(int depth=0; ; depth++) {
+    if(nodes[k].first < 0) {            // leaf
+      if(nodes[k].body < 0 || depth >= max_depth) {
+        next[i] = nodes[k].body;        // add to chain
+        nodes[k].body = i;
+        return;
+      }
+      int j = nodes[k].body;            // move body j to child
+      nodes[k].body = -1;
+      Split(k);
+      nodes[nodes[k].first + Octant(pos[j], nodes[k].center)].body = j;
+    }
+    k = nodes[k].first + Octant(pos[i], nodes[k].center);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// build tree for positions pos, compute masses and centers of mass
+void NBody3D::Tree::Build(const std::vector<double> &mass)
+{
+  int n = pos.size();
+  Value3D lo = pos[0], hi = pos[0];
+  for(int i=1; i<n; i++) {
+    const Value3D &p = pos[i];
+    lo = Value3D(std::min(lo.x(), p.x()), std::min(lo.y(), p.y()),
+                 std::min(lo.z(), p.z()));
+    hi = Value3D(std::max(hi.x(), p.x()), std::max(hi.y(), p.y()),
+                 std::max(hi.z(), p.z()));
+  }
+  Value3D size = hi - lo;
+  double half = 0.5*std::max(size.x(), std::max(size.y(), size.z()));
+  if(half == 0)
+    half = 1;
+  nodes.clear();
+  nodes.push_back(Node(0.5*(lo + hi), half*(1 + 1e-9)));
+  next.assign(n, -1);
+  for(int i=0; i<n; i++)
+    Insert(i);
+  for(int k=nodes.size()-1; k>=0; k--) {  // bottom-up
+    Node &nd = nodes[k];
+    Value3D s(0,0,0);
+    double m = 0;
+    if(nd.first < 0) {
+      for(int b=nd.body; b>=0; b=next[b]) {
+        m += mass[b];
+        s = s + mass[b]*pos[b];
+      }
+    } else {
+      for(int o=0; o<8; o++) {
+        const Node &c = nodes[nd.first + o];
+        m += c.m;
+        s = s + c.m*c.com;
+      }
+    }
+    nd.m = m;
+    nd.com = m > 0 ? s/m : nd.center;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// acceleration of body i (without gravity constant)
+Value3D NBody3D::Tree::Acceleration(int i, const std::vector<double> &mass,
+                                    double theta2, double eps2)
+{
+  const Value3D p = pos[i];
+  Value3D a(0,0,0);
+  stack.clear();
+  stack.push_back(0);
+  while(!stack.empty()) {
+    const Node &nd = nodes[stack.back()];
+    stack.pop_back();
+    if(nd.m == 0)
+      continue;
+    if(nd.first < 0) {                  // leaf: all bodies
+      for(int b=nd.body; b>=0; b=next[b]) {
+        if(b == i)
+          continue;
+        Value3D d = pos[b] - p;
+        double r2 = scalar_product(d, d) + eps2;
+        if(r2 > 0)
+          a = a + d * (mass[b] / (r2*std::sqrt(r2)));
+      }
+      continue;
+    }
+    Value3D d = nd.com - p;
+    double r2 = scalar_product(d, d);
+    double s = 2*nd.half;
+    if(s*s < theta2*r2 && !Contains(nd, p)) { // far away: center of mass
+      r2 += eps2;
+      a = a + d * (nd.m / (r2*std::sqrt(r2)));
+    } else {
+      for(int o=0; o<8; o++)
+        stack.push_back(nd.first + o);
+    }
+  }
+  return a;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+// NBody3D --- constructor & destructor
+//
+NBody3D::NBody3D(size_t bodies, double gravity_constant):
+    Integrator3DArray(2*bodies),
+    tree(new Tree),
+    n(bodies),
+    mass(bodies, 0.0),
+    G(gravity_constant),
+    theta(0.5),
+    eps2(0)
+{
+  Dprintf(("NBody3D[%p]::NBody3D(%lu)", this, (unsigned long)bodies));
+}
+
+NBody3D::~NBody3D()
+{
+  delete tree;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// set mass, initial position and velocity of body k
+void NBody3D::Init(size_t k, double m, const Value3D &p, const Value3D &v)
+{
+  mass[k] = m;
+  Integrator3DArray::Init(k, p);
+  Integrator3DArray::Init(n+k, v);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// accelerations of all bodies for current positions
+void NBody3D::Accelerations(std::vector<Value3D> &a)
+{
+  a.assign(n, Value3D(0,0,0));
+  if(n == 0)
+    return;
+  tree->pos.clear();
+  for(size_t k=0; k<n; k++)
+    tree->pos.push_back(Get(k));
+  tree->Build(mass);
+  for(size_t k=0; k<n; k++)
+    a[k] = G * tree->Acceleration(k, mass, theta*theta, eps2);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// total energy of system (for checks of accuracy)
+double NBody3D::Energy()
+{
+  double e = 0;
+  for(size_t i=0; i<n; i++) {
+    Value3D v = Get(n+i);
+    e += 0.5*mass[i]*scalar_product(v, v);
+    for(size_t j=i+1; j<n; j++) {
+      Value3D d = Get(j) - Get(i);
+      e -= G*mass[i]*mass[j] / std::sqrt(scalar_product(d, d) + eps2);
+    }
+  }
+  return e;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// derivatives: p' = v, v' = a(p)
+void NBody3D::Eval()
+{
+  static thread_local std::vector<Value3D> a;
+  Accelerations(a);
+  for(size_t k=0; k<n; k++) {
+    SetDiff(k, Get(n+k));
+    SetDiff(n+k, a[k]);
+  }
+}
+
+} // namespace
+
+// end of nbody3D.cc
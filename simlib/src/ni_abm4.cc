@@ -56,12 +56,14 @@ void ABM4::Integrate(void)
   const double err_hi = 1.00; // limits an error range
   const int max_dbl = 8; // avoid stepsize growing too quickly
   register size_t i;   // auxiliary variables
-  Iterator ip, end_it; // for loops to go through container of integrators
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
   bool DoubleStepFlag; // allows doubling step
   // WARNING: following variables must be static !!!
-  static double PrevStep; // previous stepsize
-  static int ind = 0; // base index to arrays with values from previous steps
-  static int DoubleCount = 0; // number of good steps for doubling stepsize
+  static thread_local double PrevStep; // previous stepsize
+  static thread_local int ind = 0; // base index to arrays with values from previous steps
+  static thread_local int DoubleCount = 0; // number of good steps for doubling stepsize
 
   Dprintf((" ABM4 integration step ")); // print debugging info
   Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
@@ -70,7 +72,11 @@ void ABM4::Integrate(void)
   //  Step of method
   //--------------------------------------------------------------------------
 
-  end_it=LastIntegrator(); // end of container of integrators
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
   DoubleStepFlag = true; // allow doubling stepsize
 
 begin_step:
@@ -93,8 +99,8 @@ begin_step:
     Dprintf(("start, step = %g, Time = %g",SIMLIB_StepSize,(double)Time));
     ind = 0;
     DoubleCount = 0;
-    for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-      Z[ABM_Count][i] = (*ip)->GetOldDiff();  // store values for next steps
+    for(i=0; i<N; i++) {
+      Z[ABM_Count][i] = dy0[i];  // store values for next steps
     }
     ABM_Count++;  // increment counter of starts
     SlavePtr()->Integrate();  // call starting method (slave)
@@ -113,17 +119,17 @@ begin_step:
     //  compute predictor
     //-----------------------------------------------------------------------
 
-    for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-      // store values for next steps
-      Z[(ind+3)%abm_ord][i] = (*ip)->GetOldDiff();
+    Memory &z0 = Z[ind], &z1 = Z[(ind+1)%abm_ord];  // previous values
+    Memory &z2 = Z[(ind+2)%abm_ord], &z3 = Z[(ind+3)%abm_ord];
+    for(i=0; i<N; i++) {
+      z3[i] = dy0[i];  // store values for next steps
       // predictor
-      (*ip)->SetState( PRED[i] = (*ip)->GetOldState() +
-                    (   55.0 * Z[(ind+3)%abm_ord][i]
-                      - 59.0 * Z[(ind+2)%abm_ord][i]
-                      + 37.0 * Z[(ind+1)%abm_ord][i]
-                      -  9.0 * Z[ind][i]
-                    ) * (SIMLIB_StepSize / 24.0)
-                  );
+      y[i] = PRED[i] = y0[i] +
+                    (   55.0 * z3[i]
+                      - 59.0 * z2[i]
+                      + 37.0 * z1[i]
+                      -  9.0 * z0[i]
+                    ) * (SIMLIB_StepSize / 24.0);
     }
 
     _SetTime(Time,SIMLIB_StepStartTime + SIMLIB_StepSize); // endpoint time
@@ -135,14 +141,14 @@ begin_step:
     //  compute corrector
     //-----------------------------------------------------------------------
 
-    for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-      (*ip)->SetState( (*ip)->GetOldState()
-                    + (    9.0 * (*ip)->GetDiff()
-                        + 19.0 * Z[(ind+2)%abm_ord][i]
-                        -  5.0 * Z[(ind+1)%abm_ord][i]
-                        +        Z[ind][i]
-                      ) * (SIMLIB_StepSize / 24.0)
-                  );
+    Memory &c0 = Z[ind], &c1 = Z[(ind+1)%abm_ord], &c2 = Z[(ind+2)%abm_ord];
+    for(i=0; i<N; i++) {
+      y[i] = y0[i]
+                    + (    9.0 * dy[i]
+                        + 19.0 * c2[i]
+                        -  5.0 * c1[i]
+                        +        c0[i]
+                      ) * (SIMLIB_StepSize / 24.0);
     }
 
     //-----------------------------------------------------------------------
@@ -150,12 +156,12 @@ begin_step:
     //-----------------------------------------------------------------------
 
     SIMLIB_ERRNO = 0;
-    for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+    for(i=0; i<N; i++) {
       double eerr; // estimated error
       double terr; // greatest allowed error
 
-      eerr = 0.5 * fabs(PRED[i] - (*ip)->GetState()); // error estimation
-      terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*(*ip)->GetState());
+      eerr = 0.5 * fabs(PRED[i] - y[i]); // error estimation
+      terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*y[i]);
 
       if(eerr < err_lo*terr) // tolerantion is fulfiled with provision
         continue;
@@ -0,0 +1,261 @@
+/////////////////////////////////////////////////////////////////////////////
+// ni_bdf2.cc
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  numerical integration: backward differentiation formula, order 1-2
+//
+
+////////////////////////////////////////////////////////////////////////////
+//  interface
+//
+#include "simlib.h"
+#include "internal.h"
+#include "ni_bdf2.h"
+#include <cmath>
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////////////
+//  implementation
+//
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+
+////////////////////////////////////////////////////////////////////////////
+//  BDF2 with variable step
+//
+/*  Formula (w = h/h_prev):
+
+    y[n+1] = a1*y[n] - a2*y[n-1] + b*h*f(t+h, y[n+1])
+
+    a1 = (1+w)^2/(1+2w),  a2 = w^2/(1+2w),  b = (1+w)/(1+2w)
+
+    The first step (and the step after a discontinuity) is the backward
+    Euler method: y[n+1] = y[n] + h*f(t+h, y[n+1]).
+
+    Nonlinear equation is solved by simplified Newton iteration with
+    matrix I - b*h*J. The predictor is the quadratic polynomial through
+    y[n-1], y[n], f(t,y[n]) (Euler step for order 1), the error is
+    estimated from the difference between the predictor and corrector:
+
+    err = b/(1+b) * |y[n+1] - yp|
+*/
+
+////////////////////////////////////////////////////////////////////////////
+//  BDF2::PrepareStep
+//
+bool BDF2::PrepareStep(void)
+{
+  if(StiffMethod::PrepareStep()) {
+    history = false;    // # of integrators changed
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  BDF2::Integrate
+//
+void BDF2::Integrate(void)
+{
+  const double safety = 0.9;    // keeps the new step from growing too large
+  const double max_ratio = 2.0; // ditto
+  const double min_grow = 1.2;  // smaller changes do not need new LU
+  const int max_iter = 4;       // Newton iterations
+  size_t i;            // auxiliary variables for loops to go through list
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
+  bool order2;         // use 2nd order formula
+  bool fresh;          // Jacobian matrix was computed in this step
+  double h;            // step size
+  double b;            // coefficient of f(t+h, y[n+1])
+  double ratio;        // ratio for next step computation
+  double next_step;    // recommended stepsize for next step
+  size_t n;            // integrator with the greatest error
+
+  Dprintf((" BDF2 integration step ")); // print debugging info
+  Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
+
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
+
+  // continue with previous steps? (no events changed the state)
+  order2 = history && t_end == SIMLIB_StepStartTime;
+  for(i=0; order2 && i<N; i++)
+    if(YE[i] != y0[i])
+      order2 = false;
+  fresh = false;
+
+  //--------------------------------------------------------------------------
+  //  Step of method
+  //--------------------------------------------------------------------------
+
+begin_step:
+
+  ///////////////////////////////////////////////////////// beginning of step
+
+  SIMLIB_StepSize = max(SIMLIB_StepSize, SIMLIB_MinStep); // low step limit
+
+  SIMLIB_ContractStepFlag = false;           // clear reduce step flag
+  SIMLIB_ContractStep = 0.5*SIMLIB_StepSize; // implicitly reduce to half step
+
+  h = SIMLIB_StepSize;
+  if(order2) {
+    double w = h/h_prev;
+    double a1 = (1+w)*(1+w)/(1+2*w);
+    double a2 = w*w/(1+2*w);
+    b = (1+w)/(1+2*w);
+    for(i=0; i<N; i++) {
+      double c = (Y1[i] - y0[i] + dy0[i]*h_prev) / (h_prev*h_prev);
+      YP[i] = y0[i] + dy0[i]*h + c*h*h;       // predictor
+      PSI[i] = a1*y0[i] - a2*Y1[i];
+    }
+  } else {
+    b = 1;
+    for(i=0; i<N; i++) {
+      YP[i] = y0[i] + dy0[i]*h;               // Euler predictor
+      PSI[i] = y0[i];
+    }
+  }
+
+  if(!jac_ok) {  // first step
+    Jacobian(y0, dy0);
+    fresh = true;
+  }
+
+  ///////////////////////////////////////////////////////// Newton iteration
+
+newton:
+  if(NeedFactor(b*h) && !Factor(b*h))
+    goto failed;        // singular matrix
+  for(i=0; i<N; i++)
+    y[i] = YP[i];
+  {
+    double old_norm = 0;
+    for(int it=0; it<max_iter; it++) {
+      FunCall(1.0);     // f(t+h, y)
+      double norm = 0;
+      for(i=0; i<N; i++)
+        R[i] = PSI[i] + b*h*dy[i] - y[i];
+      Solve(&R[0]);
+      for(i=0; i<N; i++) {
+        y[i] += R[i];
+        norm = max(norm, std::fabs(R[i])/Tolerance(y0[i], y[i]));
+      }
+      if(!(norm==norm))
+        break;          // NaN: divergence
+      if(norm <= 0.05)
+        goto converged;
+      if(it>0 && norm > 0.9*old_norm)
+        break;          // divergence or slow convergence
+      old_norm = norm;
+    }
+  }
+
+failed:
+  if(!fresh) {          // new Jacobian matrix
+    Jacobian(y0, dy0);
+    fresh = true;
+    goto newton;
+  }
+  if(SIMLIB_StepSize > SIMLIB_MinStep) {  // reducing step is possible
+    SIMLIB_OptStep = max(0.25*SIMLIB_StepSize, SIMLIB_MinStep);
+    SIMLIB_StepSize = SIMLIB_OptStep;
+    IsEndStepEvent = false; // no event will be at the end of the step
+    goto begin_step;        // compute again with smaller step
+  }
+  // reducing step is unpossible: accept the last iteration
+
+converged:
+
+  ////////////////////////////////////////////////////////////// end of step
+
+  FunCall(1.0);  // evaluate new state of model at the end of step
+
+  //--------------------------------------------------------------------------
+  //  Check on accuracy of numerical integration, estimate error
+  //--------------------------------------------------------------------------
+
+  SIMLIB_ERRNO = 0; // OK
+  ratio = 8.0;      // 2^3 - ratio for stepsize computation - initial value
+  n=0;              // integrator with greatest error
+  for(i=0; i<N; i++) {
+    double eerr; // estimated error
+    double terr; // greatest allowed error
+
+    eerr = b/(1+b) * std::fabs(y[i] - YP[i]); // estimation
+    terr = Tolerance(y0[i], y[i]);
+    if(!(eerr==eerr)) {     // NaN: reduce step
+      ratio = 0;
+      n=i;
+      break;
+    }
+    if(terr < eerr*ratio) { // avoid arithmetic overflow
+      ratio = terr/eerr;    // find the lowest ratio
+      n=i;                  // remember the integrator
+    }
+  } // for
+
+  Dprintf(("R: %g",ratio));
+
+  if(ratio < 1.0) { // error is too large, reduce stepsize
+    ratio = max(std::pow(ratio, order2 ? 1.0/3 : 0.5), 0.2);
+    Dprintf(("Down: %g",ratio));
+    if(SIMLIB_StepSize > SIMLIB_MinStep) {  // reducing step is possible
+      SIMLIB_OptStep = max(safety*ratio*SIMLIB_StepSize, SIMLIB_MinStep);
+      SIMLIB_StepSize = SIMLIB_OptStep;
+      IsEndStepEvent = false; // no event will be at the end of the step
+      goto begin_step;        // compute again with smaller step
+    }
+    // reducing step is unpossible
+    SIMLIB_ERRNO++;          // requested accuracy cannot be achieved
+    _Print("\n Integrator[%lu] ",(unsigned long)n);
+    SIMLIB_warning(AccuracyError);
+    next_step = SIMLIB_StepSize;
+  } else { // allowed tolerantion is fulfiled
+    ratio = min(safety*std::pow(ratio, order2 ? 1.0/3 : 0.5), max_ratio);
+    Dprintf(("Up: %g",ratio));
+    if(ratio < min_grow)      // keep step (and factorization)
+      ratio = 1.0;
+    next_step = min(ratio*SIMLIB_StepSize, SIMLIB_MaxStep);
+  }
+
+  //--------------------------------------------------------------------------
+  //  Analyse system at the end of the step
+  //--------------------------------------------------------------------------
+
+  if(StateCond()) { // check on changes of state conditions at end of step
+    goto begin_step;
+  }
+
+  //--------------------------------------------------------------------------
+  //  Results of step have been accepted, take fresh step
+  //--------------------------------------------------------------------------
+
+  for(i=0; i<N; i++) {
+    Y1[i] = y0[i];
+    YE[i] = y[i];
+  }
+  h_prev = SIMLIB_StepSize;
+  t_end = Time;
+  history = true;
+
+  // increase step, if accuracy is good
+  SIMLIB_OptStep = next_step;
+
+} // BDF2::Integrate
+
+
+}
+// end of ni_bdf2.cc
@@ -0,0 +1,45 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file ni_bdf2.h  Backward differentiation formula, 2nd order
+//
+// Copyright (c) 2016 Petr Peringer
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  numerical integration: implicit BDF method of order 1-2
+//                         with variable step (stiff systems)
+//
+
+
+#include "simlib.h"
+#include "ni_stiff.h"
+
+namespace simlib3 {
+
+////////////////////////////////////////////////////////////////////////////
+//  class representing the integration method
+//
+class BDF2 : public StiffMethod {
+private:
+  Memory Y1;            // state from start of previous step: y[n-1]
+  Memory YE;            // state at end of previous step (continuity check)
+  Memory YP;            // predicted state
+  Memory PSI;           // constant part of the formula
+  Memory R;             // Newton correction
+  bool history;         // previous step can be used (order 2)
+  double h_prev;        // previous step size
+  double t_end;         // time of end of previous step
+public:
+  BDF2(const char* name) :  // registrate method and name it
+    StiffMethod(name),
+    history(false), h_prev(0), t_end(0)
+  { /*NOTHING*/ }
+  virtual ~BDF2()  // destructor
+  { /*NOTHING*/ }
+  virtual bool PrepareStep(void);  // prepare step (checks changes)
+  virtual void Integrate(void);  // integration method
+}; // class BDF2
+
+}
+
+// end of ni_bdf2.h
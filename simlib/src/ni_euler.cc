@@ -46,15 +46,21 @@ SIMLIB_IMPLEMENTATION;
 void EULER::Integrate(void)
 {
   const double err_coef = 0.02; // limits an error range
-  static double dthlf;   // half step
+  static thread_local double dthlf;   // half step
   register size_t i;   // auxiliary variables for loops to go through list
-  Iterator ip, end_it; // of integrators
-  static bool DoubleStepFlag; // flag - allow increasing (doubling) the step
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
+  static thread_local bool DoubleStepFlag; // flag - allow increasing (doubling) the step
 
   Dprintf((" Euler integration step ")); // print debugging info
   Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
 
-  end_it=LastIntegrator(); // end of container of integrators
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
 
   //--------------------------------------------------------------------------
   //  Step of method
@@ -69,9 +75,9 @@ begin_step: // beginning of step
   SIMLIB_ContractStepFlag = false; // clear reduce step flag
   SIMLIB_ContractStep = 0.5*dthlf; // implicitly reduce to half
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A[i]   = (*ip)->GetOldDiff();
-    (*ip)->SetState((*ip)->GetOldState() + dthlf*(*ip)->GetDiff());   // state y(t+h/2)
+  for(i=0; i<N; i++) {
+    A[i]   = dy0[i];
+    y[i] = y0[i] + dthlf*dy[i];   // state y(t+h/2)
   }
 
   ////////////////////////////////////////////////////////////// 1/2 of step
@@ -91,10 +97,10 @@ begin_step: // beginning of step
 
   StoreState(di, si, xi); // store values in 1/2 of step
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     // difference of differentiations for error estimation
-    A[i] -= (*ip)->GetDiff();
-    (*ip)->SetState(si[i] + dthlf*(*ip)->GetDiff());
+    A[i] -= dy[i];
+    y[i] = si[i] + dthlf*dy[i];
   }
 
   //////////////////////////////////////////////////////////// end of step
@@ -110,7 +116,7 @@ begin_step: // beginning of step
 
   DoubleStepFlag = true; // allow doubling the step
   SIMLIB_ERRNO = 0; // OK
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     double eerr; // estimated error
     double terr; // greatest allowed error
 
@@ -46,22 +46,28 @@ void FW::Integrate(void)
   const double fw_err_rnghi  = 1.5;  // ranges for step accuracy
   const double fw_err_rnglo  = 0.75; // and error estimation
   register size_t i;   // auxiliary variables for loops to go through list
-  Iterator ip, end_it; // of integrators
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
   bool EulDoubleStepFlag; // allow increasing (doubling) the E. substepsize
   bool FWDoubleStepFlag;  // allow increasing (doubling) the FW. stepsize
   bool FWHalveStepFlag;   // allow reducing (halving) the FW. stepsize
   bool FWMayDouble;       // accuracy has been very good
   // WARNING: following variables must be static!
   // others are static only for efficiency
-  static int FWDoubleCount;   // counter of doubling step requestes in FW
-  static int EulDoubleCount;  // counter of doubling step requestes in Euler
-  static double Eul_StepSize; // step of Euler's method
-  static double PrevStep;     // previous FW step
+  static thread_local int FWDoubleCount;   // counter of doubling step requestes in FW
+  static thread_local int EulDoubleCount;  // counter of doubling step requestes in Euler
+  static thread_local double Eul_StepSize; // step of Euler's method
+  static thread_local double PrevStep;     // previous FW step
 
   Dprintf((" Fowler-Warten integration step ")); // print debugging info
   Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
 
-  end_it=LastIntegrator(); // end of container of integrators
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
 
   FWDoubleStepFlag  = true;  // allow doubling for FW
   EulDoubleStepFlag = true; // allow doubling for Euler
@@ -95,9 +101,9 @@ euler_step: // beginning of Euler's step
   Dprintf(("E_MIN: %g, E_MAX %g", eul_step_coef*SIMLIB_MinStep,
           eul_step_coef*SIMLIB_StepSize));
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     // state y(t+he) = y + he * y'
-    (*ip)->SetState((*ip)->GetOldState()+Eul_StepSize*(*ip)->GetOldDiff());
+    y[i] = y0[i]+Eul_StepSize*dy0[i];
   }
 
   _SetTime(Time,SIMLIB_StepStartTime + Eul_StepSize); // set time to t+he
@@ -109,13 +115,13 @@ euler_step: // beginning of Euler's step
   //--------------------------------------------------------------------------
 
   SIMLIB_ERRNO = 0; // OK
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     double eerr; // estimated error
     double terr; // greatest allowed error
 
     // error estimation
-    eerr = Eul_StepSize*fabs((*ip)->GetDiff() - (*ip)->GetOldDiff());
-    terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*(*ip)->GetState());
+    eerr = Eul_StepSize*fabs(dy[i] - dy0[i]);
+    terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*y[i]);
 
     if(eerr < eul_err_coef*terr) // tolerantion is fulfiled with provision
       continue;
@@ -173,7 +179,7 @@ euler_step: // beginning of Euler's step
   //  End of Euler's substep, FW continues
   //--------------------------------------------------------------------------
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     double yia; // formula's coefficients
     double d1;
     double d2;
@@ -182,9 +188,9 @@ euler_step: // beginning of Euler's step
     double c0;
     double denom;
 
-    yia = FW_First ? 0 : (((*ip)->GetOldState() - Y1[i]) / PrevStep);
-    d1  = (*ip)->GetOldDiff() - yia;
-    d2  = ((*ip)->GetDiff() - (*ip)->GetOldDiff())/Eul_StepSize;
+    yia = FW_First ? 0 : ((y0[i] - Y1[i]) / PrevStep);
+    d1  = dy0[i] - yia;
+    d2  = (dy[i] - dy0[i])/Eul_StepSize;
     ll  = (d1<=prec && d1>=-prec) ? 0 : (d2/d1);
     denom = SIMLIB_StepSize * ll;
     c1  = (denom >= -prec)
@@ -193,7 +199,7 @@ euler_step: // beginning of Euler's step
     c0  = (ll>=0) ? (1.0 + denom)
                   : exp(denom);
     // state
-    (*ip)->SetState((*ip)->GetOldState() + SIMLIB_StepSize * (yia + c1 * d1));
+    y[i] = y0[i] + SIMLIB_StepSize * (yia + c1 * d1);
     ERR[i] = yia + c0 * d1;
   }
 
@@ -207,12 +213,12 @@ euler_step: // beginning of Euler's step
 
   FWMayDouble = false;
   SIMLIB_ERRNO = 0; // OK
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     double eerr; // estimated error
     double terr; // greatest allowed error
 
-    eerr = SIMLIB_StepSize*fabs((*ip)->GetDiff() - ERR[i]); // estimation
-    terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*(*ip)->GetState());
+    eerr = SIMLIB_StepSize*fabs(dy[i] - ERR[i]); // estimation
+    terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*y[i]);
 
     if(eerr > fw_err_rnghi*terr) {
       // allowed tolerantion is overfulfiled,
@@ -265,8 +271,8 @@ euler_step: // beginning of Euler's step
   //  Results of step have been accepted, store values and take fresh step
   //--------------------------------------------------------------------------
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    Y1[i] = (*ip)->GetOldDiff();
+  for(i=0; i<N; i++) {
+    Y1[i] = dy0[i];
   }
   FW_First = false;
   PrevStep = SIMLIB_StepSize;
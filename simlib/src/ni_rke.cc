@@ -54,16 +54,22 @@ SIMLIB_IMPLEMENTATION;
 void RKE::Integrate(void)
 {
   static const double err_coef = 0.02; // limits an error range
-  static double dthlf;         // half step
-  static double dtqrt;         // quater step
-  static bool DoubleStepFlag;  // flag - allow increasing (doubling) the step
+  static thread_local double dthlf;         // half step
+  static thread_local double dtqrt;         // quater step
+  static thread_local bool DoubleStepFlag;  // flag - allow increasing (doubling) the step
   register size_t i;   // auxiliary variables for loops to go through list
-  Iterator ip, end_it; // of integrators
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
 
   Dprintf((" RKE integration step ")); // print debugging info
   Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
 
-  end_it=LastIntegrator(); // end of container of integrators
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
 
   //--------------------------------------------------------------------------
   //  Step of method
@@ -80,9 +86,9 @@ begin_step:
   SIMLIB_ContractStepFlag = false; // clear reduce step flag
   SIMLIB_ContractStep = dtqrt;     // implicitly reduce to quater of step
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A1[i] = dthlf*(*ip)->GetOldDiff();     // compute coefficient
-    (*ip)->SetState((*ip)->GetOldState()+0.5*A1[i]); // state (y) for next sub-step
+  for(i=0; i<N; i++) {
+    A1[i] = dthlf*dy0[i];     // compute coefficient
+    y[i] = y0[i]+0.5*A1[i]; // state (y) for next sub-step
   }
 
   ////////////////////////////////////////////////////////////// 1/4 of step
@@ -92,16 +98,16 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model (y'=f(t,y))      (1)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A2[i] = dthlf*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() + 0.25*(A1[i]+A2[i]));
+  for(i=0; i<N; i++) {
+    A2[i] = dthlf*dy[i];
+    y[i] = y0[i] + 0.25*(A1[i]+A2[i]);
   }
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (2)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A3[i] = dthlf*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() - A2[i] + A3[i] + A3[i]);
+  for(i=0; i<N; i++) {
+    A3[i] = dthlf*dy[i];
+    y[i] = y0[i] - A2[i] + A3[i] + A3[i];
   }
 
   //////////////////////////////////////////////////////////////
@@ -113,11 +119,14 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (3)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A4[i] = dthlf*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() + (A1[i] + 4.0*A3[i] + A4[i]) / 6.0);
+  for(i=0; i<N; i++) {
+    A4[i] = dthlf*dy[i];
+    y[i] = y0[i] + (A1[i] + 4.0*A3[i] + A4[i]) / 6.0;
   }
 
+  SIMLIB_Dynamic();  // evaluate new state of model                  (4)
+                     // (derivatives in 1/2 of step for StateCond)
+
   if(StateCond()) { // check on changes of state conditions in 1/2 of step
     goto begin_step; // compute again
   }
@@ -128,11 +137,9 @@ begin_step:
 
   StoreState(di, si, xi); // store  values in 1/2 of step
 
-  SIMLIB_Dynamic();  // evaluate new state of model                  (4)
-
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A5[i] = dthlf*(*ip)->GetDiff();
-    (*ip)->SetState(si[i] + 0.5*A5[i]);
+  for(i=0; i<N; i++) {
+    A5[i] = dthlf*dy[i];
+    y[i] = si[i] + 0.5*A5[i];
   }
 
   ////////////////////////////////////////////////////////////// 3/4 of step
@@ -142,16 +149,16 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (5)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A6[i] = dthlf * (*ip)->GetDiff();
-    (*ip)->SetState(si[i] + 0.25*(A5[i] + A6[i]));
+  for(i=0; i<N; i++) {
+    A6[i] = dthlf * dy[i];
+    y[i] = si[i] + 0.25*(A5[i] + A6[i]);
   }
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (6)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A7[i] = dthlf*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState()
+  for(i=0; i<N; i++) {
+    A7[i] = dthlf*dy[i];
+    y[i] = y0[i]
       + (         - A1[i]
           -  96.0 * A2[i]
           +  92.0 * A3[i]
@@ -159,7 +166,7 @@ begin_step:
           + 144.0 * A5[i]
           +   6.0 * A6[i]
           -  12.0 * A7[i]
-        ) / 6.0);
+        ) / 6.0;
   }
 
   //////////////////////////////////////////////////////////// end of step
@@ -175,7 +182,7 @@ begin_step:
 
   DoubleStepFlag = true;
   SIMLIB_ERRNO = 0;
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     double eerr; // estimated error
     double terr; // greatest allowed error
 
@@ -184,7 +191,7 @@ begin_step:
                   +  17.0 * A4[i]
                   -  23.0 * A5[i]
                   +   4.0 * A7[i]
-                  - dthlf * (*ip)->GetDiff()
+                  - dthlf * dy[i]
                 ) / 90.0);  // error estimation
     terr = SIMLIB_AbsoluteError + fabs(SIMLIB_RelativeError*si[i]);
 
@@ -224,8 +231,8 @@ begin_step:
 
     GoToState(di, si, xi);
 
-    for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-      (*ip)->SetState(si[i] - A6[i] + A7[i] + A7[i]);
+    for(i=0; i<N; i++) {
+      y[i] = si[i] - A6[i] + A7[i] + A7[i];
     }
 
     SIMLIB_StepStartTime += dthlf;
@@ -233,9 +240,13 @@ begin_step:
 
     SIMLIB_Dynamic();  // evaluate new state of model                (8)
 
-    for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+    for(i=0; i<N; i++) {
       // new state
-      (*ip)->SetState(si[i] + (A5[i] + 4.0*A7[i] + dthlf*(*ip)->GetDiff()) / 6.0);
+      y[i] = si[i] + (A5[i] + 4.0*A7[i] + dthlf*dy[i]) / 6.0;
+    }
+
+    if(Condition::isAny()) { // derivatives at end of step for StateCond
+      SIMLIB_Dynamic();      // (dense output uses them)             (9)
     }
 
     if(StateCond()) { // check on changes of state conditions at end of step
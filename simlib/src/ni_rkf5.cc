@@ -63,7 +63,9 @@ void RKF5::Integrate(void)
   const double pshrnk = 0.25;   // coefficient for reducing step
   const double pgrow  = 0.20;   // coefficient for increasing step
   register size_t i;   // auxiliary variables for loops to go through list
-  Iterator ip, end_it; // of integrators
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
   double ratio;     // ratio for next step computation
   double next_step; // recommended stepsize for next step
   size_t n;       // integrator with the greatest error
@@ -71,7 +73,11 @@ void RKF5::Integrate(void)
   Dprintf((" RKF5 integration step ")); // print debugging info
   Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
 
-  end_it=LastIntegrator(); // end of container of integrators
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
 
   //--------------------------------------------------------------------------
   //  Step of method
@@ -86,9 +92,9 @@ begin_step:
   SIMLIB_ContractStepFlag = false;           // clear reduce step flag
   SIMLIB_ContractStep = 0.5*SIMLIB_StepSize; // implicitly reduce to half step
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A1[i] = SIMLIB_StepSize*(*ip)->GetOldDiff(); // compute coefficient
-    (*ip)->SetState((*ip)->GetOldState() + 0.2*A1[i]); // state (y) for next sub-step
+  for(i=0; i<N; i++) {
+    A1[i] = SIMLIB_StepSize*dy0[i]; // compute coefficient
+    y[i] = y0[i] + 0.2*A1[i]; // state (y) for next sub-step
   }
 
   ////////////////////////////////////////////////////////////// 0.2 of step
@@ -98,9 +104,9 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model (y'=f(t,y))      (1)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A2[i] = SIMLIB_StepSize*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() + (3.0*A1[i] + 9.0*A2[i]) / 40.0);
+  for(i=0; i<N; i++) {
+    A2[i] = SIMLIB_StepSize*dy[i];
+    y[i] = y0[i] + (3.0*A1[i] + 9.0*A2[i]) / 40.0;
   }
 
   ////////////////////////////////////////////////////////////// 0.3 of step
@@ -110,9 +116,9 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (2)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A3[i] = SIMLIB_StepSize*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() + 0.3 * A1[i] - 0.9 * A2[i] + 1.2 * A3[i]);
+  for(i=0; i<N; i++) {
+    A3[i] = SIMLIB_StepSize*dy[i];
+    y[i] = y0[i] + 0.3 * A1[i] - 0.9 * A2[i] + 1.2 * A3[i];
   }
 
   ////////////////////////////////////////////////////////////// 0.6 of step
@@ -122,12 +128,12 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (3)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A4[i] = SIMLIB_StepSize*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() - 11.0 / 54.0 * A1[i]
+  for(i=0; i<N; i++) {
+    A4[i] = SIMLIB_StepSize*dy[i];
+    y[i] = y0[i] - 11.0 / 54.0 * A1[i]
                                    +  2.5        * A2[i]
                                    - 70.0 / 27.0 * A3[i]
-                                   + 35.0 / 27.0 * A4[i]);
+                                   + 35.0 / 27.0 * A4[i];
   }
 
   ////////////////////////////////////////////////////////////// 1.0 of step
@@ -137,13 +143,13 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (4)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A5[i] = SIMLIB_StepSize*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() +  1631.0 /  55296.0 * A1[i]
+  for(i=0; i<N; i++) {
+    A5[i] = SIMLIB_StepSize*dy[i];
+    y[i] = y0[i] +  1631.0 /  55296.0 * A1[i]
                                    +   175.0 /    512.0 * A2[i]
                                    +   575.0 /  13824.0 * A3[i]
                                    + 44275.0 / 110592.0 * A4[i]
-                                   +   253.0 /   4096.0 * A5[i]);
+                                   +   253.0 /   4096.0 * A5[i];
   }
 
   ///////////////////////////////////////////////////////////// 0.875 of step
@@ -153,12 +159,12 @@ begin_step:
 
   SIMLIB_Dynamic();  // evaluate new state of model                  (5)
 
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
-    A6[i] = SIMLIB_StepSize*(*ip)->GetDiff();
-    (*ip)->SetState((*ip)->GetOldState() +  37.0 /  378.0 * A1[i] // final state
+  for(i=0; i<N; i++) {
+    A6[i] = SIMLIB_StepSize*dy[i];
+    y[i] = y0[i] +  37.0 /  378.0 * A1[i] // final state
                                    + 250.0 /  621.0 * A3[i]
                                    + 125.0 /  594.0 * A4[i]
-                                   + 512.0 / 1771.0 * A6[i]);
+                                   + 512.0 / 1771.0 * A6[i];
   }
 
   ////////////////////////////////////////////////////////////// end of step
@@ -174,7 +180,7 @@ begin_step:
   SIMLIB_ERRNO = 0; // OK
   ratio = 32.0;     // 2^5 - ratio for stepsize computation - initial value
   n=0;              // integrator with greatest error
-  for(ip=FirstIntegrator(),i=0; ip!=end_it; ip++,i++) {
+  for(i=0; i<N; i++) {
     double eerr; // estimated error
     double terr; // greatest allowed error
 
@@ -184,7 +190,7 @@ begin_step:
                 -  277.0 /  14336.0 * A5[i]
                 +  277.0 /   7084.0 * A6[i]);
     terr = fabs(SIMLIB_AbsoluteError)
-         + fabs(SIMLIB_RelativeError*(*ip)->GetState());
+         + fabs(SIMLIB_RelativeError*y[i]);
     if(terr < eerr*ratio) { // avoid arithmetic overflow
       ratio = terr/eerr;    // find the lowest ratio
       n=i;                  // remember the integrator
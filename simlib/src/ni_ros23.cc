@@ -0,0 +1,209 @@
+/////////////////////////////////////////////////////////////////////////////
+// ni_ros23.cc
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  numerical integration: Rosenbrock method 2(3)
+//  (L. F. Shampine, M. W. Reichelt: The MATLAB ODE Suite, 1997)
+//
+
+////////////////////////////////////////////////////////////////////////////
+//  interface
+//
+#include "simlib.h"
+#include "internal.h"
+#include "ni_ros23.h"
+#include <cmath>
+#include <cfloat>
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////////////
+//  implementation
+//
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+
+////////////////////////////////////////////////////////////////////////////
+//  Rosenbrock method 2(3)
+//
+/*  Formula (d = 1/(2+sqrt(2)), e = 6+sqrt(2), W = I - h*d*J):
+
+    F0 = f(t,y)
+    k1 = W \ (F0 + h*d*T)                                 T = df/dt
+    F1 = f(t+0.5*h, y + 0.5*h*k1)
+    k2 = W \ (F1 - k1) + k1
+    y += h*k2
+    F2 = f(t+h, y)
+    k3 = W \ (F2 - e*(k2 - F1) - 2*(k1 - F0) + h*d*T)
+    err = h/6 * |k1 - 2*k2 + k3|
+
+    Jacobian matrix is computed once per step (also used after rejected
+    step), one LU factorization is used for all three stages.
+*/
+
+void ROS23::Integrate(void)
+{
+  const double safety = 0.9; // keeps the new step from growing too large
+  const double max_ratio = 4.0; // ditto
+  const double d = 1.0/(2.0 + std::sqrt(2.0));
+  const double e = 6.0 + std::sqrt(2.0);
+  size_t i;            // auxiliary variables for loops to go through list
+  size_t N;            // # of integrators
+  double *y, *dy;      // state and derivative of all integrators
+  double *y0, *dy0;    // the same from start of step
+  bool fresh;          // Jacobian matrix was computed in this step
+  double h;            // step size
+  double ratio;        // ratio for next step computation
+  double next_step;    // recommended stepsize for next step
+  size_t n;            // integrator with the greatest error
+
+  Dprintf((" ROS23 integration step ")); // print debugging info
+  Dprintf((" Time = %g, optimal step = %g", (double)Time, OptStep));
+
+  N   = IntegratorContainer::Size();  // contiguous arrays (see intg.cc)
+  y   = IntegratorContainer::State();
+  dy  = IntegratorContainer::Diff();
+  y0  = IntegratorContainer::OldState();
+  dy0 = IntegratorContainer::OldDiff();
+  fresh = false;
+
+  //--------------------------------------------------------------------------
+  //  Step of method
+  //--------------------------------------------------------------------------
+
+begin_step:
+
+  ///////////////////////////////////////////////////////// beginning of step
+
+  SIMLIB_StepSize = max(SIMLIB_StepSize, SIMLIB_MinStep); // low step limit
+
+  SIMLIB_ContractStepFlag = false;           // clear reduce step flag
+  SIMLIB_ContractStep = 0.5*SIMLIB_StepSize; // implicitly reduce to half step
+
+  h = SIMLIB_StepSize;
+
+  if(!fresh) {  // J and T at (t,y0)
+    Jacobian(y0, dy0);
+    double dt = std::sqrt(DBL_EPSILON) * max(std::fabs(SIMLIB_StepStartTime), h);
+    FunCall(dt/h);  // f(t+dt, y0)
+    dt = double(Time) - SIMLIB_StepStartTime;
+    for(i=0; i<N; i++)
+      T[i] = dt>0 ? (dy[i] - dy0[i]) / dt : 0.0;
+    fresh = true;
+  }
+
+  if(NeedFactor(d*h) && !Factor(d*h)) {  // singular matrix
+    if(SIMLIB_StepSize > SIMLIB_MinStep) {
+      SIMLIB_OptStep = max(0.5*SIMLIB_StepSize, SIMLIB_MinStep);
+      SIMLIB_StepSize = SIMLIB_OptStep;
+      IsEndStepEvent = false;
+      goto begin_step;
+    }
+    SIMLIB_warning(AccuracyError);
+  }
+
+  for(i=0; i<N; i++)
+    K1[i] = dy0[i] + h*d*T[i];
+  Solve(&K1[0]);
+  for(i=0; i<N; i++)
+    y[i] = y0[i] + 0.5*h*K1[i];
+
+  ////////////////////////////////////////////////////////////// 0.5 of step
+
+  FunCall(0.5);  // evaluate new state of model                      (1)
+
+  for(i=0; i<N; i++) {
+    F1[i] = dy[i];
+    K2[i] = F1[i] - K1[i];
+  }
+  Solve(&K2[0]);
+  for(i=0; i<N; i++) {
+    K2[i] += K1[i];
+    y[i] = y0[i] + h*K2[i];  // final state
+  }
+
+  ////////////////////////////////////////////////////////////// end of step
+
+  FunCall(1.0);  // evaluate new state of model                      (2)
+
+  for(i=0; i<N; i++)
+    K3[i] = dy[i] - e*(K2[i] - F1[i]) - 2.0*(K1[i] - dy0[i]) + h*d*T[i];
+  Solve(&K3[0]);
+
+  //--------------------------------------------------------------------------
+  //  Check on accuracy of numerical integration, estimate error
+  //--------------------------------------------------------------------------
+
+  SIMLIB_ERRNO = 0; // OK
+  ratio = 8.0;      // 2^3 - ratio for stepsize computation - initial value
+  n=0;              // integrator with greatest error
+  for(i=0; i<N; i++) {
+    double eerr; // estimated error
+    double terr; // greatest allowed error
+
+    eerr = h/6.0 * std::fabs(K1[i] - 2.0*K2[i] + K3[i]); // estimation
+    terr = Tolerance(y0[i], y[i]);
+    if(!(eerr==eerr)) {     // NaN: reduce step
+      ratio = 0;
+      n=i;
+      break;
+    }
+    if(terr < eerr*ratio) { // avoid arithmetic overflow
+      ratio = terr/eerr;    // find the lowest ratio
+      n=i;                  // remember the integrator
+    }
+  } // for
+
+  Dprintf(("R: %g",ratio));
+
+  if(ratio < 1.0) { // error is too large, reduce stepsize
+    ratio = max(std::pow(ratio, 1.0/3), 0.2); // coefficient for reduce
+    Dprintf(("Down: %g",ratio));
+    if(SIMLIB_StepSize > SIMLIB_MinStep) {  // reducing step is possible
+      SIMLIB_OptStep = max(safety*ratio*SIMLIB_StepSize, SIMLIB_MinStep);
+      SIMLIB_StepSize = SIMLIB_OptStep;
+      IsEndStepEvent = false; // no event will be at the end of the step
+      goto begin_step;        // compute again with smaller step
+    }
+    // reducing step is unpossible
+    SIMLIB_ERRNO++;          // requested accuracy cannot be achieved
+    _Print("\n Integrator[%lu] ",(unsigned long)n);
+    SIMLIB_warning(AccuracyError);
+    next_step = SIMLIB_StepSize;
+  } else { // allowed tolerantion is fulfiled
+    if(!IsStartMode()) { // method is not used for start multi-step method
+      ratio = min(std::pow(ratio, 1.0/3), max_ratio); // coefficient for increase
+      Dprintf(("Up: %g",ratio));
+      next_step = min(safety*ratio*SIMLIB_StepSize, SIMLIB_MaxStep);
+    } else {
+      next_step = SIMLIB_StepSize;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  //  Analyse system at the end of the step
+  //--------------------------------------------------------------------------
+
+  if(StateCond()) { // check on changes of state conditions at end of step
+    goto begin_step;
+  }
+
+  //--------------------------------------------------------------------------
+  //  Results of step have been accepted, take fresh step
+  //--------------------------------------------------------------------------
+
+  // increase step, if accuracy is good
+  SIMLIB_OptStep = next_step;
+
+} // ROS23::Integrate
+
+
+}
+// end of ni_ros23.cc
@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file ni_ros23.h  Rosenbrock method 2(3)
+//
+// Copyright (c) 2016 Petr Peringer
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  numerical integration: linearly implicit Rosenbrock method 2nd order
+//                         with 3rd order error estimation (stiff systems)
+//
+
+
+#include "simlib.h"
+#include "ni_stiff.h"
+
+namespace simlib3 {
+
+////////////////////////////////////////////////////////////////////////////
+//  class representing the integration method
+//
+class ROS23 : public StiffMethod {
+private:
+  Memory K1, K2, K3;    // stages
+  Memory F1;            // f at the middle of step
+  Memory T;             // time derivative df/dt
+public:
+  ROS23(const char* name) :  // registrate method and name it
+    StiffMethod(name)
+  { /*NOTHING*/ }
+  virtual ~ROS23()  // destructor
+  { /*NOTHING*/ }
+  virtual void Integrate(void);  // integration method
+}; // class ROS23
+
+}
+
+// end of ni_ros23.h
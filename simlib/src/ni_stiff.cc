@@ -0,0 +1,295 @@
+/////////////////////////////////////////////////////////////////////////////
+// ni_stiff.cc
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  numerical integration: common part of implicit methods
+//
+//  Jacobian matrix J = df/dy is computed by finite differences. Inputs
+//  of integrators are compiled (see tape.cc), so the structure of J is
+//  known: columns without common nonzero row are grouped (greedy
+//  coloring, Curtis-Powell-Reid) and each group needs only one
+//  evaluation of the model. For example a chain of N integrators
+//  (discretized heating, pipelines) needs 3 evaluations instead of N.
+//  Blocks which are not compiled (user blocks) can depend on any state,
+//  so their rows are full.
+//
+//  Only nonzero elements of J are stored (by rows). Matrix I - gh*J is
+//  factorized by Gaussian elimination with partial pivoting (row
+//  interchanges fill at most kl diagonals above the band). If the band
+//  (kl+ku+1 diagonals, from the structure of J) is narrower than the
+//  matrix, LU is kept in band storage: n*(2*kl+ku+1) elements and
+//  O(n*kl*(kl+ku)) operations, so a chain of N integrators costs O(N)
+//  instead of O(N^3). Wide bands (user blocks, cycles) are stored dense.
+//  Zero elements under the diagonal are skipped. Factorization is reused
+//  while gh does not change too much (see NeedFactor).
+//
+
+////////////////////////////////////////////////////////////////////////////
+//  interface
+//
+#include "simlib.h"
+#include "internal.h"
+#include "ni_stiff.h"
+#include "tape.h"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////////////
+//  implementation
+//
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::StiffMethod
+//
+StiffMethod::StiffMethod(const char* name):
+  SingleStepMethod(name),
+  n(0), pattern_id(~0UL), kl(0), ku(0), banded(false), lu_row(0),
+  lu_off(0), lu_gh(0), jac_ok(false)
+{ /*NOTHING*/ }
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::PrepareStep
+//  # of integrators changed: all matrices are invalid
+//
+bool StiffMethod::PrepareStep(void)
+{
+  if(SingleStepMethod::PrepareStep()) {
+    pattern_id = ~0UL;
+    jac_ok = false;
+    lu_gh = 0;
+    return true;
+  }
+  return false;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::TurnOff
+//
+void StiffMethod::TurnOff(void)
+{
+  SingleStepMethod::TurnOff();
+  n = 0;
+  pattern_id = ~0UL;
+  jac_ok = false;
+  lu_gh = 0;
+  rows.clear(); cols.clear(); cidx.clear(); groups.clear();
+  rowstart.clear(); J.clear(); LU.clear(); piv.clear();
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::Pattern
+//  nonzero elements of J and groups of independent columns
+//
+void StiffMethod::Pattern(void)
+{
+  SIMLIB_Tape *t = IntegratorContainer::Tape();
+  n = IntegratorContainer::Size();
+  pattern_id = t ? t->Id() : 0;
+  if(t)
+    t->Dependencies(rows);
+  else {  // not compiled: dense matrix
+    rows.assign(n, std::vector<size_t>(n));
+    for(size_t i=0; i<n; i++)
+      for(size_t j=0; j<n; j++)
+        rows[i][j] = j;
+  }
+  cols.assign(n, std::vector<size_t>());
+  cidx.assign(n, std::vector<size_t>());
+  rowstart.assign(n+1, 0);
+  kl = ku = 0;
+  for(size_t i=0; i<n; i++) {
+    rowstart[i+1] = rowstart[i] + rows[i].size();
+    for(size_t k=0; k<rows[i].size(); k++) {
+      size_t j = rows[i][k];
+      cols[j].push_back(i);
+      cidx[j].push_back(rowstart[i] + k);
+      if(i > j && i-j > kl) kl = i-j;
+      if(j > i && j-i > ku) ku = j-i;
+    }
+  }
+
+  // greedy coloring: column gets the first color not used by columns
+  // with common row
+  const size_t none = ~size_t(0);
+  std::vector<size_t> color(n, none);
+  std::vector<size_t> used;            // used[c]==j: color c forbidden for j
+  groups.clear();
+  for(size_t j=0; j<n; j++) {
+    for(size_t k=0; k<cols[j].size(); k++) {
+      const std::vector<size_t> &r = rows[cols[j][k]];
+      for(size_t m=0; m<r.size(); m++)
+        if(color[r[m]] != none)
+          used[color[r[m]]] = j;
+    }
+    size_t c = 0;
+    while(c < groups.size() && used[c] == j)
+      c++;
+    if(c == groups.size()) {
+      groups.push_back(std::vector<size_t>());
+      used.push_back(none);
+    }
+    color[j] = c;
+    groups[c].push_back(j);
+  }
+  J.assign(rowstart[n], 0.0);
+  // band storage: row i keeps columns i-kl .. i+kl+ku (fill by pivoting)
+  const size_t w = 2*kl + ku + 1;
+  banded = w < n;
+  if(banded) {
+    lu_row = w - 1;
+    lu_off = kl;
+  } else {
+    kl = ku = n ? n-1 : 0;    // loops over the whole matrix
+    lu_row = n;
+    lu_off = 0;
+  }
+  LU.resize(banded ? n*w : n*n);
+  piv.resize(n);
+  jac_ok = false;
+  lu_gh = 0;
+  Dprintf(("StiffMethod::Pattern: %lu integrators, %lu evaluations, %s",
+           (unsigned long)n, (unsigned long)groups.size(),
+           banded ? "band" : "dense"));
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::Jacobian
+//  J = df/dy at start of step, f0 = f(t,y0)
+//  (state is left equal to y0, derivatives are changed)
+//
+void StiffMethod::Jacobian(const double *y0, const double *f0)
+{
+  SIMLIB_Tape *t = IntegratorContainer::Tape();
+  if(IntegratorContainer::Size() != n || (t ? t->Id() : 0) != pattern_id)
+    Pattern();  // first use or changed model
+  double *y  = IntegratorContainer::State();
+  double *dy = IntegratorContainer::Diff();
+  const double eps = std::sqrt(DBL_EPSILON);
+  std::vector<double> delta(n);
+  for(size_t j=0; j<n; j++)
+    y[j] = y0[j];
+  for(size_t c=0; c<groups.size(); c++) {
+    const std::vector<size_t> &g = groups[c];
+    for(size_t k=0; k<g.size(); k++) {
+      size_t j = g[k];
+      volatile double yj = y0[j] + eps*max(std::fabs(y0[j]), 1e-6);
+      delta[j] = yj - y0[j];    // exactly representable difference
+      y[j] = yj;
+    }
+    FunCall(0.0);               // f(t, y0 + delta)
+    for(size_t k=0; k<g.size(); k++) {
+      size_t j = g[k];
+      for(size_t m=0; m<cols[j].size(); m++) {
+        size_t i = cols[j][m];
+        J[cidx[j][m]] = (dy[i] - f0[i]) / delta[j];
+      }
+      y[j] = y0[j];
+    }
+  }
+  jac_ok = true;
+  lu_gh = 0;    // factorization is not valid
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::Factor
+//  LU factorization of I - gh*J, returns false for singular matrix
+//  (only columns k..k+kl+ku of rows k..k+kl are changed in step k,
+//  multipliers are not interchanged: see Solve)
+//
+bool StiffMethod::Factor(double gh)
+{
+  double *a = n ? &LU[0] : 0;
+  for(size_t i=0; i<LU.size(); i++)
+    a[i] = 0.0;
+  for(size_t i=0; i<n; i++) {
+    for(size_t k=0; k<rows[i].size(); k++)
+      a[At(i,rows[i][k])] = -gh*J[rowstart[i]+k];
+    a[At(i,i)] += 1.0;
+  }
+  lu_gh = 0;
+  for(size_t k=0; k<n; k++) {
+    const size_t imax = std::min(n-1, k+kl);        // last row in band
+    const size_t jmax = std::min(n-1, k+kl+ku);     // last column with fill
+    size_t p = k;                       // pivot
+    for(size_t i=k+1; i<=imax; i++)
+      if(std::fabs(a[At(i,k)]) > std::fabs(a[At(p,k)]))
+        p = i;
+    if(a[At(p,k)] == 0.0)
+      return false;
+    piv[k] = p;
+    if(p != k)
+      for(size_t j=k; j<=jmax; j++) {
+        double tmp = a[At(k,j)]; a[At(k,j)] = a[At(p,j)]; a[At(p,j)] = tmp;
+      }
+    const double *rk = a + At(k,0);     // row k: rk[j] is element (k,j)
+    for(size_t i=k+1; i<=imax; i++) {
+      double *ri = a + At(i,0);
+      if(ri[k] == 0.0)
+        continue;                       // sparse matrix
+      double m = ri[k] /= rk[k];
+      for(size_t j=k+1; j<=jmax; j++)
+        ri[j] -= m*rk[j];
+    }
+  }
+  lu_gh = gh;
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::Solve
+//  solve (I - gh*J) x = b, result in b
+//
+void StiffMethod::Solve(double *b)
+{
+  const double *a = n ? &LU[0] : 0;
+  for(size_t k=0; k<n; k++) {           // forward substitution
+    if(piv[k] != k) {                   // row interchange of step k
+      double tmp = b[k]; b[k] = b[piv[k]]; b[piv[k]] = tmp;
+    }
+    if(b[k] != 0.0) {
+      const size_t imax = std::min(n-1, k+kl);
+      for(size_t i=k+1; i<=imax; i++)
+        b[i] -= a[At(i,k)]*b[k];
+    }
+  }
+  for(size_t k=n; k-->0; ) {            // back substitution
+    const size_t jmax = std::min(n-1, k+kl+ku);
+    double s = b[k];
+    for(size_t j=k+1; j<=jmax; j++)
+      s -= a[At(k,j)]*b[j];
+    b[k] = s / a[At(k,k)];
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  StiffMethod::Tolerance
+//  allowed error for state values a, b (start and end of step)
+//
+double StiffMethod::Tolerance(double a, double b)
+{
+  return std::fabs(SIMLIB_AbsoluteError)
+       + std::fabs(SIMLIB_RelativeError)*max(std::fabs(a), std::fabs(b))
+       + DBL_MIN;   // no division by zero
+}
+
+}
+// end of ni_stiff.cc
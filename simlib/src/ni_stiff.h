@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file ni_stiff.h  Base of implicit methods for stiff systems
+//
+// Copyright (c) 2016 Petr Peringer
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  numerical integration: common part of implicit methods (BDF2, ROS23)
+//  - Jacobian matrix by finite differences, columns which do not share
+//    any row are perturbed together (structure from compiled inputs),
+//    only nonzero elements are stored
+//  - LU factorization of I - g*J in band storage (dense if the band is
+//    not narrower than the matrix), kept while g*J does not change much
+//
+
+#ifndef __SIMLIB__NI_STIFF_H__
+#define __SIMLIB__NI_STIFF_H__
+
+#include "simlib.h"
+#include <vector>
+
+namespace simlib3 {
+
+////////////////////////////////////////////////////////////////////////////
+//  base class of implicit integration methods
+//
+class StiffMethod : public SingleStepMethod {
+private:
+  size_t n;                             // size of matrices
+  unsigned long pattern_id;             // tape of pattern (0 = dense)
+  std::vector< std::vector<size_t> > rows; // nonzero columns of each row
+  std::vector< std::vector<size_t> > cols; // nonzero rows of each column
+  std::vector< std::vector<size_t> > cidx; // cols: indexes into J
+  std::vector< std::vector<size_t> > groups; // columns of the same color
+  std::vector<size_t> rowstart;         // rows[i] starts at J[rowstart[i]]
+  std::vector<double> J;                // nonzero elements of Jacobian
+  size_t kl, ku;                        // lower and upper bandwidth
+  bool banded;                          // LU in band storage
+  size_t lu_row, lu_off;                // element (i,j) of LU: see At()
+  std::vector<double> LU;               // factorized I - gh*J
+  std::vector<size_t> piv;              // row interchanges
+  double lu_gh;                         // gh of factorization (0 = none)
+  void Pattern(void);                   // structure of J, coloring
+  size_t At(size_t i, size_t j) const { // index of element (i,j) in LU
+    return i*lu_row + j + lu_off;
+  }
+protected:
+  bool jac_ok;                          // J is valid (computed earlier)
+  // compute J at (y0,f0), start of step (uses state and derivative arrays)
+  void Jacobian(const double *y0, const double *f0);
+  bool Factor(double gh);               // factorize I - gh*J
+  bool NeedFactor(double gh) const {    // gh changed too much
+    return lu_gh==0 || gh > 1.3*lu_gh || gh < 0.7*lu_gh;
+  }
+  void Solve(double *b);                // b := (I - gh*J)^-1 b
+  static double Tolerance(double a, double b); // allowed error
+public:
+  StiffMethod(const char* name);
+  virtual ~StiffMethod() { /*NOTHING*/ }
+  virtual bool PrepareStep(void);       // invalidate J on changes
+  virtual void TurnOff(void);           // free matrices
+  unsigned Evaluations(void) const {    // # of evaluations for J
+    return groups.size();
+  }
+  bool Banded(void) const {             // LU in band storage
+    return banded;
+  }
+}; // class StiffMethod
+
+}
+
+#endif // __SIMLIB__NI_STIFF_H__
+
+// end of ni_stiff.h
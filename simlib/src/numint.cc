@@ -18,14 +18,17 @@
 #include "simlib.h"
 #include "internal.h"
 #include "ni_abm4.h"
+#include "ni_bdf2.h"
 #include "ni_euler.h"
 #include "ni_fw.h"
 #include "ni_rke.h"
 #include "ni_rkf3.h"
 #include "ni_rkf5.h"
 #include "ni_rkf8.h"
+#include "ni_ros23.h"
 #include <cstddef>
 #include <cstring>
+#include <vector>
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -58,7 +61,7 @@ void IntegrationMethod::StepSim(void)
   SIMLIB_DynamicFlag = true; // numerical integration is running
   if(Prepare()) { // initialize integration step (condition is not changed)
     if(IntegratorContainer::isAny()) { // are there any integrators?
-      CurrentMethodPtr->Integrate(); // * numerical integration *
+      CurrentMethod()->Integrate(); // * numerical integration *
     } else {     // model without integrators
       Iterate(); // compute new values of state blocks
     }
@@ -78,7 +81,7 @@ void IntegrationMethod::SetMethod(const char* name)
   if(SIMLIB_DynamicFlag) {
     SIMLIB_error(NI_CantSetMethod);  // can't in 'dynamic section' !!!
   }
-  CurrentMethodPtr->TurnOff();  // suspend present method
+  CurrentMethod()->TurnOff();  // suspend present method
   CurrentMethodPtr=SearchMethod(name);  // set new method
 }
 
@@ -164,7 +167,7 @@ bool IntegrationMethod::Prepare(void)
   if(SIMLIB_StepSize<=0)
     SIMLIB_error(NI_IlStepSize); // error of integration
 
-  CurrentMethodPtr->PrepareStep(); // prepare current method for single step
+  CurrentMethod()->PrepareStep(); // prepare current method for single step
 
   return true;
 }
@@ -176,19 +179,112 @@ bool IntegrationMethod::StateCond(void)
 {
   Dprintf(("IntegrationMethod::StateCond()"));
 
+  SIMLIB_EventStep = SIMLIB_MAXTIME;
+  SIMLIB_LocateFlag = true;     // conditions find crossings (see cond.cc)
   Condition::TestAll(); // check on changes
+  SIMLIB_LocateFlag = false;
 
   if(SIMLIB_ContractStepFlag && SIMLIB_StepSize>SIMLIB_MinStep) {
     // step reducing is requested and it is possible
-    SIMLIB_StepSize = SIMLIB_ContractStep; // reduce step to demanded size
+    SIMLIB_StepSize = min(SIMLIB_ContractStep, SIMLIB_EventStep);
+                                           // reduce step to demanded size
                                            // implicitly to quater of step
     IsEndStepEvent = false; // no event will be scheduled at end of step
     return true;
   }
+  if(SIMLIB_EventStep < SIMLIB_StepSize) {
+    // crossing was located inside step: step ends just after it
+    SIMLIB_StepSize = SIMLIB_EventStep;
+    IsEndStepEvent = false; // no event will be scheduled at end of step
+    return true;
+  }
   return false;
 }
 
 
+////////////////////////////////////////////////////////////////////////////
+//  dense output (continuous extension of integration methods)
+//  used for location of state condition changes inside the step
+//
+thread_local bool SIMLIB_LocateFlag = false;    //!< conditions locate crossings
+thread_local double SIMLIB_EventStep = SIMLIB_MAXTIME; //!< step to crossing
+
+namespace {
+struct EndOfStep {                      // saved state at the end of step
+  bool saved;
+  std::vector<double> y;
+  double time, delta;
+  bool contract_flag;
+  double contract_step;
+  EndOfStep() : saved(false), time(0), delta(0),
+                contract_flag(false), contract_step(0) {}
+};
+thread_local EndOfStep end_of_step;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///  interpolated states: y(t + step_frag*h) from y, y' at start (old
+///  values) and end of the step (cubic Hermite polynomial, 3rd order)
+void IntegrationMethod::DenseOutput(double step_frag, const double *yend,
+                                    double *y)
+{
+  const double th = step_frag;
+  const double h = end_of_step.delta;
+  const double h00 = (2*th - 3)*th*th + 1;
+  const double h10 = ((th - 2)*th + 1)*th;
+  const double h01 = (3 - 2*th)*th*th;
+  const double h11 = (th - 1)*th*th;
+  size_t n = IntegratorContainer::Size();
+  const double *y0 = IntegratorContainer::OldState();
+  const double *f0 = IntegratorContainer::OldDiff();
+  const double *f1 = IntegratorContainer::Diff();
+  for(size_t i=0; i<n; i++)
+    y[i] = h00*y0[i] + h10*h*f0[i] + h01*yend[i] + h11*h*f1[i];
+}
+
+////////////////////////////////////////////////////////////////////////////
+///  set states of integrators and status blocks inside the step
+///  (derivatives are not changed, see EndState)
+void IntegrationMethod::DenseState(double step_frag)
+{
+  EndOfStep &e = end_of_step;
+  size_t n = IntegratorContainer::Size();
+  double *y = IntegratorContainer::State();
+  if(!e.saved) {
+    e.y.assign(y, y + n);
+    e.time = Time;
+    e.delta = double(Time) - SIMLIB_StepStartTime;
+    e.contract_flag = SIMLIB_ContractStepFlag;
+    e.contract_step = SIMLIB_ContractStep;
+    e.saved = true;
+  }
+  CurrentMethod()->DenseOutput(step_frag, n ? &e.y[0] : 0, y);
+  _SetTime(Time, SIMLIB_StepStartTime + step_frag*e.delta);
+  SIMLIB_DeltaTime = double(Time) - SIMLIB_StepStartTime;
+  StatusContainer::ClearAllValueOK();
+  StatusContainer::EvaluateAll();
+}
+
+////////////////////////////////////////////////////////////////////////////
+///  restore state at the end of step (after DenseState)
+void IntegrationMethod::EndState(void)
+{
+  EndOfStep &e = end_of_step;
+  if(!e.saved)
+    return;
+  double *y = IntegratorContainer::State();
+  for(size_t i=0; i<e.y.size(); i++)
+    y[i] = e.y[i];
+  _SetTime(Time, e.time);
+  SIMLIB_DeltaTime = e.delta;
+  SIMLIB_ContractStepFlag = e.contract_flag;  // status blocks can change it
+  SIMLIB_ContractStep = e.contract_step;
+  e.saved = false;
+  StatusContainer::ClearAllValueOK();
+  StatusContainer::EvaluateAll();
+}
+
+
 ////////////////////////////////////////////////////////////////////////////
 /// register method to list of methods and name it
 IntegrationMethod::IntegrationMethod(const char *name):
@@ -242,6 +338,7 @@ IntegrationMethod* IntegrationMethod::SearchMethod(const char* name)
   std::list<IntegrationMethod*>::iterator end_it; // iterator to end of the list
 
   Dprintf(("IntegrationMethod::SearchMethod(\"%s\")", name));
+  (void)CurrentMethod(); // create predefined methods
   // is list of methods created?
   if(MthLstPtr!=NULL) {
     // search for method in the list of registrated methods
@@ -545,15 +642,14 @@ void StatusMethod::StatusResize(size_t size)
 void StatusMethod::StoreState(Memory& di, Memory& si, StatusMemory& xi)
 {
   register size_t i;
-  IntegratorContainer::iterator ip, end_it;
+  size_t N = IntegratorContainer::Size();
+  double *y = IntegratorContainer::State();
+  double *dy = IntegratorContainer::Diff();
   StatusContainer::iterator sp, status_end_it;
 
-  for(ip=IntegratorContainer::Begin(), end_it=IntegratorContainer::End(), i=0;
-      ip!=end_it;
-      ip++, i++)
-  {
-    di[i]=(*ip)->GetDiff();
-    si[i]=(*ip)->GetState();
+  for(i=0; i<N; i++) {
+    di[i]=dy[i];
+    si[i]=y[i];
   }
 
   for(sp=StatusContainer::Begin(), status_end_it=StatusContainer::End(), i=0;
@@ -570,15 +666,14 @@ void StatusMethod::RestoreState(double dthlf, Memory& di, Memory& si,
                                 StatusMemory& xi)
 {
   register size_t i;
-  IntegratorContainer::iterator ip, end_it;
+  size_t N = IntegratorContainer::Size();
+  double *y = IntegratorContainer::State();
+  double *dy = IntegratorContainer::Diff();
   StatusContainer::iterator sp, status_end_it;
 
-  for(ip=IntegratorContainer::Begin(), end_it=IntegratorContainer::End(), i=0;
-      ip!=end_it;
-      ip++, i++)
-  {
-    (*ip)->SetDiff(di[i]);
-    (*ip)->SetState(si[i]);
+  for(i=0; i<N; i++) {
+    dy[i]=di[i];
+    y[i]=si[i];
   }
 
   for(sp=StatusContainer::Begin(), status_end_it=StatusContainer::End(), i=0;
@@ -597,15 +692,14 @@ void StatusMethod::RestoreState(double dthlf, Memory& di, Memory& si,
 void StatusMethod::GoToState(Memory& di, Memory& si, StatusMemory& xi)
 {
   register size_t i;
-  IntegratorContainer::iterator ip, end_it;
+  size_t N = IntegratorContainer::Size();
+  double *y0 = IntegratorContainer::OldState();
+  double *dy0 = IntegratorContainer::OldDiff();
   StatusContainer::iterator sp, status_end_it;
 
-  for(ip=IntegratorContainer::Begin(), end_it=IntegratorContainer::End(), i=0;
-      ip!=end_it;
-      ip++, i++)
-  {
-    (*ip)->SetOldDiff(di[i]);
-    (*ip)->SetOldState(si[i]);
+  for(i=0; i<N; i++) {
+    dy0[i]=di[i];
+    y0[i]=si[i];
   }
 
   for(sp=StatusContainer::Begin(), status_end_it=StatusContainer::End(), i=0;
@@ -623,39 +717,61 @@ void StatusMethod::GoToState(Memory& di, Memory& si, StatusMemory& xi)
 const size_t IntegrationMethod::Memory::page_size = 256;
 
 // flag - will be event at the end of the step?
-bool IntegrationMethod::IsEndStepEvent=false;
+thread_local bool IntegrationMethod::IsEndStepEvent=false;
 
 // list of registered methods
-std::list<IntegrationMethod*>* IntegrationMethod::MthLstPtr=NULL;
+thread_local std::list<IntegrationMethod*>* IntegrationMethod::MthLstPtr=NULL;
 
 // pointer to the filled list of memories
-std::list<IntegrationMethod::Memory*>* IntegrationMethod::PtrMList;
+thread_local std::list<IntegrationMethod::Memory*>* IntegrationMethod::PtrMList;
 
 // pointer to the filled list of status memories
-std::list<IntegrationMethod::Memory*>* StatusMethod::PtrStatusMList;
+thread_local std::list<IntegrationMethod::Memory*>* StatusMethod::PtrStatusMList;
 
 
 ////////////////////////////////////////////////////////////////////////////
 // instantiate integration methods
-
-/// Adams-Bashforth-Moulton, 4th order
-ABM4 abm4("abm4", "rkf5");
-/// Euler method
-EULER euler("euler");
-/// Fowler-Warten (Warning: needs testing, do not use)
-FW fw("fw");
-/// Runge-Kutta-England, 4th order?
-RKE rke("rke");
-/// Runge-Kutta-Fehlberg, 3rd order
-RKF3 rkf3("rkf3");
-/// Runge-Kutta-Fehlberg, 5th order
-RKF5 rkf5("rkf5");
-/// Runge-Kutta-Fehlberg, 8th order
-RKF8 rkf8("rkf8");
+// methods keep state between steps, so each thread (simulation context)
+// uses its own instances, created at first use
+namespace {
+struct PredefinedMethods {
+  /// Adams-Bashforth-Moulton, 4th order
+  ABM4 abm4;
+  /// backward differentiation formula, 2nd order (stiff systems)
+  BDF2 bdf2;
+  /// Euler method
+  EULER euler;
+  /// Fowler-Warten (Warning: needs testing, do not use)
+  FW fw;
+  /// Runge-Kutta-England, 4th order?
+  RKE rke;
+  /// Runge-Kutta-Fehlberg, 3rd order
+  RKF3 rkf3;
+  /// Runge-Kutta-Fehlberg, 5th order
+  RKF5 rkf5;
+  /// Runge-Kutta-Fehlberg, 8th order
+  RKF8 rkf8;
+  /// Rosenbrock 2(3) (stiff systems)
+  ROS23 ros23;
+  PredefinedMethods():
+    abm4("abm4", "rkf5"), bdf2("bdf2"), euler("euler"), fw("fw"), rke("rke"),
+    rkf3("rkf3"), rkf5("rkf5"), rkf8("rkf8"), ros23("ros23") {}
+};
+}
 
 /// pointer to the method currently used
+thread_local IntegrationMethod* IntegrationMethod::CurrentMethodPtr = NULL;
+
+////////////////////////////////////////////////////////////////////////////
+/// method currently used, creates predefined methods at first call
 /// "rke" is a predefined method (historical reasons, we need rk45)
-IntegrationMethod* IntegrationMethod::CurrentMethodPtr = &rke;
+IntegrationMethod* IntegrationMethod::CurrentMethod(void)
+{
+  static thread_local PredefinedMethods methods;
+  if(CurrentMethodPtr==NULL)
+    CurrentMethodPtr = &methods.rke;
+  return CurrentMethodPtr;
+}
 
 } // namespace
 
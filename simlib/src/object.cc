@@ -20,7 +20,7 @@ SIMLIB_IMPLEMENTATION;
 ////////////////////////////////////////////////////////////////////////////
 
 // static flag for IsAllocated()
-static bool SimObject_allocated = false;
+static thread_local bool SimObject_allocated = false;
 
 ////////////////////////////////////////////////////////////////////////////
 //! allocate memory for object
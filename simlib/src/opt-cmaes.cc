@@ -0,0 +1,207 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file opt-cmaes.cc  Optimization algorithm - CMA-ES
+//
+// Copyright (c) 2000-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+// EXPERIMENTAL
+// covariance matrix adaptation evolution strategy (mu/mu_w, lambda),
+// see N. Hansen: The CMA Evolution Strategy: A Tutorial
+//  - works in normalized coordinates (0..1 = parameter range)
+//  - points outside of range are moved to the limit (Param assignment)
+//  - population is evaluated in parallel (OptEvaluator)
+//  - samples are taken from RandomStream seeded by current seed
+
+#include "simlib.h"
+#include "internal.h"
+#include "optimize.h"
+#include <algorithm>
+#include <cmath>
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+typedef std::vector<double> vec;
+
+//////////////////////////////////////////////////////////////////////////////
+// eigen decomposition of symmetric matrix C (n*n, by rows) by Jacobi
+// rotations: C = B*diag(d)*B'
+static void eigen(int n, const vec & C, vec & B, vec & d)
+{
+    vec a(C);
+    B.assign(n * n, 0.0);
+    for (int i = 0; i < n; i++)
+        B[i*n + i] = 1.0;
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = 0;
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                off += a[i*n + j] * a[i*n + j];
+        if (off < 1e-30)
+            break;
+        for (int p = 0; p < n; p++)
+            for (int q = p + 1; q < n; q++) {
+                double apq = a[p*n + q];
+                if (apq == 0.0)
+                    continue;
+                double theta = (a[q*n + q] - a[p*n + p]) / (2 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) /
+                           (std::fabs(theta) + std::sqrt(theta * theta + 1));
+                double c = 1 / std::sqrt(t * t + 1), s = t * c;
+                for (int k = 0; k < n; k++) {   // a = a*J
+                    double akp = a[k*n + p], akq = a[k*n + q];
+                    a[k*n + p] = c * akp - s * akq;
+                    a[k*n + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < n; k++) {   // a = J'*a
+                    double apk = a[p*n + k], aqk = a[q*n + k];
+                    a[p*n + k] = c * apk - s * aqk;
+                    a[q*n + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < n; k++) {   // B = B*J
+                    double bkp = B[k*n + p], bkq = B[k*n + q];
+                    B[k*n + p] = c * bkp - s * bkq;
+                    B[k*n + q] = s * bkp + c * bkq;
+                }
+            }
+    }
+    d.resize(n);
+    for (int i = 0; i < n; i++)
+        d[i] = (a[i*n + i] > 0) ? a[i*n + i] : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+double Optimize_cmaes(opt_function_t f, ParameterVector & p,
+                      double sigma, double epsilon, int itermax,
+                      unsigned lambda, unsigned threads)
+{
+    OptEvaluator e(f, threads);
+    return Optimize_cmaes(e, p, sigma, epsilon, itermax, lambda);
+}
+
+double Optimize_cmaes(OptEvaluator & f, ParameterVector & p,
+                      double sigma, double epsilon, int itermax,
+                      unsigned lambda)
+{
+    const int n = p.size();
+    if (lambda < 2)
+        lambda = 4 + int(3 * std::log(double(n)));
+    const int mu = lambda / 2;
+    vec w(mu);                          // recombination weights
+    double sw = 0, sw2 = 0;
+    for (int i = 0; i < mu; i++) {
+        w[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+        sw += w[i];
+    }
+    for (int i = 0; i < mu; i++) {
+        w[i] /= sw;
+        sw2 += w[i] * w[i];
+    }
+    const double mueff = 1 / sw2;
+    const double cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+    const double cs = (mueff + 2) / (n + mueff + 5);
+    const double c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff);
+    const double cmu = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) /
+                                        ((n + 2) * (n + 2) + mueff));
+    const double damps = 1 + cs +
+        2 * std::max(0.0, std::sqrt((mueff - 1) / (n + 1)) - 1);
+    const double chiN = std::sqrt(double(n)) *
+        (1 - 1.0 / (4 * n) + 1.0 / (21.0 * n * n));
+
+    // normalized coordinates
+    vec lo(n), range(n), m(n);
+    for (int i = 0; i < n; i++) {
+        lo[i] = p[i].Min();
+        range[i] = (p[i].Range() > 0) ? p[i].Range() : 1;
+        m[i] = (p[i] - lo[i]) / range[i];
+    }
+    vec C(n * n, 0.0), B, D, pc(n, 0.0), ps(n, 0.0);
+    for (int i = 0; i < n; i++)
+        C[i*n + i] = 1.0;
+    RandomStream rs(SIMLIB_RandomStreamSeed(0, 1));
+    std::vector<ParameterVector> x(lambda, p);
+    std::vector<vec> y(lambda, vec(n));
+    vec fx, z(n), old(n);
+    std::vector<int> order(lambda);
+    double fbest = f(p);
+    ParameterVector best(p);
+    for (int g = 0; g < itermax; g++) {
+        eigen(n, C, B, D);
+        for (int i = 0; i < n; i++)
+            D[i] = std::sqrt(D[i]);
+        if (sigma * *std::max_element(D.begin(), D.end()) < epsilon)
+            break;
+        // sample population: y = m + sigma*B*D*z
+        for (unsigned k = 0; k < lambda; k++) {
+            for (int i = 0; i < n; i++)
+                z[i] = D[i] * Normal(rs, 0, 1);
+            for (int i = 0; i < n; i++) {
+                double s = 0;
+                for (int j = 0; j < n; j++)
+                    s += B[i*n + j] * z[j];
+                x[k][i] = lo[i] + (m[i] + sigma * s) * range[i]; // limit
+                y[k][i] = (x[k][i] - lo[i]) / range[i];
+            }
+        }
+        f(x, fx);
+        for (unsigned k = 0; k < lambda; k++)
+            order[k] = k;
+        std::stable_sort(order.begin(), order.end(),
+                         [&fx](int a, int b) { return fx[a] < fx[b]; });
+        if (fx[order[0]] < fbest) {
+            fbest = fx[order[0]];
+            best = x[order[0]];
+        }
+        // new mean
+        old = m;
+        for (int i = 0; i < n; i++) {
+            m[i] = 0;
+            for (int k = 0; k < mu; k++)
+                m[i] += w[k] * y[order[k]][i];
+        }
+        // evolution paths (ps uses C^(-1/2)*(m-old))
+        for (int j = 0; j < n; j++) {
+            double s = 0;
+            for (int i = 0; i < n; i++)
+                s += B[i*n + j] * (m[i] - old[i]);
+            z[j] = (D[j] > 0) ? s / D[j] : 0;
+        }
+        double psn = 0;
+        for (int i = 0; i < n; i++) {
+            double s = 0;
+            for (int j = 0; j < n; j++)
+                s += B[i*n + j] * z[j];
+            ps[i] = (1 - cs) * ps[i] +
+                    std::sqrt(cs * (2 - cs) * mueff) * s / sigma;
+            psn += ps[i] * ps[i];
+        }
+        psn = std::sqrt(psn);
+        bool hsig = psn / std::sqrt(1 - std::pow(1 - cs, 2.0 * (g + 1))) /
+                    chiN < 1.4 + 2.0 / (n + 1);
+        for (int i = 0; i < n; i++)
+            pc[i] = (1 - cc) * pc[i] + (hsig ? 1 : 0) *
+                    std::sqrt(cc * (2 - cc) * mueff) * (m[i] - old[i]) / sigma;
+        // covariance matrix: rank-one and rank-mu update
+        double c1a = c1 * (hsig ? 0 : cc * (2 - cc));
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j <= i; j++) {
+                double r = 0;
+                for (int k = 0; k < mu; k++)
+                    r += w[k] * (y[order[k]][i] - old[i]) *
+                                (y[order[k]][j] - old[j]);
+                double c = (1 - c1 - cmu + c1a) * C[i*n + j] +
+                           c1 * pc[i] * pc[j] + cmu * r / (sigma * sigma);
+                C[i*n + j] = C[j*n + i] = c;
+            }
+        sigma *= std::exp((cs / damps) * (psn / chiN - 1));
+    }
+    p = best;                   // copy result
+    return fbest;
+}
+
+}
+// end
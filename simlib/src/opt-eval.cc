@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file opt-eval.cc  Optimization - evaluation of function (cache, threads)
+//
+// Copyright (c) 2000-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+// EXPERIMENTAL
+// evaluator of function to optimize: cache of values, batch of points
+// evaluated in parallel threads (each with own simulation context)
+
+#include "simlib.h"
+#include "internal.h"
+#include "optimize.h"
+#include <atomic>
+#include <thread>
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+//////////////////////////////////////////////////////////////////////////////
+// key of cache: values of parameters
+static std::vector<double> key(const ParameterVector & p)
+{
+    std::vector<double> k(p.size());
+    for (int i = 0; i < p.size(); i++)
+        k[i] = p[i].Value();
+    return k;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// batch of points evaluated by worker threads
+struct OptEvaluator::Batch {
+    OptEvaluator & e;
+    const std::vector<ParameterVector> & p;
+    std::vector<double> & value;
+    const std::vector<unsigned> & todo;  // indexes of points to evaluate
+    std::atomic<unsigned> next;          // next item of todo
+    Batch(OptEvaluator & ev, const std::vector<ParameterVector> & pv,
+          std::vector<double> & v, const std::vector<unsigned> & t):
+        e(ev), p(pv), value(v), todo(t), next(0) {}
+    void Worker() {
+        for (;;) {
+            unsigned k = next++;
+            if (k >= todo.size())
+                break;
+            value[todo[k]] = e.Eval(p[todo[k]]);
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// constructor
+// @param fun       function to optimize
+// @param n         number of threads (1 = calling thread,
+//                  0 = number of processors)
+// @param c         use cache of values
+// @param r         common random numbers (reseed before each evaluation)
+OptEvaluator::OptEvaluator(opt_function_t fun, unsigned n, bool c, bool r):
+    f(fun), threads(n), use_cache(c), crn(r),
+    seed(SIMLIB_RandomStreamSeed(0, 1)),
+    cache(), evaluations(0), hits(0)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// state of random generator of calling thread is not changed by evaluation
+// with common random numbers
+namespace {
+struct SavedSeed {
+    bool saved;
+    long seed;
+    SavedSeed(bool crn):
+        saved(crn), seed(crn ? SIMLIB_RandomStreamSeed(0, 1) : 0) {}
+    ~SavedSeed() { if (saved) RandomSeed(seed); }
+};
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// single evaluation of f: each one starts with the same random seed
+// (common random numbers: values do not depend on order or thread),
+// random generator of calling thread is restored by caller (SavedSeed)
+double OptEvaluator::Eval(const ParameterVector & p) const
+{
+    if (crn)
+        RandomSeed(seed);
+    return f(p);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// value at single point (in calling thread)
+double OptEvaluator::operator() (const ParameterVector & p)
+{
+    if (!use_cache) {
+        SavedSeed s(crn);
+        evaluations++;
+        return Eval(p);
+    }
+    std::vector<double> k = key(p);
+    std::map<std::vector<double>, double>::const_iterator i = cache.find(k);
+    if (i != cache.end()) {
+        hits++;
+        return i->second;
+    }
+    double v;
+    {
+        SavedSeed s(crn);
+        v = Eval(p);
+    }
+    evaluations++;
+    cache[k] = v;
+    return v;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// values at all points (cached values and duplicates are not evaluated)
+void OptEvaluator::operator() (const std::vector<ParameterVector> & p,
+                               std::vector<double> & value)
+{
+    const unsigned n = p.size();
+    value.assign(n, 0.0);
+    std::vector<unsigned> todo;         // points to evaluate
+    std::vector<int> same(n, -1);       // duplicate of point in todo
+    std::map<std::vector<double>, unsigned> batch;
+    for (unsigned i = 0; i < n; i++) {
+        std::vector<double> k = key(p[i]);
+        std::map<std::vector<double>, double>::const_iterator c;
+        std::map<std::vector<double>, unsigned>::const_iterator b;
+        if (use_cache && (c = cache.find(k)) != cache.end()) {
+            value[i] = c->second;
+            hits++;
+        } else if ((b = batch.find(k)) != batch.end()) {
+            same[i] = b->second;
+            hits++;
+        } else {
+            batch[k] = i;
+            todo.push_back(i);
+        }
+    }
+    Dprintf(("OptEvaluator: %u points, %u evaluations", n,
+             (unsigned)todo.size()));
+    if (threads <= 1 || todo.size() <= 1) {
+        SavedSeed s(crn);
+        for (unsigned k = 0; k < todo.size(); k++)
+            value[todo[k]] = Eval(p[todo[k]]);
+    } else {
+        if (SIMLIB_Phase == SIMULATION)
+            SIMLIB_error(OptEvaluatorError);
+        Batch w(*this, p, value, todo);
+        unsigned T = (threads < todo.size()) ? threads : todo.size();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < T; t++)
+            workers.push_back(std::thread(&Batch::Worker, &w));
+        for (unsigned t = 0; t < T; t++)
+            workers[t].join();
+    }
+    evaluations += todo.size();
+    for (unsigned i = 0; i < n; i++)
+        if (same[i] >= 0)
+            value[i] = value[same[i]];
+    if (use_cache)
+        for (unsigned k = 0; k < todo.size(); k++)
+            cache[key(p[todo[k]])] = value[todo[k]];
+}
+
+}
+// end
@@ -26,7 +26,7 @@ SIMLIB_IMPLEMENTATION;
 // optimization method
 //
 // look for a better minimum, change one coord at a time
-static double hooke_step(double *delta, opt_function_t f, ParameterVector & p,
+static double hooke_step(double *delta, OptEvaluator & f, ParameterVector & p,
                          double min0)
 {
     int n = p.size();
@@ -52,10 +52,73 @@ static double hooke_step(double *delta, opt_function_t f, ParameterVector & p,
     return fmin;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// parallel version of hooke_step: all +-delta probes are evaluated at once,
+// then all improving moves are combined (if it is better than the best
+// single move)
+static double hooke_step_parallel(double *delta, OptEvaluator & f,
+                                  ParameterVector & p, double min0)
+{
+    int n = p.size();
+    std::vector<ParameterVector> probe;
+    std::vector<int> index;     // probe = index[i/2] +- delta
+    for (int i = 0; i < n; i++) {
+        if (delta[i] == 0.0)
+            continue;           // ignore zero delta
+        for (int k = 0; k < 2; k++) {
+            probe.push_back(p);
+            probe.back()[i] = p[i] + (k ? -delta[i] : delta[i]);
+        }
+        index.push_back(i);
+    }
+    std::vector<double> value;
+    f(probe, value);
+    ParameterVector all(p);     // all improving moves
+    double fbest = min0;        // the best single move
+    int best = -1;
+    int moves = 0;
+    for (unsigned j = 0; j < index.size(); j++) {
+        int i = index[j];
+        int k = (value[2*j + 1] < value[2*j]) ? 1 : 0;
+        double ftmp = value[2*j + k];
+        if (probe[2*j + k][i] == p[i] || ftmp >= min0) {
+            delta[i] = -delta[i];       // as hooke_step: opposite direction
+            continue;
+        }
+        if (k)
+            delta[i] = -delta[i];
+        all[i] = probe[2*j + k][i];
+        moves++;
+        if (ftmp < fbest) {
+            fbest = ftmp;
+            best = 2*j + k;
+        }
+    }
+    if (best < 0)
+        return min0;            // no change
+    if (moves > 1) {
+        double fall = f(all);
+        if (fall < fbest) {
+            p = all;
+            return fall;
+        }
+    }
+    p = probe[best];
+    return fbest;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 double Optimize_hooke(opt_function_t f, ParameterVector & parameter,
                       double rho, double epsilon, int itermax)
+{
+    OptEvaluator e(f, 1, false, false); // calling thread, no cache,
+                                        // random numbers not reseeded
+    return Optimize_hooke(e, parameter, rho, epsilon, itermax);
+}
+
+double Optimize_hooke(OptEvaluator & f, ParameterVector & parameter,
+                      double rho, double epsilon, int itermax)
 {
 // assert(rho>0.01 && rho <1.0);
 // assert(epsilon>1e-12 && epsilon < rho);  // 1e-12 > 100*DBL_EPS
@@ -75,10 +138,12 @@ double Optimize_hooke(opt_function_t f, ParameterVector & parameter,
     Print("%g\n", newf);
 #endif
     double oldf = newf;
+    double (*step)(double *, OptEvaluator &, ParameterVector &, double) =
+        (f.Threads() > 1) ? hooke_step_parallel : hooke_step;
     while (iteration < itermax && steplength > epsilon) {
         iteration++;
         newx = oldx;
-        newf = hooke_step(delta, f, newx, oldf);
+        newf = step(delta, f, newx, oldf);
         // if we made some improvements, continue that direction
         while (newf < oldf) {
 #if debug
@@ -94,7 +159,7 @@ double Optimize_hooke(opt_function_t f, ParameterVector & parameter,
                 newx[i] = newx[i] + dxi;
             }
             oldf = newf;
-            newf = hooke_step(delta, f, newx, oldf);
+            newf = step(delta, f, newx, oldf);
             /* if the further (optimistic) move was bad.... */
             if (newf >= oldf)   // worse
                 break;          ///////////////////// break
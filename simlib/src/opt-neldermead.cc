@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file opt-neldermead.cc  Optimization algorithm - Nelder-Mead simplex
+//
+// Copyright (c) 2000-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+// EXPERIMENTAL
+// Nelder-Mead simplex method, vertices are evaluated in parallel:
+//  - initial simplex and shrink step (n vertices)
+//  - reflection, expansion and both contractions of each step are
+//    evaluated at once if more threads are available (speculatively)
+
+#include "simlib.h"
+#include "internal.h"
+#include "optimize.h"
+#include <algorithm>
+#include <cmath>
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+//////////////////////////////////////////////////////////////////////////////
+// simplex: n+1 vertices, values sorted by order
+//
+namespace {
+struct Simplex {
+    std::vector<ParameterVector> x;     // vertices
+    std::vector<double> fx;             // values
+    void Sort();                        // the best vertex first
+    double Size() const;                // max. distance from the best vertex
+};
+
+void Simplex::Sort()
+{
+    // insertion sort (n is small)
+    for (unsigned i = 1; i < x.size(); i++)
+        for (unsigned j = i; j > 0 && fx[j] < fx[j-1]; j--) {
+            std::swap(fx[j], fx[j-1]);
+            ParameterVector t(x[j]);
+            x[j] = x[j-1];
+            x[j-1] = t;
+        }
+}
+
+double Simplex::Size() const
+{
+    double size = 0;
+    for (unsigned j = 1; j < x.size(); j++)
+        for (int i = 0; i < x[0].size(); i++) {
+            double r = x[0][i].Range();
+            double d = (r > 0) ? std::fabs(x[j][i] - x[0][i]) / r : 0;
+            if (d > size)
+                size = d;
+        }
+    return size;
+}
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// point c + t*(c - w), limited by parameter ranges
+static void move_point(ParameterVector & p, const std::vector<double> & c,
+                       const ParameterVector & w, double t)
+{
+    for (int i = 0; i < p.size(); i++)
+        p[i] = c[i] + t * (c[i] - w[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+double Optimize_neldermead(opt_function_t f, ParameterVector & p,
+                           double size, double epsilon, int itermax,
+                           unsigned threads)
+{
+    OptEvaluator e(f, threads);
+    return Optimize_neldermead(e, p, size, epsilon, itermax);
+}
+
+double Optimize_neldermead(OptEvaluator & f, ParameterVector & p,
+                           double size, double epsilon, int itermax)
+{
+    const int n = p.size();
+    const double alpha = 1, gamma = 2, rho = 0.5, sigma = 0.5;
+    Simplex s;
+    // initial simplex: p and p+size*range in each axis
+    s.x.assign(n + 1, p);
+    for (int i = 0; i < n; i++) {
+        double d = size * p[i].Range();
+        double old = p[i];
+        s.x[i+1][i] = old + d;
+        if (s.x[i+1][i] == old)         // at upper limit
+            s.x[i+1][i] = old - d;
+    }
+    f(s.x, s.fx);
+    s.Sort();
+
+    // candidates: reflection, expansion, outside and inside contraction
+    const double t[4] = { alpha, alpha * gamma, alpha * rho, -rho };
+    std::vector<ParameterVector> cand(4, p);
+    std::vector<double> fc(4);
+    bool done[4];
+    std::vector<double> c(n);           // centroid
+    for (int iteration = 0; iteration < itermax; iteration++) {
+        if (s.Size() < epsilon)
+            break;
+        const ParameterVector & w = s.x[n];     // the worst vertex
+        for (int i = 0; i < n; i++) {
+            c[i] = 0;
+            for (int j = 0; j < n; j++)
+                c[i] += s.x[j][i];
+            c[i] /= n;
+        }
+        for (int k = 0; k < 4; k++) {
+            move_point(cand[k], c, w, t[k]);
+            done[k] = false;
+        }
+        if (f.Threads() > 1) {          // all candidates at once
+            f(cand, fc);
+            for (int k = 0; k < 4; k++)
+                done[k] = true;
+        }
+#define VALUE(k) (done[k] ? fc[k] : (done[k] = true, fc[k] = f(cand[k])))
+        int accept = -1;                // accepted candidate
+        double fr = VALUE(0);
+        if (fr < s.fx[0])
+            accept = (VALUE(1) < fr) ? 1 : 0;
+        else if (fr < s.fx[n-1])
+            accept = 0;
+        else if (fr < s.fx[n]) {
+            if (VALUE(2) <= fr)
+                accept = 2;
+        } else if (VALUE(3) < s.fx[n])
+            accept = 3;
+#undef VALUE
+        if (accept >= 0) {
+            s.x[n] = cand[accept];
+            s.fx[n] = fc[accept];
+        } else {                        // shrink to the best vertex
+            std::vector<ParameterVector> v(s.x.begin() + 1, s.x.end());
+            std::vector<double> fv;
+            for (int j = 0; j < n; j++)
+                for (int i = 0; i < n; i++)
+                    v[j][i] = s.x[0][i] + sigma * (v[j][i] - s.x[0][i]);
+            f(v, fv);
+            for (int j = 0; j < n; j++) {
+                s.x[j+1] = v[j];
+                s.fx[j+1] = fv[j];
+            }
+        }
+        s.Sort();
+    }
+    p = s.x[0];                 // copy result
+    return s.fx[0];
+}
+
+}
+// end
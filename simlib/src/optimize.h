@@ -12,6 +12,9 @@
 #ifndef __SIMLIB_OPTIMIZE_H
 #define __SIMLIB_OPTIMIZE_H
 
+#include <map>
+#include <vector>
+
 namespace simlib3 {
 
 class Param
@@ -82,9 +85,76 @@ class ParameterVector
 // Type of function to optimize
 typedef double (*opt_function_t) (const ParameterVector & p);
 
+////////////////////////////////////////////////////////////////////////////
+// evaluator of function to optimize
+//  - values are cached (key = values of parameters)
+//  - batch of points is evaluated in parallel threads; each thread has
+//    its own simulation context (see class Simulation), so function f
+//    should create its model (like init of RunReplications)
+//  - threads==1 (default): all evaluations in calling thread (global
+//    model is O.K.), parallel evaluation must be requested explicitly
+//  - crn==true (default): each evaluation starts with the same random
+//    seed (seed at creation of evaluator, common random numbers), values
+//    do not depend on number of threads; random generator of calling
+//    thread is restored after evaluation. Only the default generator
+//    is reseeded, generator set by SetBaseRandomGenerator is not.
+//  - crn==false: random numbers continue between evaluations (values of
+//    stochastic f depend on order of evaluations)
+//
+class OptEvaluator
+{
+    OptEvaluator(const OptEvaluator &);                 // disable
+    OptEvaluator & operator = (const OptEvaluator &);   // disable
+    opt_function_t f;
+    unsigned threads;           // number of threads (1 = calling thread)
+    bool use_cache;
+    bool crn;                   // common random numbers (reseed)
+    long seed;                  // random seed of each evaluation
+    std::map<std::vector<double>, double> cache;
+    unsigned long evaluations;  // number of calls of f
+    unsigned long hits;         // number of values found in cache
+    struct Batch;               // parallel evaluation (see opt-eval.cc)
+    double Eval(const ParameterVector & p) const;   // reseed, call f
+  public:
+    explicit OptEvaluator(opt_function_t f, unsigned threads=1,
+                          bool cache=true, bool crn=true);
+    // value at single point (in calling thread)
+    double operator() (const ParameterVector & p);
+    // values at all points (in parallel)
+    void operator() (const std::vector<ParameterVector> & p,
+                     std::vector<double> & value);
+    unsigned Threads() const { return threads; }
+    unsigned long Evaluations() const { return evaluations; }
+    unsigned long Hits() const { return hits; }
+    void ClearCache() { cache.clear(); }
+};
+
 // Predefined optimization methods
+// Hooke-Jeeves: serial evaluation, random numbers are not reseeded
 double Optimize_hooke(opt_function_t f, ParameterVector & p,
                       double rho, double epsilon, int itermax);
+// Hooke-Jeeves: all +-delta probes of a step are evaluated in parallel
+// if f.Threads()>1
+double Optimize_hooke(OptEvaluator & f, ParameterVector & p,
+                      double rho, double epsilon, int itermax);
+
+// Nelder-Mead simplex: size = initial edge (fraction of parameter range),
+// all candidate vertices of a step are evaluated in parallel if threads>1
+double Optimize_neldermead(opt_function_t f, ParameterVector & p,
+                           double size, double epsilon, int itermax,
+                           unsigned threads=1);
+double Optimize_neldermead(OptEvaluator & f, ParameterVector & p,
+                           double size, double epsilon, int itermax);
+
+// CMA-ES: sigma = initial step (fraction of parameter range),
+// lambda = population size (0 = default 4+3*ln(n)), population is
+// evaluated in parallel if threads>1
+double Optimize_cmaes(opt_function_t f, ParameterVector & p,
+                      double sigma, double epsilon, int itermax,
+                      unsigned lambda=0, unsigned threads=1);
+double Optimize_cmaes(OptEvaluator & f, ParameterVector & p,
+                      double sigma, double epsilon, int itermax,
+                      unsigned lambda=0);
 
 double Optimize_simann(opt_function_t f, ParameterVector & p, int MAXT);
 
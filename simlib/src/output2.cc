@@ -104,6 +104,41 @@ void Histogram::Output() const
   Print("\n");
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  LogHistogram::Output --- nonempty intervals and percentiles
+//
+void LogHistogram::Output() const
+{
+  Print("+----------------------------------------------------------+\n");
+  Print("| HISTOGRAM %-46s |\n",Name());
+  stat.Output();
+  unsigned long sum = stat.Number();
+  if (sum==0) return;
+  Print("|    from    |     to     |     n    |   rel    |   sum    |\n");
+  Print("+------------+------------+----------+----------+----------+\n");
+  unsigned long s = 0;
+  for (unsigned i=0; i<=count+1; i++)
+  {
+    unsigned long x = dptr[i];
+    if (x==0) continue;
+    s += x;
+    char from[20], to[20];
+    if (i==0) sprintf(from, "%10s", "-inf");
+    else      sprintf(from, "%10.4g", From(i));
+    if (i>count) sprintf(to, "%10s", "inf");
+    else         sprintf(to, "%10.4g", From(i+1));
+    Print("| %s | %s | %8lu | %8.6f | %8.6f |\n",
+            from, to, x, (double)x/sum, (double)s/sum);
+  }
+  Print("+------------+------------+----------+----------+----------+\n");
+  static const double p[] = { 50, 90, 99, 99.9 };
+  for (unsigned i=0; i<sizeof(p)/sizeof(p[0]); i++)
+    Print("|  Percentile %-5g = %-25g             |\n",
+          p[i], Percentile(p[i]));
+  Print("+----------------------------------------------------------+\n");
+  Print("\n");
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Process::Output
 //
@@ -113,13 +148,14 @@ void Process::Output() const
 }
 
 ////////////////////////////////////////////////////////////////////////////
-//  Queue::Output
+//  QueueOutput --- print statistics of queue (Queue, RingQueue)
 //
-void Queue::Output() const
+static void QueueOutput(const char *name, const TStat &StatN,
+                        const Stat &StatDT, unsigned long length)
 {
   char s[100];
   Print("+----------------------------------------------------------+\n");
-  Print("| QUEUE %-39s %10s |\n", Name(), StatN.Number()?"":"not used");
+  Print("| QUEUE %-39s %10s |\n", name, StatN.Number()?"":"not used");
   if (StatN.Number() > 0)
   {
     Print("+----------------------------------------------------------+\n");
@@ -127,7 +163,7 @@ void Queue::Output() const
     Print(  "| %-56s |\n", s);
     Print(  "|  Incoming  %-26ld                    |\n", StatN.Number());
     Print(  "|  Outcoming  %-26ld                   |\n", StatDT.Number());
-    Print(  "|  Current length = %-26lu             |\n", size());
+    Print(  "|  Current length = %-26lu             |\n", length);
     Print(  "|  Maximal length = %-25g              |\n", StatN.Max());
     double dt = double(Time) - StatN.StartTime();
     if(dt>0)
@@ -147,6 +183,14 @@ void Queue::Output() const
     }
   }
   Print("+----------------------------------------------------------+\n");
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Queue::Output
+//
+void Queue::Output() const
+{
+  QueueOutput(Name(), StatN, StatDT, size());
 #ifdef XXX_PRINT_QUEUE_
   // only for debug
   {
@@ -162,6 +206,14 @@ void Queue::Output() const
 #endif
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  RingQueue::Output
+//
+void RingQueue::Output() const
+{
+  QueueOutput(Name(), StatN, StatDT, size());
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Stat::Output
 //
@@ -183,6 +235,35 @@ void Stat::Output() const
   Print("+----------------------------------------------------------+\n");
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  BatchStat::Output
+//
+void BatchStat::Output() const
+{
+  Print("+----------------------------------------------------------+\n");
+  Print("| STATISTIC %-46s |\n",Name());
+  Print("+----------------------------------------------------------+\n");
+  if (n==0)
+    Print("|  no record                                               |\n");
+  else
+  {
+    char s[100];
+    Print(  "|  Min = %-15g         Max = %-15g     |\n", min, max);
+    Print(  "|  Number of records = %-26ld          |\n", n);
+    Print(  "|  Average value = %-25g               |\n", MeanValue());
+    if (n>99)
+      Print("|  Standard deviation = %-25g          |\n", StdDev());
+    sprintf(s," Batches = %u (size %lu) ", nb, bsize);
+    Print(  "| %-56s |\n", s);
+    if (nb>1) {
+      sprintf(s," 95%% confidence interval = %g +- %g ",
+                MeanValue(), ConfidenceInterval(0.95));
+      Print("| %-56s |\n", s);
+    }
+  }
+  Print("+----------------------------------------------------------+\n");
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Store::Output
 //
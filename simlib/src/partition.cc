@@ -0,0 +1,291 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file partition.cc  Conservative parallel simulation of partitioned model
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+// description: RunPartitions --- each partition of the model runs in its
+//              own thread with its own calendar, partitions communicate
+//              by messages sent through channels with constant delay.
+//
+//              Synchronization uses time windows: at the start of each
+//              window all partitions exchange messages and compute global
+//              minimum M of next-event times. Window ends at M+L, where L
+//              (lookahead) is minimal channel delay, so no message sent
+//              in the window can arrive before its end.
+//              Partitions with continuous blocks can create events at any
+//              time --- their next-event time is the current Time.
+//
+
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+////////////////////////////////////////////////////////////////////////////
+
+#include "simlib.h"
+#include "internal.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+////////////////////////////////////////////////////////////////////////////
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////
+/// message in transit
+struct Message {
+    double time;                // time of delivery
+    unsigned channel;           // channel number
+    unsigned long seq;          // sequence number in channel
+    Channel *ch;
+    double value;
+    bool operator < (const Message &m) const { // deterministic order
+        if(time != m.time) return time < m.time;
+        if(channel != m.channel) return channel < m.channel;
+        return seq < m.seq;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// barrier for partition threads, computes minimum of arguments
+/// (partition which ends simulation run leaves the barrier)
+class WindowBarrier {
+    std::mutex m;
+    std::condition_variable cv;
+    unsigned count;             // number of participants
+    unsigned waiting;           // number of waiting threads
+    unsigned long generation;
+    double min;                 // minimum of current generation
+    double result;              // minimum of last generation
+    void Release() {            // all participants are waiting
+        result = min;
+        min = SIMLIB_MAXTIME;
+        waiting = 0;
+        generation++;
+        cv.notify_all();
+    }
+  public:
+    WindowBarrier(): count(0), waiting(0), generation(0),
+                     min(SIMLIB_MAXTIME), result(SIMLIB_MAXTIME) {}
+    void Start(unsigned n) { count = n; }
+    double Wait(double x = SIMLIB_MAXTIME) {
+        std::unique_lock<std::mutex> lock(m);
+        unsigned long gen = generation;
+        if(x < min) min = x;
+        if(++waiting == count)
+            Release();
+        else
+            cv.wait(lock, [&]{ return gen != generation; });
+        return result;
+    }
+    void Leave() {
+        std::lock_guard<std::mutex> lock(m);
+        count--;
+        if(waiting > 0 && waiting == count)
+            Release();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// module variables (set in main thread before start of partition threads)
+std::vector<Partition*> partitions;     // all partitions
+std::vector<Channel*> channels;         // all channels
+double lookahead = SIMLIB_MAXTIME;      // minimal delay of channels
+double start_time, end_time;            // parameters of RunPartitions
+WindowBarrier barrier;
+std::mutex collect_mutex;               // serialize collect() calls
+
+thread_local Partition *current_partition = 0; // partition of thread
+
+////////////////////////////////////////////////////////////////////////////
+/// delivery of message in destination partition
+class Delivery : public Event {
+    void (*receive)(double);
+    double value;
+  public:
+    Delivery(void (*f)(double), double x) : receive(f), value(x) {}
+    void Behavior() { receive(value); }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////
+/// incoming messages of partition (written by other partition threads)
+struct Partition::Inbox {
+    std::mutex m;
+    std::vector<Message> messages;
+    bool finished;              // simulation run ended (no delivery)
+    Inbox(): finished(false) {}
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// synchronization at the start of time window
+/// (highest priority: runs before all other events at the same time)
+class SIMLIB_Synchronizer : public Event {
+    Partition *p;
+  public:
+    SIMLIB_Synchronizer(Partition *P) : Event(HIGHEST_PRIORITY), p(P) {}
+    void Behavior();
+};
+
+void SIMLIB_Synchronizer::Behavior()
+{
+    barrier.Wait();             // all messages sent before Time are in inboxes
+    p->Deliver();
+    double next = NextTime;
+    if(IntegratorContainer::isAny() || StatusContainer::isAny())
+        next = Time;            // continuous part: event at any time
+    double bound = barrier.Wait(next) + lookahead;
+    Dprintf(("Partition#%u: window [%g,%g)", p->number, Time, bound));
+    if(bound < EndTime)
+        Activate(bound);        // start of next window
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// constructor
+Partition::Partition(void (*i)(), void (*c)()):
+    inbox(new Inbox), init(i), collect(c), number(partitions.size())
+{
+    Dprintf(("Partition::Partition()#%u", number));
+    partitions.push_back(this);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// destructor
+Partition::~Partition()
+{
+    Dprintf(("Partition::~Partition()#%u", number));
+    partitions.erase(std::find(partitions.begin(), partitions.end(), this));
+    delete inbox;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// partition of the calling thread
+Partition *Partition::Current()
+{
+    return current_partition;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// schedule received messages (in deterministic order)
+void Partition::Deliver()
+{
+    std::vector<Message> msg;
+    {
+        std::lock_guard<std::mutex> lock(inbox->m);
+        msg.swap(inbox->messages);
+    }
+    std::sort(msg.begin(), msg.end());
+    for(unsigned i=0; i<msg.size(); i++)
+        if(msg[i].time <= EndTime)
+            (new Delivery(msg[i].ch->receive, msg[i].value))
+                ->Activate(msg[i].time);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// thread of single partition
+void Partition::Thread(Partition *p, long seed)
+{
+    current_partition = p;
+    RandomSeed(seed);           // independent random stream
+    Init(start_time, end_time);
+    if(p->init)
+        p->init();              // create submodel
+    if(lookahead < SIMLIB_MAXTIME)
+        (new SIMLIB_Synchronizer(p))->Activate(start_time);
+    Run();
+    {
+        std::lock_guard<std::mutex> lock(p->inbox->m);
+        p->inbox->finished = true;
+        p->inbox->messages.clear();
+    }
+    barrier.Leave();            // Stop() in partition
+    if(p->collect) {
+        std::lock_guard<std::mutex> lock(collect_mutex);
+        p->collect();
+    }
+    current_partition = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// constructor
+Channel::Channel(Partition &f, Partition &t, double d, void (*r)(double)):
+    from(f), to(t), delay(d), receive(r), number(channels.size()), sent(0)
+{
+    Dprintf(("Channel::Channel(#%u->#%u, %g)#%u",
+             f.number, t.number, d, number));
+    if(!(d > 0))
+        SIMLIB_error(ChannelDelayError);
+    channels.push_back(this);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// destructor
+Channel::~Channel()
+{
+    Dprintf(("Channel::~Channel()#%u", number));
+    channels.erase(std::find(channels.begin(), channels.end(), this));
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// send value, it will be received at Time+delay in destination partition
+void Channel::Send(double value)
+{
+    if(current_partition != &from)
+        SIMLIB_error(ChannelSendError);
+    Message m = { Time + delay, number, sent++, this, value };
+    std::lock_guard<std::mutex> lock(to.inbox->m);
+    if(!to.inbox->finished)
+        to.inbox->messages.push_back(m);
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  RunPartitions --- conservative parallel simulation of all partitions
+//
+void RunPartitions(double t0, double t1)
+{
+    Dprintf(("RunPartitions(%g, %g)", t0, t1));
+    if(SIMLIB_Phase == SIMULATION || current_partition)
+        SIMLIB_error(PartitionsError);
+    const unsigned n = partitions.size();
+    if(n == 0)
+        return;
+    start_time = t0;
+    end_time = t1;
+    lookahead = SIMLIB_MAXTIME;
+    for(unsigned i=0; i<channels.size(); i++) {
+        channels[i]->number = i;
+        channels[i]->sent = 0;
+        lookahead = std::min(lookahead, channels[i]->delay);
+    }
+    barrier.Start(n);
+
+    std::vector<std::thread> threads;
+    for(unsigned i=0; i<n; i++) {
+        Partition *p = partitions[i];
+        p->number = i;
+        p->inbox->finished = false;
+        threads.push_back(std::thread(Partition::Thread, p,
+                                      SIMLIB_RandomStreamSeed(i, n)));
+    }
+    for(unsigned i=0; i<n; i++)
+        threads[i].join();
+}
+
+} // namespace
+
+// end
@@ -125,12 +125,13 @@ struct P_Context_t {
 
 ////////////////////////////////////////////////////////////////////////////
 // global variables (should be volatile)
-static jmp_buf P_DispatcherStatusBuffer; //!< setjmp() state before dispatch
-static char *volatile P_StackBase = 0;   //!< global start of stack area
-static char *volatile P_StackBase2 = 0;  //!< for checking start of stack
+// thread-local: each thread dispatches processes of its own simulation
+static thread_local jmp_buf P_DispatcherStatusBuffer; //!< setjmp() state before dispatch
+static thread_local char *volatile P_StackBase = 0;   //!< global start of stack area
+static thread_local char *volatile P_StackBase2 = 0;  //!< for checking start of stack
 
-static P_Context_t *volatile P_Context = 0; //!< temporary global process state
-static volatile size_t P_StackSize = 0;     //!< temporary global stack size
+static thread_local P_Context_t *volatile P_Context = 0; //!< temporary global process state
+static thread_local volatile size_t P_StackSize = 0;     //!< temporary global stack size
 
 ////////////////////////////////////////////////////////////////////////////
 // Support for THREADS implementation debugging:
@@ -239,6 +240,7 @@ static void FREE_CONTEXT() {
 Process::Process(Priority_t p) : Entity(p) {
   Dprintf(("Process::Process(%d)", p));
   _wait_until = false;
+  _wait_on = 0;                 // not waiting in WaitUntilOn
   _context = 0;                 // pointer to process context
   _status = _PREPARED;          // prepared for running
 }
@@ -264,6 +266,7 @@ Process::~Process()
         //SIMLIB_warning("Process in Wait-Until destructed");
         _WaitUntilRemove();     // Remove from wait-until list
     }
+    _WaitOnRemove(true);        // Remove from all signals (WaitUntilOn)
 
     if (Where() != 0) {         // if waiting in queue
         //SIMLIB_warning("Process waiting in queue destructed");
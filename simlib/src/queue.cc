@@ -22,16 +22,112 @@ namespace simlib3 {
 
 SIMLIB_IMPLEMENTATION;
 
+////////////////////////////////////////////////////////////////////////////
+/// priority buckets of queue --- O(1) priority insert
+///
+/// Items are sorted by key (higher key first, FIFO for equal keys).
+/// Index contains last item (tail) of each nonempty bucket and two-level
+/// bitmap of nonempty buckets: new item with key k is inserted after the
+/// tail of the smallest nonempty bucket >= k.
+/// Keys:  Insert()      --- Priority
+///        ServiceIns()  --- service priority, Priority (see Facility)
+/// Other insert operations (InsFirst, PredIns, ...) and mixed keys switch
+/// the index off until the queue is empty (linear search is used then).
+/// WARNING: change of Priority of entity in queue is ignored by index.
+struct Queue::Index {
+    enum { UNUSED, PRIORITY, SERVICE, OFF };
+    int mode;
+    struct Level {
+        unsigned long long bits[4];     // nonempty buckets
+        Entity *tail[256];              // last item of each bucket
+        Level() { bits[0] = bits[1] = bits[2] = bits[3] = 0; }
+    };
+    unsigned long long top[4];          // nonempty levels (key>>8)
+    Level *level[256];                  // allocated at first use
+
+    Index(): mode(UNUSED) {
+        top[0] = top[1] = top[2] = top[3] = 0;
+        for(unsigned i=0; i<256; i++)
+            level[i] = 0;
+    }
+    ~Index() {
+        for(unsigned i=0; i<256; i++)
+            delete level[i];
+    }
+    bool Active() const { return mode == PRIORITY || mode == SERVICE; }
+
+    // first set bit >= i, or -1
+    static int Next(const unsigned long long *bits, unsigned i) {
+        for(unsigned w = i>>6; w < 4; w++, i = w<<6) {
+            unsigned long long x = bits[w] & (~0ULL << (i & 63));
+            if(x)
+                return (w<<6) + __builtin_ctzll(x);
+        }
+        return -1;
+    }
+    static void Set(unsigned long long *bits, unsigned i) {
+        bits[i>>6] |= 1ULL << (i & 63);
+    }
+    static void Reset(unsigned long long *bits, unsigned i) {
+        bits[i>>6] &= ~(1ULL << (i & 63));
+    }
+
+    // last item with key >= k (0 if there is no such item)
+    Entity *Pred(unsigned k) const {
+        Level *l = level[k>>8];
+        if(l) {
+            int i = Next(l->bits, k & 255);
+            if(i >= 0)
+                return l->tail[i];
+        }
+        int L = Next(top, (k>>8) + 1);
+        if(L < 0)
+            return 0;
+        l = level[L];
+        return l->tail[Next(l->bits, 0)];
+    }
+    // e is new tail of bucket k
+    void Add(Entity *e, unsigned k) {
+        Level *&l = level[k>>8];
+        if(!l)
+            l = new Level;
+        l->tail[k & 255] = e;
+        Set(l->bits, k & 255);
+        Set(top, k>>8);
+    }
+    // e is removed, pred is previous item in the same bucket (or 0)
+    void Remove(Entity *e, unsigned k, Entity *pred) {
+        Level *l = level[k>>8];
+        if(l->tail[k & 255] != e)
+            return;                     // not last in bucket
+        if(pred) {
+            l->tail[k & 255] = pred;
+            return;
+        }
+        Reset(l->bits, k & 255);        // empty bucket
+        if(Next(l->bits, 0) < 0)
+            Reset(top, k>>8);
+    }
+    // clear all buckets (used for empty queue)
+    void Clear() {
+        top[0] = top[1] = top[2] = top[3] = 0;
+        for(unsigned i=0; i<256; i++)
+            if(level[i])
+                level[i]->bits[0] = level[i]->bits[1] =
+                level[i]->bits[2] = level[i]->bits[3] = 0;
+    }
+};
+
 
 ////////////////////////////////////////////////////////////////////////////
 //  constructors
 //
-Queue::Queue()
+Queue::Queue() : index(0)
 {
   Dprintf(("Queue{%p}::Queue()", this));
 }
 
-Queue::Queue(const char *name)
+Queue::Queue(const char *name) : index(0)
 {
   Dprintf(("Queue{%p}::Queue(\"%s\")", this, name));
   SetName(name);
@@ -42,6 +138,34 @@ Queue::Queue(const char *name)
 //
 Queue::~Queue() {
   Dprintf(("Queue{%p}::~Queue() // \"%s\" ", this, Name()));
+  delete index;
+  index = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// IndexIns --- O(1) insert by key, fails if the index can't be used
+//
+bool Queue::IndexIns(Entity *ent, unsigned key, int mode)
+{
+  if(!index)
+      index = new Index;
+  if(empty()) {                 // start new sorted sequence
+      if(index->mode == Index::OFF)
+          index->Clear();
+      index->mode = mode;
+  }
+  if(index->mode != mode) {     // unsorted or sorted by other key
+      index->mode = Index::OFF;
+      return false;
+  }
+  Entity *pred = index->Pred(key);
+  iterator p = pred ? ++iterator(pred) : begin();
+  ent->_QKey = key;
+  index->Add(ent, key);
+  List::PredIns(ent, *p);       // insert before p, can be end()
+  ent->_MarkTime = Time;        // marks input time
+  StatN(size());                // length statistic
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -51,6 +175,8 @@ void Queue::Insert(Entity *ent)
 {
   Dprintf(("%s::Insert(%s)", Name(), ent->Name() ));
   Entity::Priority_t prio = ent->Priority;
+  if(IndexIns(ent, unsigned(prio + 128), Index::PRIORITY))
+      return;
   // find (higher priority is first)
 #if 0 // _INS_FROM_BEGIN
   Queue::iterator p = begin();
@@ -67,6 +193,38 @@ void Queue::Insert(Entity *ent)
   PredIns(ent,p); // works for end()
 }
 
+////////////////////////////////////////////////////////////////////////////
+// ServiceIns --- insert by service priority and priority (Facility queues)
+//
+void Queue::ServiceIns(Entity *e)
+{
+  Dprintf(("%s::ServiceIns(%s)", Name(), e->Name() ));
+  ServicePriority_t Sprio = e->_SPrio;
+  Entity::Priority_t prio = e->Priority;
+  if(IndexIns(e, (unsigned(Sprio) << 8) + unsigned(prio + 128), Index::SERVICE))
+      return;
+  Queue::iterator begin = Queue::begin();
+  Queue::iterator p = end();
+  while (p != begin) {
+      Queue::iterator q = p;
+      --p;
+      if (static_cast<Entity *>(*p)->_SPrio >= Sprio) {       // higher service priority first
+          p = q;
+          break;
+      }
+  }
+  while (p != begin) {
+      Queue::iterator q = p;
+      --p;
+      if (static_cast<Entity *>(*p)->_SPrio > Sprio ||
+          static_cast<Entity *>(*p)->Priority >= prio) { // higher priority first
+          p = q;
+          break;
+      }
+  }
+  PredIns(e, p);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // InsFirst --- insert at first position (special case)
 //
@@ -102,6 +260,8 @@ void Queue::PostIns(Entity *ent, iterator pos)
 void Queue::PredIns(Entity *ent, iterator pos)
 {
   Dprintf(("%s::PredIns(%s,pos:%p)", Name(), ent->Name(), *pos ));
+  if(index)
+      index->mode = Index::OFF; // arbitrary position
   List::PredIns(ent, *pos); // insert before pos, can be end()
   ent->_MarkTime = Time;    // marks input time
   StatN(size());            // length statistic
@@ -133,6 +293,14 @@ Entity *Queue::GetLast()
 Entity *Queue::Get(iterator pos)
 {
   Dprintf(("%s::Get(pos:%p)", Name(), *pos));
+  if(index && index->Active() && pos!=end() && (*pos)->Where()==this) {
+      Entity *e = (Entity*) *pos;
+      iterator q = pos;
+      Entity *pred = (--q != end()) ? (Entity*) *q : 0;
+      if(pred && pred->_QKey != e->_QKey)
+          pred = 0;             // other bucket
+      index->Remove(e, e->_QKey, pred);
+  }
   Entity *ent = (Entity*) List::Get(*pos);
   StatDT(double(Time) - ent->_MarkTime);
   StatN(size());  StatN.n--; // correction !!!
@@ -53,17 +53,39 @@ const myint32 MAXLONGINT = 0x7FFFFFFFUL;
 const myint32 SIGNBIT    = 0x80000000UL;
 
 ////////////////////////////////////////////////////////////////////////////
-// random generator seed
+// random generator seed is owned by simulation context
+// (Simulation::random_seed, initialized to INICONST)
 //
 
-static myint32 SIMLIB_RandomSeed = INICONST ;
-
 ////////////////////////////////////////////////////////////////////////////
 // RandomSeed - initialization of random generator
 //
 void RandomSeed(long seed)
 {
-  SIMLIB_RandomSeed = seed;
+  Simulation::Current().random_seed = static_cast<myint32>(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// SIMLIB_RandomStreamSeed --- seed of independent random stream
+//
+// the period of base generator (starting at seed of calling thread)
+// is split into n disjoint streams, returns start of stream i
+// (used by RunReplications)
+//
+long SIMLIB_RandomStreamSeed(unsigned long i, unsigned long n)
+{
+  const unsigned long long PERIOD = 1ULL<<29; // period for odd seed
+  const unsigned long long MODMASK = MAXLONGINT; // modulo 2^31
+  unsigned long long skip = (n>0 && n<PERIOD) ? PERIOD/n : 1;
+  unsigned long long k = (i*skip) % PERIOD;  // numbers to skip
+  unsigned long long a = MULCONST;           // a^k mod 2^31
+  unsigned long long mul = 1;
+  for( ; k>0; k>>=1) {
+    if(k&1) mul = (mul*a) & MODMASK;
+    a = (a*a) & MODMASK;
+  }
+  myint32 seed = static_cast<myint32>(Simulation::Current().random_seed);
+  return static_cast<long>((mul*(seed & MODMASK)) & MODMASK);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -74,8 +96,11 @@ void RandomSeed(long seed)
 //
 double SIMLIB_RandomBase()  // range <0..1)
 {
+  long &seed = Simulation::Current().random_seed;
+  myint32 SIMLIB_RandomSeed = static_cast<myint32>(seed);
   SIMLIB_RandomSeed *= MULCONST;
   SIMLIB_RandomSeed &= MAXLONGINT; // strip sign bit
+  seed = SIMLIB_RandomSeed;
 //  _Print("random=%lx\n", (long)SIMLIB_RandomSeed);
   double r = static_cast<double>(SIMLIB_RandomSeed)/MAXLONGINT;
   // assert: if( r<0.0 || r>=1.0 ) SIMLIB_error("Random() out of range");
@@ -108,6 +133,109 @@ void SetBaseRandomGenerator(double (*new_gen)())
     SIMLIB_RandomBasePtr = SIMLIB_RandomBase; // default value
 }
 
+////////////////////////////////////////////////////////////////////////////
+// RandomStream --- counter-based generator Philox4x32-10
+//
+// (J. K. Salmon et al.: Parallel random numbers: as easy as 1, 2, 3, 2011)
+// counter = (block number, stream number), key = seed
+// each block of 4 32-bit words gives 2 values with 53 random bits
+//
+
+static_assert(sizeof(unsigned)==4, "RandomStream: unsigned should have 32 bits");
+
+const unsigned PHILOX_M0 = 0xD2511F53U;   // multipliers
+const unsigned PHILOX_M1 = 0xCD9E8D57U;
+const unsigned PHILOX_W0 = 0x9E3779B9U;   // key increments (Weyl sequence)
+const unsigned PHILOX_W1 = 0xBB67AE85U;
+
+////////////////////////////////////////////////////////////////////////////
+// RandomStream::Philox --- 10 rounds of Philox4x32
+//
+void RandomStream::Philox(unsigned ctr[4], const unsigned key[2])
+{
+  unsigned k0 = key[0], k1 = key[1];
+  for(int round=0; round<10; round++) {
+    if(round>0) { k0 += PHILOX_W0; k1 += PHILOX_W1; }
+    unsigned long long p0 = (unsigned long long)PHILOX_M0 * ctr[0];
+    unsigned long long p1 = (unsigned long long)PHILOX_M1 * ctr[2];
+    unsigned c1 = ctr[1], c3 = ctr[3];
+    ctr[0] = unsigned(p1 >> 32) ^ c1 ^ k0;
+    ctr[1] = unsigned(p1);
+    ctr[2] = unsigned(p0 >> 32) ^ c3 ^ k1;
+    ctr[3] = unsigned(p0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// RandomStream constructor
+//
+RandomStream::RandomStream(unsigned long long seed, unsigned long long s)
+{
+  Seed(seed, s);
 }
-// end
 
+////////////////////////////////////////////////////////////////////////////
+// RandomStream::Seed --- start of stream s for given seed
+//
+void RandomStream::Seed(unsigned long long seed, unsigned long long s)
+{
+  key[0] = unsigned(seed);
+  key[1] = unsigned(seed >> 32);
+  stream = s;
+  block = 0;
+  idx = 0;
+  valid = false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// RandomStream::SetPosition --- jump to value number n of stream (O(1))
+//
+void RandomStream::SetPosition(unsigned long long n)
+{
+  unsigned long long b = n >> 1;
+  valid = valid && b == block;
+  block = b;
+  idx = unsigned(n & 1);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// RandomStream::Generate --- compute values of current block
+//
+void RandomStream::Generate()
+{
+  unsigned c[4] = { unsigned(block), unsigned(block >> 32),
+                    unsigned(stream), unsigned(stream >> 32) };
+  Philox(c, key);
+  const double SCALE = 1.0/9007199254740992.0;  // 2^-53
+  buf[0] = ((c[0] >> 5) * 67108864.0 + (c[1] >> 6)) * SCALE;
+  buf[1] = ((c[2] >> 5) * 67108864.0 + (c[3] >> 6)) * SCALE;
+  valid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// RandomStream::Fill --- generate n values (whole blocks in tight loop)
+//
+void RandomStream::Fill(double *out, unsigned long n)
+{
+  while(n>0 && idx==1) {        // rest of current block
+    *out++ = Random();
+    n--;
+  }
+  if(idx==2) { block++; idx = 0; valid = false; }
+  const double SCALE = 1.0/9007199254740992.0;  // 2^-53
+  unsigned long long b = block;
+  for( ; n>=2; n-=2, b++, out+=2) {             // whole blocks
+    unsigned c[4] = { unsigned(b), unsigned(b >> 32),
+                      unsigned(stream), unsigned(stream >> 32) };
+    Philox(c, key);
+    out[0] = ((c[0] >> 5) * 67108864.0 + (c[1] >> 6)) * SCALE;
+    out[1] = ((c[2] >> 5) * 67108864.0 + (c[3] >> 6)) * SCALE;
+  }
+  valid = valid && b == block;
+  block = b;
+  if(n>0)                       // first value of last block
+    *out = Random();
+}
+
+}
+// end
@@ -29,10 +29,18 @@ namespace simlib3 {
 
 SIMLIB_IMPLEMENTATION;
 
+////////////////////////////////////////////////////////////////////////////
+//  generators are templates parametrized by source of uniform numbers:
+//  SIMLIB_BaseGen (Random(), can be changed by SetBaseRandomGenerator)
+//  or SIMLIB_StreamGen (RandomStream), see internal.h; the parameter is
+//  named Random, so that the bodies of generators are the same as before
+//
+
 ////////////////////////////////////////////////////////////////////////////
 //  _gam
 //
-static double _gam(double AK)
+template <class Gen>
+static double _gam(Gen &Random, double AK)
 {
   int K,i;
   double FK,PROD,DG,G,W;
@@ -68,18 +76,32 @@ static double _gam(double AK)
 ////////////////////////////////////////////////////////////////////////////
 //  Uniform - uniform random number generator
 //
-double Uniform(double l, double h)
+template <class Gen>
+static double _Uniform(Gen &Random, double l, double h)
 {
   if( l >= h ) SIMLIB_error(BadUniformParam);
   return(l+(h-l)*Random());
 }
 
+double Uniform(double l, double h)
+{
+  SIMLIB_BaseGen g;
+  return _Uniform(g, l, h);
+}
+
+double Uniform(RandomStream &s, double l, double h)
+{
+  SIMLIB_StreamGen g(s);
+  return _Uniform(g, l, h);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Normal(mi,sigma)
 //  mi    = mean value
 //  sigma = std deviation? (smerodatna odchylka) ###
 //
-double Normal(double mi, double sigma)
+template <class Gen>
+static double _Normal(Gen &Random, double mi, double sigma)
 {
   int i;
   double SUM = 0.0;
@@ -87,11 +109,24 @@ double Normal(double mi, double sigma)
   return (SUM-6.0)*sigma + mi;
 }
 
+double Normal(double mi, double sigma)
+{
+  SIMLIB_BaseGen g;
+  return _Normal(g, mi, sigma);
+}
+
+double Normal(RandomStream &s, double mi, double sigma)
+{
+  SIMLIB_StreamGen g(s);
+  return _Normal(g, mi, sigma);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Weibul
 //
 // TODO: check
-double Weibul(double lambda, double alfa)
+template <class Gen>
+static double _Weibul(Gen &Random, double lambda, double alfa)
 {
   double R,W;
 
@@ -102,11 +137,24 @@ double Weibul(double lambda, double alfa)
   return (W);
 }
 
+double Weibul(double lambda, double alfa)
+{
+  SIMLIB_BaseGen g;
+  return _Weibul(g, lambda, alfa);
+}
+
+double Weibul(RandomStream &s, double lambda, double alfa)
+{
+  SIMLIB_StreamGen g(s);
+  return _Weibul(g, lambda, alfa);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Erlang
 //
 // TODO: check
-double Erlang(double alfa, int beta)
+template <class Gen>
+static double _Erlang(Gen &Random, double alfa, int beta)
 {
   double ER = 1.0;
   int i;
@@ -115,10 +163,23 @@ double Erlang(double alfa, int beta)
   return -alfa*log(ER);
 }
 
+double Erlang(double alfa, int beta)
+{
+  SIMLIB_BaseGen g;
+  return _Erlang(g, alfa, beta);
+}
+
+double Erlang(RandomStream &s, double alfa, int beta)
+{
+  SIMLIB_StreamGen g(s);
+  return _Erlang(g, alfa, beta);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  NegBin
 //
-int NegBin(double q, int k)
+template <class Gen>
+static int _NegBin(Gen &Random, double q, int k)
 {
   double IS,XLOGQ,R;
   int i;
@@ -135,33 +196,72 @@ int NegBin(double q, int k)
   return int(IS);
 }
 
+int NegBin(double q, int k)
+{
+  SIMLIB_BaseGen g;
+  return _NegBin(g, q, k);
+}
+
+int NegBin(RandomStream &s, double q, int k)
+{
+  SIMLIB_StreamGen g(s);
+  return _NegBin(g, q, k);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Gamma
 //
-double Gamma(double alfa, double beta)
+template <class Gen>
+static double _Gamma(Gen &Random, double alfa, double beta)
 {
   double G;
 
-  G = _gam(alfa)*beta;
+  G = _gam(Random, alfa)*beta;
   return (G);
 }
 
+double Gamma(double alfa, double beta)
+{
+  SIMLIB_BaseGen g;
+  return _Gamma(g, alfa, beta);
+}
+
+double Gamma(RandomStream &s, double alfa, double beta)
+{
+  SIMLIB_StreamGen g(s);
+  return _Gamma(g, alfa, beta);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Exponential(mv)
 //
-double Exponential(double mv)
+template <class Gen>
+static double _Exponential(Gen &Random, double mv)
 {
   double exp = -mv * std::log(Random());
 //  _Print("Exponential(%g),%g = %g\n", mv, r, exp);
   return exp;
 }
 
+double Exponential(double mv)
+{
+  SIMLIB_BaseGen g;
+  return _Exponential(g, mv);
+}
+
+double Exponential(RandomStream &s, double mv)
+{
+  SIMLIB_StreamGen g(s);
+  return _Exponential(g, mv);
+}
+
 
 
 ////////////////////////////////////////////////////////////////////////////
 //
 //
-int NegBinM(double p, int m)
+template <class Gen>
+static int _NegBinM(Gen &Random, double p, int m)
 {
   int i,ix;
 
@@ -175,22 +275,48 @@ int NegBinM(double p, int m)
   return (ix);
 }
 
+int NegBinM(double p, int m)
+{
+  SIMLIB_BaseGen g;
+  return _NegBinM(g, p, m);
+}
+
+int NegBinM(RandomStream &s, double p, int m)
+{
+  SIMLIB_StreamGen g(s);
+  return _NegBinM(g, p, m);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Beta
 //
-double Beta(double th, double fi, double min, double max)
+template <class Gen>
+static double _Beta(Gen &Random, double th, double fi, double min, double max)
 {
   double X;
-  X = _gam(th);
-  X = X/(X+_gam(fi));
+  X = _gam(Random, th);
+  X = X/(X+_gam(Random, fi));
   X = X*(max-min)+min;
   return (X);
 }
 
+double Beta(double th, double fi, double min, double max)
+{
+  SIMLIB_BaseGen g;
+  return _Beta(g, th, fi, min, max);
+}
+
+double Beta(RandomStream &s, double th, double fi, double min, double max)
+{
+  SIMLIB_StreamGen g(s);
+  return _Beta(g, th, fi, min, max);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Triag(mod,min,max)
 //
-double Triag(double mod, double min, double max)
+template <class Gen>
+static double _Triag(Gen &Random, double mod, double min, double max)
 {
   double RN,BMA,CMA,TR;
 
@@ -204,29 +330,68 @@ double Triag(double mod, double min, double max)
   return (TR);
 }
 
+double Triag(double mod, double min, double max)
+{
+  SIMLIB_BaseGen g;
+  return _Triag(g, mod, min, max);
+}
+
+double Triag(RandomStream &s, double mod, double min, double max)
+{
+  SIMLIB_StreamGen g(s);
+  return _Triag(g, mod, min, max);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Log
 //
-double Logar(double mi, double delta)
+template <class Gen>
+static double _Logar(Gen &Random, double mi, double delta)
 {
-  double VA = Normal(mi, delta);
+  double VA = _Normal(Random, mi, delta);
   return exp(VA);
 }
 
+double Logar(double mi, double delta)
+{
+  SIMLIB_BaseGen g;
+  return _Logar(g, mi, delta);
+}
+
+double Logar(RandomStream &s, double mi, double delta)
+{
+  SIMLIB_StreamGen g(s);
+  return _Logar(g, mi, delta);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Rayle(delta)
 //
-double Rayle(double delta)
+template <class Gen>
+static double _Rayle(Gen &Random, double delta)
 {
   double R;
   while ((R=Random()) == 0) { /*empty*/ }
   return  delta * sqrt(-log(R));
 }
 
+double Rayle(double delta)
+{
+  SIMLIB_BaseGen g;
+  return _Rayle(g, delta);
+}
+
+double Rayle(RandomStream &s, double delta)
+{
+  SIMLIB_StreamGen g(s);
+  return _Rayle(g, delta);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Poisson(double lambda)
 //
-int Poisson(double lambda)
+template <class Gen>
+static int _Poisson(Gen &Random, double lambda)
 {
   double Y,X;
   int PSSN = 0;
@@ -245,16 +410,29 @@ int Poisson(double lambda)
   {
     double sl=sqrt(lambda);
     do
-      PSSN = (int) (Normal(lambda, sl) + 0.5);  /* round ???### */
+      PSSN = (int) (_Normal(Random, lambda, sl) + 0.5);  /* round ???### */
     while (PSSN<0);
   }
   return PSSN;
 }
 
+int Poisson(double lambda)
+{
+  SIMLIB_BaseGen g;
+  return _Poisson(g, lambda);
+}
+
+int Poisson(RandomStream &s, double lambda)
+{
+  SIMLIB_StreamGen g(s);
+  return _Poisson(g, lambda);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Geom(q)
 //
-int Geom(double q)
+template <class Gen>
+static int _Geom(Gen &Random, double q)
 {
   double X,R;
 
@@ -264,10 +442,23 @@ int Geom(double q)
   return int(X);
 }
 
+int Geom(double q)
+{
+  SIMLIB_BaseGen g;
+  return _Geom(g, q);
+}
+
+int Geom(RandomStream &s, double q)
+{
+  SIMLIB_StreamGen g(s);
+  return _Geom(g, q);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  HyperGeometric
 //
-int HyperGeom(double p, int n, int m)
+template <class Gen>
+static int _HyperGeom(Gen &Random, double p, int n, int m)
 {
   int IX,i;
   if (m <= 0)           SIMLIB_error(HyperGeomError1);
@@ -287,6 +478,18 @@ int HyperGeom(double p, int n, int m)
   return (IX);
 }
 
+int HyperGeom(double p, int n, int m)
+{
+  SIMLIB_BaseGen g;
+  return _HyperGeom(g, p, n, m);
+}
+
+int HyperGeom(RandomStream &s, double p, int n, int m)
+{
+  SIMLIB_StreamGen g(s);
+  return _HyperGeom(g, p, n, m);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Binom(n,theta)
 //  n     = # of experiments (pocet pokusu)
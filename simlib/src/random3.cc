@@ -0,0 +1,226 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file random3.cc  Random number generators - batch generation
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  batch generators: arrays of values (Monte Carlo inputs, pregenerated
+//  arrival streams) generated in tight loops without calls through
+//  the base generator pointer (for RandomStream)
+//
+//  Normal and Exponential use Ziggurat method (G. Marsaglia, W. W. Tsang:
+//  The Ziggurat Method for Generating Random Variables, 2000; variant
+//  with doubles by J. A. Doornik, 2005): most values need one uniform
+//  number, one table lookup and one multiplication (no log, exp)
+//
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "internal.h"
+
+#include <cmath>  // exp() log() sqrt() fabs()
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+////////////////////////////////////////////////////////////////////////////
+//  Ziggurat --- tables of layers of equal area under density f
+//  x[0] is the width of base strip (rectangle + tail), x[C] = 0
+//
+const int ZIG_C = 128;                  // number of layers
+
+struct Ziggurat {
+  double x[ZIG_C+1];            // right ends of layers
+  double ratio[ZIG_C];          // x[i+1]/x[i] (inner rectangles)
+  double f[ZIG_C+1];            // f(x[i])
+  // f(x)=exp(-x*x/2) for Normal, f(x)=exp(-x) for Exponential
+  static double Density(bool normal, double x) {
+    return normal ? std::exp(-0.5*x*x) : std::exp(-x);
+  }
+  static double Inverse(bool normal, double y) {
+    return normal ? std::sqrt(-2*std::log(y)) : -std::log(y);
+  }
+  Ziggurat(bool normal, double r, double v) {
+    x[0] = v/Density(normal, r);
+    x[1] = r;
+    for(int i=2; i<ZIG_C; i++)
+      x[i] = Inverse(normal, v/x[i-1] + Density(normal, x[i-1]));
+    x[ZIG_C] = 0;
+    for(int i=0; i<ZIG_C; i++)
+      ratio[i] = x[i+1]/x[i];
+    for(int i=0; i<=ZIG_C; i++)
+      f[i] = Density(normal, x[i]);
+  }
+};
+
+// tables are computed at first use (thread-safe initialization)
+static const Ziggurat &ZigNormal()
+{
+  static const Ziggurat z(true, 3.442619855899, 9.91256303526217e-3);
+  return z;
+}
+
+static const Ziggurat &ZigExponential()
+{
+  static const Ziggurat z(false, 6.898315116615642, 7.973229539553496e-3);
+  return z;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  _Normal --- standard normal distribution (Ziggurat)
+//
+template <class Gen>
+static inline double _Normal(Gen &Random, const Ziggurat &z)
+{
+  const double R = z.x[1];
+  for(;;) {
+    double t = Random()*ZIG_C;          // layer and position
+    int i = int(t);
+    double u = 2*(t - i) - 1;           // -1..1
+    if(std::fabs(u) < z.ratio[i])
+      return u*z.x[i];                  // inner rectangle (fast path)
+    if(i==0) {                          // tail: x > R
+      double x, y;
+      do {
+        x = std::log(1 - Random())/R;
+        y = std::log(1 - Random());
+      } while(-2*y < x*x);
+      return u<0 ? x - R : R - x;
+    }
+    double x = u*z.x[i];                // wedge
+    double f0 = std::exp(-0.5*(x*x));
+    if(z.f[i] + Random()*(z.f[i+1] - z.f[i]) < f0)
+      return x;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  _Exponential --- exponential distribution with mean 1 (Ziggurat)
+//
+template <class Gen>
+static inline double _Exponential(Gen &Random, const Ziggurat &z)
+{
+  for(;;) {
+    double t = Random()*ZIG_C;          // layer and position
+    int i = int(t);
+    double u = t - i;                   // 0..1
+    double x = u*z.x[i];
+    if(u < z.ratio[i])
+      return x;                         // inner rectangle (fast path)
+    if(i==0)                            // tail: memoryless
+      return z.x[1] - std::log(1 - Random());
+    if(z.f[i] + Random()*(z.f[i+1] - z.f[i]) < std::exp(-x))
+      return x;                         // wedge
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  batch generators (templates)
+//
+template <class Gen>
+static void _Normal(Gen &g, double mi, double sigma,
+                    double *out, unsigned long n)
+{
+  const Ziggurat &z = ZigNormal();
+  for(unsigned long j=0; j<n; j++)
+    out[j] = mi + sigma*_Normal(g, z);
+}
+
+template <class Gen>
+static void _Exponential(Gen &g, double mv, double *out, unsigned long n)
+{
+  const Ziggurat &z = ZigExponential();
+  for(unsigned long j=0; j<n; j++)
+    out[j] = mv*_Exponential(g, z);
+}
+
+template <class Gen>
+static void _Erlang(Gen &g, double alfa, int beta,
+                    double *out, unsigned long n)
+{
+  if (beta<1)  SIMLIB_error(ErlangError);
+  const Ziggurat &z = ZigExponential();
+  for(unsigned long j=0; j<n; j++) {
+    double s = 0;
+    for(int k=0; k<beta; k++)
+      s += _Exponential(g, z);
+    out[j] = alfa*s;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Uniform
+//
+void Uniform(double l, double h, double *out, unsigned long n)
+{
+  if( l >= h ) SIMLIB_error(BadUniformParam);
+  for(unsigned long j=0; j<n; j++)
+    out[j] = l+(h-l)*Random();
+}
+
+void Uniform(RandomStream &s, double l, double h, double *out, unsigned long n)
+{
+  if( l >= h ) SIMLIB_error(BadUniformParam);
+  s.Fill(out, n);
+  for(unsigned long j=0; j<n; j++)      // vectorized
+    out[j] = l+(h-l)*out[j];
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Normal
+//
+void Normal(double mi, double sigma, double *out, unsigned long n)
+{
+  SIMLIB_BaseGen g;
+  _Normal(g, mi, sigma, out, n);
+}
+
+void Normal(RandomStream &s, double mi, double sigma, double *out, unsigned long n)
+{
+  SIMLIB_StreamGen g(s);
+  _Normal(g, mi, sigma, out, n);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Exponential
+//
+void Exponential(double mv, double *out, unsigned long n)
+{
+  SIMLIB_BaseGen g;
+  _Exponential(g, mv, out, n);
+}
+
+void Exponential(RandomStream &s, double mv, double *out, unsigned long n)
+{
+  SIMLIB_StreamGen g(s);
+  _Exponential(g, mv, out, n);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Erlang
+//
+void Erlang(double alfa, int beta, double *out, unsigned long n)
+{
+  SIMLIB_BaseGen g;
+  _Erlang(g, alfa, beta, out, n);
+}
+
+void Erlang(RandomStream &s, double alfa, int beta, double *out, unsigned long n)
+{
+  SIMLIB_StreamGen g(s);
+  _Erlang(g, alfa, beta, out, n);
+}
+
+} // end
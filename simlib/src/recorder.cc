@@ -0,0 +1,353 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file recorder.cc  multi-rate recorder implementation
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  This module contains implementation of Recorder
+//
+//  classes:
+//     Recorder::Group  -- Sampler of one rate, fills buffers of rows
+//     Recorder::Writer -- thread writing full buffers to file
+//
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "recorder.h"
+#include "internal.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+////////////////////////////////////////////////////////////////////////////
+/// buffer of rows of one rate: row = time, values
+struct Recorder::Block {
+    unsigned rate;
+    size_t rows;                // number of filled rows
+    std::vector<double> data;   // rows * (1+columns)
+    Block(unsigned r, size_t size) : rate(r), rows(0), data(size) {}
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// sampler of one rate
+class Recorder::Group : public Sampler {
+    Recorder *r;
+    unsigned number;            // rate number
+  public:
+    std::vector<aContiBlock*> blocks;   // recorded values
+    std::vector<std::string> names;
+    Block *buf;                 // current buffer (0 before first sample)
+    unsigned long count;        // number of recorded rows
+    Group(Recorder *p, unsigned n, double dt) :
+        Sampler(0, dt), r(p), number(n), buf(0), count(0) {}
+    ~Group() { delete buf; }
+    // owned by recorder: not "allocated" object deleted by calendar Init
+    static void *operator new(size_t size) { return ::operator new(size); }
+    static void operator delete(void *p) { ::operator delete(p); }
+    size_t Columns() const { return blocks.size() + 1; }
+    void Behavior();            // record one row, schedule next sample
+    void Send();                // give buffer to writer
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// output thread: writes full blocks to file
+///
+/// Simulation fills blocks, full blocks are queued, the thread writes them
+/// and returns them to pool for reuse. Number of queued blocks is limited
+/// (simulation waits if writing is slow).
+struct Recorder::Writer {
+    FILE *f;
+    Format format;
+    const Recorder &r;
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<Block*> queue;   // blocks to write
+    std::vector<Block*> pool;   // written blocks (for reuse)
+    bool busy;                  // thread is writing a block
+    bool stop;                  // end of thread
+    bool header;                // file header written
+    bool error;                 // write error
+    std::thread thread;
+    static const size_t max_queue = 8;
+
+    Writer(FILE *file, Format fmt, const Recorder &rec) :
+        f(file), format(fmt), r(rec), busy(false), stop(false),
+        header(false), error(false), thread(&Writer::Run, this) {}
+    ~Writer() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        cv.notify_all();
+        thread.join();
+        for(size_t i=0; i<pool.size(); i++)
+            delete pool[i];
+    }
+    void Put(const void *p, size_t size) {
+        if(fwrite(p, 1, size, f) != size)
+            error = true;
+    }
+    void PutU32(size_t x) {
+        uint32_t u = x;
+        Put(&u, sizeof(u));
+    }
+    void WriteHeader();
+    void Write(const Block *b);
+    void Run();
+    void Push(Block *b);
+    Block *Get(unsigned rate, size_t size);
+    void Wait();
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// write file header (rates and names of columns)
+void Recorder::Writer::WriteHeader()
+{
+  const std::vector<Group*> &g = r.groups;
+  if(format == BINARY) {
+    Put("SIMLIBR1", 8);
+    PutU32(g.size());
+    for(size_t i=0; i<g.size(); i++) {
+      double step = g[i]->GetStep();
+      Put(&step, sizeof(step));
+      PutU32(g[i]->names.size());
+      for(size_t j=0; j<g[i]->names.size(); j++) {
+        PutU32(g[i]->names[j].size());
+        Put(g[i]->names[j].data(), g[i]->names[j].size());
+      }
+    }
+  } else {
+    for(size_t i=0; i<g.size(); i++) {
+      if(g.size() > 1)
+        fprintf(f, "# rate %u step %.15g: ", (unsigned)i, g[i]->GetStep());
+      fputs("time", f);
+      for(size_t j=0; j<g[i]->names.size(); j++)
+        fprintf(f, ",%s", g[i]->names[j].c_str());
+      fputc('\n', f);
+    }
+  }
+  header = true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// write rows of block
+void Recorder::Writer::Write(const Block *b)
+{
+  size_t cols = r.groups[b->rate]->Columns();
+  if(format == BINARY) {
+    PutU32(b->rate);
+    PutU32(b->rows);
+    Put(b->data.data(), b->rows*cols*sizeof(double));
+    return;
+  }
+  const double *p = b->data.data();
+  for(size_t i=0; i<b->rows; i++) {
+    if(r.groups.size() > 1)
+      fprintf(f, "%u,", b->rate);
+    for(size_t j=0; j<cols; j++)
+      fprintf(f, j ? ",%.17g" : "%.17g", *p++);
+    if(fputc('\n', f) == EOF)
+      error = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// thread: write queued blocks
+void Recorder::Writer::Run()
+{
+  std::unique_lock<std::mutex> lock(m);
+  for(;;) {
+    cv.wait(lock, [this]{ return stop || !queue.empty(); });
+    if(queue.empty())
+      return;                   // stop
+    Block *b = queue.front();
+    queue.pop_front();
+    busy = true;
+    lock.unlock();
+    if(!header)
+      WriteHeader();
+    Write(b);
+    lock.lock();
+    busy = false;
+    pool.push_back(b);
+    cv.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// queue block for writing (waits if queue is full)
+void Recorder::Writer::Push(Block *b)
+{
+  std::unique_lock<std::mutex> lock(m);
+  cv.wait(lock, [this]{ return queue.size() < max_queue; });
+  queue.push_back(b);
+  cv.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// empty block for rate (from pool or new)
+Recorder::Block *Recorder::Writer::Get(unsigned rate, size_t size)
+{
+  Block *b = 0;
+  {
+    std::lock_guard<std::mutex> lock(m);
+    if(!pool.empty()) {
+      b = pool.back();
+      pool.pop_back();
+    }
+  }
+  if(b == 0)
+    return new Block(rate, size);
+  b->rate = rate;
+  b->rows = 0;
+  b->data.resize(size);
+  return b;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// wait until all queued blocks are written
+void Recorder::Writer::Wait()
+{
+  std::unique_lock<std::mutex> lock(m);
+  cv.wait(lock, [this]{ return queue.empty() && !busy; });
+  if(!header)
+    WriteHeader();
+  fflush(f);
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// record one row: Time and values of all blocks
+void Recorder::Group::Behavior()
+{
+  r->started = true;
+  const size_t cols = Columns();
+  if(buf == 0)
+    buf = r->writer->Get(number, r->rows*cols);
+  double *p = buf->data.data() + buf->rows*cols;
+  *p++ = Time;
+  for(size_t j=0; j<blocks.size(); j++)
+    *p++ = blocks[j]->Value();
+  count++;
+  if(++buf->rows == r->rows)
+    Send();
+  Sampler::Behavior();          // schedule next sample
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// give (partially) filled buffer to writer
+void Recorder::Group::Send()
+{
+  if(buf == 0 || buf->rows == 0)
+    return;
+  r->writer->Push(buf);
+  buf = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// constructor
+/// @param filename output file
+/// @param step step of sampling for rate 0
+/// @param f format of file
+/// @param nrows number of rows in one buffer
+Recorder::Recorder(const char *filename, double step, Format f, size_t nrows) :
+  writer(0), groups(), rows(nrows > 0 ? nrows : 1), started(false)
+{
+  Dprintf(("Recorder[%p]::Recorder(\"%s\",%g)", this, filename, step));
+  FILE *file = fopen(filename, f == BINARY ? "wb" : "w");
+  if(file == 0)
+    SIMLIB_error(CantOpenOutFile);
+  writer = new Writer(file, f, *this);
+  groups.push_back(new Group(this, 0, step));
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// destructor: write all data, close file
+Recorder::~Recorder()
+{
+  Dprintf(("destructor: Recorder[%p]", this));
+  Flush();
+  FILE *file = writer->f;
+  delete writer;                // stops thread
+  fclose(file);
+  for(size_t i=0; i<groups.size(); i++)
+    delete groups[i];
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// add new sampling rate
+unsigned Recorder::Rate(double step)
+{
+  if(started)
+    SIMLIB_error(RecorderAddErr);
+  groups.push_back(new Group(this, groups.size(), step));
+  return groups.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// add value of block b (recorded with given rate)
+void Recorder::Add(aContiBlock &b, const char *name, unsigned rate)
+{
+  if(started || rate >= groups.size())
+    SIMLIB_error(RecorderAddErr);
+  groups[rate]->blocks.push_back(&b);
+  groups[rate]->names.push_back(name ? name : "");
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// start/stop sampling of all rates
+void Recorder::Start()
+{
+  for(size_t i=0; i<groups.size(); i++)
+    groups[i]->Start();
+}
+
+void Recorder::Stop()
+{
+  for(size_t i=0; i<groups.size(); i++)
+    groups[i]->Stop();
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// write all recorded rows to file
+void Recorder::Flush()
+{
+  started = true;               // header is written
+  for(size_t i=0; i<groups.size(); i++)
+    groups[i]->Send();
+  writer->Wait();
+  if(writer->error)
+    SIMLIB_error(OutFilePutError);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// number of rows recorded with given rate
+unsigned long Recorder::Records(unsigned rate) const
+{
+  return rate < groups.size() ? groups[rate]->count : 0;
+}
+
+} // namespace
+
+// end of recorder.cc
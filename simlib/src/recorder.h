@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file recorder.h   multi-rate recorder of block values
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  This is the interface for Recorder: values of continuous blocks
+//  (aContiBlock, Variable, Integrator, ...) are sampled with one or more
+//  rates into preallocated buffers, full buffers are written to file by
+//  separate thread (no formatted output in simulation step).
+//
+//  File formats:
+//
+//  CSV     one rate:   header "time,name1,..." and lines "t,v1,..."
+//          more rates: header lines "# rate r step s: time,name1,..."
+//                      and lines "r,t,v1,..."
+//
+//  BINARY  (native byte order)
+//          header:  char magic[8] = "SIMLIBR1", uint32 rates,
+//                   for each rate: double step, uint32 columns,
+//                   for each column: uint32 length, char name[length]
+//          blocks:  uint32 rate, uint32 rows,
+//                   double data[rows][1+columns]  (time, values)
+//
+
+#ifndef __SIMLIB__
+#   error "recorder.h: 30: you should include simlib.h first"
+#endif
+#if __SIMLIB__ < 0x0307
+#   error "recorder.h: 33: requires SIMLIB version 3.07 and higher"
+#endif
+
+#include <vector>
+
+namespace simlib3 {
+
+////////////////////////////////////////////////////////////////////////////
+//! recorder of block values with buffered output to file
+//! Rate 0 is created by constructor, other rates by Rate(step).
+//! Values are added before the first sample (Init+Run). Written file is
+//! complete after Flush() or destruction of recorder.
+class Recorder {
+    Recorder(const Recorder&);           // disable copy ctor
+    void operator= (const Recorder&);    // disable assignment
+  public:
+    enum Format {
+        CSV,            //!< text, comma separated values
+        BINARY          //!< doubles in native format (see recorder.h)
+    };
+  private:
+    struct Block;               // buffer of rows (see recorder.cc)
+    struct Writer;              // output thread (see recorder.cc)
+    class Group;                // sampler of one rate (see recorder.cc)
+    Writer *writer;
+    std::vector<Group*> groups;
+    size_t rows;                // rows in one buffer
+    bool started;               // set by first sample
+    friend class Group;
+  public:
+    Recorder(const char *filename, double step, Format f=CSV,
+             size_t rows=1024);
+    ~Recorder();
+    unsigned Rate(double step); //!< add sampling rate, returns its number
+    void Add(aContiBlock &b, const char *name, unsigned rate=0); //!< value
+    void Start();               //!< start sampling (all rates)
+    void Stop();                //!< stop sampling (all rates)
+    void Flush();               //!< write all buffers, wait for writer
+    unsigned long Records(unsigned rate=0) const; //!< # of recorded rows
+};
+
+} // namespace
+
+// end of recorder.h
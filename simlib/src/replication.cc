@@ -0,0 +1,152 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file replication.cc  Parallel replications of simulation experiment
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+// description: RunReplications --- independent replications of model
+//              in a pool of worker threads (with work stealing)
+//
+
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+////////////////////////////////////////////////////////////////////////////
+
+#include "simlib.h"
+#include "internal.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+////////////////////////////////////////////////////////////////////////////
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////
+/// work queue of single worker thread
+/// owner takes replications from front, other workers steal from back
+class WorkQueue {
+    std::mutex m;
+    std::deque<unsigned long> q;        // numbers of replications
+  public:
+    void push(unsigned long i) {
+        std::lock_guard<std::mutex> lock(m);
+        q.push_back(i);
+    }
+    bool pop(unsigned long &i) {        // used by owner
+        std::lock_guard<std::mutex> lock(m);
+        if(q.empty()) return false;
+        i = q.front();
+        q.pop_front();
+        return true;
+    }
+    bool steal(unsigned long &i) {      // used by other workers
+        std::lock_guard<std::mutex> lock(m);
+        if(q.empty()) return false;
+        i = q.back();
+        q.pop_back();
+        return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// shared state of replication run
+struct Replications {
+    unsigned long n;                    // number of replications
+    void (*init)(unsigned long);        // model creation + Init()
+    void (*collect)(unsigned long);     // merge results
+    std::vector<WorkQueue> queues;      // one queue per worker
+    std::vector<long> seeds;            // seeds of random streams
+    std::mutex collect_mutex;           // serialize collect() calls
+    Replications(unsigned long N, unsigned threads):
+        n(N), init(0), collect(0), queues(threads), seeds(N) {}
+    void Worker(unsigned w);            // worker thread body
+    void Replication(unsigned long i);  // single experiment
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// single replication in the context of calling worker thread
+void Replications::Replication(unsigned long i)
+{
+    Dprintf(("RunReplications: replication #%lu", i));
+    RandomSeed(seeds[i]);               // independent random stream
+    init(i);                            // create model, Init()
+    Run();
+    std::lock_guard<std::mutex> lock(collect_mutex);
+    if(collect)
+        collect(i);                     // merge results, destroy model
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// worker thread: own queue first, then steal from others
+void Replications::Worker(unsigned w)
+{
+    const unsigned T = queues.size();
+    unsigned long i;
+    for(;;) {
+        if(queues[w].pop(i)) {
+            Replication(i);
+            continue;
+        }
+        bool found = false;
+        for(unsigned k=1; k<T && !found; k++)
+            found = queues[(w+k)%T].steal(i);
+        if(!found)
+            break;                      // all queues are empty
+        Replication(i);
+    }
+}
+
+} // namespace
+
+
+////////////////////////////////////////////////////////////////////////////
+//  RunReplications --- run n independent replications of the model
+//
+void RunReplications(unsigned long n,
+                     void (*init)(unsigned long i),
+                     void (*collect)(unsigned long i),
+                     unsigned threads)
+{
+    Dprintf(("RunReplications(%lu, %p, %p, %u)", n, init, collect, threads));
+    if(SIMLIB_Phase == SIMULATION)
+        SIMLIB_error(ReplicationsError);
+    if(n==0 || init==0)
+        return;
+    if(threads==0)
+        threads = std::thread::hardware_concurrency();
+    if(threads==0)
+        threads = 1;
+    if(threads>n)
+        threads = n;
+
+    Replications r(n, threads);
+    r.init = init;
+    r.collect = collect;
+    for(unsigned long i=0; i<n; i++) {
+        r.seeds[i] = SIMLIB_RandomStreamSeed(i, n);  // from current seed
+        r.queues[i*threads/n].push(i);  // contiguous blocks of work
+    }
+
+    std::vector<std::thread> workers;
+    for(unsigned w=0; w<threads; w++)
+        workers.push_back(std::thread(&Replications::Worker, &r, w));
+    for(unsigned w=0; w<threads; w++)
+        workers[w].join();
+}
+
+} // namespace
+
+// end
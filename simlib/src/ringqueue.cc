@@ -0,0 +1,237 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file ringqueue.cc  RingQueue implementation (queue of entity handles)
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  implementation of queue stored in contiguous ring buffer
+//  items are handles (slot index + generation, see EntityHandle),
+//  insertion time and priority, so scanning does not touch entities
+//
+
+#include "simlib.h"
+#include "internal.h"
+
+
+////////////////////////////////////////////////////////////////////////////
+//  implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+static const unsigned RINGQUEUE_MIN_CAPACITY = 16; // power of 2
+
+////////////////////////////////////////////////////////////////////////////
+//  constructors
+//
+RingQueue::RingQueue() :
+    items(new Item[RINGQUEUE_MIN_CAPACITY]),
+    mask(RINGQUEUE_MIN_CAPACITY-1), first(0), n(0)
+{
+  Dprintf(("RingQueue{%p}::RingQueue()", this));
+}
+
+RingQueue::RingQueue(const char *name) :
+    items(new Item[RINGQUEUE_MIN_CAPACITY]),
+    mask(RINGQUEUE_MIN_CAPACITY-1), first(0), n(0)
+{
+  Dprintf(("RingQueue{%p}::RingQueue(\"%s\")", this, name));
+  SetName(name);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  destructor
+//
+RingQueue::~RingQueue() {
+  Dprintf(("RingQueue{%p}::~RingQueue() // \"%s\" ", this, Name()));
+  clear();
+  delete [] items;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Grow --- double the capacity of ring buffer
+//
+void RingQueue::Grow()
+{
+  unsigned capacity = 2 * (mask + 1);
+  Item *p = new Item[capacity];
+  for(unsigned i=0; i<n; i++)
+      p[i] = at(i);
+  delete [] items;
+  items = p;
+  mask = capacity - 1;
+  first = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Ins --- insert before position i (shifts the shorter part)
+//
+void RingQueue::Ins(Entity *ent, unsigned i)
+{
+  if(i > n)
+      SIMLIB_error(ListActivityError);
+  if(n == mask + 1)
+      Grow();
+  if(i < n - i) {               // shift first part to the left
+      first = (first - 1) & mask;
+      for(unsigned j=0; j<i; j++)
+          at(j) = at(j+1);
+  } else {                      // shift last part to the right
+      for(unsigned j=n; j>i; j--)
+          at(j) = at(j-1);
+  }
+  n++;
+  Item &x = at(i);
+  x.h = ent->Handle();
+  x.time = Time;                // marks input time
+  x.prio = ent->Priority;
+  StatN(n);                     // length statistic
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Del --- remove item at position i (shifts the shorter part)
+//
+Entity *RingQueue::Del(unsigned i)
+{
+  if(n == 0)
+      SIMLIB_error(ListEmptyError);
+  if(i >= n)
+      SIMLIB_error(ListActivityError);
+  Item x = at(i);
+  if(i < n - 1 - i) {           // shift first part to the right
+      for(unsigned j=i; j>0; j--)
+          at(j) = at(j-1);
+      first = (first + 1) & mask;
+  } else {                      // shift last part to the left
+      for(unsigned j=i; j<n-1; j++)
+          at(j) = at(j+1);
+  }
+  n--;
+  StatDT(double(Time) - x.time);
+  StatN(n);  StatN.n--; // correction !!!
+  return x.h.get();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Insert --- priority insert into queue (after items with >= priority)
+//
+void RingQueue::Insert(Entity *ent)
+{
+  Dprintf(("%s::Insert(%s)", Name(), ent->Name() ));
+  Entity::Priority_t prio = ent->Priority;
+  unsigned i = n;               // items are inserted at end usually
+  while(i > 0 && at(i-1).prio < prio)
+      i--;
+  Ins(ent, i);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// InsFirst --- insert at first position
+//
+void RingQueue::InsFirst(Entity *ent)
+{
+  Dprintf(("%s::InsFirst(%s)", Name(), ent->Name() ));
+  Ins(ent, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// InsLast --- insert at last position (for FIFO)
+//
+void RingQueue::InsLast(Entity *ent)
+{
+  Dprintf(("%s::InsLast(%s)", Name(), ent->Name() ));
+  Ins(ent, n);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// PredIns --- insert before position
+//
+void RingQueue::PredIns(Entity *ent, iterator pos)
+{
+  Dprintf(("%s::PredIns(%s,pos:%u)", Name(), ent->Name(), pos.i ));
+  if(pos.q != this)
+      SIMLIB_error(ListActivityError);
+  Ins(ent, pos.i);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// PostIns --- insert after position
+//
+void RingQueue::PostIns(Entity *ent, iterator pos)
+{
+  Dprintf(("%s::PostIns(%s,pos:%u)", Name(), ent->Name(), pos.i ));
+  if(pos.q != this || pos == end())
+      SIMLIB_error(ListActivityError);
+  Ins(ent, pos.i + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Get --- remove item, returns 0 for destroyed entity
+//
+Entity *RingQueue::Get(iterator pos)
+{
+  Dprintf(("%s::Get(pos:%u)", Name(), pos.i));
+  if(pos.q != this)
+      SIMLIB_error(ListActivityError);
+  return Del(pos.i);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetFirst --- remove first entity (stale items are skipped)
+//
+Entity *RingQueue::GetFirst()
+{
+  Dprintf(("%s::GetFirst()", Name()));
+  Entity *ent;
+  do {
+      ent = Del(0);
+  } while(ent == 0 && n > 0);
+  return ent;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetLast --- remove last entity (stale items are skipped)
+//
+Entity *RingQueue::GetLast()
+{
+  Dprintf(("%s::GetLast()", Name()));
+  Entity *ent;
+  do {
+      ent = Del(n-1);
+  } while(ent == 0 && n > 0);
+  return ent;
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  clear - initialization of queue, destroys allocated entities
+//
+void RingQueue::clear()
+{
+  Dprintf(("%s::Clear()", Name()));
+  for(unsigned i=0; i<n; i++) {
+      Entity *e = at(i).h.get();
+      if(e && e->isAllocated()) delete e;
+  }
+  n = 0;
+  first = 0;
+  StatN.Clear();
+  StatDT.Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  RingQueue::Name --- name of the queue
+//
+const char *RingQueue::Name() const
+{
+    const char *name = SimObject::Name();
+    if(*name) return name; // has explicit name
+    else      return SIMLIB_create_tmp_name("RingQueue{%p}", this);
+}
+
+}
+// end
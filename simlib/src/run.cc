@@ -34,31 +34,33 @@ SIMLIB_IMPLEMENTATION;
 //  SIMLIB_*  --- internal variables
 //  [A-Z]*    --- user-level variables
 //
+//  all are thread-local: each thread has its own simulation context
+//
 
 
 // time-related variables
-double SIMLIB_StartTime;       // time of simulation start
-double SIMLIB_Time;            // simulation time
-double SIMLIB_NextTime;        // next-event time
-double SIMLIB_EndTime;         // time of simulation end
+thread_local double SIMLIB_StartTime;  // time of simulation start
+thread_local double SIMLIB_Time;       // simulation time
+thread_local double SIMLIB_NextTime;   // next-event time
+thread_local double SIMLIB_EndTime;    // time of simulation end
 
 // read-only references to time variables
 // ASSERTION: StartTime <= Time <= NextTime <= EndTime
-const double & StartTime = SIMLIB_StartTime;    // time of simulation start
-const double & Time      = SIMLIB_Time;         // simulation time
-const double & NextTime  = SIMLIB_NextTime;     // next-event time
-const double & EndTime   = SIMLIB_EndTime;      // time of simulation end
+thread_local const double & StartTime = SIMLIB_StartTime; // time of simulation start
+thread_local const double & Time      = SIMLIB_Time;      // simulation time
+thread_local const double & NextTime  = SIMLIB_NextTime;  // next-event time
+thread_local const double & EndTime   = SIMLIB_EndTime;   // time of simulation end
 
 // current entity pointer
-Entity *SIMLIB_Current = NULL;
-Entity *const &Current = SIMLIB_Current;        // read-only reference
+thread_local Entity *SIMLIB_Current = NULL;
+thread_local Entity *const &Current = SIMLIB_Current;     // read-only reference
 
 // phase of simulation experiment
-SIMLIB_Phase_t SIMLIB_Phase = START;
-const SIMLIB_Phase_t & Phase = SIMLIB_Phase;    // read-only reference
+thread_local SIMLIB_Phase_t SIMLIB_Phase = START;
+thread_local const SIMLIB_Phase_t & Phase = SIMLIB_Phase; // read-only reference
 
 // experiment counter
-unsigned long SIMLIB_experiment_no = 0;
+thread_local unsigned long SIMLIB_experiment_no = 0;
 
 ////////////////////////////////////////////////////////////////////////////
 /// internal statistical information
@@ -74,13 +76,13 @@ void SIMLIB_statistics_t::Init() {
     EndTime = -1;
 }
 
-static SIMLIB_statistics_t SIMLIB_run_statistics;
-const SIMLIB_statistics_t &SIMLIB_statistics = SIMLIB_run_statistics;
+static thread_local SIMLIB_statistics_t SIMLIB_run_statistics;
+thread_local const SIMLIB_statistics_t &SIMLIB_statistics = SIMLIB_run_statistics;
 
 ////////////////////////////////////////////////////////////////////////////
 // private module variables
 
-static bool StopFlag = false;           // if set, stop simulation run
+static thread_local bool StopFlag = false; // if set, stop simulation run
 
 ////////////////////////////////////////////////////////////////////////////
 // support for Delay blocks (internal)
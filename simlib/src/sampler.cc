@@ -30,8 +30,7 @@ namespace simlib3 {
 
 SIMLIB_IMPLEMENTATION;
 
-// inicializace
-Sampler *Sampler::First = 0;
+// list of samplers is owned by simulation context (Simulation::samplers)
 
 ////////////////////////////////////////////////////////////////////////////
 // constructor
@@ -44,6 +43,7 @@ Sampler::Sampler(void(*pf)(), double dt) :
     on(true)
 {
   Dprintf(("Sampler::Sampler(%p,%g)", pf, dt));
+  Sampler *&First = Simulation::Current().samplers;
   if( First==0 ) { // first created sampler
      INSTALL_HOOK( SamplerInit, Sampler::InitAll );
      INSTALL_HOOK( SamplerAct, Sampler::ActivateAll );
@@ -59,6 +59,7 @@ Sampler::Sampler(void(*pf)(), double dt) :
 Sampler::~Sampler()
 {
   Dprintf(("Sampler::~Sampler() // \"%p\" ", function));
+  Sampler *&First = Simulation::Current().samplers;
   // remove from list:
   if (this==First)
     First = Next;
@@ -101,7 +102,7 @@ void Sampler::Behavior() {
 // Sampler::InitAll --- init all samplers - called by Init()
 // static
 void Sampler::InitAll() {
-  for( Sampler *i = First; i; i = i->Next ) {
+  for( Sampler *i = Simulation::Current().samplers; i; i = i->Next ) {
     i->last = -1;
     i->on = true;
   }
@@ -112,7 +113,7 @@ void Sampler::InitAll() {
 // static
 void Sampler::ActivateAll()
 {
-  for(Sampler *i=First; i; i=i->Next)
+  for(Sampler *i=Simulation::Current().samplers; i; i=i->Next)
   {
     i->last = -1;               // really needed ???? ######
     if(i->on)                   // activate this one
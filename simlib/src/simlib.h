@@ -47,6 +47,7 @@
 // includes
 #include <cstdlib>      // size_t
 #include <list>         // std::list<>
+#include <initializer_list> // WaitUntilOn
 
 // /////////////////////////////////////////////////////////////////////////
 //! \namespace simlib3  Main SIMLIB (version 3+) namespace.
@@ -107,11 +108,14 @@ class     Entity;               // discrete model entity
 class       Process;            // process base
 class       Event;              // event base
 class         Sampler;          // periodic calls of global function
+class   Signal;                 // state change signal (WaitUntilOn)
 class   List;                   // list of objects of class Link descendants
 class     Queue;                // priority queue
+class   RingQueue;              // priority queue of entity handles
 class   Stat;                   // statistics
 class   TStat;                  // time dependent statistics
 class   Histogram;              // histogram
+class   LogHistogram;           // log-linear histogram (percentiles)
 class   Facility;               // SOL-like facility
 class   Store;                  // SOL-like store
 class   Barrier;                // barrier
@@ -120,6 +124,7 @@ class   Semaphore;              // semaphore
 class   aBlock;                 // abstract block
 class     aContiBlock;          // blocks with continuous output
 class       Integrator;         // integrator
+class     IntegratorVector;     // vector of states (spatial discretization)
 class       Status;             // status variables
 class         Hyst;             // hysteresis
 class         Blash;            // backlash
@@ -142,30 +147,132 @@ class        ConditionDown;     // action by TRUE-->FALSE
 const double SIMLIB_MINTIME = 0.0;    //!< minimal time value
 const double SIMLIB_MAXTIME = 1.0e30; //!< maximum time (1e30 works for float, too)
 
+////////////////////////////////////////////////////////////////////////////
+// CATEGORY: simulation context
+
+class Calendar;                 // calendar implementation (internal)
+class EventNoticeAllocator;     // allocator of calendar items (internal)
+class WaitUntilList;            // list of processes in WaitUntil (internal)
+class EntityTable;              // slots for entity handles (internal)
+class IntegratorArrays;         // states of integrators (internal)
+class SIMLIB_Tape;              // compiled block expressions (internal)
+
+////////////////////////////////////////////////////////////////////////////
+//! Simulation context --- the state of one simulator instance
+//! (calendar, WaitUntil list, samplers, state conditions, integrators,
+//! random number generator seed).
+//! Each thread has its own context (created at first use), so independent
+//! simulations can run in separate threads of a single process.
+//! Model objects belong to the context of the thread which created them.
+//! \ingroup simlib
+class Simulation {
+    Simulation(const Simulation&);              // disable
+    Simulation &operator=(const Simulation&);   // disable
+    Simulation();
+    ~Simulation();                              // cleanup at thread exit
+    struct Owner;                               // thread-local owner
+    // owned state:
+    Calendar *calendar;                         // calendar (created at first use)
+    EventNoticeAllocator *allocator;            // free-list of calendar items
+    WaitUntilList *wait_until;                  // processes in WaitUntil
+    Sampler *samplers;                          // list of all samplers
+    aCondition *conditions;                     // list of all conditions
+    IntegratorArrays *integrators;              // all integrators
+    std::list<Status*> *status;                 // all status variables
+    long random_seed;                           // base generator seed
+    EntityTable *entities;                      // slots for entity handles
+    friend class Calendar;
+    friend class EntityTable;
+    friend class WaitUntilList;
+    friend class Sampler;
+    friend class aCondition;
+    friend class IntegratorContainer;
+    friend class StatusContainer;
+    friend void RandomSeed(long seed);
+    friend double SIMLIB_RandomBase();
+    friend long SIMLIB_RandomStreamSeed(unsigned long i, unsigned long n);
+  public:
+    //! context of the calling thread
+    static Simulation & Current();
+    //! check if the calling thread is the main program thread
+    static bool isMainThread();
+};
+
+////////////////////////////////////////////////////////////////////////////
+//! Partition of model for conservative parallel simulation (see
+//! RunPartitions). Each partition runs in its own thread with its own
+//! simulation context; partitions interact only by messages sent through
+//! Channel objects. Create partitions and channels in main thread.
+//! \ingroup simlib
+class Partition {
+    Partition(const Partition&);            // ## disable
+    Partition&operator=(const Partition&);  // ## disable
+    struct Inbox;               // incoming messages (see partition.cc)
+    Inbox *inbox;
+    void (*init)();             // creates submodel (after Init)
+    void (*collect)();          // called after Run (results)
+    unsigned number;            // partition number (0, 1, ...)
+    void Deliver();             // move received messages to calendar
+    static void Thread(Partition *p, long seed);
+    friend class Channel;
+    friend class SIMLIB_Synchronizer;
+    friend void RunPartitions(double t0, double t1);
+  public:
+    Partition(void (*init)(), void (*collect)()=0);
+    ~Partition();
+    unsigned Number() const { return number; } //!< partition number
+    static Partition *Current(); //!< partition of calling thread (or 0)
+};
+
+////////////////////////////////////////////////////////////////////////////
+//! One-way connection between partitions with constant delay.
+//! Value sent at Time is received at Time+Delay() by function called
+//! in the destination partition. The minimal delay of all channels is
+//! the lookahead of the parallel simulation.
+//! \ingroup simlib
+class Channel {
+    Channel(const Channel&);            // ## disable
+    Channel&operator=(const Channel&);  // ## disable
+    Partition &from;            // source partition
+    Partition &to;              // destination partition
+    double delay;               // constant transport delay (> 0)
+    void (*receive)(double value); // called in destination partition
+    unsigned number;            // channel number (message ordering)
+    unsigned long sent;         // number of sent messages (ordering)
+    friend class Partition;
+    friend void RunPartitions(double t0, double t1);
+  public:
+    Channel(Partition &from, Partition &to, double delay,
+            void (*receive)(double value));
+    ~Channel();
+    void Send(double value);    //!< send value (in source partition)
+    double Delay() const { return delay; } //!< transport delay
+};
+
 ////////////////////////////////////////////////////////////////////////////
 // CATEGORY: global variables
-// Warning: NOT THREAD-SAFE! --- TODO: change to methods of SimulationContext
+// Note: all values are thread-local (see class Simulation)
 
-extern Entity *const &Current;    //!< pointer to active (now running) entity
+extern thread_local Entity *const &Current; //!< pointer to active (now running) entity
 
 // time values:
-extern const double & StartTime;       //!< time of simulation start
-extern const double & NextTime;        //!< next-event time
-extern const double & EndTime;         //!< time of simulation end
+extern thread_local const double & StartTime;  //!< time of simulation start
+extern thread_local const double & NextTime;   //!< next-event time
+extern thread_local const double & EndTime;    //!< time of simulation end
 
 // WARNING: Time cannot be used in block expressions!
-extern const double & Time;            //!< model time (is NOT the block)
+extern thread_local const double & Time;       //!< model time (is NOT the block)
 extern aContiBlock  & T;               //!< model time (continuous block)
 
 // read-only step limits of numerical integration method
-extern const double &MinStep;     //!< minimal step size
-extern const double &StepSize;    //!< current step size
-extern const double &OptStep;     //!< optimal step size
-extern const double &MaxStep;     //!< maximal step size
+extern thread_local const double &MinStep;     //!< minimal step size
+extern thread_local const double &StepSize;    //!< current step size
+extern thread_local const double &OptStep;     //!< optimal step size
+extern thread_local const double &MaxStep;     //!< maximal step size
 
 // error params for numerical integration methods
-extern const double &AbsoluteError; //!< max absolute error
-extern const double &RelativeError; //!< max relative error
+extern thread_local const double &AbsoluteError; //!< max absolute error
+extern thread_local const double &RelativeError; //!< max relative error
 
 ////////////////////////////////////////////////////////////////////////////
 // CATEGORY: global functions ...
@@ -199,6 +306,14 @@ void SetAccuracy(double abserr, double relerr);
 //! @param relerr  tolerance relative to integrator value
 void SetAccuracy(double relerr);
 
+//! evaluate integrator inputs using compiled tape (default) or by
+//! recursive Value() calls of blocks (see tape.cc)
+void SetCompiledEvaluation(bool on);
+//! evaluate integrator inputs by n threads (default 1: serial evaluation)
+//! only for large models without user blocks, functions used by
+//! Function1/Function2 blocks must be thread-safe (see tape.cc)
+void SetParallelEvaluation(unsigned n);
+
 //! run simulation experiment
 void Run();
 //! stop current simulation run
@@ -206,6 +321,28 @@ void Stop();
 //! end simulation program
 void Abort();
 
+//! run n independent replications of simulation experiment in parallel
+//! threads; each replication has its own simulation context (see class
+//! Simulation) and independent random number stream
+//! @param n        number of replications
+//! @param init     called for replication i: creates model, calls Init()
+//! @param collect  called after Run() of replication i: merges results
+//!                 (Stat::operator+=, ...) and destroys model,
+//!                 calls are serialized
+//! @param threads  number of worker threads (0 = number of processors)
+void RunReplications(unsigned long n,
+                     void (*init)(unsigned long i),
+                     void (*collect)(unsigned long i),
+                     unsigned threads=0);
+
+//! conservative parallel simulation of partitioned model:
+//! each Partition runs in its own thread (Init(t0,t1), init, Run, collect),
+//! partitions are synchronized in time windows of length given by
+//! the minimal Channel delay (lookahead)
+//! @param t0  simulation start time
+//! @param t1  simulation end time
+void RunPartitions(double t0, double t1);
+
 //! print message and terminate program
 void Error(const char *fmt, ...);
 
@@ -247,14 +384,50 @@ void ContractStep(double time);
 //! @param seed initial value of generator state
 void   RandomSeed(long seed);
 //! base uniform generator (range 0-0.999999...)
-//! the default implementation is simple LCG 32bit
+//! the default implementation is simple LCG 32bit (see RandomStream)
 double Random();
 //! set another random generator
 //! default Random() implementation can be replaced
 //! @param new_gen pointer to user-defined function
 void   SetBaseRandomGenerator(double (*new_gen)());
 
+//! independent random number stream (counter-based generator Philox4x32-10)
+//! value number i of stream s with seed k is a function of (k,s,i) only:
+//! streams with different numbers do not overlap and jump-ahead is O(1)
+//! (e.g. stream number = replication number or entity number)
+class RandomStream {
+  unsigned key[2];              // seed
+  unsigned long long stream;    // stream number (high part of counter)
+  unsigned long long block;     // number of current block (low part)
+  unsigned idx;                 // index of next value in block
+  bool valid;                   // buf contains block
+  double buf[2];                // values of current block
+  void Generate();
+ public:
+  RandomStream(unsigned long long seed=0, unsigned long long stream=0);
+  void Seed(unsigned long long seed, unsigned long long stream=0);
+  unsigned long long Stream() const { return stream; }
+  //! number of values generated from the start of stream
+  unsigned long long Position() const { return 2*block + idx; }
+  void SetPosition(unsigned long long n);
+  void Jump(unsigned long long n) { SetPosition(Position() + n); } //!< skip n values
+  //! uniform random number (range 0-0.999999...)
+  double Random() {
+    if (idx == 2) { block++; idx = 0; valid = false; }
+    if (!valid) Generate();
+    return buf[idx++];
+  }
+  double operator () () { return Random(); }
+  void Fill(double *out, unsigned long n); //!< n values to out[0..n-1]
+  //! Philox4x32-10 bijection of counter ctr (result in ctr)
+  static void Philox(unsigned ctr[4], const unsigned key[2]);
+};
+
+//! base uniform generator using given stream
+inline double Random(RandomStream &s) { return s.Random(); }
+
 // following generators depend on Random()
+// (variants with RandomStream parameter use given stream instead)
 //! Beta distribution generator @param th @param fi @param min @param max
 double Beta(double th, double fi, double min, double max);
 //! Erlang distribution generator @param alfa @param beta
@@ -281,6 +454,33 @@ double Uniform(double l, double h);
 //! Weibul distribution generator @param lambda @param alfa
 double Weibul(double lambda, double alfa);
 
+double Beta(RandomStream &s, double th, double fi, double min, double max);
+double Erlang(RandomStream &s, double alfa, int beta);
+double Exponential(RandomStream &s, double mv);
+double Gamma(RandomStream &s, double alfa, double beta);
+int    Geom(RandomStream &s, double q);
+int    HyperGeom(RandomStream &s, double p, int n, int m);
+double Logar(RandomStream &s, double mi, double delta);
+int    NegBinM(RandomStream &s, double p,int m);
+int    NegBin(RandomStream &s, double q, int k);
+double Normal(RandomStream &s, double mi, double sigma);
+int    Poisson(RandomStream &s, double lambda);
+double Rayle(RandomStream &s, double delta);
+double Triag(RandomStream &s, double mod, double min, double max);
+double Uniform(RandomStream &s, double l, double h);
+double Weibul(RandomStream &s, double lambda, double alfa);
+
+// batch generators: fill array out[0..n-1]
+// (Normal and Exponential use Ziggurat method: exact distribution)
+void Uniform(double l, double h, double *out, unsigned long n);
+void Normal(double mi, double sigma, double *out, unsigned long n);
+void Exponential(double mv, double *out, unsigned long n);
+void Erlang(double alfa, int beta, double *out, unsigned long n);
+void Uniform(RandomStream &s, double l, double h, double *out, unsigned long n);
+void Normal(RandomStream &s, double mi, double sigma, double *out, unsigned long n);
+void Exponential(RandomStream &s, double mv, double *out, unsigned long n);
+void Erlang(RandomStream &s, double alfa, int beta, double *out, unsigned long n);
+
 
 ////////////////////////////////////////////////////////////////////////////
 // CATEGORY: basics
@@ -357,6 +557,21 @@ typedef unsigned char ServicePriority_t;
 //! struct EventNotice is  private to calendar implementation
 struct EventNotice;     // we use only pointer to this class here
 
+////////////////////////////////////////////////////////////////////////////
+//! weak reference to entity: index of slot in entity table + generation
+//! of the slot (slot is reused after entity destruction, the generation
+//! detects stale handles). See Entity::Handle(), RingQueue.
+struct EntityHandle {
+    unsigned index;             //!< slot number (0 = null handle)
+    unsigned generation;        //!< slot generation
+    EntityHandle(): index(0), generation(0) {}
+    Entity *get() const;        //!< entity or 0 (null/stale handle)
+    bool operator == (const EntityHandle &h) const {
+        return index == h.index && generation == h.generation;
+    }
+    bool operator != (const EntityHandle &h) const { return !(*this == h); }
+};
+
 ////////////////////////////////////////////////////////////////////////////
 //! abstract base class for active entities (Process, Event)
 //! instances of derived classes provide Behavior() method implementation,
@@ -366,7 +581,7 @@ class Entity : public Link {
     Entity(const Entity&);           // disable
     Entity&operator=(const Entity&); // disable
   protected:
-    static unsigned long _Number;   //!< current number of entities
+    static thread_local unsigned long _Number; //!< current number of entities
     unsigned long _Ident;           //!< unique identification number of entity
     ////////////////////////////////////////////////////////////////////////////
     // TODO: next attributes will be changed/removed:
@@ -388,6 +603,10 @@ class Entity : public Link {
     typedef EntityPriority_t Priority_t;
     //! priority of the entity (scheduling,queues)
     Priority_t Priority;                //!< priority of the entity
+  protected:
+    unsigned short _QKey;               // priority bucket in Queue (see queue.cc)
+    unsigned _Slot;                     // slot in entity table (see Handle())
+  public:
     Entity(Priority_t p = DEFAULT_PRIORITY);
     virtual ~Entity();
 
@@ -395,6 +614,7 @@ class Entity : public Link {
     operator Entity* () { return this; } // default conversion
     virtual const char *Name() const;   //!< name of the entity
     double ActivationTime();            // get activation time if scheduled
+    EntityHandle Handle();              //!< weak reference to the entity
 
     void Activate() { Activate(Time); } //!< activate now
     virtual void Activate(double t);    //!< activate at time t (schedule)
@@ -446,6 +666,10 @@ class Process : public Entity {
   friend class WaitUntilList;
   bool _wait_until;                     // waiting for condition
   void _WaitUntilRemove();
+  friend class Signal;
+  struct WaitOnList;                    // signals of WaitUntilOn (waitunti.cc)
+  WaitOnList *_wait_on;                 // signals the process waits on
+  void _WaitOnRemove(bool destroy=false); // remove from all signals
 
  public:
   Process(Priority_t p=DEFAULT_PRIORITY);
@@ -462,6 +686,13 @@ class Process : public Entity {
 //! wait until the condition is true (lazy evaluation of condition)
 # define WaitUntil(condition)  while(_WaitUntil(condition)) /*empty body*/;
 #endif
+  //! wait for condition, it is tested only after Notify() of any of signals
+  bool  _WaitUntilOn(bool test, std::initializer_list<Signal*> signals);
+//! wait until the condition is true, condition depends only on objects
+//! with given signals, e.g.:
+//! WaitUntilOn(!F.Busy() && V.Value()>1, F.Changed, V.Changed)
+# define WaitUntilOn(condition, ...) \
+    while(_WaitUntilOn((condition), {__VA_ARGS__})) /*empty body*/;
   void Interrupt(); //!< test of WaitUntil list, allow running others
   virtual void Terminate();             //!< kill process
 
@@ -474,6 +705,30 @@ class Process : public Entity {
   virtual void Into(Queue &q);          //!< insert process into queue
 };
 
+////////////////////////////////////////////////////////////////////////////
+//! Signal of state change for WaitUntilOn.
+//! Processes waiting in WaitUntilOn are registered in signals of objects
+//! the condition depends on; Notify() reactivates them (at current Time)
+//! to test the condition again. Facility, Store and Variable have their
+//! own signals, other objects (user state) can use Signal directly.
+//! Signal with waiting processes can not be deleted during simulation.
+//! \ingroup simlib
+class Signal : public SimObject {
+    Signal(const Signal&);              // disable
+    Signal&operator=(const Signal&);    // disable
+    std::list<Process*> waiting;        // registered processes
+    void Wake();                        // reactivate all waiting processes
+    friend class Process;
+  public:
+    Signal();
+    Signal(const char *name);
+    virtual ~Signal();
+    //! state changed: waiting processes should test their conditions
+    void Notify() { if(!waiting.empty()) Wake(); }
+    unsigned Waiting() const { return waiting.size(); } //!< # of waiting
+    operator Signal* () { return this; }
+};
+
 ////////////////////////////////////////////////////////////////////////////
 //! abstract base class for events
 //! Event behavior is simple function (can not be interrupted)
@@ -497,8 +752,7 @@ class Event : public Entity {
 class Sampler: public Event {
     Sampler(const Sampler&);            //## disable
     Sampler&operator=(const Sampler&);  //## disable
-    static Sampler *First;              // list of objects TODO: use container
-    Sampler *Next;                      // next object
+    Sampler *Next;                      // next object (list in Simulation)
   protected:
     void (*function)(); //!< function to call periodically
     double last;        //!< last sample time -- prevents sample duplication
@@ -556,7 +810,10 @@ class aStat : public SimObject {
 class Stat : public SimObject {
  protected:
   double sx;                    // sum of values
-  double sx2;                   // sum of value square
+  double csx;                   // compensation of sum (Kahan)
+  double shift;                 // first value (shifts values for mean, m2)
+  double mean;                  // running mean of shifted values (Welford)
+  double m2;                    // sum of squared deviations from mean
   double min;                   // min value
   double max;                   // max value
   unsigned long n;              // number of values recorded
@@ -565,17 +822,54 @@ class Stat : public SimObject {
   Stat(const char *name);
   ~Stat();
   virtual void Clear();         //!< initialize
-  void operator () (double x);  //!< record the value
+  //! record the value (virtual: BatchStat can be used via Stat&,
+  //! the cost is one indirect call per record)
+  virtual void operator () (double x);
 // Stat &operator = (Stat &x);  // TODO: copy semantics
-// Stat &operator += (Stat &x); // sum two statistics + template operator +
+  Stat &operator += (const Stat &x); //!< merge statistics (replications, threads)
   virtual void Output() const;  //!< print statistics
   unsigned long Number() const { return n; }
   double Min() const           { /* TODO: test n==0 */ return min; }
   double Max() const           { /* test n==0 */ return max; }
-  double Sum() const           { return sx; }
-  double SumSquare() const     { return sx2; }
+  double Sum() const           { return sx + csx; }
+  double SumSquare() const     { return n ? m2 + Sum()*Sum()/n : 0; }
   double MeanValue() const;
   double StdDev() const;
+  //! half-width of confidence interval of mean value
+  //! (records should be independent, e.g. results of replications)
+  virtual double ConfidenceInterval(double level=0.95) const;
+};
+
+
+////////////////////////////////////////////////////////////////////////////
+//! statistics with confidence interval computed by batch means method
+//! (for correlated values from single long run)
+//! values are grouped into batches of equal size; the number of batches
+//! is kept between k and 2k (two neighbour batches are joined and the
+//! batch size doubled when 2k batches are completed)
+//! \ingroup simlib
+class BatchStat : public Stat {
+  BatchStat(const BatchStat&);            // disable
+  BatchStat&operator=(const BatchStat&);  // disable
+ protected:
+  double *bsum;                 // sums of completed batches (2k items)
+  unsigned k;                   // minimal number of batches
+  unsigned nb;                  // number of completed batches
+  unsigned long bsize;          // batch size
+  double cur;                   // sum of current batch
+  unsigned long ncur;           // number of values in current batch
+ public:
+  BatchStat(unsigned batches=16);
+  BatchStat(const char *name, unsigned batches=16);
+  ~BatchStat();
+  virtual void Clear();         //!< initialize
+  virtual void operator () (double x);  //!< record the value
+  virtual void Output() const;  //!< print statistics
+  unsigned Batches() const        { return nb; }
+  unsigned long BatchSize() const { return bsize; }
+  double BatchMean(unsigned i) const;
+  //! half-width of confidence interval of mean value (batch means)
+  virtual double ConfidenceInterval(double level=0.95) const;
 };
 
 
@@ -585,7 +879,9 @@ class Stat : public SimObject {
 class TStat : public SimObject {
  protected:
   double sxt;                   // sum of x*time
-  double sx2t;                  // sum of squares
+  double csxt;                  // compensation of sum (Kahan)
+  double mt;                    // time-weighted mean value (West)
+  double m2t;                   // time-weighted sum of squared deviations
   double min;                   // min value x
   double max;                   // max value x
   double t0;                    // time of initialization
@@ -595,6 +891,7 @@ class TStat : public SimObject {
   friend class Facility; // needs to correct n -- TODO: remove
   friend class Store;
   friend class Queue;
+  friend class RingQueue;
  public:
   TStat(double initval=0.0);
   TStat(const char *name, double initval=0.0);
@@ -602,15 +899,17 @@ class TStat : public SimObject {
   virtual void Clear(double initval=0.0);        //!< initialize
   virtual void Output() const;          //!< print object to default output
   virtual void operator () (double x);           //!< record the value
+  TStat &operator += (const TStat &x); //!< merge statistics (replications, threads)
   unsigned long Number() const { return n; }
   double Min() const           { /*TODO: only if(n>0)*/ return min; }
   double Max() const           { return max; }
-  double Sum() const           { return sxt; }
-  double SumSquare() const     { return sx2t; }
+  double Sum() const           { return sxt + csxt; }
+  double SumSquare() const     { return m2t + (tl-t0)*mt*mt; }
   double StartTime() const     { return t0; }
   double LastTime() const      { return tl; }
   double LastValue() const     { return xl; }
   double MeanValue() const;
+  double StdDev() const;        //!< time-weighted standard deviation
 };
 
 
@@ -680,6 +979,10 @@ class Queue : public List { // don't inherit interface for now
 //TODO:remove
     friend class Facility;
     friend class Store;
+    struct Index;                       // priority buckets (see queue.cc)
+    Index *index;                       // allocated at first Insert
+    bool IndexIns(Entity *e, unsigned key, int mode);
+    void ServiceIns(Entity *e);         // Facility: service priority first
   public:
     typedef List::iterator iterator;
     TStat StatN;
@@ -711,6 +1014,75 @@ class Queue : public List { // don't inherit interface for now
     Entity *GetLast();
 };
 
+////////////////////////////////////////////////////////////////////////////
+//! priority queue stored in contiguous ring buffer of entity handles
+//! (alternative to Queue for long queues: fast scanning, no pointer chasing)
+//! <br> Interface is compatible with Queue, but entities are not linked
+//! (Entity::Where() is 0). Destroyed entity leaves stale item in the queue,
+//! iterator returns 0 for it and GetFirst/GetLast skip it.
+//! \ingroup simlib
+class RingQueue : public SimObject {
+    RingQueue(const RingQueue&);            // disable
+    RingQueue&operator=(const RingQueue&);  // disable
+    struct Item {               // queue item
+        EntityHandle h;         // entity
+        double time;            // time of insertion (statistics)
+        EntityPriority_t prio;  // priority at insertion
+    };
+    Item *items;                // ring buffer
+    unsigned mask;              // capacity-1 (capacity is power of 2)
+    unsigned first;             // index of first item
+    unsigned n;                 // number of items
+    Item &at(unsigned i) const { return items[(first+i) & mask]; }
+    void Grow();                // double the capacity
+    void Ins(Entity *e, unsigned i);    // insert before position i
+    Entity *Del(unsigned i);            // remove at position i
+  public:
+    //! position in queue (compatible with Queue::iterator)
+    class iterator {
+        const RingQueue *q;
+        unsigned i;             // position (0 = first)
+        friend class RingQueue;
+      public:
+        iterator(const RingQueue *Q, unsigned I): q(Q), i(I) {}
+        iterator &operator++() { ++i; return *this; }
+        iterator &operator--() { --i; return *this; }
+        iterator operator++(int) { iterator t(*this); ++i; return t; }
+        iterator operator--(int) { iterator t(*this); --i; return t; }
+        Entity * operator*() const { return q->at(i).h.get(); }
+        EntityHandle handle() const { return q->at(i).h; } //!< item handle
+        double time() const { return q->at(i).time; } //!< insertion time
+        bool operator != (iterator p) const { return i!=p.i; }
+        bool operator == (iterator p) const { return i==p.i; }
+    };
+    TStat StatN;
+    Stat  StatDT;                       // statistics
+    RingQueue();
+    RingQueue(const char *_name);
+    ~RingQueue();
+    virtual const char *Name() const;
+    virtual void Output() const;        //!< print statistics
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const   { return iterator(this, n); }
+    Entity *front() const  { return n ? at(0).h.get() : 0; }
+    Entity *back() const   { return n ? at(n-1).h.get() : 0; }
+    unsigned size() const  { return n; }
+    bool empty() const     { return n == 0; }
+    void clear();                       //!< initialize
+    // backward COMPATIBILITY (see Queue)
+    void Clear()  { clear(); }
+    bool Empty()  { return empty(); }
+    unsigned Length() { return size(); }
+    void Insert  (Entity *e);           //!< priority insert
+    void InsFirst(Entity *e);           //!< insert at first position
+    void InsLast (Entity *e);           //!< insert at last position
+    void PredIns (Entity *e, iterator pos); //!< insert before pos
+    void PostIns (Entity *e, iterator pos); //!< insert after pos
+    Entity *Get(iterator pos);          //!< remove item (0 if stale)
+    Entity *GetFirst();                 //!< remove first entity
+    Entity *GetLast();                  //!< remove last entity
+};
+
 ////////////////////////////////////////////////////////////////////////////
 //! histogram
 //! statistics
@@ -732,6 +1104,7 @@ class Histogram : public SimObject {
   virtual void Output() const;         //!< print to default output
   void Init(double low, double step, unsigned count);
   void operator () (double x);         // record value x
+  Histogram &operator += (const Histogram &x); //!< merge (replications)
   virtual void Clear();                // initialize (zero) value array
   double Low() const     { return low; }
   double High() const    { return low + step*count; }
@@ -741,6 +1114,44 @@ class Histogram : public SimObject {
 };
 
 
+////////////////////////////////////////////////////////////////////////////
+//! log-linear (HDR-like) histogram
+//! constant relative precision 2^-bits over range low..high:
+//! each binary order of magnitude is split into 2^bits equal intervals
+//! (interval 0 counts values < low, interval Count()+1 values >= high)
+//! \ingroup simlib
+class LogHistogram : public SimObject {
+    LogHistogram(const LogHistogram&);           // disable
+    LogHistogram&operator=(const LogHistogram&); // disable
+ protected:
+  unsigned long *dptr;       // value array
+  double   low;              // low bound
+  double   scale;            // 1/low
+  unsigned bits;             // number of bits of relative precision
+  unsigned exps;             // number of binary orders of magnitude
+  unsigned count;            // number of intervals (exps << bits)
+ public:
+  Stat     stat;             // statistics
+  LogHistogram(double low=1e-6, double high=1e9, unsigned bits=7);
+  LogHistogram(const char *_name, double low=1e-6, double high=1e9,
+               unsigned bits=7);
+  ~LogHistogram();
+  virtual void Output() const;         //!< print to default output
+  void Init(double low, double high, unsigned bits);
+  void operator () (double x);         //!< record value x
+  void Record(const double *x, unsigned long n); //!< record n values
+  LogHistogram &operator += (const LogHistogram &x); //!< merge (replications)
+  virtual void Clear();                //!< initialize (zero) value array
+  double Percentile(double p) const;   //!< value under which p % of records
+  double Low() const     { return low; }
+  double High() const    { return From(count+1); }
+  unsigned Bits() const  { return bits; }
+  unsigned Count() const { return count; }
+  double From(unsigned i) const;       //!< low bound of interval[i]
+  unsigned long operator [](unsigned i) const; //!< # of items in interval[i]
+};
+
+
 
 ////////////////////////////////////////////////////////////////////////////
 //! (SOL-like) facility
@@ -755,6 +1166,7 @@ class Facility : public SimObject {
   Queue  *Q1;                //!< input queue
   Queue  *Q2;                //!< interrupted requests queue
   TStat tstat;               // stat
+  Signal Changed;            //!< state change (for WaitUntilOn)
   Facility();
   Facility(const char *_name);
   Facility(Queue *_queue1);
@@ -787,6 +1199,7 @@ class Store : public SimObject {
  public:
   Queue *Q;                     //!< input queue
   TStat tstat;                  //!< usage statistics
+  Signal Changed;               //!< state change (for WaitUntilOn)
   Store();
   Store(unsigned long _capacity);
   Store(const char *_name, unsigned long _capacity);
@@ -838,6 +1251,9 @@ class aContiBlock : public aBlock {
     //! get block output value <br>
     //! this method should be defined in classes derived from aContiBlock
     virtual double Value() = 0;
+    //! add block to evaluation tape, return its register (internal) <br>
+    //! default: tape calls Value()
+    virtual unsigned Compile(SIMLIB_Tape &t);
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -848,6 +1264,7 @@ class Constant : public aContiBlock {
  public:
   Constant(double x) : value(x) {}
   virtual double Value ()       { return value; }
+  virtual unsigned Compile(SIMLIB_Tape &t);
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -856,9 +1273,13 @@ class Constant : public aContiBlock {
 class Variable : public aContiBlock {
   double value;
  public:
+  Signal Changed;               //!< value change (for WaitUntilOn)
   Variable(double x=0) : value(x) {}
-  Variable &operator= (double x)  { value = x; return *this; }
+  Variable &operator= (double x)  {
+    value = x; Changed.Notify(); return *this;
+  }
   virtual double Value ()         { return value; }
+  virtual unsigned Compile(SIMLIB_Tape &t);
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -870,6 +1291,7 @@ class Parameter : public aContiBlock {
   Parameter(double x) : value(x) {}
   Parameter &operator= (double x) { value = x; return *this; }
   virtual double Value ()         { return value; }
+  virtual unsigned Compile(SIMLIB_Tape &t);
 };
 
 
@@ -893,6 +1315,7 @@ class Parameter : public aContiBlock {
 class Input {
   aContiBlock *bp;
   Input(); // disable default constructor
+  friend class SIMLIB_Tape;
  public:
   //! transparent copy of block reference
   Input(const Input &i): bp(i.bp) { RegisterReference(bp); }
@@ -939,6 +1362,7 @@ class aContiBlock1 : public aContiBlock {
  public:
   aContiBlock1(Input i);
   double InputValue() { return input.Value(); }
+  unsigned CompileInput(SIMLIB_Tape &t);  // input to evaluation tape
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -948,6 +1372,7 @@ class aContiBlock1 : public aContiBlock {
 struct Expression : public aContiBlock1 {
   Expression(Input i) : aContiBlock1(i) {}
   double Value();       //!< Evaluate expression and return the value
+  virtual unsigned Compile(SIMLIB_Tape &t);
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -960,6 +1385,8 @@ class aContiBlock2 : public aContiBlock {
   aContiBlock2(Input i1, Input i2);
   double Input1Value() { return input1.Value(); }
   double Input2Value() { return input2.Value(); }
+  unsigned CompileInput1(SIMLIB_Tape &t); // inputs to evaluation tape
+  unsigned CompileInput2(SIMLIB_Tape &t);
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -974,6 +1401,36 @@ class aContiBlock3 : public aContiBlock {
   double Input1Value() { return input1.Value(); }
   double Input2Value() { return input2.Value(); }
   double Input3Value() { return input3.Value(); }
+  unsigned CompileInput1(SIMLIB_Tape &t); // inputs to evaluation tape
+  unsigned CompileInput2(SIMLIB_Tape &t);
+  unsigned CompileInput3(SIMLIB_Tape &t);
+};
+
+
+////////////////////////////////////////////////////////////////////////////
+//! IntegratorArrays - states of all integrators (in Simulation context)
+//! Integrator number i (in order of creation) uses element i of each
+//! array, the arrays are contiguous and aligned, so that integration
+//! methods can update the whole system in simple loops
+//! IntegratorVector uses a range of elements (items[i] is 0 there)
+//TODO: move to implementation header
+class IntegratorArrays {
+    IntegratorArrays(const IntegratorArrays&); // ## disable
+    IntegratorArrays&operator=(const IntegratorArrays&); // ## disable
+    double *mem;                // allocated memory (all four arrays)
+    size_t capacity;            // allocated size of each array
+ public:
+    Integrator **items;         // integrators (0 = slot of vector)
+    size_t n;                   // # of integrators
+    std::list<IntegratorVector*> vectors; // blocks with ranges of slots
+    double *ss;                 // status: y
+    double *dd;                 // input value: y'=f(t,y)
+    double *ssl;                // status from previous step
+    double *ddl;                // input value from previous step
+    SIMLIB_Tape *tape;          // compiled inputs (0 = not compiled)
+    IntegratorArrays();
+    ~IntegratorArrays();
+    void Reserve(size_t size);  // allocate arrays for size integrators
 };
 
 
@@ -982,31 +1439,37 @@ class aContiBlock3 : public aContiBlock {
 //TODO: move to implementation header
 class IntegratorContainer {
 private:
-  static std::list<Integrator*> * ListPtr;  // list of integrators
+  static IntegratorArrays *& ListPtr(void);  // arrays (in Simulation context)
   IntegratorContainer();  // forbid constructor
-  static std::list<Integrator*> * Instance(void);  // return list (& create)
+  static IntegratorArrays * Instance(void);  // return arrays (& create)
+  static void RemoveSlots(IntegratorArrays *a, size_t first, size_t count);
 public:
-  typedef std::list<Integrator*>::iterator iterator;
-  // is there any integrator in the list? (e.g. list is not empty)
-  static bool isAny(void) {
-    return ListPtr!=0 && !(ListPtr->empty());
-  }
-  // # of elements in the list
-  static size_t Size(void) {
-    return (ListPtr!=0) ? (ListPtr->size()) : 0;
-  }
-  // return iterator to the first element
+  typedef Integrator **iterator;
+  // is there any integrator in the container?
+  static bool isAny(void);
+  // # of elements in the container
+  static size_t Size(void);
+  // return iterator to the first element (WARNING: slots of vectors are 0)
   static iterator Begin(void) {
-    return Instance()->begin();
+    return Instance()->items;
   }
   // return iterator to the end (not to the last element!)
   static iterator End(void) {
-    return Instance()->end();
+    IntegratorArrays *a = Instance();
+    return a->items + a->n;
   }
-  static iterator Insert(Integrator* ptr);  // insert element into container
-  static void Erase(iterator it);  // exclude element
+  // arrays of states, element i belongs to integrator Begin()[i]
+  static double *State(void)    { return Instance()->ss; }
+  static double *Diff(void)     { return Instance()->dd; }
+  static double *OldState(void) { return Instance()->ssl; }
+  static double *OldDiff(void)  { return Instance()->ddl; }
+  static void Insert(Integrator* ptr);  // insert element into container
+  static void Erase(Integrator* ptr);   // exclude element
+  static void Insert(IntegratorVector* ptr, size_t count); // range of slots
+  static void Erase(IntegratorVector* ptr);
   static void InitAll();           // initialize all
-  static void EvaluateAll();       // evaluate all integrators
+  static void EvaluateAll();       // evaluate all integrators and vectors
+  static SIMLIB_Tape *Tape();      // compiled inputs (0 if not used)
   static void LtoN();              // last -> now
   static void NtoL();              // now -> last
 }; // class IntegratorContainer
@@ -1017,19 +1480,15 @@ public:
 //TODO: move to implementation header
 class StatusContainer {
 private:
-  static std::list<Status*>* ListPtr;  // list of integrators
+  static std::list<Status*> *& ListPtr(void);  // list (in Simulation context)
   StatusContainer();  // forbid constructor
   static std::list<Status*>* Instance(void);  // return list (& create)
 public:
   typedef std::list<Status*>::iterator iterator;
   // is there any integrator in the list? (e.g. list is not empty)
-  static bool isAny(void) {
-    return ListPtr!=0 && !(ListPtr->empty());
-  }
+  static bool isAny(void);
   // # of elements in the list
-  static size_t Size(void) {
-    return (ListPtr!=0) ? (ListPtr->size()) : 0;
-  }
+  static size_t Size(void);
   // return iterator to the first element
   static iterator Begin(void) {
     return Instance()->begin();
@@ -1056,8 +1515,10 @@ class IntegrationMethod {
     IntegrationMethod(const IntegrationMethod&); // ## disable
     IntegrationMethod&operator=(const IntegrationMethod&); // ## disable
 private:
-  static IntegrationMethod* CurrentMethodPtr;  // method used at present
-  static std::list<IntegrationMethod*>* MthLstPtr; // list of registrated methods
+  // Note: static members are thread-local (see class Simulation)
+  static thread_local IntegrationMethod* CurrentMethodPtr;  // method used at present
+  static thread_local std::list<IntegrationMethod*>* MthLstPtr; // list of registrated methods
+  static IntegrationMethod* CurrentMethod(void);  // method used (& create all)
   std::list<IntegrationMethod*>::iterator ItList;  // position in the list
   const char* method_name;  // C-string --- the name of the method
 protected:  //## repair
@@ -1066,14 +1527,14 @@ protected:  //## repair
 private:   //## repair
   size_t PrevINum;  // # of integrators in previous step
   std::list<Memory*> MList;  // list of auxiliary memories
-  static std::list<Memory*> * PtrMList;  // pointer to list being filled
+  static thread_local std::list<Memory*> * PtrMList;  // pointer to list being filled
   IntegrationMethod();  // forbid implicit constructor
   IntegrationMethod(IntegrationMethod&);  // forbid implicit copy-constructor
   static bool Prepare(void);  // prepare system for integration step
   static void Iterate(void);  // compute new values of state blocks
   static void Summarize(void);  // set up new state after integration
 protected:
-  static bool IsEndStepEvent; // flag - will be event at the end of the step?
+  static thread_local bool IsEndStepEvent; // flag - will be event at the end of the step?
   typedef IntegratorContainer::iterator Iterator;  // iterator of intg. list
   static Iterator FirstIntegrator(void) {  // it. to first integrator in list
     return IntegratorContainer::Begin();
@@ -1118,33 +1579,38 @@ public:
   virtual void Resize(size_t size);  // resize all memories to given size
   static void StepSim(void);  // single step of numerical integration method
   static void IntegrationDone(void) {  // terminate integration
-    CurrentMethodPtr->TurnOff();  // suspend present method
+    CurrentMethod()->TurnOff();  // suspend present method
   }
   static void SetMethod(const char* name);  // set method which will be used
   static const char* GetMethod(void) {  // get name of method which is used
-    return CurrentMethodPtr->method_name;
+    return CurrentMethod()->method_name;
   }
   // auxiliary functions (interface) for user to add own method
   static void InitStep(double step_frag); // initialize step
   static void FunCall(double step_frag); // evaluate y'(t) = f(t, y(t))
+  // dense output: interpolated states inside the last step (default:
+  // cubic Hermite polynomial of y, y' at start and end of step)
+  virtual void DenseOutput(double step_frag, const double *yend, double *y);
+  static void DenseState(double step_frag); // set model state inside step
+  static void EndState(void);  // restore state at the end of step
   static void SetOptStep(double opt_step) { // set optimal step size
-    extern double SIMLIB_OptStep; // available without including internal.h
+    extern thread_local double SIMLIB_OptStep; // available without including internal.h
     SIMLIB_OptStep = opt_step;
   }
   static void SetStepSize(double step_size) { // set step size
-    extern double SIMLIB_StepSize; // available without including internal.h
+    extern thread_local double SIMLIB_StepSize; // available without including internal.h
     SIMLIB_StepSize = step_size;
   }
   static bool IsConditionFlag(void) { // wer any changes of condition vector?
-    extern bool SIMLIB_ConditionFlag; // available without ... blah, blah
+    extern thread_local bool SIMLIB_ConditionFlag; // available without ... blah, blah
     return SIMLIB_ConditionFlag;
   }
   static int GetErrNo(void) { // return # of errors
-    extern int SIMLIB_ERRNO;
+    extern thread_local int SIMLIB_ERRNO;
     return SIMLIB_ERRNO;
   }
   static void SetErrNo(int num) { // set # of errors
-    extern int SIMLIB_ERRNO;
+    extern thread_local int SIMLIB_ERRNO;
     SIMLIB_ERRNO = num;
   }
 }; // class IntegrationMethod
@@ -1212,7 +1678,7 @@ private:
   StatusMethod(StatusMethod&);  // forbid implicit copy-constructor
   size_t PrevStatusNum;  // # of status variables in previous step
   std::list<Memory*> StatusMList;  // list of auxiliary memories
-  static std::list<Memory*>* PtrStatusMList;  // pointer to list being filled
+  static thread_local std::list<Memory*>* PtrStatusMList;  // pointer to list being filled
 protected:
   typedef StatusContainer::iterator StatusIterator;  // iterator of intg. list
   static StatusIterator FirstStatus(void) {  // it. to first status in list
@@ -1262,7 +1728,8 @@ public:
 //
 
 //! select the integration method
-//! @param name  "abm4", "euler", "fw", "rke"(default), "rkf3", "rkf5", "rkf8"
+//! @param name  "abm4", "bdf2", "euler", "fw", "rke"(default), "rkf3", "rkf5",
+//!               "rkf8", "ros23" (bdf2 and ros23 are for stiff systems)
 //! \ingroup simlib
 inline void SetMethod(const char* name)
 {
@@ -1313,15 +1780,14 @@ inline const char* GetStarter(void)
 class Integrator : public aContiBlock {   // integrator
  private:
   Integrator &operator= (const Integrator &x); // disable assignment
-  double dd;                           // input value: y'=f(t,y)
-  double ddl;                          // the same from previous step
-  double ss;                           // status: y = S f(t,y) dt
-  double ssl;                          // the same from previous step
+  IntegratorArrays *arrays;            // status y, input y' and saved values
+  size_t slot;                         // index to arrays
+  friend class IntegratorContainer;
+  friend class SIMLIB_Tape;
  protected:
   Input input;                         //!< input expression: f(t,y)
   double initval;                      //!< initial value: y(t0)
   void CtrInit();
-  IntegratorContainer::iterator it_list; //!< position in list of integrators
  public:
   Integrator();                        // implicit CTR (input = 0)
   Integrator(Input i, double initvalue=0);
@@ -1332,24 +1798,58 @@ class Integrator : public aContiBlock {   // integrator
   void Set(double value);              // set integrator state value
   //! set integrator state value
   Integrator &operator= (double x) { Set(x); return *this; }
-  //! set integrator input block expression
-  Input SetInput(Input inp) { return input.Set(inp); }
+  Input SetInput(Input inp);           // set input block expression
   void Eval();                         // integrator input evaluation
   double Value();                      //!< the state of integrator
+  virtual unsigned Compile(SIMLIB_Tape &t);
   double InputValue() { return input.Value(); } //!< current input value
   virtual const char *Name() const;
 
   // private interface
-  void Save(void) { ddl=dd; ssl=ss; }     // save status
-  void Restore(void) { dd=ddl; ss=ssl; }  // restore saved status
-  void SetState(double s) { ss=s; }
-  double GetState(void) { return ss; }
-  void SetOldState(double s) { ssl=s; }
-  double GetOldState(void) { return ssl; }
-  void SetDiff(double d) { dd=d; }
-  double GetDiff(void) { return dd; }
-  void SetOldDiff(double d) { ddl=d; }
-  double GetOldDiff(void) { return ddl; }
+  void Save(void) {                       // save status
+    arrays->ddl[slot]=arrays->dd[slot]; arrays->ssl[slot]=arrays->ss[slot];
+  }
+  void Restore(void) {                    // restore saved status
+    arrays->dd[slot]=arrays->ddl[slot]; arrays->ss[slot]=arrays->ssl[slot];
+  }
+  void SetState(double s) { arrays->ss[slot]=s; }
+  double GetState(void) { return arrays->ss[slot]; }
+  void SetOldState(double s) { arrays->ssl[slot]=s; }
+  double GetOldState(void) { return arrays->ssl[slot]; }
+  void SetDiff(double d) { arrays->dd[slot]=d; }
+  double GetDiff(void) { return arrays->dd[slot]; }
+  void SetOldDiff(double d) { arrays->ddl[slot]=d; }
+  double GetOldDiff(void) { return arrays->ddl[slot]; }
+};
+
+
+////////////////////////////////////////////////////////////////////////////
+//! vector of integrators without Integrator objects
+//! abstract base for blocks with many states (e.g. spatially discretized
+//! partial differential equations): the block owns a contiguous range
+//! of integrator slots and computes all its derivatives by one Eval()
+//! call, all integration methods can be used
+//! \ingroup simlib
+class IntegratorVector : public aBlock {
+  IntegratorVector(const IntegratorVector&);  // disable copy ctor
+  void operator= (const IntegratorVector&);   // disable assignment
+  IntegratorArrays *arrays;            // states (see IntegratorContainer)
+  size_t first;                        // index of the first state
+  size_t count;                        // # of states
+  friend class IntegratorContainer;
+ protected:
+  // states and derivatives (pointers are valid during the step only)
+  double *State() { return arrays->ss + first; } //!< y[0..Size()-1]
+  double *Diff()  { return arrays->dd + first; } //!< y'[0..Size()-1]
+ public:
+  explicit IntegratorVector(size_t n); // n states
+  virtual ~IntegratorVector();
+  size_t Size() const { return count; }   //!< # of states
+  double Value(size_t i);                 // state i
+  void Set(size_t i, double value);       // set state i (step change)
+  unsigned CompileState(SIMLIB_Tape &t, size_t i); // state i to tape
+  virtual void Init() = 0;             //!< set initial states
+  virtual void Eval() = 0;             //!< compute all derivatives
 };
 
 
@@ -1482,6 +1982,7 @@ class Function1 : public aContiBlock1 {
  public:
   Function1(Input i, double (*pf)(double));
   virtual double Value();
+  virtual unsigned Compile(SIMLIB_Tape &t);
   virtual const char *Name() const;
 };
 
@@ -1496,6 +1997,7 @@ class Function2 : public aContiBlock2 {
  public:
   Function2(Input i1, Input i2, double (*pf)(double,double));
   virtual double Value();
+  virtual unsigned Compile(SIMLIB_Tape &t);
   virtual const char *Name() const;
 };
 
@@ -1509,8 +2011,7 @@ class Function2 : public aContiBlock2 {
 //! changes its boolean value
 //! \ingroup simlib
 class aCondition : public aBlock {
-  static aCondition *First;            // list of all conditions
-  aCondition *Next;                    // next condition in list
+  aCondition *Next;                    // next condition (list in Simulation)
   void operator= (aCondition&);        // disable operation
   aCondition(aCondition&);             // disable operation
  public:
@@ -1537,6 +2038,7 @@ class Condition : public aCondition {  // state condition
   unsigned char ccl;                   // old state
   virtual void Init();
   virtual void SetNewStatus();
+  void Locate(double value);           // find crossing inside step
  protected:
   virtual bool Test();                  // test function (input >= 0.0)
   bool Up()     { return ccl<cc; }      // change: FALSE->TRUE
@@ -1847,7 +2349,7 @@ struct SIMLIB_statistics_t {
 };
 
 //! interface to internal run-time statistics structure
-extern const SIMLIB_statistics_t & SIMLIB_statistics;
+extern thread_local const SIMLIB_statistics_t & SIMLIB_statistics;
 
 } // namespace simlib3
 
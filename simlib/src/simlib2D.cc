@@ -32,59 +32,9 @@ namespace simlib3 {
 SIMLIB_IMPLEMENTATION;
 
 ////////////////////////////////////////////////////////////////////////////
-// non-block operations
+// non-block operations are inline (see simlib2D.h)
 //
 
-double abs(const Value2D &a)
-{
-    return sqrt( a._x * a._x + a._y * a._y );
-}
-
-Value2D operator +(const Value2D& a, const Value2D &b)
-{
-  return Value2D( a._x + b._x,  a._y + b._y );
-}
-
-Value2D operator -(const Value2D& a, const Value2D &b)
-{
-  return Value2D( a._x - b._x,  a._y - b._y );
-}
-
-Value2D operator -(const Value2D& a)
-{
-  return Value2D( -a._x, -a._y);
-}
-
-/*
-Value2D operator *(const Value2D& a, const Value2D &b)
-{
-  return Value2D( a._y * b._z - a._z * b._y,
-                  a._z * b._x - a._x * b._z,
-                  a._x * b._y - a._y * b._x
-                );
-}
-*/
-
-Value2D operator *(const Value2D& a, const double b)
-{
-  return Value2D( a._x * b,  a._y * b );
-}
-
-Value2D operator *(const double a, const Value2D& b)
-{
-  return b * a;
-}
-
-double scalar_product(const Value2D& a, const Value2D &b)
-{
-    return a._x * b._x + a._y * b._y ;
-}
-
-Value2D operator /(const Value2D& a, const double b)
-{
-  return Value2D( a._x / b,  a._y / b );
-}
-
 
 ////////////////////////////////////////////////////////////////////////////
 // aContiBlock2D --- constructor & destructor
@@ -23,33 +23,61 @@
 #   error "simlib2D.h: 23: requires SIMLIB version 2.12 and higher"
 #endif
 
+#include <cmath>
+
 namespace simlib3 {
 
 ////////////////////////////////////////////////////////////////////////////
 //! 2D vector value
+//! packed in 2 aligned lanes (x, y): operations are inline (SIMD)
 //! \ingroup simlib2D
 class Value2D {
-  double _x, _y;
+  alignas(2*sizeof(double)) double v[2];  // x, y
+  Value2D() {}                  // uninitialized (operations only)
  public:
-  Value2D(double x, double y) : _x(x), _y(y) {}
-  double x() const { return _x; }
-  double y() const { return _y; }
+  Value2D(double x, double y) { v[0]=x; v[1]=y; }
+  double x() const { return v[0]; }
+  double y() const { return v[1]; }
 
   // using default copy constructor, destructor, and operator =
 
-  Value2D operator + (Value2D b) { return Value2D(_x+b._x, _y+b._y); }
-  Value2D operator - (Value2D b) { return Value2D(_x-b._x, _y-b._y); }
-  void Print() { ::Print(" %g %g ", _x, _y); }
+  void Print() { ::Print(" %g %g ", v[0], v[1]); }
 
   // utilities:
-  friend double abs(const Value2D &a);
-  friend Value2D operator +(const Value2D& a, const Value2D &b);
-  friend Value2D operator -(const Value2D& a, const Value2D &b);
-  friend Value2D operator -(const Value2D& a);
-  friend Value2D operator *(const Value2D& a, const double b);
-  friend Value2D operator *(const double a, const Value2D& b);
-  friend double scalar_product(const Value2D& a, const Value2D &b);
-  friend Value2D operator /(const Value2D& a, const double b);
+  friend double abs(const Value2D &a) {
+    return std::sqrt(scalar_product(a, a));
+  }
+  friend Value2D operator +(const Value2D& a, const Value2D &b) {
+    Value2D r;
+    for(int i=0; i<2; i++) r.v[i] = a.v[i] + b.v[i];
+    return r;
+  }
+  friend Value2D operator -(const Value2D& a, const Value2D &b) {
+    Value2D r;
+    for(int i=0; i<2; i++) r.v[i] = a.v[i] - b.v[i];
+    return r;
+  }
+  friend Value2D operator -(const Value2D& a) {
+    Value2D r;
+    for(int i=0; i<2; i++) r.v[i] = -a.v[i];
+    return r;
+  }
+  friend Value2D operator *(const Value2D& a, const double b) {
+    Value2D r;
+    for(int i=0; i<2; i++) r.v[i] = a.v[i] * b;
+    return r;
+  }
+  friend Value2D operator *(const double a, const Value2D& b) {
+    return b * a;
+  }
+  friend double scalar_product(const Value2D& a, const Value2D &b) {
+    return a.v[0] * b.v[0] + a.v[1] * b.v[1];
+  }
+  friend Value2D operator /(const Value2D& a, const double b) {
+    Value2D r;
+    for(int i=0; i<2; i++) r.v[i] = a.v[i] / b;
+    return r;
+  }
 
 };
 
@@ -32,57 +32,9 @@ namespace simlib3 {
 SIMLIB_IMPLEMENTATION;
 
 ////////////////////////////////////////////////////////////////////////////
-// non-block operations
+// non-block operations are inline (see simlib3D.h)
 //
 
-double abs(const Value3D &a)
-{
-    return sqrt( a._x * a._x + a._y * a._y + a._z * a._z );
-}
-
-Value3D operator +(const Value3D& a, const Value3D &b)
-{
-  return Value3D( a._x + b._x,  a._y + b._y,  a._z + b._z );
-}
-
-Value3D operator -(const Value3D& a, const Value3D &b)
-{
-  return Value3D( a._x - b._x,  a._y - b._y,  a._z - b._z );
-}
-
-Value3D operator -(const Value3D& a)
-{
-  return Value3D( -a._x, -a._y, -a._z);
-}
-
-Value3D operator *(const Value3D& a, const Value3D &b)
-{
-  return Value3D( a._y * b._z - a._z * b._y,
-                  a._z * b._x - a._x * b._z,
-                  a._x * b._y - a._y * b._x
-                );
-}
-
-Value3D operator *(const Value3D& a, const double b)
-{
-  return Value3D( a._x * b,  a._y * b,  a._z * b );
-}
-
-Value3D operator *(const double a, const Value3D& b)
-{
-  return b * a;
-}
-
-double scalar_product(const Value3D& a, const Value3D &b)
-{
-    return a._x * b._x + a._y * b._y + a._z * b._z;
-}
-
-Value3D operator /(const Value3D& a, const double b)
-{
-  return Value3D( a._x / b,  a._y / b,  a._z / b );
-}
-
 
 ////////////////////////////////////////////////////////////////////////////
 // aContiBlock3D --- constructor & destructor
@@ -215,6 +167,65 @@ Integrator3D &Integrator3D::operator = (Input3D i)
     return *this;
 }
 
+////////////////////////////////////////////////////////////////////////////
+// Integrator3DArray --- constructor & destructor
+//
+Integrator3DArray::Integrator3DArray(size_t k):
+    IntegratorVector(3*k),
+    in(k, Input3D(Zero3D)),
+    initval(k, Value3D(0,0,0)),
+    out(k)
+{
+  Dprintf(("Integrator3DArray[%p]::Integrator3DArray(%lu)",
+           this, (unsigned long)k));
+  for(size_t i=0; i<k; i++)
+    out[i] = new Element(*this, i);
+}
+
+Integrator3DArray::~Integrator3DArray()
+{
+  for(size_t i=0; i<out.size(); i++)
+    delete out[i];
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Integrator3DArray --- inputs and initial values
+//
+Input3D Integrator3DArray::SetInput(size_t k, Input3D i)
+{
+  return in[k].Set(i);
+}
+
+void Integrator3DArray::Init(size_t k, const Value3D &v)
+{
+  initval[k] = v;
+  Set(k, v);
+}
+
+void Integrator3DArray::Init()
+{
+  for(size_t k=0; k<Count(); k++) {
+    double *y = State() + 3*k;
+    y[0] = initval[k].x(); y[1] = initval[k].y(); y[2] = initval[k].z();
+  }
+}
+
+void Integrator3DArray::Set(size_t k, const Value3D &v)
+{
+  IntegratorVector::Set(3*k,   v.x());
+  IntegratorVector::Set(3*k+1, v.y());
+  IntegratorVector::Set(3*k+2, v.z());
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Integrator3DArray::Eval --- one evaluation of each 3D input
+//
+void Integrator3DArray::Eval()
+{
+  for(size_t k=0, n=Count(); k<n; k++)
+    SetDiff(k, in[k].Value());
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  aContiBlock2 --- base for 2 input blocks
 //
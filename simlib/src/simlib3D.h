@@ -23,35 +23,74 @@
 #   error "simlib3D.h: 22: requires SIMLIB version 2.12 and higher"
 #endif
 
+#include <cmath>
+#include <vector>
+
 namespace simlib3 {
 
 ////////////////////////////////////////////////////////////////////////////
 //! 3D vector value
+//! packed in 4 aligned lanes (x, y, z, 0): all operations are inline
+//! loops over lanes, the compiler can use SIMD instructions
 //! \ingroup simlib3D
 class Value3D {
-  double _x, _y, _z;
+  alignas(4*sizeof(double)) double v[4];  // x, y, z, 0
+  Value3D() {}                  // uninitialized (operations only)
  public:
-  Value3D(double x, double y, double z) : _x(x), _y(y), _z(z) {}
-  double x() const { return _x; }
-  double y() const { return _y; }
-  double z() const { return _z; }
+  Value3D(double x, double y, double z) { v[0]=x; v[1]=y; v[2]=z; v[3]=0; }
+  double x() const { return v[0]; }
+  double y() const { return v[1]; }
+  double z() const { return v[2]; }
 
   // using default copy constructor, destructor, and operator =
 
-  Value3D operator + (Value3D b) { return Value3D(_x+b._x, _y+b._y, _z+b._z); }
-  Value3D operator - (Value3D b) { return Value3D(_x-b._x, _y-b._y, _z-b._z); }
-  void Print() { ::Print(" %g %g %g ", _x, _y, _z); }
+  void Print() { ::Print(" %g %g %g ", v[0], v[1], v[2]); }
 
   // utilities:
-  friend double abs(const Value3D &a);
-  friend Value3D operator +(const Value3D& a, const Value3D &b);
-  friend Value3D operator -(const Value3D& a, const Value3D &b);
-  friend Value3D operator -(const Value3D& a);
-  friend Value3D operator *(const Value3D& a, const Value3D &b);
-  friend Value3D operator *(const Value3D& a, const double b);
-  friend Value3D operator *(const double a, const Value3D& b);
-  friend double scalar_product(const Value3D& a, const Value3D &b);
-  friend Value3D operator /(const Value3D& a, const double b);
+  friend double abs(const Value3D &a) {
+    return std::sqrt(scalar_product(a, a));
+  }
+  friend Value3D operator +(const Value3D& a, const Value3D &b) {
+    Value3D r;
+    for(int i=0; i<4; i++) r.v[i] = a.v[i] + b.v[i];
+    return r;
+  }
+  friend Value3D operator -(const Value3D& a, const Value3D &b) {
+    Value3D r;
+    for(int i=0; i<4; i++) r.v[i] = a.v[i] - b.v[i];
+    return r;
+  }
+  friend Value3D operator -(const Value3D& a) {
+    Value3D r;
+    for(int i=0; i<4; i++) r.v[i] = -a.v[i];
+    return r;
+  }
+  //! vector product
+  friend Value3D operator *(const Value3D& a, const Value3D &b) {
+    return Value3D( a.v[1] * b.v[2] - a.v[2] * b.v[1],
+                    a.v[2] * b.v[0] - a.v[0] * b.v[2],
+                    a.v[0] * b.v[1] - a.v[1] * b.v[0] );
+  }
+  friend Value3D operator *(const Value3D& a, const double b) {
+    Value3D r;
+    for(int i=0; i<4; i++) r.v[i] = a.v[i] * b;
+    r.v[3] = 0;                 // also for b==inf
+    return r;
+  }
+  friend Value3D operator *(const double a, const Value3D& b) {
+    return b * a;
+  }
+  friend double scalar_product(const Value3D& a, const Value3D &b) {
+    double s = 0;
+    for(int i=0; i<4; i++) s += a.v[i] * b.v[i];  // v[3] is 0
+    return s;
+  }
+  friend Value3D operator /(const Value3D& a, const double b) {
+    Value3D r;
+    for(int i=0; i<4; i++) r.v[i] = a.v[i] / b;
+    r.v[3] = 0;                 // also for b==0
+    return r;
+  }
 
 };
 
@@ -212,6 +251,85 @@ class Integrator3D : public aContiBlock3D {
 };
 
 
+////////////////////////////////////////////////////////////////////////////
+//! array of 3D vector integrators
+//! K elements are stored contiguously in one IntegratorVector (x, y, z of
+//! element k are states 3k, 3k+1, 3k+2), each input is evaluated once per
+//! step stage. Derived classes can redefine Eval() to compute inputs of
+//! all elements in one loop (e.g. forces of N-body system).
+//! \ingroup simlib3D
+class Integrator3DArray : public IntegratorVector {
+  Integrator3DArray(const Integrator3DArray&);  // disable copy ctor
+  void operator= (const Integrator3DArray&);    // disable assignment
+ public:
+  //! output block of one element
+  class Element : public aContiBlock3D {
+    Integrator3DArray &a;
+    size_t k;
+   public:
+    Element(Integrator3DArray &array, size_t index) : a(array), k(index) {}
+    virtual Value3D Value() { return a.Get(k); }
+  };
+ protected:
+  std::vector<Input3D> in;             //!< inputs of elements
+  std::vector<Value3D> initval;        //!< initial values
+  std::vector<Element*> out;           //!< output blocks
+  //! set derivative of element k (for redefined Eval)
+  void SetDiff(size_t k, const Value3D &d) {
+    double *dy = Diff() + 3*k;
+    dy[0] = d.x(); dy[1] = d.y(); dy[2] = d.z();
+  }
+ public:
+  explicit Integrator3DArray(size_t k); // k elements, input (0,0,0)
+  ~Integrator3DArray();
+  size_t Count() const { return Size()/3; } //!< # of elements
+  Input3D SetInput(size_t k, Input3D i);    // input of element k
+  void Init(size_t k, const Value3D &v);    // initial value of element k
+  virtual void Init();                      // set initial values
+  virtual void Eval();                      // evaluate all inputs
+  //! state of element k
+  Value3D Get(size_t k) {
+    const double *y = State() + 3*k;
+    return Value3D(y[0], y[1], y[2]);
+  }
+  void Set(size_t k, const Value3D &v);     // step change of element k
+  using IntegratorVector::Set;
+  aContiBlock3D &operator[](size_t k) { return *out[k]; } //!< output
+};
+
+
+////////////////////////////////////////////////////////////////////////////
+//! N-body system with gravity (Barnes-Hut octree algorithm)
+//! elements 0..N-1 of the array are positions of bodies, N..2N-1 their
+//! velocities, accelerations are computed by octree built again for each
+//! evaluation: O(N log N). Distant groups of bodies are replaced by their
+//! center of mass if size/distance < theta (theta=0: exact O(N^2) sum),
+//! groups containing the body itself are never replaced.
+//! \ingroup simlib3D
+class NBody3D : public Integrator3DArray {
+  struct Tree;                         // octree (implementation)
+  Tree *tree;
+  size_t n;                            // # of bodies
+  std::vector<double> mass;            // masses of bodies
+  double G;                            // gravity constant
+  double theta;                        // opening angle
+  double eps2;                         // softening^2
+ public:
+  explicit NBody3D(size_t bodies, double gravity_constant=6.67e-11);
+  ~NBody3D();
+  size_t Bodies() const { return n; }  //!< # of bodies
+  void Init(size_t k, double m, const Value3D &p, const Value3D &v);
+  using Integrator3DArray::Init;
+  void SetTheta(double t) { theta = t; }      //!< opening angle (0.5)
+  void SetSoftening(double e) { eps2 = e*e; } //!< for close bodies (0)
+  aContiBlock3D &Position(size_t k) { return (*this)[k]; }   //!< output
+  aContiBlock3D &Velocity(size_t k) { return (*this)[n+k]; } //!< output
+  void Accelerations(std::vector<Value3D> &a); // for current positions
+  double Energy();                     // kinetic + potential (O(N^2))
+  virtual void Eval();                 // p' = v, v' = a(p)
+};
+
+
 ////////////////////////////////////////////////////////////////////////////
 // Continuous block arithmetic operators
 //
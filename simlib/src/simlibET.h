@@ -0,0 +1,233 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file  simlibET.h   expression templates for continuous blocks
+//! \defgroup simlibET  SIMLIB/C++ expression templates
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  Block expressions (x*y + Sin(z)) create one heap object for each
+//  operator and evaluate them by virtual Value() calls. For models with
+//  fixed structure the same syntax can be resolved at compile time:
+//  operands wrapped by ET() build a single functor type, which is
+//  evaluated by inline code. ETInput() converts it to a single block,
+//  so it can be used as an input of any SIMLIB block:
+//
+//      Integrator x, v;
+//      Parameter k(2), m(1);
+//      v.SetInput(ETInput(-ET(k)/ET(m)*ET(x) - 0.1*ET(v)));
+//      x.SetInput(v);
+//
+//  Any block (including dynamic expressions) can be used as operand:
+//  ET(block) calls its Value() method.
+//
+//  This header only extension has no library code.
+//
+
+#ifndef __SIMLIBET_H
+#define __SIMLIBET_H
+
+#ifndef __SIMLIB__
+#   error "simlibET.h: 31: you must include simlib.h first"
+#endif
+#if __SIMLIB__ < 0x0307
+#   error "simlibET.h: 34: requires SIMLIB version 3.07 and higher"
+#endif
+
+#include <cmath>
+
+namespace simlib3 {
+
+////////////////////////////////////////////////////////////////////////////
+//! base of all expression templates (CRTP)
+//! \ingroup simlibET
+template <class E>
+struct ETExpr {
+  const E &self() const { return static_cast<const E&>(*this); }
+  double operator () () const { return self()(); } //!< evaluate expression
+};
+
+////////////////////////////////////////////////////////////////////////////
+// operands
+
+//! constant
+//! \ingroup simlibET
+struct ETConst : public ETExpr<ETConst> {
+  double c;
+  explicit ETConst(double x) : c(x) {}
+  double operator () () const { return c; }
+};
+
+//! integrator state (inline access to the array of states)
+//! \ingroup simlibET
+struct ETState : public ETExpr<ETState> {
+  Integrator *p;
+  explicit ETState(Integrator &i) : p(&i) {}
+  double operator () () const { return p->GetState(); }
+};
+
+//! variable (value can be changed during simulation)
+//! \ingroup simlibET
+struct ETVariable : public ETExpr<ETVariable> {
+  Variable *p;
+  explicit ETVariable(Variable &v) : p(&v) {}
+  double operator () () const { return p->Variable::Value(); }
+};
+
+//! parameter
+//! \ingroup simlibET
+struct ETParameter : public ETExpr<ETParameter> {
+  Parameter *p;
+  explicit ETParameter(Parameter &v) : p(&v) {}
+  double operator () () const { return p->Parameter::Value(); }
+};
+
+//! any block (virtual Value() call)
+//! \ingroup simlibET
+struct ETBlockRef : public ETExpr<ETBlockRef> {
+  aContiBlock *p;
+  explicit ETBlockRef(aContiBlock &b) : p(&b) {}
+  double operator () () const { return p->Value(); }
+};
+
+//! operand constructors
+//! \ingroup simlibET
+inline ETConst     ET(double c)      { return ETConst(c); }
+inline ETState     ET(Integrator &i) { return ETState(i); }
+inline ETVariable  ET(Variable &v)   { return ETVariable(v); }
+inline ETParameter ET(Parameter &p)  { return ETParameter(p); }
+inline ETBlockRef  ET(aContiBlock &b){ return ETBlockRef(b); }
+
+////////////////////////////////////////////////////////////////////////////
+// operations
+
+//! unary operation F applied to expression A
+//! \ingroup simlibET
+template <class F, class A>
+struct ETUnary : public ETExpr< ETUnary<F,A> > {
+  A a;
+  explicit ETUnary(const A &x) : a(x) {}
+  double operator () () const { return F::apply(a()); }
+};
+
+//! binary operation F applied to expressions A, B
+//! \ingroup simlibET
+template <class F, class A, class B>
+struct ETBinary : public ETExpr< ETBinary<F,A,B> > {
+  A a;
+  B b;
+  ETBinary(const A &x, const B &y) : a(x), b(y) {}
+  double operator () () const { return F::apply(a(), b()); }
+};
+
+// operation functors (the same functions as in block expressions)
+struct ETAdd { static double apply(double a, double b) { return a + b; } };
+struct ETSub { static double apply(double a, double b) { return a - b; } };
+struct ETMul { static double apply(double a, double b) { return a * b; } };
+struct ETDiv { static double apply(double a, double b) { return a / b; } };
+struct ETNeg { static double apply(double a) { return -a; } };
+struct ETSqr { static double apply(double a) { return a * a; } };
+struct ETMin { static double apply(double a, double b) { return a < b ? a : b; } };
+struct ETMax { static double apply(double a, double b) { return a > b ? a : b; } };
+
+#define SIMLIB_ET_FUNCTION1(name, f) \
+  struct ET##name { static double apply(double a) { return f(a); } }; \
+  template <class A> \
+  inline ETUnary<ET##name,A> name(const ETExpr<A> &a) \
+  { return ETUnary<ET##name,A>(a.self()); }
+
+#define SIMLIB_ET_FUNCTION2(name, f) \
+  struct ET##name { static double apply(double a, double b) { return f(a, b); } }; \
+  template <class A, class B> \
+  inline ETBinary<ET##name,A,B> name(const ETExpr<A> &a, const ETExpr<B> &b) \
+  { return ETBinary<ET##name,A,B>(a.self(), b.self()); }
+
+SIMLIB_ET_FUNCTION1(Abs, std::fabs)
+SIMLIB_ET_FUNCTION1(Sin, std::sin)
+SIMLIB_ET_FUNCTION1(Cos, std::cos)
+SIMLIB_ET_FUNCTION1(Tan, std::tan)
+SIMLIB_ET_FUNCTION1(ASin, std::asin)
+SIMLIB_ET_FUNCTION1(ACos, std::acos)
+SIMLIB_ET_FUNCTION1(ATan, std::atan)
+SIMLIB_ET_FUNCTION1(Exp, std::exp)
+SIMLIB_ET_FUNCTION1(Log10, std::log10)
+SIMLIB_ET_FUNCTION1(Ln, std::log)
+SIMLIB_ET_FUNCTION1(Sqrt, std::sqrt)
+SIMLIB_ET_FUNCTION2(ATan2, std::atan2)
+SIMLIB_ET_FUNCTION2(Pow, std::pow)
+
+#undef SIMLIB_ET_FUNCTION1
+#undef SIMLIB_ET_FUNCTION2
+
+//! square
+//! \ingroup simlibET
+template <class A>
+inline ETUnary<ETSqr,A> Sqr(const ETExpr<A> &a)
+{ return ETUnary<ETSqr,A>(a.self()); }
+
+//! minimum
+//! \ingroup simlibET
+template <class A, class B>
+inline ETBinary<ETMin,A,B> Min(const ETExpr<A> &a, const ETExpr<B> &b)
+{ return ETBinary<ETMin,A,B>(a.self(), b.self()); }
+
+//! maximum
+//! \ingroup simlibET
+template <class A, class B>
+inline ETBinary<ETMax,A,B> Max(const ETExpr<A> &a, const ETExpr<B> &b)
+{ return ETBinary<ETMax,A,B>(a.self(), b.self()); }
+
+//! unary minus
+//! \ingroup simlibET
+template <class A>
+inline ETUnary<ETNeg,A> operator - (const ETExpr<A> &a)
+{ return ETUnary<ETNeg,A>(a.self()); }
+
+// binary operators: expression op expression, expression op double,
+// double op expression
+#define SIMLIB_ET_OPERATOR(op, F) \
+  template <class A, class B> \
+  inline ETBinary<F,A,B> operator op (const ETExpr<A> &a, const ETExpr<B> &b) \
+  { return ETBinary<F,A,B>(a.self(), b.self()); } \
+  template <class A> \
+  inline ETBinary<F,A,ETConst> operator op (const ETExpr<A> &a, double b) \
+  { return ETBinary<F,A,ETConst>(a.self(), ETConst(b)); } \
+  template <class B> \
+  inline ETBinary<F,ETConst,B> operator op (double a, const ETExpr<B> &b) \
+  { return ETBinary<F,ETConst,B>(ETConst(a), b.self()); }
+
+SIMLIB_ET_OPERATOR(+, ETAdd)
+SIMLIB_ET_OPERATOR(-, ETSub)
+SIMLIB_ET_OPERATOR(*, ETMul)
+SIMLIB_ET_OPERATOR(/, ETDiv)
+
+#undef SIMLIB_ET_OPERATOR
+
+////////////////////////////////////////////////////////////////////////////
+//! adapter: expression template as a continuous block
+//! (single virtual call, the expression is inline code)
+//! \ingroup simlibET
+template <class E>
+class ETBlock : public aContiBlock {
+  E e;
+ public:
+  explicit ETBlock(const E &x) : e(x) {}
+  virtual double Value() { return e(); }
+  virtual const char *Name() const {
+    return HasName() ? _name : "ETBlock";
+  }
+};
+
+//! create block for expression template (as input of other blocks)
+//! \ingroup simlibET
+template <class E>
+inline Input ETInput(const ETExpr<E> &e)
+{
+  return new ETBlock<E>(e.self());
+}
+
+} // namespace
+
+#endif // __SIMLIBET_H
@@ -0,0 +1,100 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file simulation.cc  Simulation context
+//
+// Copyright (c) 1991-2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+// description: simulation context --- state of one simulator instance,
+//              each thread uses its own context
+//
+
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+////////////////////////////////////////////////////////////////////////////
+
+#include "simlib.h"
+#include "internal.h"
+#include <thread>
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+////////////////////////////////////////////////////////////////////////////
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+////////////////////////////////////////////////////////////////////////////
+// main program thread (static initialization runs there)
+static const std::thread::id SIMLIB_main_thread = std::this_thread::get_id();
+
+////////////////////////////////////////////////////////////////////////////
+/// thread-local owner of the context
+/// destroys context at the end of thread (except main thread, where
+/// model objects with static storage duration live longer and the cleanup
+/// is done by the last SIMLIB module --- see atexit.cc)
+struct Simulation::Owner {
+    Simulation *context;
+    Owner(): context(0) {}
+    ~Owner() {
+        if(context && !Simulation::isMainThread())
+            delete context;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+/// current context selection
+static thread_local Simulation *SIMLIB_current_context = 0;
+
+////////////////////////////////////////////////////////////////////////////
+/// constructor --- empty simulator state
+Simulation::Simulation():
+    calendar(0),
+    allocator(0),
+    wait_until(0),
+    samplers(0),
+    conditions(0),
+    integrators(0),
+    status(0),
+    random_seed(1537L),         // default seed (see random1.cc)
+    entities(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// destructor --- called at thread exit
+Simulation::~Simulation()
+{
+    Dprintf(("Simulation::~Simulation()"));
+    SIMLIB_atexit_call();       // calendar, WaitUntil list, ...
+    delete integrators;
+    delete status;
+    SIMLIB_current_context = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// get context of the calling thread, create it at first use
+Simulation & Simulation::Current()
+{
+    if(SIMLIB_current_context == 0) {
+        static thread_local Owner owner;
+        SIMLIB_current_context = owner.context = new Simulation;
+    }
+    return *SIMLIB_current_context;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// check if the calling thread is the main program thread
+bool Simulation::isMainThread()
+{
+    return std::this_thread::get_id() == SIMLIB_main_thread;
+}
+
+} // namespace
+
+// end
@@ -17,7 +17,7 @@
 #include "simlib.h"
 #include "internal.h"
 
-#include <cmath>     // sqrt()
+#include <cmath>     // sqrt(), log(), pow()
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -30,24 +30,58 @@ SIMLIB_IMPLEMENTATION;
 
 ////////////////////////////////////////////////////////////////////////////
 //  operator ()  --- record value
+//  mean value and sum of squared deviations are updated by Welford's
+//  method (for values shifted by the first value to avoid cancellation),
+//  sum is compensated (no loss of precision for long runs)
 //
 void Stat::operator () (double x)
 {
-  sx  += x;
-  sx2 += x*x;
-  if(++n==1) min=max=x;
+  SIMLIB_KahanAdd(sx, csx, x);
+  if(++n==1) {
+    min=max=x;
+    shift = x;                  // values are shifted by the first one
+  }
   else {
     if(x<min) min = x;
     if(x>max) max = x;
+    x -= shift;
+    double delta = x - mean;
+    mean += delta/n;
+    m2 += delta*(x - mean);
   }
 };
 
 
+////////////////////////////////////////////////////////////////////////////
+//  operator +=  --- merge statistics of independent experiment
+//                   (e.g. replication, see RunReplications, or statistics
+//                   gathered by other thread)
+//  the result is the same as if all values were recorded in this object
+//
+Stat &Stat::operator += (const Stat &x)
+{
+  if(x.n==0) return *this;
+  if(n==0) { min = x.min; max = x.max; shift = x.shift; }
+  else {
+    if(x.min<min) min = x.min;
+    if(x.max>max) max = x.max;
+  }
+  SIMLIB_KahanAdd(sx, csx, x.sx);
+  SIMLIB_KahanAdd(sx, csx, x.csx);
+  double N = double(n) + x.n;
+  double delta = (x.shift - shift) + (x.mean - mean); // Chan et al.
+  mean += delta*(x.n/N);
+  m2   += x.m2 + delta*delta*(n*(x.n/N));
+  n    += x.n;
+  return *this;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////
 //  constructors
 //
 Stat::Stat(const char *name) :
-  sx(0), sx2(0),
+  sx(0), csx(0), shift(0), mean(0), m2(0),
   min(0), max(0),
   n(0)
 {
@@ -56,7 +90,7 @@ Stat::Stat(const char *name) :
 }
 
 Stat::Stat() :
-  sx(0), sx2(0),
+  sx(0), csx(0), shift(0), mean(0), m2(0),
   min(0), max(0),
   n(0)
 {
@@ -76,7 +110,8 @@ Stat::~Stat()
 //
 void Stat::Clear()
 {
-  sx = sx2 = 0;    // sums
+  sx = csx = 0;    // sum
+  shift = mean = m2 = 0;
   min = max = 0;
   n = 0;           // # of records
 }
@@ -88,7 +123,7 @@ void Stat::Clear()
 double Stat::MeanValue() const
 {
   if (n==0) SIMLIB_error(StatNoRecError);
-  return sx/n;
+  return Sum()/n;               // compensated sum is more precise
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -97,8 +132,94 @@ double Stat::MeanValue() const
 double Stat::StdDev() const
 {
   if (n<2)  SIMLIB_error(StatDispError);
-  double mv = sx/n;
-  return sqrt((sx2-n*mv*mv)/(n-1));
+  return sqrt(m2/(n-1));
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  Stat::ConfidenceInterval  --- half-width of confidence interval
+//  of mean value: MeanValue() +- ConfidenceInterval(level)
+//  records should be independent identically distributed values,
+//  e.g. results of replications (see RunReplications)
+//
+double Stat::ConfidenceInterval(double level) const
+{
+  if (n<2)  SIMLIB_error(StatDispError);
+  return SIMLIB_StudentQuantile(level, n-1) * StdDev() / sqrt(double(n));
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  NormalQuantile --- inverse of standard normal distribution function
+//  rational approximation (P. J. Acklam), relative error < 1.15e-9
+//
+static double NormalQuantile(double p)
+{
+  static const double a[] = {
+    -3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+     1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00 };
+  static const double b[] = {
+    -5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+     6.680131188771972e+01, -1.328068155288572e+01 };
+  static const double c[] = {
+    -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+    -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00 };
+  static const double d[] = {
+     7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+     3.754408661907416e+00 };
+  const double plow = 0.02425;
+  if (p < plow) {                     // lower tail
+    double q = sqrt(-2*log(p));
+    return (((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) /
+           ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+  }
+  if (p > 1-plow) {                   // upper tail
+    double q = sqrt(-2*log(1-p));
+    return -(((((c[0]*q+c[1])*q+c[2])*q+c[3])*q+c[4])*q+c[5]) /
+            ((((d[0]*q+d[1])*q+d[2])*q+d[3])*q+1);
+  }
+  double q = p - 0.5;                 // central region
+  double r = q*q;
+  return (((((a[0]*r+a[1])*r+a[2])*r+a[3])*r+a[4])*r+a[5])*q /
+         (((((b[0]*r+b[1])*r+b[2])*r+b[3])*r+b[4])*r+1);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//  SIMLIB_StudentQuantile --- quantile of Student's t distribution
+//  for two-sided confidence interval with given level
+//  algorithm: G. W. Hill, ACM Algorithm 396 (1970)
+//
+double SIMLIB_StudentQuantile(double level, unsigned long df)
+{
+  if (level<=0 || level>=1) SIMLIB_error(ConfidenceLevelError);
+  if (df==0) SIMLIB_error(StatDispError);
+  const double pi = 3.14159265358979323846;
+  double p = 1 - level;               // two-tailed probability
+  double n = double(df);
+  if (df==1) {
+    p *= pi/2;
+    return cos(p)/sin(p);
+  }
+  if (df==2)
+    return sqrt(2/(p*(2-p)) - 2);
+  double a = 1/(n-0.5);
+  double b = 48/(a*a);
+  double c = ((20700*a/b - 98)*a - 16)*a + 96.36;
+  double d = ((94.5/(b+c) - 3)/b + 1)*sqrt(a*pi/2)*n;
+  double x = d*p;
+  double y = pow(x, 2/n);
+  if (y > 0.05 + a) {                 // asymptotic inverse expansion
+    x = -NormalQuantile(0.5*p);
+    y = x*x;
+    if (df<5) c += 0.3*(n-4.5)*(x+0.6);
+    c = (((0.05*d*x - 5)*x - 7)*x - 2)*x + b + c;
+    y = (((((0.4*y + 6.3)*y + 36)*y + 94.5)/c - y - 3)/b + 1)*x;
+    y = a*y*y;
+    y = (y > 0.002) ? exp(y) - 1 : 0.5*y*y + y;
+  }
+  else
+    y = ((1/(((n+6)/(n*y) - 0.089*d - 0.822)*(n+2)*3) + 0.5/(n+4))*y - 1)
+        * (n+1)/(n+2) + 1/y;
+  return sqrt(n*y);
 }
 
 }
@@ -105,6 +105,7 @@ void Store::SetCapacity(unsigned long newcapacity)
       (QueueLen()==0 && used<=newcapacity)
      ) capacity = newcapacity;
   else SIMLIB_error(SetCapacityError);
+  Changed.Notify();     // state change (WaitUntilOn)
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -134,6 +135,7 @@ void Store::Enter(Entity *e, unsigned long rcap)
     SIMLIB_error(EntityRefError); // current process only
 
   if (rcap>capacity)  SIMLIB_error(EnterCapError);
+  Changed.Notify();     // state change (WaitUntilOn)
   if (Free() < rcap)    // not enough space in store
   {
     QueueIn(e,rcap);    // isert into queue
@@ -154,6 +156,7 @@ void Store::Leave(unsigned long rcap)
   Dprintf(("%s.Leave(%lu)", Name(), rcap));
   if (used<rcap)
     SIMLIB_error(LeaveManyError);
+  Changed.Notify();        // state change (WaitUntilOn)
   used -= rcap ;           // free capacity
   tstat(used);  tstat.n--; // fix: correction
   if(Q->empty())
@@ -196,6 +199,7 @@ void Store::Clear()
   // initialize only own queue
   if (OwnQueue()) Q->Clear();   // clear input queue
   tstat.Clear();                // clear store statistics
+  Changed.Notify();
 }
 
 ////////////////////////////////////////////////////////////////////////////
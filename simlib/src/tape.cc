@@ -0,0 +1,551 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file tape.cc  Compiled evaluation of integrator inputs
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  The block expressions of integrator inputs are compiled at Init
+//  (and after any change of integrators) to a linear tape. Each
+//  integration step evaluates the tape in a simple loop instead of
+//  recursive virtual Value() calls; blocks shared by several
+//  expressions are evaluated only once.
+//
+//  Blocks which are not known to the compiler (user blocks, status
+//  blocks, 2D/3D adaptors) are evaluated by Value() call (CALL). These
+//  blocks can have side effects (e.g. input of Integrator3D expects
+//  three subsequent calls), so expressions containing them are not
+//  shared: the calls are done as many times as without the tape.
+//
+//  Parallel evaluation (SetParallelEvaluation): integrators are split
+//  into contiguous parts of similar cost, each part has its own list of
+//  instructions (all instructions its inputs depend on, so instructions
+//  shared by parts are computed in each of them) and its own registers.
+//  Parts are evaluated by a persistent pool of worker threads, the
+//  calling thread waits for all of them (barrier) in each evaluation.
+//  Tapes with CALL instructions are always evaluated serially (blocks
+//  are not thread-safe); functions used by Function1/Function2 blocks
+//  must be thread-safe.
+//
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "internal.h"
+#include "tape.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+/// use compiled tape in IntegratorContainer::EvaluateAll
+thread_local bool SIMLIB_TapeFlag = true;
+
+/// # of threads for evaluation of tape (SetParallelEvaluation)
+thread_local unsigned SIMLIB_TapeThreads = 1;
+
+////////////////////////////////////////////////////////////////////////////
+/// switch compiled evaluation on/off (off: recursive Value() calls)
+void SetCompiledEvaluation(bool on)
+{
+  SIMLIB_TapeFlag = on;
+}
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////
+/// persistent worker threads for parallel evaluation of tape
+/// (worker i evaluates part i+1, calling thread evaluates part 0)
+class TapePool {
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable cv;         // wakes sleeping workers
+    std::atomic<unsigned long> generation; // incremented by each job
+    std::atomic<unsigned> pending;      // # of running workers
+    bool stop;
+    // current job
+    SIMLIB_Tape *tape;
+    const double *ss;
+    double *dd;
+    double time;
+    enum { SPIN = 20000 };              // busy waiting before sleep
+    void Worker(unsigned part);
+  public:
+    explicit TapePool(unsigned workers);
+    ~TapePool();
+    unsigned Size() const { return threads.size() + 1; } // # of parts
+    void Run(SIMLIB_Tape *t, const double *s, double *d, double tm);
+};
+
+TapePool::TapePool(unsigned workers) :
+  generation(0), pending(0), stop(false), tape(0), ss(0), dd(0), time(0)
+{
+  for(unsigned i=0; i<workers; i++)
+    threads.push_back(std::thread(&TapePool::Worker, this, i+1));
+}
+
+TapePool::~TapePool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m);
+    stop = true;
+    generation.fetch_add(1, std::memory_order_release);
+  }
+  cv.notify_all();
+  for(size_t i=0; i<threads.size(); i++)
+    threads[i].join();
+}
+
+void TapePool::Worker(unsigned part)
+{
+  unsigned long seen = 0;
+  for(;;) {
+    unsigned long g;
+    unsigned spin = 0;
+    // steps of integration method follow quickly: busy wait first
+    while((g = generation.load(std::memory_order_acquire)) == seen) {
+      if(++spin < SPIN)
+        continue;
+      std::unique_lock<std::mutex> lock(m);
+      cv.wait(lock, [&]{
+          return generation.load(std::memory_order_acquire) != seen; });
+    }
+    seen = g;
+    if(stop)
+      return;
+    tape->RunPart(part, ss, dd, time);
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+void TapePool::Run(SIMLIB_Tape *t, const double *s, double *d, double tm)
+{
+  tape = t; ss = s; dd = d; time = tm;
+  pending.store(threads.size(), std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(m);
+    generation.fetch_add(1, std::memory_order_release);
+  }
+  cv.notify_all();
+  t->RunPart(0, s, d, tm);
+  while(pending.load(std::memory_order_acquire) != 0)
+    std::this_thread::yield();          // barrier
+}
+
+/// worker threads of calling thread (simulation context)
+thread_local std::unique_ptr<TapePool> tape_pool;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////
+/// evaluate integrator inputs by n threads (n<=1: serial evaluation)
+/// (useful for large models only, requires compiled evaluation)
+void SetParallelEvaluation(unsigned n)
+{
+  if(n < 1)
+    n = 1;
+  if(n == SIMLIB_TapeThreads)
+    return;
+  tape_pool.reset(n > 1 ? new TapePool(n - 1) : 0);
+  SIMLIB_TapeThreads = n;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// empty tape
+SIMLIB_Tape::SIMLIB_Tape() : calls(0), loop(false), parts(0), parts_for(0)
+{
+  static thread_local unsigned long counter = 0;
+  id = ++counter;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// compile inputs of all integrators
+/// (tape is not usable if there is an algebraic loop, see OK())
+SIMLIB_Tape *SIMLIB_Tape::Compile(IntegratorArrays *a)
+{
+  SIMLIB_Tape *t = new SIMLIB_Tape;
+  t->out.resize(a->n);
+  t->vec.resize(a->n);
+  for(size_t i=0; i<a->n; i++) {
+    t->vec[i] = a->items[i]==0;
+    if(!t->vec[i])
+      t->out[i] = t->Node(a->items[i]->input);
+  }
+  if(!a->vectors.empty()) {     // slots of vectors: zero (see EvaluateAll)
+    unsigned zero = t->Const(0);
+    for(size_t i=0; i<a->n; i++)
+      if(t->vec[i])
+        t->out[i] = zero;
+  }
+  t->done.clear();              // not needed for evaluation
+  Dprintf(("SIMLIB_Tape::Compile: %lu integrators, %lu instructions%s",
+           (unsigned long)a->n, (unsigned long)t->code.size(),
+           t->loop ? " (algebraic loop)" : ""));
+  return t;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// compile the block referenced by input (once), return its register
+unsigned SIMLIB_Tape::Node(const Input &i)
+{
+  aContiBlock *b = i.bp;
+  std::map<aContiBlock*,unsigned>::iterator it = done.find(b);
+  if(it != done.end())
+    return it->second;          // shared subexpression
+  if(open.count(b)) {           // recursion: algebraic loop
+    loop = true;                // reported by Value() evaluation
+    return Const(0);
+  }
+  open.insert(b);
+  unsigned c = calls;
+  unsigned r = b->Compile(*this);
+  open.erase(b);
+  if(calls == c)                // no Value() calls inside: can be shared
+    done[b] = r;
+  return r;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// add instruction, return its register
+unsigned SIMLIB_Tape::Emit(OpCode op, unsigned a, unsigned b)
+{
+  Instruction x;
+  x.op = op;
+  x.a = a;
+  x.b = b;
+  x.p = 0;
+  code.push_back(x);
+  reg.push_back(0.0);
+  return code.size() - 1;
+}
+
+unsigned SIMLIB_Tape::Const(double c)
+{
+  unsigned r = Emit(CONST);
+  reg[r] = c;                   // never changed
+  return r;
+}
+
+unsigned SIMLIB_Tape::Load(const double *p)
+{
+  unsigned r = Emit(LOAD);
+  code[r].p = p;
+  return r;
+}
+
+unsigned SIMLIB_Tape::State(size_t slot)
+{
+  unsigned r = Emit(STATE);
+  code[r].slot = slot;
+  return r;
+}
+
+unsigned SIMLIB_Tape::Time()
+{
+  return Emit(TIME);
+}
+
+unsigned SIMLIB_Tape::Call(aContiBlock *b)
+{
+  unsigned r = Emit(CALL);
+  code[r].block = b;
+  calls++;
+  return r;
+}
+
+unsigned SIMLIB_Tape::Op(OpCode op, unsigned a, unsigned b)
+{
+  return Emit(op, a, b);
+}
+
+unsigned SIMLIB_Tape::Fun1(unsigned a, double (*f)(double))
+{
+  unsigned r = Emit(FUN1, a);
+  code[r].f1 = f;
+  return r;
+}
+
+unsigned SIMLIB_Tape::Fun2(unsigned a, unsigned b, double (*f)(double,double))
+{
+  unsigned r = Emit(FUN2, a, b);
+  code[r].f2 = f;
+  return r;
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// evaluate all integrator inputs
+void SIMLIB_Tape::Run(const double *ss, double *dd)
+{
+  if(code.empty())
+    return;
+  const Instruction *c = &code[0];
+  double *r = &reg[0];
+  for(size_t i=0, n=code.size(); i<n; i++) {
+    const Instruction &x = c[i];
+    switch(x.op) {
+      case CONST: break;
+      case LOAD:  r[i] = *x.p; break;
+      case STATE: r[i] = ss[x.slot]; break;
+      case TIME:  r[i] = simlib3::Time; break;
+      case CALL:  r[i] = x.block->Value(); break;
+      case ADD:   r[i] = r[x.a] + r[x.b]; break;
+      case SUB:   r[i] = r[x.a] - r[x.b]; break;
+      case MUL:   r[i] = r[x.a] * r[x.b]; break;
+      case DIV:   r[i] = r[x.a] / r[x.b]; break;
+      case NEG:   r[i] = -r[x.a]; break;
+      case FUN1:  r[i] = x.f1(r[x.a]); break;
+      case FUN2:  r[i] = x.f2(r[x.a], r[x.b]); break;
+    }
+  }
+  for(size_t k=0, n=out.size(); k<n; k++)
+    dd[k] = r[out[k]];
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// split integrator slots into n parts (similar # of instructions),
+/// less than n parts if there are less than n slots
+void SIMLIB_Tape::Partition(unsigned n)
+{
+  size_t N = out.size();
+  parts_for = n;
+  if(n > N)
+    n = N ? N : 1;
+  std::vector<bool> mark(code.size(), false);
+  std::vector<unsigned> stack;
+  // mark instructions used by register r (and its arguments),
+  // newly marked instructions are added to list (if not 0)
+  struct Closure {
+    static size_t Mark(const std::vector<Instruction> &code, unsigned r,
+                       std::vector<bool> &mark, std::vector<unsigned> &stack,
+                       std::vector<unsigned> *list) {
+      size_t cnt = 0;
+      stack.push_back(r);
+      while(!stack.empty()) {
+        unsigned i = stack.back();
+        stack.pop_back();
+        if(mark[i])
+          continue;
+        mark[i] = true;
+        cnt++;
+        if(list)
+          list->push_back(i);
+        switch(code[i].op) {
+          case ADD: case SUB: case MUL: case DIV: case FUN2:
+            stack.push_back(code[i].b);
+            /* fall through */
+          case NEG: case FUN1:
+            stack.push_back(code[i].a);
+            break;
+          default:
+            break;
+        }
+      }
+      return cnt;
+    }
+  };
+  // cost of slot: # of instructions used first by its input
+  std::vector<size_t> cost(N);
+  size_t total = 0;
+  for(size_t k=0; k<N; k++)
+    total += cost[k] = Closure::Mark(code, out[k], mark, stack, 0);
+  part_begin.assign(n + 1, N);
+  part_begin[0] = 0;
+  size_t acc = 0;
+  unsigned p = 1;
+  for(size_t k=0; k<N && p<n; k++) {
+    acc += cost[k];
+    if(acc*n >= total*p)
+      part_begin[p++] = k + 1;
+  }
+  part_code.assign(n, std::vector<unsigned>());
+  part_reg.assign(n, reg);              // copy of constants
+  for(p=0; p<n; p++) {
+    mark.assign(code.size(), false);
+    for(size_t k=part_begin[p]; k<part_begin[p+1]; k++)
+      Closure::Mark(code, out[k], mark, stack, &part_code[p]);
+    std::sort(part_code[p].begin(), part_code[p].end()); // topological
+  }
+  parts = n;
+  Dprintf(("SIMLIB_Tape::Partition: %u parts", n));
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// evaluate inputs of slots of part p (t = simulation time)
+void SIMLIB_Tape::RunPart(unsigned p, const double *ss, double *dd, double t)
+{
+  if(p >= parts || part_code[p].empty())
+    return;
+  const Instruction *c = &code[0];
+  const unsigned *idx = &part_code[p][0];
+  double *r = &part_reg[p][0];
+  for(size_t j=0, n=part_code[p].size(); j<n; j++) {
+    const unsigned i = idx[j];
+    const Instruction &x = c[i];
+    switch(x.op) {
+      case CONST: break;
+      case LOAD:  r[i] = *x.p; break;
+      case STATE: r[i] = ss[x.slot]; break;
+      case TIME:  r[i] = t; break;
+      case CALL:  r[i] = x.block->Value(); break;  // not used
+      case ADD:   r[i] = r[x.a] + r[x.b]; break;
+      case SUB:   r[i] = r[x.a] - r[x.b]; break;
+      case MUL:   r[i] = r[x.a] * r[x.b]; break;
+      case DIV:   r[i] = r[x.a] / r[x.b]; break;
+      case NEG:   r[i] = -r[x.a]; break;
+      case FUN1:  r[i] = x.f1(r[x.a]); break;
+      case FUN2:  r[i] = x.f2(r[x.a], r[x.b]); break;
+    }
+  }
+  for(size_t k=part_begin[p], n=part_begin[p+1]; k<n; k++)
+    dd[k] = r[out[k]];
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// evaluate all integrator inputs by worker threads
+void SIMLIB_Tape::RunParallel(const double *ss, double *dd)
+{
+  TapePool *pool = tape_pool.get();
+  if(pool==0 || calls>0 || out.size() < 2) {
+    Run(ss, dd);                        // serial evaluation
+    return;
+  }
+  if(parts_for != pool->Size())        // (parts can be less than size)
+    Partition(pool->Size());
+  pool->Run(this, ss, dd, simlib3::Time);
+}
+
+////////////////////////////////////////////////////////////////////////////
+/// sparsity pattern: rows[slot] = sorted states used by input of integrator
+/// (CALL and IntegratorVector can use anything: all states)
+void SIMLIB_Tape::Dependencies(std::vector< std::vector<size_t> > &rows) const
+{
+  size_t n = out.size();
+  std::vector< std::vector<size_t> > dep(code.size());
+  std::vector<bool> all(code.size(), false);
+  for(size_t i=0; i<code.size(); i++) {
+    const Instruction &x = code[i];
+    switch(x.op) {
+      case CONST: case LOAD: case TIME:
+        break;
+      case STATE:
+        dep[i].push_back(x.slot);
+        break;
+      case CALL:
+        all[i] = true;
+        break;
+      case NEG: case FUN1:
+        all[i] = all[x.a];
+        dep[i] = dep[x.a];
+        break;
+      case ADD: case SUB: case MUL: case DIV: case FUN2:
+        all[i] = all[x.a] || all[x.b];
+        if(!all[i])
+          std::set_union(dep[x.a].begin(), dep[x.a].end(),
+                         dep[x.b].begin(), dep[x.b].end(),
+                         std::back_inserter(dep[i]));
+        break;
+    }
+  }
+  rows.assign(n, std::vector<size_t>());
+  for(size_t k=0; k<n; k++) {
+    if(all[out[k]] || vec[k]) {
+      rows[k].resize(n);
+      for(size_t j=0; j<n; j++)
+        rows[k][j] = j;
+    } else
+      rows[k] = dep[out[k]];
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+//  Compile methods of basic blocks
+//  (derived classes can redefine Value(), so they are checked by typeid
+//   and compiled as CALL)
+//
+
+/// unknown block: Value() call
+unsigned aContiBlock::Compile(SIMLIB_Tape &t)
+{
+  return t.Call(this);
+}
+
+unsigned Constant::Compile(SIMLIB_Tape &t)
+{
+  if(typeid(*this) != typeid(Constant))
+    return t.Call(this);
+  return t.Const(value);
+}
+
+unsigned Variable::Compile(SIMLIB_Tape &t)
+{
+  if(typeid(*this) != typeid(Variable))
+    return t.Call(this);
+  return t.Load(&value);
+}
+
+unsigned Parameter::Compile(SIMLIB_Tape &t)
+{
+  if(typeid(*this) != typeid(Parameter))
+    return t.Call(this);
+  return t.Load(&value);
+}
+
+unsigned Expression::Compile(SIMLIB_Tape &t)
+{
+  if(typeid(*this) != typeid(Expression))
+    return t.Call(this);
+  return CompileInput(t);       // transparent
+}
+
+unsigned aContiBlock1::CompileInput(SIMLIB_Tape &t)
+{
+  return t.Node(input);
+}
+
+unsigned aContiBlock2::CompileInput1(SIMLIB_Tape &t)
+{
+  return t.Node(input1);
+}
+
+unsigned aContiBlock2::CompileInput2(SIMLIB_Tape &t)
+{
+  return t.Node(input2);
+}
+
+unsigned aContiBlock3::CompileInput1(SIMLIB_Tape &t)
+{
+  return t.Node(input1);
+}
+
+unsigned aContiBlock3::CompileInput2(SIMLIB_Tape &t)
+{
+  return t.Node(input2);
+}
+
+unsigned aContiBlock3::CompileInput3(SIMLIB_Tape &t)
+{
+  return t.Node(input3);
+}
+
+} // namespace
+
+// end of tape.cc
@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file tape.h  Compiled evaluation of integrator inputs (internal)
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  block expressions of all integrator inputs are compiled to linear
+//  code over an array of registers: instruction i computes register i,
+//  arguments are always in lower registers (topological order)
+//
+
+#ifndef __SIMLIB__TAPE_H__
+#define __SIMLIB__TAPE_H__
+
+#include "simlib.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace simlib3 {
+
+extern thread_local bool SIMLIB_TapeFlag;  // use tape (SetCompiledEvaluation)
+extern thread_local unsigned SIMLIB_TapeThreads; // SetParallelEvaluation
+
+////////////////////////////////////////////////////////////////////////////
+//! SIMLIB_Tape --- compiled block expressions of integrator inputs
+//! each block is compiled once (shared subexpressions are evaluated once
+//! per IntegratorContainer::EvaluateAll), blocks which can not be
+//! compiled are evaluated by virtual Value() call (not shared)
+class SIMLIB_Tape {
+  public:
+    enum OpCode {
+        CONST,          // constant (register is set by compiler)
+        LOAD,           // *p (Variable, Parameter)
+        STATE,          // integrator state ss[slot]
+        TIME,           // simulation time
+        CALL,           // block->Value()
+        ADD, SUB, MUL, DIV, NEG,
+        FUN1,           // f1(a)
+        FUN2            // f2(a,b)
+    };
+    struct Instruction {
+        OpCode op;
+        unsigned a, b;                  // argument registers
+        union {
+            const double *p;            // LOAD
+            size_t slot;                // STATE
+            aContiBlock *block;         // CALL
+            double (*f1)(double);       // FUN1
+            double (*f2)(double,double);// FUN2
+        };
+    };
+  private:
+    std::vector<Instruction> code;
+    std::vector<double> reg;            // registers, reg[i] = result of code[i]
+    std::vector<unsigned> out;          // input register of integrator slot
+    std::vector<bool> vec;              // slot of IntegratorVector (Eval)
+    std::map<aContiBlock*,unsigned> done; // compiled blocks (only compiler)
+    std::set<aContiBlock*> open;        // blocks being compiled (loop check)
+    unsigned calls;                     // # of CALL instructions
+    bool loop;                          // algebraic loop: tape is not used
+    unsigned long id;                   // unique number of compiled tape
+    // parallel evaluation: integrator slots are split into parts, each
+    // part evaluates all instructions its inputs depend on
+    unsigned parts;                     // # of parts (0 = not partitioned)
+    unsigned parts_for;                 // pool size used by Partition
+    std::vector< std::vector<unsigned> > part_code; // instructions of part
+    std::vector<size_t> part_begin;     // first slot of part (parts+1)
+    std::vector< std::vector<double> > part_reg; // registers of part
+    void Partition(unsigned n);
+    unsigned Emit(OpCode op, unsigned a=0, unsigned b=0);
+    SIMLIB_Tape();
+  public:
+    // compile inputs of all integrators
+    static SIMLIB_Tape *Compile(IntegratorArrays *a);
+    bool OK() const { return !loop; }   //!< can be used for evaluation
+    size_t Size() const { return code.size(); } //!< # of instructions
+    unsigned long Id() const { return id; }     //!< changes by compilation
+    // states used by each input (structure of Jacobian matrix)
+    void Dependencies(std::vector< std::vector<size_t> > &rows) const;
+    // evaluate all inputs: dd[slot] = input of integrator
+    // (slots of IntegratorVector are computed by its Eval() later)
+    void Run(const double *ss, double *dd);
+    // the same in worker threads (only if there is no CALL instruction)
+    void RunParallel(const double *ss, double *dd);
+    void RunPart(unsigned p, const double *ss, double *dd, double t);
+
+    // interface for aContiBlock::Compile methods
+    unsigned Node(const Input &i);      // compile referenced block
+    unsigned Const(double c);
+    unsigned Load(const double *p);
+    unsigned State(size_t slot);
+    unsigned Time();
+    unsigned Call(aContiBlock *b);
+    unsigned Op(OpCode op, unsigned a, unsigned b=0);
+    unsigned Fun1(unsigned a, double (*f)(double));
+    unsigned Fun2(unsigned a, unsigned b, double (*f)(double,double));
+};
+
+} // namespace
+
+#endif // __SIMLIB__TAPE_H__
+
+// end
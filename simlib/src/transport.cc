@@ -0,0 +1,201 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file transport.cc  1D transport block implementation
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  This module contains implementation of spatially discretized
+//  transport blocks (finite volume method of lines)
+//
+//  classes:
+//     Transport1D -- advection in 1D pipe (upwind/MUSCL)
+//
+
+////////////////////////////////////////////////////////////////////////////
+// interface
+//
+
+#include "simlib.h"
+#include "transport.h"
+#include "internal.h"
+
+#include <cmath>
+
+
+////////////////////////////////////////////////////////////////////////////
+// implementation
+//
+
+namespace simlib3 {
+
+SIMLIB_IMPLEMENTATION;
+
+/*  Finite volume method (face j is between cells j-1 and j):
+
+    du[i]/dt = -(F[i+1] - F[i]) / dx
+
+    F[j] = v * uL[j]   for v >= 0,   F[j] = v * uR[j]   for v < 0
+
+    upwind:  uL[j] = u[j-1],  uR[j] = u[j]
+    MUSCL:   uL[j] = u[j-1] + 0.5*minmod(u[j-1]-u[j-2], u[j]-u[j-1])
+             uR[j] = u[j]   - 0.5*minmod(u[j]-u[j-1],   u[j+1]-u[j])
+
+    Ghost cells: u[-2] = u[-1] = inflow, u[N] = u[N+1] = u[N-1]
+*/
+
+/// minmod slope limiter
+static inline double minmod(double a, double b)
+{
+  if(a*b <= 0)
+    return 0;
+  return std::fabs(a) < std::fabs(b) ? a : b;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// constructor
+/// @param v velocity input
+/// @param in value of medium entering the pipe
+/// @param n number of cells
+/// @param length length of pipe
+/// @param s spatial discretization scheme
+/// @param initvalue initial value of all cells
+Transport1D::Transport1D(Input v, Input in, size_t n, double length,
+                         Scheme s, double initvalue) :
+  IntegratorVector(n),
+  velocity(v), inflow(in),
+  dx(length/n), scheme(s), initval(initvalue),
+  u(new double[n+4]), cells(new Cell*[n])
+{
+  Dprintf(("Transport1D[%p]::Transport1D(%lu,%g)",
+           this, (unsigned long)n, length));
+  if(n == 0) SIMLIB_error(TransportSizeError);
+  for(size_t i=0; i<n; i++)
+    cells[i] = 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// destructor
+Transport1D::~Transport1D()
+{
+  Dprintf(("destructor: Transport1D[%p]", this));
+  for(size_t i=0; i<Size(); i++)
+    delete cells[i];
+  delete [] cells;
+  delete [] u;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// set initial value of all cells
+void Transport1D::Init(double initvalue)
+{
+  initval = initvalue;
+  double *y = State();
+  for(size_t i=0; i<Size(); i++)
+    y[i] = initvalue;
+  SIMLIB_ResetStatus = true; // if in simulation
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// change velocity input, returns the old one
+Input Transport1D::SetVelocity(Input v)
+{
+  return velocity.Set(v);
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// change inflow input, returns the old one
+Input Transport1D::SetInflow(Input i)
+{
+  return inflow.Set(i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// integral of u over the pipe (e.g. mass in pipe for concentration)
+double Transport1D::Integral()
+{
+  const double *y = State();
+  double s = 0;
+  for(size_t i=0; i<Size(); i++)
+    s += y[i];
+  return s*dx;
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// output block with value of cell i (created once, owned by transport)
+aContiBlock &Transport1D::CellBlock(size_t i)
+{
+  if(i >= Size()) SIMLIB_error(TransportCellError);
+  if(cells[i]==0)
+    cells[i] = new Cell(*this, i);
+  return *cells[i];
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// evaluate derivatives of all cells (one loop over faces)
+void Transport1D::Eval()
+{
+  const size_t N = Size();
+  const long n = N;             // signed index (ghost cells)
+  const double *y = State();
+  double *dy = Diff();
+  const double v = velocity.Value();
+  const double c = v/dx;
+  double *w = u + 2;            // w[-2..N+1]: cells with ghost cells
+  w[-2] = w[-1] = inflow.Value();
+  for(size_t i=0; i<N; i++)
+    w[i] = y[i];
+  w[N] = w[N+1] = y[N-1];
+  double f = 0;                 // flux/dx through face j
+  double fprev;                 // flux/dx through face j-1
+  if(scheme == UPWIND) {
+    for(long j=0; j<=n; j++) {
+      fprev = f;
+      f = c * (v >= 0 ? w[j-1] : w[j]);
+      if(j > 0)
+        dy[j-1] = fprev - f;
+    }
+  } else if(v >= 0) {
+    double d0 = w[-1] - w[-2];  // slope: u[j-1] - u[j-2]
+    for(long j=0; j<=n; j++) {
+      double d1 = w[j] - w[j-1];
+      fprev = f;
+      f = c * (w[j-1] + 0.5*minmod(d0, d1));
+      if(j > 0)
+        dy[j-1] = fprev - f;
+      d0 = d1;
+    }
+  } else {
+    double d0 = w[0] - w[-1];   // slope: u[j] - u[j-1]
+    for(long j=0; j<=n; j++) {
+      double d1 = w[j+1] - w[j];
+      fprev = f;
+      f = c * (w[j] - 0.5*minmod(d0, d1));
+      if(j > 0)
+        dy[j-1] = fprev - f;
+      d0 = d1;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+/// cell value in evaluation tape: direct access to state
+unsigned Transport1D::Cell::Compile(SIMLIB_Tape &tape)
+{
+  return t.CompileState(tape, i);
+}
+
+} // namespace
+
+// end of transport.cc
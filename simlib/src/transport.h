@@ -0,0 +1,74 @@
+/////////////////////////////////////////////////////////////////////////////
+//! \file transport.h   1D transport (advection) block interface
+//
+// Copyright (c) 2016 Petr Peringer
+//
+// This library is licensed under GNU Library GPL. See the file COPYING.
+//
+
+//
+//  This is the interface for spatially discretized transport blocks:
+//
+//      du/dt + v * du/dx = 0        x in [0, length]
+//
+//  (e.g. concentration or temperature of medium flowing in a pipe)
+//  The pipe is divided into N cells (finite volume method), states of
+//  all cells are in one IntegratorVector (no Integrator objects).
+//
+
+#ifndef __SIMLIB__
+#   error "transport.h: 20: you should include simlib.h first"
+#endif
+#if __SIMLIB__ < 0x0307
+#   error "transport.h: 23: requires SIMLIB version 3.07 and higher"
+#endif
+
+namespace simlib3 {
+
+////////////////////////////////////////////////////////////////////////////
+//! 1D transport block: N cells, upwind or MUSCL scheme
+//! velocity v > 0: medium enters cell 0 with value of input inflow,
+//! v < 0: zero gradient at outlet, output goes out through cell 0
+class Transport1D : public IntegratorVector {
+    Transport1D(const Transport1D&);     // disable copy ctor
+    void operator= (const Transport1D&); // disable assignment
+  public:
+    enum Scheme {
+        UPWIND,         //!< 1st order upwind (monotone, diffusive)
+        MUSCL           //!< 2nd order MUSCL with minmod limiter
+    };
+    //! output block: value of one cell
+    class Cell : public aContiBlock {
+        Transport1D &t;
+        size_t i;
+      public:
+        Cell(Transport1D &tr, size_t index) : t(tr), i(index) {}
+        double Value() { return t.Value(i); }
+        virtual unsigned Compile(SIMLIB_Tape &tape);
+    };
+  protected:
+    Input velocity;             //!< flow velocity v (length/time)
+    Input inflow;               //!< value of medium entering the pipe
+    double dx;                  //!< length of cell
+    Scheme scheme;              //!< spatial discretization
+    double initval;             //!< initial value of all cells
+    double *u;                  //!< cell values with 2 ghost cells each side
+    Cell **cells;               //!< output blocks (created by CellBlock)
+  public:
+    Transport1D(Input velocity, Input inflow, size_t n, double length,
+                Scheme s=MUSCL, double initvalue=0);
+    ~Transport1D();
+    void Init(double initvalue);        // set all cells
+    void Init() { Init(initval); }      //!< use preset initial value
+    void Eval();                        // derivatives of all cells
+    Input SetVelocity(Input v);         // change velocity input
+    Input SetInflow(Input i);           // change inflow input
+    double Length() const { return dx*Size(); } //!< length of pipe
+    double Integral();                  // integral of u over the pipe
+    aContiBlock &CellBlock(size_t i);   // block with value of cell i
+    aContiBlock &Outlet() { return CellBlock(Size()-1); } //!< last cell
+}; // class Transport1D
+
+} // namespace
+
+// end
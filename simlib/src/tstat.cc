@@ -17,6 +17,8 @@
 #include "simlib.h"
 #include "internal.h"
 
+#include <cmath>     // sqrt()
+
 ////////////////////////////////////////////////////////////////////////////
 // implementation
 //
@@ -30,7 +32,7 @@ SIMLIB_IMPLEMENTATION;
 //  constructors
 //
 TStat::TStat(double initval):
-  sxt(0), sx2t(0),
+  sxt(0), csxt(0), mt(initval), m2t(0),
   min(initval), max(initval),
   t0(Time), tl(Time),     // time of initialization and last op
   xl(initval),            // last value
@@ -40,7 +42,7 @@ TStat::TStat(double initval):
 }
 
 TStat::TStat(const char *name, double initval) :
-  sxt(0), sx2t(0),
+  sxt(0), csxt(0), mt(initval), m2t(0),
   min(initval), max(initval),
   t0(Time), tl(Time),
   xl(initval),
@@ -58,15 +60,30 @@ TStat::~TStat()
   Dprintf(("TStat::~TStat() // \"%s\" ", Name()));
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  WeightedAdd --- add value x of duration w to time-weighted mean value
+//  and sum of squared deviations (weighted Welford's method, West 1979)
+//  W is the total duration of previous values
+//
+static inline void WeightedAdd(double &mean, double &m2, double W,
+                          double x, double w)
+{
+  if (w<=0) return;
+  double delta = x - mean;
+  double r = delta*(w/(W+w));
+  mean += r;
+  m2 += W*delta*r;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  operator ()
 //
 void TStat::operator () (double x)
 {
   if (Time<tl) SIMLIB_warning(TStatNotInitialized);
-  double tt = xl*(double(Time)-tl);
-  sxt  += tt;
-  sx2t += xl*tt;
+  double dt = double(Time)-tl;
+  SIMLIB_KahanAdd(sxt, csxt, xl*dt);
+  WeightedAdd(mt, m2t, tl-t0, xl, dt);
   xl = x;
   tl = Time;
   if(++n==1) min=max=x;   // TODO: check
@@ -77,13 +94,50 @@ void TStat::operator () (double x)
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  operator +=  --- merge statistics of independent experiment
+//                   (e.g. replication, see RunReplications, or statistics
+//                   gathered by other thread)
+//  the observation period of x (up to current Time) is prepended
+//  to the period of this statistics
+//
+TStat &TStat::operator += (const TStat &x)
+{
+  if (Time<x.tl) SIMLIB_warning(TStatNotInitialized);
+  double dt = double(Time)-x.tl;        // count last period of x
+  SIMLIB_KahanAdd(sxt, csxt, x.sxt);
+  SIMLIB_KahanAdd(sxt, csxt, x.csxt);
+  SIMLIB_KahanAdd(sxt, csxt, x.xl*dt);
+  double xmt = x.mt, xm2t = x.m2t;
+  WeightedAdd(xmt, xm2t, x.tl-x.t0, x.xl, dt);
+  double W  = tl-t0;                    // length of observation of this
+  double Wx = double(Time)-x.t0;        // length of observation of x
+  if (Wx>0) {                           // parallel algorithm (Chan et al.)
+    double delta = xmt - mt;
+    mt  += delta*(Wx/(W+Wx));
+    m2t += xm2t + delta*delta*(W*(Wx/(W+Wx)));
+  }
+  t0 -= Wx;
+  if(x.n>0) {
+    if(n==0) { min = x.min; max = x.max; }
+    else {
+      if(x.min<min) min = x.min;
+      if(x.max>max) max = x.max;
+    }
+  }
+  n += x.n;
+  return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //  Clear
 //
 void TStat::Clear(double initval)
 {
   Dprintf(("TStat::Clear() // \"%s\" ", Name()));
-  sxt = sx2t = 0;
+  sxt = csxt = 0;
+  mt = initval;
+  m2t = 0;
   min = max = initval;
   t0 = tl = Time;
   xl = initval;       // last value
@@ -100,9 +154,23 @@ double TStat::MeanValue() const
     SIMLIB_error(TStatNotInitialized);;
   if(Time==t0)  return xl;
   double sumxt = sxt + xl*(double(Time)-tl); // count last period
+  sumxt += csxt;
   return sumxt/(double(Time)-t0);
 }
 
+////////////////////////////////////////////////////////////////////////////
+//  TStat::StdDev --- time-weighted standard deviation
+//
+double TStat::StdDev() const
+{
+  if(Time<t0)
+    SIMLIB_error(TStatNotInitialized);
+  if(Time==t0)  return 0;
+  double mean = mt, m2 = m2t;
+  WeightedAdd(mean, m2, tl-t0, xl, double(Time)-tl);   // count last period
+  return sqrt(m2/(double(Time)-t0));
+}
+
 }
 // end
 
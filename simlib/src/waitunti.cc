@@ -13,6 +13,10 @@
 //  better implementation will use objects in WUexpressions
 //
 // 199808  updated:  uses standard list<>
+//
+//  WaitUntilOn --- reactive version: process is registered in signals
+//  of objects the condition depends on and the condition is tested only
+//  after Notify() of any of these signals
 
 ////////////////////////////////////////////////////////////////////////////
 // interface
@@ -20,6 +24,7 @@
 #include "simlib.h"
 #include "internal.h"
 #include <list>
+#include <vector>
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -36,36 +41,45 @@ SIMLIB_IMPLEMENTATION;
 class WaitUntilList {
     typedef std::list<Process *> container_t;
     container_t l;
-    static WaitUntilList *instance;   // unique list
+    container_t on;                     // processes in WaitUntilOn
+    static WaitUntilList *&instance();  // unique list (in Simulation)
   public:
     typedef container_t::iterator iterator;
-    static iterator begin() { return instance->l.begin(); }
-    static iterator end() { return instance->l.end(); }
-    static bool empty() { return instance->l.empty(); }
+    static iterator begin() { return instance()->l.begin(); }
+    static iterator end() { return instance()->l.end(); }
+    static bool empty() { return instance()->l.empty(); }
     static void InsertCurrent();     // insert current process into list
     static void GetCurrent();        // get current process
     static void WU_hook(); // active: next process in WUlist or 0
     static void Remove(Process *p) { // find and remove p
         Dprintf(("WaitUntil::Remove(%s)", p->Name()));
-        instance->l.remove(p); // should be in list
+        instance()->l.remove(p); // should be in list
     }
     static void clear();    // empty
+    static container_t::iterator InsertOn(Process *p) { // WaitUntilOn
+        if(instance()==0)
+            create();
+        return instance()->on.insert(instance()->on.end(), p);
+    }
+    static void RemoveOn(container_t::iterator i) {
+        instance()->on.erase(i);
+    }
     static void create() {  // create single instance
-        if(instance==0) instance = new WaitUntilList;
+        if(instance()==0) instance() = new WaitUntilList;
         else            SIMLIB_internal_error(); // called twice
         INSTALL_HOOK(WUclear, WaitUntilList::clear);
         SIMLIB_atexit(destroy); // last SIMLIB module cleanup calls this
     }
     static void destroy() {  // destroy single instance
         clear();             // remove all contents
-        delete instance;
-        instance = 0;
+        delete instance();
+        instance() = 0;
     }
   private:
     WaitUntilList() { Dprintf(("WaitUntilList::WaitUntilList()")); }
     ~WaitUntilList() { Dprintf(("WaitUntilList::~WaitUntilList()")); }
     // destructor never called ###???
-    static iterator current;
+    static thread_local iterator current;
 #ifndef NDEBUG
     friend void WU_print();
 #endif
@@ -74,19 +88,21 @@ class WaitUntilList {
 #ifndef NDEBUG
     void WU_print() {
        _Print("WaitUntilList:\n");
-       if(WaitUntilList::instance == 0) { _Print("none\n"); return; }
+       if(WaitUntilList::instance() == 0) { _Print("none\n"); return; }
        WaitUntilList::iterator i = WaitUntilList::begin();
        for( int n=0 ; i!=WaitUntilList::end() ; ++i, ++n )
          _Print(" [%d] %s\n", n, (*i)->Name() );
     }
 #endif
 
-// WaitUntilList single instance
-WaitUntilList *WaitUntilList::instance = 0; // static
-WaitUntilList::iterator WaitUntilList::current; // static
+// WaitUntilList single instance is owned by simulation context
+WaitUntilList *&WaitUntilList::instance() { // static
+    return Simulation::Current().wait_until;
+}
+thread_local WaitUntilList::iterator WaitUntilList::current; // static
 
 ////////////////////////////////////////////////////////////////////////////
-static bool flag = false; // valid iterator in WUList
+static thread_local bool flag = false; // valid iterator in WUList
 ////////////////////////////////////////////////////////////////////////////
 // main WUlist interface function
 void WaitUntilList::WU_hook() { // get ptr to next process in WUlist or 0
@@ -156,7 +172,7 @@ void WaitUntilList::InsertCurrent()
     //CONDITION: current process is not in WUlist
     Process *e = (Process*) SIMLIB_Current; // static_cast<>
     Dprintf(("WaitUntilList.Insert(%s)", e->Name()));
-    if(instance==0)
+    if(instance()==0)
         create(); // create singleton instance
     if(empty())   // it was empty
         INSTALL_HOOK(WUget_next, WaitUntilList::WU_hook); // install hook
@@ -164,7 +180,7 @@ void WaitUntilList::InsertCurrent()
     for( pos = begin(); // find place from beginning
          pos != end() && (*pos)->Priority >= e->Priority;  // higher first
          ++pos ) { /*empty*/ }
-    instance->l.insert(pos,e);  // insert at position
+    instance()->l.insert(pos,e);  // insert at position
     //e->_wait_until = true; // mark process as inserted
 }
 
@@ -178,7 +194,7 @@ void WaitUntilList::GetCurrent()
   //PRECONDITION: WUlist is initialized, not empty
   Process *p = *current;
   Dprintf(("WaitUntilList.Get(); // \"%s\" ", p->Name()));
-  instance->l.erase(current); // remove item pointed by iterator (fast)
+  instance()->l.erase(current); // remove item pointed by iterator (fast)
   if(empty())
     INSTALL_HOOK(WUget_next, 0); // uninstall hook if last item removed
   flag = false;           // iterator invalid, start from beginning
@@ -189,7 +205,7 @@ void WaitUntilList::GetCurrent()
 //
 void WaitUntilList::clear()
 {
-    if(instance==0) return;
+    if(instance()==0) return;
     // remove all processes in WaitUntilList
     // we can do this, because all processes in list are passivated
     iterator i=begin();
@@ -199,11 +215,125 @@ void WaitUntilList::clear()
        p->_WaitUntilRemove();        // unmark and remove process
        if( p->isAllocated() ) delete p; // the same behavior as Calendar###???
     }
-    if(!instance->l.empty())
+    if(!instance()->l.empty())
         SIMLIB_internal_error(); // for sure
+    while(!instance()->on.empty()) { // processes in WaitUntilOn
+       Process *p = instance()->on.front();
+       p->_WaitOnRemove();           // unregister from signals and list
+       if( p->isAllocated() ) delete p;
+    }
     INSTALL_HOOK(WUget_next, 0); // uninstall hook if empty
 }
 
 
-} // end
+////////////////////////////////////////////////////////////////////////////
+// WaitUntilOn implementation
+////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////
+/// registrations of waiting process in signals
+struct Process::WaitOnList {
+    struct Item {
+        Signal *signal;
+        std::list<Process*>::iterator pos;  // position in Signal::waiting
+    };
+    std::vector<Item> items;
+    std::list<Process*>::iterator pos;      // position in WaitUntilList
+    bool waiting;                           // is in WaitUntilList
+    WaitOnList(): waiting(false) {}
+};
 
+////////////////////////////////////////////////////////////////////////////
+// Signal constructors, destructor
+//
+Signal::Signal()
+{
+    Dprintf(("Signal::Signal()"));
+}
+
+Signal::Signal(const char *name)
+{
+    Dprintf(("Signal::Signal(\"%s\")", name));
+    SetName(name);
+}
+
+Signal::~Signal()
+{
+    Dprintf(("Signal::~Signal() // \"%s\" ", Name()));
+    // waiting processes would never be woken up
+    if(!waiting.empty() && SIMLIB_Phase == SIMULATION)
+        SIMLIB_error(SignalDeleteError);
+    // outside of simulation: unregister processes (they remain passive
+    // and are removed by next Init or at exit, see WaitUntilList::clear)
+    for(std::list<Process*>::iterator i=waiting.begin(); i!=waiting.end(); ++i) {
+        std::vector<Process::WaitOnList::Item> &v = (*i)->_wait_on->items;
+        for(unsigned j=0; j<v.size(); j++)
+            if(v[j].signal == this) {
+                v[j] = v.back();
+                v.pop_back();
+                break;
+            }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Wake --- reactivate waiting processes (they test their conditions)
+//
+void Signal::Wake()
+{
+    Dprintf(("%s.Wake() // %u waiting", Name(), Waiting()));
+    while(!waiting.empty()) {
+        Process *p = waiting.front();
+        p->_WaitOnRemove();     // from all signals (including this)
+        p->Activate();          // test condition now
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// _WaitUntilOn --- wait for condition, hidden by macro WaitUntilOn
+// the process is passive until one of the signals is notified
+//
+bool Process::_WaitUntilOn(bool test, std::initializer_list<Signal*> signals)
+{
+  Dprintf(("%s._WaitUntilOn(%s)", Name(), test?"true":"false" ));
+  _WaitOnRemove();              // activated by other means (Activate,...)
+  if(test)                      // true --- end of wait
+      return false;
+  if (SIMLIB_Current != this) SIMLIB_internal_error();
+  if(_wait_on == 0)
+      _wait_on = new WaitOnList;
+  for(std::initializer_list<Signal*>::const_iterator i = signals.begin();
+      i != signals.end(); ++i) {
+      Signal *s = *i;
+      WaitOnList::Item it = { s, s->waiting.insert(s->waiting.end(), this) };
+      _wait_on->items.push_back(it);
+  }
+  _wait_on->pos = WaitUntilList::InsertOn(this);
+  _wait_on->waiting = true;
+  Passivate();                  // deactivation = wait
+  return true;                  // repeat test (after activation)
+}
+
+////////////////////////////////////////////////////////////////////////////
+// _WaitOnRemove --- remove process from all signals
+//                   (destroy: free the list, used by ~Process)
+//
+void Process::_WaitOnRemove(bool destroy)
+{
+  if(_wait_on == 0)
+      return;
+  if(_wait_on->waiting) {
+      std::vector<WaitOnList::Item> &v = _wait_on->items;
+      for(unsigned i=0; i<v.size(); i++)
+          v[i].signal->waiting.erase(v[i].pos);
+      v.clear();
+      WaitUntilList::RemoveOn(_wait_on->pos);
+      _wait_on->waiting = false;
+  }
+  if(destroy) {
+      delete _wait_on;
+      _wait_on = 0;
+  }
+}
+
+} // end
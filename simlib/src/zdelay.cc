@@ -25,7 +25,7 @@
 #include "zdelay.h"
 #include "internal.h"
 
-#include <set>          // for ZDelay objects container implementation
+#include <vector>       // for ZDelay objects container implementation
 #include <list>         // for list of ZDelayTimers
 
 ////////////////////////////////////////////////////////////////////////////
@@ -40,7 +40,7 @@ SIMLIB_IMPLEMENTATION;
 //
 class SIMLIB_ZDelayTimer {
     typedef std::list<ZDelayTimer *> container_t; // type of container we use
-    static container_t *container;      // list of delay objects -- singleton
+    static thread_local container_t *container;      // list of delay objects -- singleton
   public: // interface
     static void Register(ZDelayTimer *p) { // called from ZDelayTimer constructor
         if( container == 0 )
@@ -74,7 +74,7 @@ class SIMLIB_ZDelayTimer {
 };
 
 // SINGLETON: static member must be initializad
-SIMLIB_ZDelayTimer::container_t * SIMLIB_ZDelayTimer::container = 0;
+thread_local SIMLIB_ZDelayTimer::container_t * SIMLIB_ZDelayTimer::container = 0;
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -82,22 +82,58 @@ SIMLIB_ZDelayTimer::container_t * SIMLIB_ZDelayTimer::container = 0;
 //
 
 // singleton -- default ZDelayTimer
-ZDelayTimer * ZDelay::default_clock = 0;
+thread_local ZDelayTimer * ZDelay::default_clock = 0;
 
 /////////////////////////////////////////////////////////////////////////////
-// ZDelayTimer::ZDelayContainer --- container for associated ZDelay blocks
+// ZDelayTimer::ZDelayContainer --- register bank of associated ZDelay blocks
+//
+// block[k] uses element k of all arrays, tick:
+//   in[k] = input value of block[k]   (all inputs first)
+//   out = next, next = in             (swap of arrays, no copying)
 //
 class ZDelayTimer::ZDelayContainer { // implementation-defined container
-        typedef std::set<ZDelay*> container_t;
-        container_t c;
+        std::vector<ZDelay*> block;     // associated blocks
+        std::vector<double> in;         // sampled input values
+        std::vector<double> next;       // stored values (next output)
     public:
-        ZDelayContainer(): c() {}
-        typedef container_t::iterator iterator;
-        iterator begin()        { return c.begin(); }
-        iterator end()          { return c.end(); }
-        void insert(ZDelay * p) { c.insert(p); }
-        void erase(ZDelay * p)  { c.erase(p); }
-        void clear()            { c.clear(); }
+        std::vector<double> out;        // output values (delayed signal)
+        ZDelayContainer(): block(), in(), next(), out() {}
+        size_t size() const     { return block.size(); }
+        ZDelay *operator[](size_t k) { return block[k]; }
+        void insert(ZDelay * p) {
+            p->slot = block.size();
+            block.push_back(p);
+            in.push_back(p->initval);
+            next.push_back(p->initval);
+            out.push_back(p->initval);
+        }
+        void erase(ZDelay * p)  {       // move last block to the slot
+            size_t k = p->slot;
+            block[k] = block.back();
+            block[k]->slot = k;
+            in[k] = in.back();
+            next[k] = next.back();
+            out[k] = out.back();
+            block.pop_back();
+            in.pop_back();
+            next.pop_back();
+            out.pop_back();
+        }
+        void init(size_t k, double v) { in[k] = next[k] = out[k] = v; }
+        void tick() {
+            const size_t n = block.size();
+            double *x = in.data();
+            for(size_t k=0; k<n; k++)   // evaluate all inputs
+                x[k] = block[k]->InputValue();
+            out.swap(next);             // store all new output values
+            next.swap(in);
+        }
+        void clear() {
+            block.clear();
+            in.clear();
+            next.clear();
+            out.clear();
+        }
 }; // class ZDelayTimer::ZDelayContainer
 
 /////////////////////////////////////////////////////////////////////////////
@@ -118,9 +154,10 @@ ZDelayTimer::~ZDelayTimer()
     if( ZDelay::default_clock == this)
         ZDelay::default_clock = 0; // default timer deleted
     // clear all items
-    ZDelayContainer::iterator i=c->begin();
-    for( ; i!=c->end(); i++) // unregister all ZDelays
-        (*i)->clock = 0;
+    for(size_t k=0; k<c->size(); k++) { // unregister all ZDelays
+        (*c)[k]->value = c->out[k];     // keep output value
+        (*c)[k]->clock = 0;
+    }
     c->clear(); // remove all items
     delete c;
     SIMLIB_ZDelayTimer::UnRegister(this); // remove from list
@@ -131,9 +168,8 @@ ZDelayTimer::~ZDelayTimer()
 //
 void ZDelayTimer::Init()  // called each Run()
 {
-    ZDelayContainer::iterator i=c->begin();
-    for( ; i!=c->end(); i++) // init all assotiated ZDelays
-        (*i)->Init();
+    for(size_t k=0; k<c->size(); k++) // init all assotiated ZDelays
+        (*c)[k]->Init();
     Start();
 }
 
@@ -158,11 +194,7 @@ void ZDelayTimer::Stop() // clock deactivation
 //
 void ZDelayTimer::Behavior()
 {
-    ZDelayContainer::iterator i;
-    for( i=c->begin(); i!=c->end(); i++) // evaluate all inputs
-        (*i)->SampleIn();
-    for( i=c->begin(); i!=c->end(); i++) // store all new output values
-        (*i)->SampleOut();
+    c->tick();  // sample inputs and shift values of all associated ZDelays
     Activate( Time + dt );
 }
 
@@ -180,6 +212,7 @@ void ZDelayTimer::Register(ZDelay*p)
 //
 void ZDelayTimer::UnRegister(ZDelay*p)
 {
+    p->value = c->out[p->slot];
     c->erase(p);
     p->clock = 0;
 }
@@ -196,10 +229,9 @@ void ZDelayTimer::UnRegister(ZDelay*p)
 //
 ZDelay::ZDelay(Input i, ZDelayTimer *p, double ival) :
     aContiBlock1( i ),                  // input expression
-    input_value( ival ),
     clock( p ),
-    new_value( ival ),
-    old_value( ival ),
+    slot( 0 ),
+    value( ival ),
     initval( ival )                     // initial value of delay
 {   // constructor body
     Dprintf(("ZDelay::ZDelay%p(in=%p, timer=%p, ival=%g)", this, &i, p, ival));
@@ -211,10 +243,9 @@ ZDelay::ZDelay(Input i, ZDelayTimer *p, double ival) :
 
 ZDelay::ZDelay( Input i, double ival ) :
     aContiBlock1( i ),                  // input expression
-    input_value( ival ),
     clock( default_clock ),
-    new_value( ival ),
-    old_value( ival ),
+    slot( 0 ),
+    value( ival ),
     initval( ival )                     // initial value of delay
 {   // constructor body
     Dprintf(("ZDelay::ZDelay%p(in=%p, ival=%g)", this, &i, ival));
@@ -240,7 +271,9 @@ ZDelay::~ZDelay()
 // called automatically by Run()
 void ZDelay::Init() {
     Dprintf(("ZDelay::Init()"));
-    input_value = new_value = old_value = initval;
+    value = initval;
+    if(clock)
+        clock->c->init(slot, initval);
 }
 
 void ZDelay::Init(double iv) { // set initial value of ZDelay block
@@ -248,29 +281,13 @@ void ZDelay::Init(double iv) { // set initial value of ZDelay block
     Init();
 }
 
-/////////////////////////////////////////////////////////////////////////////
-// ZDelay::Sample --- sample input value
-//
-void ZDelay::SampleIn()
-{
-    Dprintf(("ZDelay::SampleIn()"));
-    input_value = InputValue(); // store new input value
-}
-
-void ZDelay::SampleOut()
-{
-    Dprintf(("ZDelay::SampleOut()"));
-    old_value = new_value;      // set output value (delayed)
-    new_value = input_value;    // store new input value for delay
-}
-
 /////////////////////////////////////////////////////////////////////////////
 // ZDelay::Value --- get delay output value
 //
 double ZDelay::Value()
 {
     Dprintf(("ZDelay::Value()"));
-    return old_value; // delayed value
+    return clock ? clock->c->out[slot] : value; // delayed value
 }
 
 }
@@ -27,6 +27,10 @@ class ZDelayTimer;
 ////////////////////////////////////////////////////////////////////////////
 // class ZDelayTimer --- clock for ZDelay blocks
 //
+//  Values of all ZDelay blocks connected to the timer are stored in
+//  contiguous arrays (register bank), tick = sample all inputs into one
+//  array, then shift arrays (input -> stored -> output)
+//
 class ZDelayTimer : public Event {
     ZDelayTimer(const ZDelayTimer&); // ##
     ZDelayTimer&operator=(const ZDelayTimer&); // ##
@@ -55,18 +59,13 @@ class ZDelayTimer : public Event {
 class ZDelay : public aContiBlock1 {
     ZDelay(const ZDelay&);              // disable copy ctor
     void operator= (const ZDelay&);     // disable assignment
-    double input_value;                 // temporary
     ZDelayTimer *clock;                 // timer-event for this block
+    size_t slot;                        // index in register bank of timer
+    double value;                       // output value (if no timer)
     friend class ZDelayTimer;
-  protected:
-    virtual void SampleIn();    // sample input (called automatically by ZDelayTimer)
-    virtual void SampleOut();   // sample output (called automatically)
-  protected: // status
-    double new_value;   // stored input value
-    double old_value;   // output value (delayed signal)
   protected: // parameters
     double initval;     // initial output value
-    static ZDelayTimer * default_clock;
+    static thread_local ZDelayTimer * default_clock;
   public: // interface
     ZDelay( Input i, ZDelayTimer * clock = default_clock, double initvalue = 0 );
     ZDelay( Input i, double initvalue );
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////
+// 3d-array-test.cc
+//
+// packed Value3D/Value2D operations and Integrator3DArray:
+// N-body system (gravity) modelled by Integrator3D blocks and by
+// one array with batched evaluation of forces, array with inputs
+// (default Eval) for harmonic oscillator
+//
+#include "simlib.h"
+#include "simlib2D.h"
+#include "simlib3D.h"
+#include <cmath>
+
+const int K = 5;                        // # of bodies
+const double G = 1.0;                   // gravity constant
+const double mass[K] = { 1, 0.1, 0.01, 0.02, 0.001 };
+
+static Value3D P0(int i)                // initial position
+{
+    return Value3D(i, 0.1*i*i, 0.05*i);
+}
+
+static Value3D V0(int i)                // initial velocity
+{
+    return i==0 ? Value3D(0,0,0) : Value3D(0, std::sqrt(G/i), 0.01*i);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// model 1: block expressions (Integrator3D for each body)
+struct Body;
+static Body *bodies[K];
+
+struct Body {
+    int i;
+    Integrator3D v, p;
+    Body(int n, Input3D a) : i(n), v(a, V0(n)), p(v, P0(n)) {}
+};
+
+class Acceleration : public aContiBlock3D {
+    int i;
+  public:
+    Acceleration(int n) : i(n) {}
+    Value3D Value() {
+        Value3D a(0,0,0);
+        Value3D p = bodies[i]->p.Value();
+        for(int j=0; j<K; j++) {
+            if(j == i) continue;
+            Value3D d = bodies[j]->p.Value() - p;
+            double r = abs(d);
+            a = a + d * (G * mass[j] / (r*r*r));
+        }
+        return a;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// model 2: array (elements 0..K-1 positions, K..2K-1 velocities)
+class NBody : public Integrator3DArray {
+  public:
+    NBody() : Integrator3DArray(2*K) {
+        for(int i=0; i<K; i++) {
+            Init(i, P0(i));
+            Init(K+i, V0(i));
+        }
+    }
+    void Eval() {               // all inputs in one loop
+        for(int i=0; i<K; i++) {
+            Value3D p = Get(i);
+            Value3D a(0,0,0);
+            for(int j=0; j<K; j++) {
+                if(j == i) continue;
+                Value3D d = Get(j) - p;
+                double r = abs(d);
+                a = a + d * (G * mass[j] / (r*r*r));
+            }
+            SetDiff(i, Get(K+i));
+            SetDiff(K+i, a);
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// model 3: harmonic oscillator p'' = -w^2 p by array inputs (default Eval)
+// element 0 position, element 1 velocity
+const double W = 2.0;
+
+static double Oscillator()
+{
+    Integrator3DArray a(2);
+    a.SetInput(0, a[1]);
+    a.SetInput(1, -W*W * Input3D(a[0]));
+    a.Init(0, Value3D(1, 0, 0.5));
+    a.Init(1, Value3D(0, W, 0));
+    SetStep(1e-8, 0.01);
+    SetAccuracy(1e-10, 1e-8);
+    Init(0, 3);
+    Run();
+    // p = (cos(wt), sin(wt), 0.5*cos(wt))
+    const double t = 3;
+    Value3D p(std::cos(W*t), std::sin(W*t), 0.5*std::cos(W*t));
+    return abs(a.Get(0) - p);
+}
+
+static void Setup()
+{
+    SetStep(1e-8, 0.01);
+    SetAccuracy(1e-10, 1e-8);
+    Init(0, 10);
+}
+
+int main()
+{
+    Print("3d-array-test --- packed 3D values, Integrator3DArray\n");
+    Value3D a(1,2,3), b(-2,0.5,4);
+    Print("a+b:"); Print(a+b); Print("\n");
+    Print("a-b:"); Print(a-b); Print("\n");
+    Print("-a:"); Print(-a); Print("\n");
+    Print("a*b:"); Print(a*b); Print("\n");
+    Print("a*2:"); Print(a*2); Print("\n");
+    Print("2*a:"); Print(2*a); Print("\n");
+    Print("a/2:"); Print(a/2); Print("\n");
+    Print("a.b = %g, |a| = %g\n", scalar_product(a,b), abs(a));
+    Print("|a*inf| = %g, |inf*a| = %g\n", abs(a*INFINITY), abs(INFINITY*a));
+    Print("aligned: %s\n", alignof(Value3D) == 4*sizeof(double) &&
+                           alignof(Value2D) == 2*sizeof(double) ? "yes" : "no");
+    Value2D c(3,4), d(1,-1);
+    Print("2D: "); Print(c+d); Print(c-d); Print(-c); Print(c*2);
+    Print(2*c); Print(c/2);
+    Print(" %g %g\n", scalar_product(c,d), abs(c));
+
+    SetMethod("rkf5");
+    for(int i=0; i<K; i++)
+        bodies[i] = new Body(i, new Acceleration(i));
+    Setup();
+    Run();
+    double r1[K][3];
+    for(int i=0; i<K; i++) {
+        Value3D p = bodies[i]->p.Value();
+        r1[i][0] = p.x(); r1[i][1] = p.y(); r1[i][2] = p.z();
+    }
+    for(int i=0; i<K; i++)
+        delete bodies[i];
+
+    NBody *n = new NBody;
+    Setup();
+    Run();
+    double e = 0;
+    for(int i=0; i<K; i++) {
+        Value3D p(r1[i][0], r1[i][1], r1[i][2]);
+        e = std::max(e, abs(n->Get(i) - p));
+    }
+    Print("positions at t=10: %s\n", e < 1e-6 ? "SAME" : "DIFFERENT");
+    Print("body 1:"); Print((*n)[1].Value()); Print("\n");
+    delete n;
+
+    Print("oscillator (default Eval): %s\n",
+          Oscillator() < 1e-6 ? "OK" : "BAD");
+    return 0;
+}
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////
+// condition-test.cc
+//
+// location of state condition changes inside integration step (dense
+// output + root finding): bouncing ball compared with exact times of
+// bounces, ConditionUp on time function, crossings of harmonic
+// oscillator (derivatives used by dense output are exact)
+//
+#include "simlib.h"
+#include <cmath>
+
+const double g = 9.81;
+const double k = 0.8;                   // energy loss
+const int bounces = 10;
+
+static unsigned long evaluations = 0;   // # of model evaluations
+static double Count(double x) { evaluations++; return x; }
+
+class Ball : ConditionDown {
+  public:
+    Integrator v, y;
+    int count;
+    double t[bounces];                  // times of bounces
+    void Action() {
+        t[count++] = T.Value();
+        v = -k * v.Value();
+        y = 0;
+        if(count >= bounces)
+            Stop();
+    }
+    Ball() : ConditionDown(y),
+             v(new Function1(-g, Count)), y(v, 1.0), count(0) {}
+};
+
+class Crossing : ConditionUp {         // Sin(2*T) >= 0.5
+  public:
+    int count;
+    double t[4];
+    void Action() { if(count < 4) t[count] = T.Value(); count++; }
+    Crossing() : ConditionUp(Sin(2*T) - 0.5), count(0) {}
+};
+
+static void BallTest(const char *method)
+{
+    Ball b;
+    SetMethod(method);
+    SetStep(1e-10, 0.5);
+    SetAccuracy(1e-8, 1e-6);
+    evaluations = 0;
+    Init(0, 100);
+    Run();
+    // exact times: first fall sqrt(2/g), then flights 2*v/g
+    double te = std::sqrt(2/g), v = g*te, e = 0;
+    for(int i=0; i<bounces; i++) {
+        e = std::max(e, std::fabs(b.t[i] - te));
+        v *= k;
+        te += 2*v/g;
+    }
+    Print("ball %-5s bounces=%d accuracy %s, evaluations/bounce %s\n",
+          method, b.count, e < 1e-6 ? "OK" : "BAD",
+          evaluations < 150UL*bounces ? "OK" : "BAD");
+}
+
+class Oscillator : ConditionDown {     // y = cos(t) <= 0.5
+  public:
+    Integrator v, y;
+    int count;
+    double t[8];
+    void Action() { if(count < 8) t[count] = T.Value(); count++; }
+    Oscillator() : ConditionDown(y - 0.5), v(-y), y(v, 1.0), count(0) {}
+};
+
+static void OscillatorTest(const char *method)
+{
+    Oscillator c;
+    SetMethod(method);
+    SetStep(1e-10, 0.5);
+    SetAccuracy(1e-8, 1e-6);
+    Init(0, 50);
+    Run();
+    // exact: t = pi/3 + 2*pi*i
+    double e = 0;
+    for(int i=0; i<8; i++)
+        e = std::max(e, std::fabs(c.t[i] - (M_PI/3 + 2*M_PI*i)));
+    Print("oscillator %-5s count=%d accuracy %s\n",
+          method, c.count, e < 4e-5 ? "OK" : "BAD");
+}
+
+static void CrossingTest(const char *method)
+{
+    Crossing c;
+    Integrator dummy(1.0);          // continuous model
+    SetMethod(method);
+    SetStep(1e-10, 0.5);
+    SetAccuracy(1e-8, 1e-6);
+    Init(0, 10);
+    Run();
+    // exact: 2t = pi/6 + 2*pi*i
+    double e = 0;
+    for(int i=0; i<4; i++)
+        e = std::max(e, std::fabs(c.t[i] - (M_PI/6 + 2*M_PI*i)/2));
+    Print("crossing %-5s count=%d accuracy %s\n",
+          method, c.count, e < 1e-6 ? "OK" : "BAD");
+}
+
+int main()
+{
+    Print("condition-test --- location of state events\n");
+    const char *methods[] = { "rke", "rkf3", "rkf5", "rkf8", "abm4" };
+    for(unsigned i=0; i<sizeof(methods)/sizeof(*methods); i++)
+        BallTest(methods[i]);
+    CrossingTest("rkf5");
+    CrossingTest("abm4");
+    OscillatorTest("rke");
+    OscillatorTest("rkf5");
+    return 0;
+}
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////
+// delay-buffer-test.cc
+//
+// Delay buffer (ring buffer with search cursor):
+//  - many long delays, compared with exact values
+//  - interpolation of order 1, 2, 3 (accuracy)
+//  - delay time increased by Set (history kept by SetHistory)
+//  - limited number of samples
+//
+#include "simlib.h"
+#include "delay.h"
+#include <cmath>
+
+const double w = 2.0;                   // frequency of input signal
+
+static double Error(Delay &d, double dt)
+{
+    return std::fabs(d.Value() - std::sin(w*(T.Value() - dt)));
+}
+
+static double OrderTest(int order)
+{
+    Delay d(Sin(w*T), 5.0);
+    d.SetInterpolation(order);
+    Integrator i(d);
+    SetMethod("rkf5");
+    SetStep(1e-6, 0.1);
+    SetAccuracy(1e-8, 1e-8);
+    Init(0, 20);
+    Run();
+    return Error(d, 5.0);
+}
+
+static void ManyTest()
+{
+    const int N = 100;
+    Delay *d[N];
+    for(int k=0; k<N; k++)
+        d[k] = new Delay(Sin(w*T), 1.0 + 0.2*k);
+    Integrator i(d[N-1]);
+    SetMethod("rke");
+    SetStep(1e-6, 0.01);
+    Init(0, 30);
+    Run();
+    double e = 0;
+    for(int k=0; k<N; k++) {
+        e = std::max(e, Error(*d[k], 1.0 + 0.2*k));
+        delete d[k];
+    }
+    Print("%d delays: accuracy %s\n", N, e < 1e-3 ? "OK" : "BAD");
+}
+
+static void SetTest(double history)
+{
+    Delay d(Sin(w*T), 1.0);
+    d.SetHistory(history);
+    Integrator i(d);
+    SetMethod("rke");
+    SetStep(1e-6, 0.01);
+    Init(0, 10);
+    Run();
+    d.Set(4.0);                         // increase delay time
+    Print("Set(4) with history %g: past values %s\n", history,
+          Error(d, 4.0) < 1e-3 ? "KEPT" : "LOST");
+}
+
+static void LimitTest()
+{
+    Delay d(Sin(w*T), 1.0);
+    d.SetHistory(100, 50);              // at most 50 samples
+    Integrator i(d);
+    SetMethod("rke");
+    SetStep(1e-6, 0.01);
+    Init(0, 10);
+    Run();
+    // about 100 steps per time unit, only 0.5 time units are kept
+    Print("50 samples: history %s\n", Error(d, 1.0) > 0.1 ? "LIMITED" : "FULL");
+}
+
+int main()
+{
+    Print("delay-buffer-test --- ring buffer of Delay\n");
+    double e1 = OrderTest(1);
+    double e2 = OrderTest(2);
+    double e3 = OrderTest(3);
+    Print("linear: accuracy %s\n", e1 < 1e-2 ? "OK" : "BAD");
+    Print("quadratic: accuracy %s, better %s\n", e2 < 1e-3 ? "OK" : "BAD",
+          e2 < e1 ? "OK" : "BAD");
+    Print("cubic: accuracy %s, better %s\n", e3 < 1e-4 ? "OK" : "BAD",
+          e3 < e2 ? "OK" : "BAD");
+    ManyTest();
+    SetTest(1);
+    SetTest(5);
+    LimitTest();
+    return 0;
+}
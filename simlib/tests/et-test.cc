@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////
+// et-test.cc
+//
+// expression templates (simlibET.h): the same model built from blocks
+// and from expression templates gives the same results
+//
+#include "simlib.h"
+#include "simlibET.h"
+
+Parameter g(9.81), l(2);
+Variable b(0.3);
+
+// damped pendulum with forcing, block expressions
+Integrator w1, f1;
+// the same model, expression templates (Time by dynamic block T)
+Integrator w2, f2;
+
+static void Experiment(const char *name, Integrator &w, Integrator &f)
+{
+    SetMethod("rkf5");
+    SetAccuracy(1e-9, 1e-9);
+    f.Init(1.2);
+    w.Init(0);
+    Init(0, 10);
+    Run();
+    Print("%-10s phi=%.12g omega=%.12g\n", name, f.Value(), w.Value());
+}
+
+int main()
+{
+    Print("et-test --- expression templates\n");
+    w1.SetInput(-g/l*Sin(f1) - b*w1 + 0.5*Cos(Sqr(T)/10) + Max(f1, 0.5));
+    f1.SetInput(w1);
+    Experiment("blocks", w1, f1);
+    double phi = f1.Value();
+
+    w2.SetInput(ETInput(-ET(g)/ET(l)*Sin(ET(f2)) - ET(b)*ET(w2)
+                        + 0.5*Cos(Sqr(ET(T))/10) + Max(ET(f2), ET(0.5))));
+    f2.SetInput(w2);
+    Experiment("templates", w2, f2);
+    Print("results: %s\n", f2.Value() == phi ? "SAME" : "DIFFERENT");
+
+    // template expression used with dynamic blocks
+    Expression e(ETInput(ET(f2)*ET(f2)) + 1);
+    Print("mixed: %s\n", e.Value() == f2.Value()*f2.Value() + 1 ? "OK" : "BAD");
+    return 0;
+}
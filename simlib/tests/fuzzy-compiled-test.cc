@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////
+// fuzzy-compiled-test.cc
+//
+// FuzzyCompiledRules: the same outputs as interpreted FuzzyGeneralRules
+// for AND, OR and NAND rules (exact mode and lookup tables)
+//
+#include "simlib.h"
+#include "fuzzy.h"
+#include <cmath>
+
+typedef FuzzyInferenceRules R;
+
+const FuzzySet E("e", -1, 1,
+                 FuzzyTriangle("N", -1, -1, 0),
+                 FuzzyTriangle("Z", -1, 0, 1),
+                 FuzzyTriangle("P", 0, 1, 1));
+const FuzzySet DE("de", -2, 2,
+                  FuzzyTrapez("N", -2, -2, -1.3, 0),
+                  FuzzyTriangle("Z", -1, 0, 1),
+                  FuzzyTrapez("P", 0, 1.3, 2, 2));
+const FuzzySet U("u", -10, 10,
+                 FuzzyTriangle("NB", -10, -10, -5),
+                 FuzzyTriangle("N", -10, -5, 0),
+                 FuzzyTriangle("Z", -5, 0, 5),
+                 FuzzyTriangle("P", 0, 5, 10),
+                 FuzzyTriangle("PB", 5, 10, 10));
+
+Variable x(0), y(0);            // inputs of all regulators
+
+// variables and general rules of one regulator
+struct Regulator {
+    FuzzyInput e, de;
+    FuzzyOutput u;
+    FuzzyGeneralRules rules;
+    Regulator(R::Operations op) : e(x, E), de(y, DE), u(U, defuzDCOG) {
+        static const char *w[3] = { "N", "Z", "P" };
+        static const char *tab[3][3] = {
+            { "NB", "N", "Z" }, { "N", "Z", "P" }, { "Z", "P", "PB" } };
+        rules.addFuzzyInput(&e);
+        rules.addFuzzyInput(&de);
+        rules.addFuzzyOutput(&u);
+        FuzzyRuleFactory *f = rules.createRuleFactory();
+        for(int i=0; i<3; i++)
+            for(int j=0; j<3; j++) {
+                FuzzyRule *r = f->createRule();
+                r->addLeft(f->createNode(f->createNode(&e, w[i]),
+                                         f->createNode(&de, w[j]), op));
+                r->addRight(f->createNode(&u, tab[i][j]));
+                rules.add(r);
+            }
+        delete f;
+    }
+};
+
+// inference block evaluating given rules
+class Block : public FuzzyRSBlock {
+  public:
+    Block(FuzzyInferenceRules &r, Regulator &reg) : FuzzyRSBlock(r) {
+        EndConstructor();
+        reg.e.registerOwner(this);
+        reg.de.registerOwner(this);
+        reg.u.registerOwner(this);
+    }
+};
+
+static void Test(const char *name, R::Operations op)
+{
+    Regulator r0(op), r1(op), r2(op);
+    FuzzyCompiledRules exact(r1.rules, 0), table(r2.rules);
+    Block b0(r0.rules, r0), b1(exact, r1), b2(table, r2);
+    double e1 = 0, e2 = 0, sum = 0;
+    for(int i=0; i<=40; i++)
+        for(int j=0; j<=40; j++) {
+            x = -1 + 0.05*i;
+            y = -2 + 0.1*j;
+            double v = r0.u.Value();
+            e1 = std::max(e1, std::fabs(r1.u.Value() - v));
+            e2 = std::max(e2, std::fabs(r2.u.Value() - v));
+            sum += std::fabs(v);
+        }
+    Print("%-4s: sum|u|=%.4f exact %s, table %s\n", name, sum,
+          e1 < 1e-12 ? "SAME" : "DIFFERENT", e2 < 0.02 ? "OK" : "BAD");
+}
+
+int main()
+{
+    Print("fuzzy-compiled-test --- compiled fuzzy inference rules\n");
+    Test("AND", R::opAND);
+    Test("OR", R::opOR);
+    Test("NAND", R::opNAND);
+    return 0;
+}
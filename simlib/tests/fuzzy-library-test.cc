@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////
+// fuzzy-library-test.cc
+//
+// fuzzy extension linked from library built with MODULES=fuzzy (not from
+// sources): FuzzyCompiledRules gives the same output as interpreted rules
+//
+#include "simlib.h"
+#include "fuzzy.h"
+#include <cmath>
+
+const FuzzySet E("e", -1, 1,
+                 FuzzyTriangle("N", -1, -1, 0),
+                 FuzzyTriangle("Z", -1, 0, 1),
+                 FuzzyTriangle("P", 0, 1, 1));
+const FuzzySet U("u", -10, 10,
+                 FuzzyTriangle("NB", -10, -10, -5),
+                 FuzzyTriangle("N", -10, -5, 0),
+                 FuzzyTriangle("Z", -5, 0, 5),
+                 FuzzyTriangle("P", 0, 5, 10),
+                 FuzzyTriangle("PB", 5, 10, 10));
+
+Variable x(0), y(0);
+
+// variables and general rules of one regulator
+struct Regulator {
+    FuzzyInput e, de;
+    FuzzyOutput u;
+    FuzzyGeneralRules rules;
+    Regulator() : e(x, E), de(y, E), u(U, defuzDCOG) {
+        static const char *w[3] = { "N", "Z", "P" };
+        static const char *tab[3][3] = {
+            { "NB", "N", "Z" }, { "N", "Z", "P" }, { "Z", "P", "PB" } };
+        rules.addFuzzyInput(&e);
+        rules.addFuzzyInput(&de);
+        rules.addFuzzyOutput(&u);
+        FuzzyRuleFactory *f = rules.createRuleFactory();
+        for(int i=0; i<3; i++)
+            for(int j=0; j<3; j++) {
+                FuzzyRule *r = f->createRule();
+                r->addLeft(f->createNode(f->createNode(&e, w[i]),
+                                         f->createNode(&de, w[j]),
+                                         FuzzyInferenceRules::opAND));
+                r->addRight(f->createNode(&u, tab[i][j]));
+                rules.add(r);
+            }
+        delete f;
+    }
+};
+
+class Block : public FuzzyRSBlock {
+  public:
+    Block(FuzzyInferenceRules &r, Regulator &reg) : FuzzyRSBlock(r) {
+        EndConstructor();
+        reg.e.registerOwner(this);
+        reg.de.registerOwner(this);
+        reg.u.registerOwner(this);
+    }
+};
+
+int main()
+{
+    Print("fuzzy-library-test --- fuzzy module in library\n");
+    Regulator r0, r1;
+    FuzzyCompiledRules compiled(r1.rules, 0);
+    Block b0(r0.rules, r0), b1(compiled, r1);
+    double e = 0;
+    for(int i=0; i<=20; i++)
+        for(int j=0; j<=20; j++) {
+            x = -1 + 0.1*i;
+            y = -1 + 0.1*j;
+            e = std::max(e, std::fabs(r1.u.Value() - r0.u.Value()));
+        }
+    Print("compiled rules: %s\n", e < 1e-12 ? "SAME" : "DIFFERENT");
+    return 0;
+}
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////
+// fuzzy-surface-test.cc
+//
+// FuzzyIIORules with precomputed output surface: error of interpolation
+// against exact inference in points off the grid is lower than maxError,
+// fuzzy values of variables are not changed by computeSurface()
+//
+#include "simlib.h"
+#include "fuzzy.h"
+#include <cmath>
+
+typedef FuzzyInferenceRules R;
+
+const FuzzySet E("e", -1, 1,
+                 FuzzyTriangle("N", -1, -1, 0),
+                 FuzzyTriangle("Z", -1, 0, 1),
+                 FuzzyTriangle("P", 0, 1, 1));
+const FuzzySet DE("de", -2, 2,
+                  FuzzyTrapez("N", -2, -2, -1.3, 0),
+                  FuzzyTriangle("Z", -1, 0, 1),
+                  FuzzyTrapez("P", 0, 1.3, 2, 2));
+const FuzzySet U("u", -10, 10,
+                 FuzzyTriangle("NB", -10, -10, -5),
+                 FuzzyTriangle("N", -10, -5, 0),
+                 FuzzyTriangle("Z", -5, 0, 5),
+                 FuzzyTriangle("P", 0, 5, 10),
+                 FuzzyTriangle("PB", 5, 10, 10));
+
+Variable x(0), y(0);            // inputs of all regulators
+
+// regulator: inference block with its own variables and rules
+class Regulator : public FuzzyRSBlock {
+    FuzzyIIORules r;
+  public:
+    FuzzyInput e, de;
+    FuzzyOutput u;
+    Regulator() : FuzzyRSBlock(r), e(x, E), de(y, DE), u(U, defuzDCOG) {
+        EndConstructor();
+        static const char *tab[3][3] = {
+            { "NB", "N", "Z" }, { "N", "Z", "P" }, { "Z", "P", "PB" } };
+        r.addFuzzyInput(&e);
+        r.addFuzzyInput(&de);
+        r.addFuzzyOutput(&u);
+        for(int j=0; j<3; j++)
+            for(int i=0; i<3; i++)
+                r.add(i == 1 && j == 1 ? R::opOR : R::opAND, i, j, tab[i][j]);
+    }
+    FuzzyIIORules &Rules() { return r; }
+};
+
+static void Test(const char *name, FuzzyIIORules::Surface method,
+                 double maxError)
+{
+    Regulator r0, r1;
+    r1.Rules().setSurface(5, 5, method, maxError);
+    // fuzzy values are restored
+    r1.e.Fuzzify(0.3);
+    r1.de.Fuzzify(-0.7);
+    double m[3] = { r1.e[1], r1.de[0], r1.de[1] };
+    r1.Rules().computeSurface();
+    bool restored = m[0] == r1.e[1] && m[1] == r1.de[0] && m[2] == r1.de[1];
+    double err = 0;
+    for(int i=0; i<=97; i++)
+        for(int j=0; j<=97; j++) {
+            x = -1 + 2.0*i/97;
+            y = -2 + 4.0*j/97;
+            err = std::max(err, std::fabs(r1.u.Value() - r0.u.Value()));
+        }
+    Print("%-8s: error %s maxError=%g, fuzzy values %s\n", name,
+          err <= maxError ? "<=" : ">", maxError,
+          restored ? "restored" : "CHANGED");
+}
+
+int main()
+{
+    Print("fuzzy-surface-test --- precomputed output surface\n");
+    Test("bilinear", FuzzyIIORules::sfBilinear, 0.2);
+    Test("bicubic", FuzzyIIORules::sfBicubic, 0.2);
+    Test("bilinear", FuzzyIIORules::sfBilinear, 0.05);
+    return 0;
+}
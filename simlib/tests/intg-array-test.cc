@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+// intg-array-test.cc
+//
+// integrator states in contiguous arrays: system of independent
+// equations y' = -a*y solved by all methods, integrators created and
+// destroyed between experiments (slots of following integrators move)
+//
+#include "simlib.h"
+#include <cmath>
+#include <algorithm>
+
+const int N = 100;
+const double TEND = 2;
+
+static double Rate(int k) { return 0.05*(k+1); }
+
+int main()
+{
+    Print("intg-array-test --- integrator arrays\n");
+    Integrator *y[N];
+    for(int k = 0; k < N; k++) {
+        y[k] = new Integrator;
+        y[k]->SetInput(-Rate(k) * *y[k]);
+    }
+
+    const char *methods[] = { "euler", "rke", "rkf3", "rkf5", "rkf8", "abm4", "fw" };
+    for(unsigned m = 0; m < sizeof(methods)/sizeof(methods[0]); m++) {
+        SetMethod(methods[m]);
+        SetStep(1e-6, 0.01);
+        SetAccuracy(1e-9, 1e-7);
+        for(int k = 0; k < N; k++)
+            y[k]->Init(1 + k);
+        Init(0, TEND);
+        Run();
+        double err = 0;
+        for(int k = 0; k < N; k++) {
+            double exact = (1 + k) * std::exp(-Rate(k)*TEND);
+            err = std::max(err, std::fabs(y[k]->Value() - exact) / exact);
+        }
+        Print("%-6s integrators=%d max.rel.error %s\n", methods[m], N,
+              err < 1e-3 ? "OK" : "BAD");
+    }
+
+    // destroy every third integrator, remaining ones keep their values
+    double v[N];
+    for(int k = 0; k < N; k++)
+        v[k] = y[k]->Value();
+    int n = 0;
+    unsigned errors = 0;
+    for(int k = 0; k < N; k++) {
+        if(k % 3 == 1) {
+            delete y[k];
+            y[k] = 0;
+        } else
+            n++;
+    }
+    for(int k = 0; k < N; k++)
+        if(y[k] && y[k]->Value() != v[k])
+            errors++;
+    // new integrator at the end
+    Integrator x(-1.0, 5);
+    SetMethod("rkf5");
+    for(int k = 0; k < N; k++)
+        if(y[k])
+            y[k]->Init(1 + k);
+    Init(0, TEND);
+    Run();
+    for(int k = 0; k < N; k++)
+        if(y[k] && std::fabs(y[k]->Value() - (1 + k)*std::exp(-Rate(k)*TEND))
+                   > 1e-4*(1 + k))
+            errors++;
+    if(std::fabs(x.Value() - (5 - TEND)) > 1e-9)
+        errors++;
+    Print("erase: integrators=%d %s\n", n + 1, errors ? "BAD" : "OK");
+    for(int k = 0; k < N; k++)
+        delete y[k];
+    return 0;
+}
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////
+// loghisto-test.cc
+//
+// LogHistogram: percentiles compared with sorted values (heavy tail),
+// recording of arrays, merging, output
+//
+#include "simlib.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+const unsigned long N = 200000;
+
+int main()
+{
+    Print("loghisto-test --- log-linear histogram\n");
+    RandomSeed(424242);
+
+    // heavy tail: Pareto distribution (alpha=1.2) scaled by exponential
+    std::vector<double> x(N);
+    for(unsigned long i = 0; i < N; i++)
+        x[i] = Exponential(1) * std::pow(Random(), -1/1.2);
+
+    LogHistogram h("H", 1e-6, 1e9, 7);
+    LogHistogram a("A", 1e-6, 1e9, 7), b("B", 1e-6, 1e9, 7);
+    for(unsigned long i = 0; i < N/2; i++) {    // single values
+        h(x[i]);
+        a(x[i]);
+    }
+    h.Record(&x[N/2], N - N/2);                  // array of values
+    b.Record(&x[N/2], N - N/2);
+
+    // percentiles: relative error <= 2^-bits
+    std::vector<double> sorted(x);
+    std::sort(sorted.begin(), sorted.end());
+    const double p[] = { 1, 10, 50, 90, 99, 99.9, 99.99, 100 };
+    unsigned errors = 0;
+    for(unsigned i = 0; i < sizeof(p)/sizeof(p[0]); i++) {
+        unsigned long r = (unsigned long)std::ceil(p[i]/100*N);
+        double exact = sorted[r ? r-1 : 0];
+        double v = h.Percentile(p[i]);
+        bool ok = v >= exact && v <= exact * (1 + 1.0/128);
+        if(!ok) errors++;
+        Print("p%-6g exact=%-12.6g histogram=%-12.6g %s\n",
+              p[i], exact, v, ok ? "OK" : "BAD");
+    }
+    Print("overflow=%lu underflow=%lu\n", h[h.Count()+1], h[0]);
+
+    // merge of partial histograms
+    a += b;
+    for(unsigned i = 0; i <= a.Count()+1; i++)
+        if(a[i] != h[i])
+            errors++;
+    if(a.stat.Number() != h.stat.Number() ||
+       std::fabs(a.stat.MeanValue() - h.stat.MeanValue()) > 1e-9)
+        errors++;
+    Print("merge: %s\n", errors ? "DIFFERENT" : "OK");
+
+    // small histogram for output
+    LogHistogram w("waiting", 0.01, 1000, 1);
+    for(int i = 0; i < 1000; i++)
+        w(Exponential(5));
+    w.Output();
+    return 0;
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////
+// nbody-test.cc
+//
+// N-body system with Barnes-Hut octree (NBody3D):
+//  - accelerations compared with direct O(N^2) sum (theta=0 and 0.5),
+//    no self-attraction of bodies for large theta
+//  - two bodies on circular orbit (period, energy)
+//  - simulation of cluster with 1000 bodies (energy)
+//
+#include "simlib.h"
+#include "simlib3D.h"
+#include <cmath>
+#include <vector>
+
+static unsigned long seed = 12345;
+static double Rnd()                     // uniform (-1,1), repeatable
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) % 1000000) / 500000.0 - 1;
+}
+
+static void Cloud(NBody3D &s, double eps, std::vector<double> &m)
+{
+    seed = 12345;
+    m.resize(s.Bodies());
+    for(size_t k=0; k<s.Bodies(); k++) {
+        Value3D p(Rnd(), Rnd(), Rnd());
+        Value3D v(Rnd(), Rnd(), Rnd());
+        m[k] = (1 + Rnd()) / s.Bodies();
+        s.Init(k, m[k], p, 0.1*v);
+    }
+    s.SetSoftening(eps);
+}
+
+// relative RMS error of accelerations
+static double Error(const std::vector<Value3D> &a,
+                    const std::vector<Value3D> &b)
+{
+    double e = 0, norm = 0;
+    for(size_t k=0; k<a.size(); k++) {
+        Value3D d = a[k] - b[k];
+        e += scalar_product(d, d);
+        norm += scalar_product(b[k], b[k]);
+    }
+    return std::sqrt(e/norm);
+}
+
+static void AccuracyTest()
+{
+    const size_t N = 2000;
+    const double eps = 0.01;
+    NBody3D s(N, 1.0);
+    std::vector<double> m;
+    Cloud(s, eps, m);
+    // direct sum: a[i] = sum m[j] (p[j]-p[i]) / (r^2+eps^2)^1.5
+    std::vector<Value3D> direct(N, Value3D(0,0,0)), a;
+    for(size_t i=0; i<N; i++)
+        for(size_t j=0; j<N; j++) {
+            if(i == j) continue;
+            Value3D d = s.Get(j) - s.Get(i);
+            double r2 = scalar_product(d, d) + eps*eps;
+            direct[i] = direct[i] + d * (m[j] / (r2*std::sqrt(r2)));
+        }
+    s.SetTheta(0);
+    s.Accelerations(a);
+    Print("theta=0:   accelerations %s\n",
+          Error(a, direct) < 1e-12 ? "EXACT" : "BAD");
+    s.SetTheta(0.5);
+    s.Accelerations(a);
+    Print("theta=0.5: accelerations %s\n",
+          Error(a, direct) < 1e-2 ? "OK" : "BAD");
+    s.SetTheta(5);
+    s.Accelerations(a);
+    Print("theta=5:   accelerations %s\n",
+          Error(a, direct) < 0.3 ? "OK" : "BAD");
+    // nodes containing the body are always opened: exact for two bodies
+    NBody3D two(2, 1.0);
+    two.Init(0, 1, Value3D(-1,0,0), Value3D(0,0,0));
+    two.Init(1, 1, Value3D( 1,0,0), Value3D(0,0,0));
+    two.SetTheta(10);
+    two.Accelerations(a);
+    Print("theta=10, two bodies: accelerations %s\n",
+          abs(a[0] - Value3D(0.25,0,0)) < 1e-15 &&
+          abs(a[1] + a[0]) < 1e-15 ? "EXACT" : "BAD");
+}
+
+static void OrbitTest()
+{
+    // two equal masses, circular orbit: r=1 (distance 2), v=0.5, T=4*pi
+    NBody3D s(2, 1.0);
+    s.Init(0, 1, Value3D(-1,0,0), Value3D(0,-0.5,0));
+    s.Init(1, 1, Value3D( 1,0,0), Value3D(0, 0.5,0));
+    SetMethod("rkf5");
+    SetStep(1e-6, 0.1);
+    SetAccuracy(1e-10, 1e-10);
+    Init(0, 4*M_PI);
+    double e0 = -0.25;                  // 2*0.5*0.25 - 1/2
+    Run();
+    Value3D d = s.Get(1) - Value3D(1,0,0);
+    Print("orbit: period %s, energy %s\n", abs(d) < 1e-6 ? "OK" : "BAD",
+          std::fabs(s.Energy() - e0) < 1e-8 ? "OK" : "BAD");
+}
+
+static void ClusterTest()
+{
+    const size_t N = 1000;
+    NBody3D s(N, 1.0);
+    std::vector<double> m;
+    Cloud(s, 0.05, m);
+    s.SetTheta(0.6);
+    SetMethod("rkf5");
+    SetStep(1e-6, 0.01);
+    SetAccuracy(1e-6, 1e-4);
+    Init(0, 0.1);
+    double e0 = s.Energy();
+    Run();
+    double e1 = s.Energy();
+    Print("cluster N=%lu: energy %s\n", (unsigned long)N,
+          std::fabs((e1 - e0)/e0) < 1e-3 ? "OK" : "BAD");
+}
+
+int main()
+{
+    Print("nbody-test --- N-body system (Barnes-Hut)\n");
+    AccuracyTest();
+    OrbitTest();
+    ClusterTest();
+    return 0;
+}
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////
+// optimize-test.cc
+//
+// optimization of model parameters: Nelder-Mead and CMA-ES with serial
+// and parallel evaluation (OptEvaluator), parallel Hooke-Jeeves step,
+// cache of values, common random numbers for stochastic functions
+//
+#include "simlib.h"
+#include "optimize.h"
+#include <cmath>
+
+// model y' = -a*y + b, y(0) = 1 is fitted to y = 0.5 + 0.5*exp(-2*t)
+// (a=2, b=1), model is created in function (thread-local simulation)
+static double Error(const ParameterVector & p)
+{
+    double a = p[0], b = p[1];
+    Integrator y;
+    y.SetInput(-a * y + b);
+    y.Init(1);
+    Integrator err(Sqr(y - (0.5 + 0.5 * Exp(-2 * T))));
+    SetStep(1e-4, 0.01);
+    SetAccuracy(1e-9, 1e-3);
+    Init(0, 3);
+    Run();
+    return err.Value();
+}
+
+// stochastic function: values depend on random numbers
+static double Noisy(const ParameterVector & p)
+{
+    double a = p[0] - 2, b = p[1] - 1, s = 0;
+    for (int i = 0; i < 10; i++)
+        s += Uniform(0, 1);
+    return a * a + b * b + 0.1 * s;
+}
+
+// stochastic function: first random number of each evaluation is saved
+static std::vector<double> draws;
+static double Draw(const ParameterVector & p)
+{
+    draws.push_back(Random());
+    return Noisy(p);
+}
+
+static void Result(const char *name, const ParameterVector & p, double f)
+{
+    Print("%s: a=%.3f b=%.3f err %s\n", name, p[0].Value(), p[1].Value(),
+          f < 1e-6 ? "OK" : "BAD");
+}
+
+int main()
+{
+    Print("optimize-test --- parallel and batched optimizers\n");
+    Param a0[] = { Param("a", 0.1, 5), Param("b", 0, 3) };
+    a0[0] = 1;
+    a0[1] = 2;
+    ParameterVector p0(2, a0);
+
+    ParameterVector p1(p0), p2(p0);
+    double f1 = Optimize_neldermead(Error, p1, 0.1, 1e-6, 500, 1);
+    double f2 = Optimize_neldermead(Error, p2, 0.1, 1e-6, 500, 4);
+    Result("Nelder-Mead", p1, f1);
+    Print("4 threads: %s\n", p1 == p2 && f1 == f2 ? "SAME" : "DIFFERENT");
+
+    ParameterVector p3(p0), p4(p0);
+    double f3 = Optimize_cmaes(Error, p3, 0.2, 1e-6, 300, 0, 1);
+    double f4 = Optimize_cmaes(Error, p4, 0.2, 1e-6, 300, 0, 3);
+    Result("CMA-ES", p3, f3);
+    Print("3 threads: %s\n", p3 == p4 && f3 == f4 ? "SAME" : "DIFFERENT");
+
+    OptEvaluator e(Error, 4);
+    ParameterVector p5(p0);
+    double f5 = Optimize_hooke(e, p5, 0.5, 1e-6, 1000);
+    Result("Hooke-Jeeves (parallel)", p5, f5);
+    unsigned long n = e.Evaluations();
+    ParameterVector p6(p0);
+    double f6 = Optimize_hooke(e, p6, 0.5, 1e-6, 1000);
+    Print("cache: %s\n", e.Evaluations() == n && e.Hits() > 0 && f5 == f6 ?
+          "OK" : "BAD");
+
+    // common random numbers: stochastic values do not depend on threads
+    std::vector<ParameterVector> pts(6, p0);
+    for (int i = 0; i < 6; i++)
+        pts[i][0] = 0.5 + i * 0.5;
+    std::vector<double> v1, v4;
+    OptEvaluator e1(Noisy, 1, false), e4(Noisy, 4, false);
+    e1(pts, v1);
+    e4(pts, v4);
+    bool same = v1 == v4;
+    for (int i = 0; i < 6; i++)
+        same = same && e1(pts[i]) == v1[i] && e4(pts[i]) == v1[i];
+    Print("stochastic, 1/4 threads: %s\n", same ? "SAME" : "DIFFERENT");
+    ParameterVector p7(p0), p8(p0);
+    double f7 = Optimize_neldermead(Noisy, p7, 0.1, 1e-6, 500, 1);
+    double f8 = Optimize_neldermead(Noisy, p8, 0.1, 1e-6, 500, 4);
+    Print("stochastic Nelder-Mead: a=%.3f b=%.3f, 4 threads: %s\n",
+          p7[0].Value(), p7[1].Value(),
+          p7 == p8 && f7 == f8 ? "SAME" : "DIFFERENT");
+
+    // without common random numbers: random numbers continue (legacy
+    // Optimize_hooke), generator of calling thread is not restored
+    OptEvaluator e0(Noisy, 1, false, false);
+    RandomSeed(777);
+    double r0 = e0(p0), r1 = e0(p0);
+    RandomSeed(777);
+    double s0 = Noisy(p0), s1 = Noisy(p0);
+    Print("no common random numbers: %s\n",
+          r0 != r1 && r0 == s0 && r1 == s1 ? "OK" : "BAD");
+    draws.clear();
+    ParameterVector p9(p0);
+    Optimize_hooke(Draw, p9, 0.5, 1e-3, 1);
+    bool distinct = draws.size() > 2;
+    for (unsigned i = 1; i < draws.size(); i++)
+        distinct = distinct && draws[i] != draws[0];
+    Print("Hooke-Jeeves (function): random numbers %s\n",
+          distinct ? "continue" : "REUSED");
+    return 0;
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////
+// parallel-eval-test.cc
+//
+// parallel evaluation of integrator inputs (SetParallelEvaluation):
+// results are the same as with serial evaluation (chain of integrators
+// with shared expressions and time, model with user block, model with
+// less integrators than threads)
+//
+#include "simlib.h"
+#include <cmath>
+
+const int N = 1000;
+
+// user block: not thread-safe, evaluated serially
+struct Source : aContiBlock {
+    double Value() { return 0.5; }
+};
+
+static double Experiment(unsigned threads, bool user)
+{
+    SetParallelEvaluation(threads);
+    Source src;
+    Constant left(1), right(0);
+    Integrator *x[N];
+    Expression *flux[N+1];               // shared by two integrators
+    for(int i=0; i<N; i++)
+        x[i] = new Integrator;
+    for(int i=0; i<=N; i++) {
+        Input a = i>0 ? Input(*x[i-1]) : Input(left);
+        Input b = i<N ? Input(*x[i]) : Input(right);
+        flux[i] = new Expression(N*(a - b));
+    }
+    for(int i=0; i<N; i++) {
+        Input in = 0.01*N*(*flux[i] - *flux[i+1]) + 0.1*Sin(T);
+        x[i]->SetInput(user && i==N/2 ? Input(in + src) : in);
+    }
+    SetMethod("rkf5");
+    SetStep(1e-8, 1e-3);
+    SetAccuracy(1e-8, 1e-6);
+    Init(0, 0.1);
+    Run();
+    double s = 0;
+    for(int i=0; i<N; i++)
+        s += x[i]->Value() * (i+1);
+    for(int i=0; i<N; i++)
+        delete x[i];
+    for(int i=0; i<=N; i++)
+        delete flux[i];
+    return s;
+}
+
+// two coupled integrators (less slots than threads)
+static double Small(unsigned threads)
+{
+    SetParallelEvaluation(threads);
+    Integrator v, y;
+    v.SetInput(-y + 0.1*Sin(T));
+    y.SetInput(v);
+    y.Init(1);
+    SetMethod("rkf5");
+    Init(0, 10);
+    Run();
+    return y.Value();
+}
+
+int main()
+{
+    Print("parallel-eval-test --- parallel evaluation of inputs\n");
+    double a = Experiment(1, false);
+    double b = Experiment(4, false);
+    double c = Experiment(3, false);
+    Print("sum=%.10g\n", a);
+    Print("4 threads: %s\n", a == b ? "SAME" : "DIFFERENT");
+    Print("3 threads: %s\n", a == c ? "SAME" : "DIFFERENT");
+    double d = Experiment(1, true);
+    double e = Experiment(4, true);
+    Print("user block: %s\n", d == e && d != a ? "SAME" : "DIFFERENT");
+    Print("2 integrators, 4 threads: %s\n",
+          Small(1) == Small(4) ? "SAME" : "DIFFERENT");
+    SetParallelEvaluation(1);
+    return 0;
+}
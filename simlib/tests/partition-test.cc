@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////
+// partition-test.cc
+//
+// RunPartitions: network of three queuing systems in separate threads
+// connected by channels with delay (lookahead), including feedback loop
+//
+//   0 --(1.5)--> 1 --(1.0)--> 2 --(2.0)--> 0  (30% of customers)
+//
+#include "simlib.h"
+
+const int N = 3;                // number of partitions
+
+struct Node {                   // submodel of single partition
+    Facility F;
+    Stat S;                     // time in system (last node only)
+    unsigned long received;     // number of received customers
+    unsigned long served;       // number of served customers
+    double last;                // time of last receive
+    bool order;                 // receive times are nondecreasing
+    Node() : F("F"), S("S"), received(0), served(0), last(0), order(true) {}
+};
+
+static thread_local Node *node = 0;     // submodel of current thread
+
+static Partition *P[N];
+static Channel *C[N];           // C[i] goes from partition i
+
+// results (indexed by partition number)
+static Stat S[N];
+static unsigned long Received[N];
+static unsigned long Served[N];
+static bool Order[N];
+
+class Customer : public Process {
+    double t0;                  // time of arrival to the network
+    void Behavior() {
+        Seize(node->F);
+        Wait(Exponential(2));
+        Release(node->F);
+        node->served++;
+        unsigned p = Partition::Current()->Number();
+        if(p < N-1)
+            C[p]->Send(t0);
+        else if(Random() < 0.3)
+            C[p]->Send(t0);     // feedback
+        else
+            node->S(Time - t0);
+    }
+  public:
+    Customer(double t) : t0(t) {}
+};
+
+class Generator : public Event {
+    void Behavior() {
+        (new Customer(Time))->Activate();
+        Activate(Time + Exponential(5));
+    }
+};
+
+void receive(double t0)         // customer from other partition
+{
+    if(Time < node->last)
+        node->order = false;
+    node->last = Time;
+    node->received++;
+    (new Customer(t0))->Activate();
+}
+
+void init()
+{
+    node = new Node;
+    if(Partition::Current()->Number() == 0)
+        (new Generator)->Activate();
+}
+
+void collect()
+{
+    unsigned p = Partition::Current()->Number();
+    S[p] += node->S;
+    Received[p] = node->received;
+    Served[p] = node->served;
+    Order[p] = node->order;
+    delete node;
+    node = 0;
+}
+
+int main()
+{
+    Print("partition-test --- conservative parallel simulation\n");
+    for(int i=0; i<N; i++)
+        P[i] = new Partition(init, collect);
+    C[0] = new Channel(*P[0], *P[1], 1.5, receive);
+    C[1] = new Channel(*P[1], *P[2], 1.0, receive);
+    C[2] = new Channel(*P[2], *P[0], 2.0, receive);
+    RunPartitions(0, 10000);
+    for(int i=0; i<N; i++)
+        Print("partition %d: received=%lu served=%lu order=%s\n",
+              i, Received[i], Served[i], Order[i] ? "OK" : "BAD");
+    S[N-1].Output();
+    for(int i=0; i<N; i++) {
+        delete C[i];
+        delete P[i];
+    }
+    return 0;
+}
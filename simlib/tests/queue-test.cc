@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////
+// queue-test.cc
+//
+// priority insert into Queue (bucket index) compared with linear search
+// in reference vector, including removal from the middle of queue and
+// switching the index off by positional insert
+//
+#include "simlib.h"
+#include <vector>
+
+class Item : public Event {     // queue item (never scheduled)
+  public:
+    int id;
+    Item(int i, Priority_t p) : Event(p), id(i) {}
+    void Behavior() {}
+};
+
+static std::vector<Item*> ref;  // reference queue
+
+// reference priority insert: after last item with priority >= p
+static void RefInsert(Item *x)
+{
+    unsigned i = ref.size();
+    while(i > 0 && ref[i-1]->Priority < x->Priority)
+        i--;
+    ref.insert(ref.begin() + i, x);
+}
+
+static bool Check(Queue &q)
+{
+    if(q.size() != ref.size())
+        return false;
+    unsigned i = 0;
+    for(Queue::iterator p = q.begin(); p != q.end(); ++p, ++i)
+        if(*p != ref[i])
+            return false;
+    return true;
+}
+
+int main()
+{
+    Print("queue-test --- priority insert\n");
+    RandomSeed(12345);
+    Queue q("Q");
+    int id = 0;
+    unsigned errors = 0;
+    unsigned long inserted = 0, removed = 0;
+    for(int step = 0; step < 20000; step++) {
+        double r = Random();
+        if(r < 0.55 || ref.empty()) {           // priority insert
+            Item *x = new Item(id++, int(Uniform(-3, 4)) * 10);
+            if(step % 5000 == 4999) {           // positional insert
+                q.InsFirst(x);
+                ref.insert(ref.begin(), x);
+            } else {
+                q.Insert(x);
+                RefInsert(x);
+            }
+            inserted++;
+        } else if(r < 0.85) {                   // remove first
+            Entity *e = q.GetFirst();
+            if(e != ref.front())
+                errors++;
+            ref.erase(ref.begin());
+            delete e;
+            removed++;
+        } else {                                // remove from middle
+            unsigned i = unsigned(Uniform(0, ref.size()));
+            Item *x = ref[i];
+            x->Out();
+            ref.erase(ref.begin() + i);
+            delete x;
+            removed++;
+        }
+        if(!Check(q))
+            errors++;
+    }
+    Print("inserted=%lu removed=%lu length=%u\n", inserted, removed, q.size());
+    Print("%s (errors=%u)\n", errors ? "DIFFERENT" : "OK", errors);
+    q.clear();
+    return 0;
+}
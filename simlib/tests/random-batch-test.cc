@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////
+// random-batch-test.cc
+//
+// batch generators: Ziggurat Normal/Exponential compared with exact
+// distribution functions (maximal difference of empirical CDF),
+// RandomStream::Fill compared with sequential generation
+//
+#include "simlib.h"
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+const unsigned long N = 1000000;
+
+// Kolmogorov-Smirnov statistic of sorted values
+static double KS(std::vector<double> &x, double (*F)(double))
+{
+    std::sort(x.begin(), x.end());
+    double d = 0;
+    for(unsigned long i = 0; i < x.size(); i++) {
+        double f = F(x[i]);
+        d = std::max(d, std::max(f - double(i)/x.size(),
+                                 double(i+1)/x.size() - f));
+    }
+    return d;
+}
+
+static double NormalCDF(double x) { return 0.5*std::erfc(-x/std::sqrt(2.0)); }
+static double ExpCDF(double x)    { return 1 - std::exp(-x); }
+static double Erlang3CDF(double x) { return 1 - std::exp(-x)*(1 + x + x*x/2); }
+
+static void Report(const char *name, std::vector<double> &x,
+                   double (*F)(double), double tail)
+{
+    Stat s;
+    unsigned long t = 0;
+    for(unsigned long i = 0; i < x.size(); i++) {
+        s(x[i]);
+        if(std::fabs(x[i]) > tail) t++;
+    }
+    double d = KS(x, F);
+    // critical value for significance level 0.001 is 1.95/sqrt(N)
+    Print("%-12s mean=%7.4f stddev=%6.4f P(|x|>%g)=%.2e KS %s\n",
+          name, s.MeanValue(), s.StdDev(), tail, double(t)/x.size(),
+          d < 1.95/std::sqrt(double(x.size())) ? "OK" : "BAD");
+}
+
+int main()
+{
+    Print("random-batch-test --- batch generators\n");
+    std::vector<double> x(N);
+
+    RandomStream s(31337, 1);
+    Normal(s, 0, 1, &x[0], N);
+    Report("Normal", x, NormalCDF, 4);
+    Exponential(s, 1, &x[0], N);
+    Report("Exponential", x, ExpCDF, 8);
+    Erlang(s, 1, 3, &x[0], N);
+    Report("Erlang", x, Erlang3CDF, 10);
+
+    RandomSeed(1537);                   // base generator
+    Normal(0, 1, &x[0], N);
+    Report("Normal/base", x, NormalCDF, 4);
+    Exponential(1, &x[0], N);
+    Report("Exp/base", x, ExpCDF, 8);
+
+    // Fill is the same as sequential generation (any start position)
+    RandomStream a(7, 0), b(7, 0);
+    unsigned errors = 0;
+    for(unsigned long n = 0; n < 40; n++) {
+        double v[40];
+        a.Fill(v, n);
+        for(unsigned long i = 0; i < n; i++)
+            if(v[i] != b()) errors++;
+    }
+    Uniform(a, 2, 5, &x[0], 1001);
+    for(unsigned long i = 0; i < 1001; i++)
+        if(x[i] != 2 + 3*b()) errors++;
+    Print("fill: %s\n", errors ? "BAD" : "OK");
+    return 0;
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////
+// randomstream-test.cc
+//
+// RandomStream: Philox4x32-10 known answers, jump-ahead, independent
+// streams, distributions using streams (base generator is not used)
+//
+#include "simlib.h"
+#include <cmath>
+
+int main()
+{
+    Print("randomstream-test --- counter-based random streams\n");
+
+    // known answer tests (Random123 kat_vectors)
+    struct { unsigned ctr[4], key[2], out[4]; } kat[] = {
+        { {0,0,0,0}, {0,0},
+          {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8} },
+        { {0xffffffff,0xffffffff,0xffffffff,0xffffffff}, {0xffffffff,0xffffffff},
+          {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd} },
+        { {0x243f6a88,0x85a308d3,0x13198a2e,0x03707344}, {0xa4093822,0x299f31d0},
+          {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1} },
+    };
+    for(unsigned i = 0; i < 3; i++) {
+        unsigned c[4] = { kat[i].ctr[0], kat[i].ctr[1],
+                          kat[i].ctr[2], kat[i].ctr[3] };
+        RandomStream::Philox(c, kat[i].key);
+        bool ok = true;
+        for(int j = 0; j < 4; j++)
+            if(c[j] != kat[i].out[j]) ok = false;
+        Print("philox %u: %08x %08x %08x %08x %s\n",
+              i, c[0], c[1], c[2], c[3], ok ? "OK" : "BAD");
+    }
+
+    // jump-ahead gives the same values as sequential generation
+    RandomStream a(12345, 7);
+    double v[1000];
+    for(int i = 0; i < 1000; i++)
+        v[i] = a.Random();
+    RandomStream b(12345, 7);
+    unsigned errors = 0;
+    for(int i = 999; i >= 0; i -= 37) {
+        b.SetPosition(i);
+        if(b() != v[i]) errors++;
+    }
+    b.SetPosition(100);
+    b.Jump(401);
+    if(b.Position() != 501 || b() != v[501]) errors++;
+    Print("jump: %s\n", errors ? "BAD" : "OK");
+
+    // different streams: uncorrelated, base generator not used
+    RandomSeed(1537);
+    double r0 = Random();
+    RandomSeed(1537);
+    const int N = 1000000;
+    RandomStream s0(2016, 0), s1(2016, 1);
+    double sx = 0, sy = 0, sxy = 0, sxx = 0, syy = 0;
+    for(int i = 0; i < N; i++) {
+        double x = s0(), y = s1();
+        sx += x; sy += y; sxy += x*y; sxx += x*x; syy += y*y;
+    }
+    double cov = sxy/N - sx/N*sy/N;
+    double corr = cov / std::sqrt((sxx/N - sx/N*sx/N) * (syy/N - sy/N*sy/N));
+    Print("streams: mean0=%.3f mean1=%.3f correlation %s\n",
+          sx/N, sy/N, (corr > -0.005 && corr < 0.005) ? "OK" : "BAD");
+
+    // distributions
+    RandomStream s(99, 3);
+    Stat e, n, u, g;
+    for(int i = 0; i < 100000; i++) {
+        e(Exponential(s, 2));
+        n(Normal(s, 10, 3));
+        u(Uniform(s, -1, 1));
+        g(Erlang(s, 2, 3));
+    }
+    Print("Exponential(2): mean=%.2f\n", e.MeanValue());
+    Print("Normal(10,3):   mean=%.2f stddev=%.2f\n", n.MeanValue(), n.StdDev());
+    Print("Uniform(-1,1):  mean=%.2f min=%.3f max=%.3f\n",
+          u.MeanValue(), u.Min(), u.Max());
+    Print("Erlang(2,3):    mean=%.2f\n", g.MeanValue());
+    Print("base generator: %s\n", Random() == r0 ? "OK" : "BAD");
+    return 0;
+}
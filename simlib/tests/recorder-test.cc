@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////
+// recorder-test.cc
+//
+// Recorder: values of blocks sampled with two rates into CSV file and
+// with one rate into binary file, files are read back and compared with
+// values printed by Sampler (two experiments)
+//
+#include "simlib.h"
+#include "recorder.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+// damped oscillator
+extern Integrator x;
+Integrator v(-0.5*v - 4*x, 1), x(v);
+
+static std::vector<double> sampled;    // x values from Sampler
+void Sample() { sampled.push_back(x.Value()); }
+Sampler s(Sample, 0.1);
+
+static void ReadCSV(const char *name)
+{
+    FILE *f = fopen(name, "r");
+    char line[1000];
+    unsigned long n[2] = { 0, 0 }, comments = 0;
+    bool same = true;
+    while(fgets(line, sizeof(line), f)) {
+        if(line[0] == '#') {
+            comments++;
+            continue;
+        }
+        unsigned r;
+        double t, val;
+        if(sscanf(line, "%u,%lg,%lg", &r, &t, &val) != 3 || r > 1)
+            same = false;
+        else if(r == 0 && (n[0] >= sampled.size() || sampled[n[0]] != val))
+            same = false;
+        n[r]++;
+    }
+    fclose(f);
+    Print("csv: %lu header lines, rate 0: %lu rows, rate 1: %lu rows, x %s\n",
+          comments, n[0], n[1], same ? "SAME" : "DIFFERENT");
+}
+
+static void ReadBinary(const char *name, unsigned long expected)
+{
+    FILE *f = fopen(name, "rb");
+    char magic[8];
+    uint32_t rates, cols, len, rate, rows;
+    double step;
+    char col[2][10] = { "", "" };
+    if(fread(magic, 8, 1, f) != 1 || fread(&rates, 4, 1, f) != 1 ||
+       fread(&step, 8, 1, f) != 1 || fread(&cols, 4, 1, f) != 1)
+        return;
+    for(unsigned i=0; i<cols && i<2; i++)
+        if(fread(&len, 4, 1, f) != 1 || len >= 10 ||
+           fread(col[i], len, 1, f) != 1)
+            return;
+    Print("bin: %.8s, %u rate, step %g, columns time,%s,%s\n",
+          magic, rates, step, col[0], col[1]);
+    unsigned long n = 0, blocks = 0;
+    double last[3] = { 0, 0, 0 };
+    while(fread(&rate, 4, 1, f) == 1 && fread(&rows, 4, 1, f) == 1) {
+        for(unsigned i=0; i<rows; i++)
+            if(fread(last, sizeof(double), 3, f) != 3)
+                return;
+        n += rows;
+        blocks++;
+    }
+    fclose(f);
+    Print("bin: %lu rows (%s), more blocks %s, last time %g\n", n,
+          n == expected ? "all" : "missing", blocks > 1 ? "yes" : "no",
+          last[0]);
+}
+
+int main()
+{
+    Print("recorder-test --- multi-rate recorder\n");
+    Recorder csv("recorder-test.csv", 0.1, Recorder::CSV, 16);
+    csv.Add(x, "x");
+    unsigned r = csv.Rate(0.5);
+    csv.Add(v, "v", r);
+    Recorder *bin = new Recorder("recorder-test.bin", 0.01, Recorder::BINARY,
+                                 100);
+    bin->Add(x, "x");
+    bin->Add(v, "v");
+    for(int i=0; i<2; i++) {            // two experiments
+        Init(0, 10);
+        Run();
+    }
+    csv.Flush();
+    ReadCSV("recorder-test.csv");
+    unsigned long n = bin->Records();
+    delete bin;                         // flush, close
+    ReadBinary("recorder-test.bin", n);
+    return 0;
+}
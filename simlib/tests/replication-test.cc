@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////
+// replication-test.cc
+//
+// RunReplications: independent replications of queuing system
+// in parallel threads, results are merged
+//
+#include "simlib.h"
+
+const unsigned long N = 8;      // number of replications
+
+struct Model {                  // model of single replication
+    Facility F;
+    Stat S;
+    TStat L;                    // number of customers in system
+    Histogram H;
+    int in;
+    Model() : F("F"), S("S"), L("L"), H("H", 0, 20, 10), in(0) {}
+};
+
+static thread_local Model *model = 0;   // model of current thread
+
+// merged results of replications (in order of replication number)
+static Stat S[N];
+static TStat L[N];
+static Histogram *H[N];
+
+class Customer : public Process {
+    double t0;
+    void Behavior() {
+        t0 = Time;
+        model->L(++model->in);
+        Seize(model->F);
+        Wait(Exponential(8));
+        Release(model->F);
+        model->L(--model->in);
+        model->S(Time - t0);
+        model->H(Time - t0);
+    }
+};
+
+class Generator : public Event {
+    void Behavior() {
+        (new Customer)->Activate();
+        Activate(Time + Exponential(10));
+    }
+};
+
+void init(unsigned long)
+{
+    Init(0, 10000);
+    model = new Model;
+    (new Generator)->Activate();
+}
+
+void collect(unsigned long i)
+{
+    S[i] += model->S;
+    L[i] += model->L;
+    *H[i] += model->H;
+    delete model;
+    model = 0;
+}
+
+int main()
+{
+    Print("replication-test --- RunReplications\n");
+    for(unsigned long i=0; i<N; i++)
+        H[i] = new Histogram(0.0, 20, 10);
+    RunReplications(N, init, collect, 3);
+    Stat sum("S");
+    TStat lsum("L");
+    Histogram hsum("H", 0, 20, 10);
+    for(unsigned long i=0; i<N; i++) {
+        Print("replication %lu: n=%lu mean=%g L=%g\n",
+              i, S[i].Number(), S[i].MeanValue(), L[i].MeanValue());
+        sum += S[i];
+        lsum += L[i];
+        hsum += *H[i];
+        delete H[i];
+    }
+    sum.Output();
+    lsum.Output();
+    hsum.Output();
+    return 0;
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////
+// ringqueue-test.cc
+//
+// RingQueue (ring buffer of entity handles) compared with Queue,
+// stale handles of destroyed entities
+//
+#include "simlib.h"
+
+class Item : public Event {     // queue item (never scheduled)
+  public:
+    Item(Priority_t p) : Event(p) {}
+    void Behavior() {}
+};
+
+class Clock : public Event {    // operations on queues in time
+    Queue &q;
+    RingQueue &r;
+    unsigned &errors;
+    void Behavior() {
+        double x = Random();
+        if(x < 0.55 || q.empty()) {             // priority insert
+            Item *a = new Item(int(Uniform(-3, 4)));
+            if(x < 0.05) {
+                q.InsFirst(a);
+                r.InsFirst(a);
+            } else {
+                q.Insert(a);
+                r.Insert(a);
+            }
+        } else if(x < 0.85) {                   // remove first
+            Entity *e = q.GetFirst();
+            if(e != r.GetFirst())
+                errors++;
+            delete e;
+        } else {                                // remove from middle
+            unsigned i = unsigned(Uniform(0, q.size()));
+            Queue::iterator p = q.begin();
+            RingQueue::iterator rp = r.begin();
+            while(i--) { ++p; ++rp; }
+            Entity *e = q.Get(p);
+            if(e != r.Get(rp))
+                errors++;
+            delete e;
+        }
+        RingQueue::iterator rp = r.begin();     // compare contents
+        for(Queue::iterator p = q.begin(); p != q.end(); ++p, ++rp)
+            if(*p != *rp)
+                errors++;
+        if(q.size() != r.size())
+            errors++;
+        Activate(Time + Exponential(1));
+    }
+  public:
+    Clock(Queue &Q, RingQueue &R, unsigned &e):
+        q(Q), r(R), errors(e) {}
+};
+
+int main()
+{
+    Print("ringqueue-test --- RingQueue compared with Queue\n");
+    RandomSeed(54321);
+    Queue q("Q");
+    RingQueue r("Q");
+    unsigned errors = 0;
+    Init(0, 5000);
+    (new Clock(q, r, errors))->Activate();
+    Run();
+    Print("length=%u errors=%u\n", r.size(), errors);
+    q.Output();
+    r.Output();
+
+    // destroyed entity: stale handle
+    Item *a = new Item(0);
+    Item *b = new Item(0);
+    RingQueue s("S");
+    s.InsLast(a);
+    s.InsLast(b);
+    EntityHandle h = a->Handle();
+    delete a;                   // slot released
+    Item *c = new Item(0);
+    EntityHandle hc = c->Handle(); // slot reused, new generation
+    Print("stale: %s\n", (h.get() == 0 && *s.begin() == 0 &&
+                          hc.index == h.index && hc != h) ? "OK" : "BAD");
+    Print("skip: %s\n", (s.GetFirst() == b && s.empty()) ? "OK" : "BAD");
+    delete b;
+    delete c;
+    q.clear();                  // destroys entities, r has stale items only
+    r.clear();
+    return 0;
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////
+// simulation-test.cc
+//
+// independent simulations in separate threads (see class Simulation)
+// results of each thread should be the same as in main thread
+//
+#include "simlib.h"
+#include <thread>
+
+struct Result {                 // results of one experiment
+    double time;
+    double served;
+    double y;
+    double mean;
+};
+
+// combined model: queuing system + integrator
+struct Model {
+    Facility F;
+    Stat S;
+    Integrator y;
+    Model() : F("F"), S("S"), y(-0.1*y, 10) {}
+};
+
+static thread_local Model *model = 0;   // model of current thread
+
+class Customer : public Process {
+    double t0;
+    void Behavior() {
+        t0 = Time;
+        Seize(model->F);
+        Wait(Exponential(8));
+        Release(model->F);
+        model->S(Time - t0);
+    }
+};
+
+class Generator : public Event {
+    void Behavior() {
+        (new Customer)->Activate();
+        Activate(Time + Exponential(10));
+    }
+};
+
+// run single experiment, model is created in the calling thread
+static void Experiment(long seed, Result *r)
+{
+    RandomSeed(seed);
+    Init(0, 1000);
+    Model m;
+    model = &m;
+    (new Generator)->Activate();
+    Run();
+    r->time = Time;
+    r->served = m.S.Number();
+    r->y = m.y.Value();
+    r->mean = m.S.MeanValue();
+    model = 0;
+}
+
+static void PrintResult(const char *id, const Result &r)
+{
+    Print("%s: Time=%g served=%g y=%.6g mean=%.6g\n",
+          id, r.time, r.served, r.y, r.mean);
+}
+
+int main()
+{
+    Print("simulation-test --- independent simulations in threads\n");
+    const int N = 4;
+    Result main_r[N];
+    Result thr_r[N];
+    for(int i=0; i<N; i++)      // sequential run in main thread
+        Experiment(1000+i, &main_r[i]);
+    std::thread t[N];
+    for(int i=0; i<N; i++)      // parallel runs
+        t[i] = std::thread(Experiment, 1000+i, &thr_r[i]);
+    for(int i=0; i<N; i++)
+        t[i].join();
+    for(int i=0; i<N; i++) {
+        PrintResult("main  ", main_r[i]);
+        PrintResult("thread", thr_r[i]);
+        Print("%s\n", (main_r[i].served == thr_r[i].served &&
+                       main_r[i].mean == thr_r[i].mean &&
+                       main_r[i].y == thr_r[i].y) ? "OK" : "DIFFERENT");
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////
+// stat-test.cc
+//
+// Stat/TStat: precision for values with large offset, merging of
+// partial statistics (shards), Student's t quantiles, confidence
+// interval of replications and batch means (BatchStat, also used
+// via Stat&)
+//
+#include "simlib.h"
+#include <cmath>
+
+const int SHARDS = 4;
+
+static bool Near(double a, double b, double eps)
+{
+    return std::fabs(a - b) <= eps * (std::fabs(b) > 1 ? std::fabs(b) : 1);
+}
+
+class Server : public Process {         // M/M/1 customer
+    static Facility F;
+    BatchStat &S;
+    void Behavior() {
+        double t0 = Time;
+        Seize(F);
+        Wait(Exponential(8));
+        Release(F);
+        S(Time - t0);
+    }
+  public:
+    Server(BatchStat &s) : S(s) {}
+};
+Facility Server::F("F");
+
+class Generator : public Event {
+    BatchStat &S;
+    void Behavior() {
+        (new Server(S))->Activate();
+        Activate(Time + Exponential(10));
+    }
+  public:
+    Generator(BatchStat &s) : S(s) {}
+};
+
+class Level : public Event {            // random step function for TStat
+    TStat &L;
+    TStat *part;
+    void Behavior() {
+        double x = Uniform(0, 10);
+        L(x);
+        if(part) (*part)(x);
+        Activate(Time + Exponential(1));
+    }
+  public:
+    Level(TStat &l, TStat *p) : L(l), part(p) {}
+};
+
+int main()
+{
+    Print("stat-test --- Stat, TStat, BatchStat\n");
+    RandomSeed(1234567);
+
+    // large offset: naive sum of squares loses all digits
+    Stat a("offset");
+    Stat shard[SHARDS];
+    for(unsigned long i = 0; i < 1000000; i++) {
+        double x = 1e9 + (i % 1000) * 0.001;
+        a(x);
+        shard[i % SHARDS](x);
+    }
+    Print("offset: mean-1e9=%.6f stddev=%.6f\n",
+          a.MeanValue() - 1e9, a.StdDev());
+    Stat m("merged");
+    for(int i = 0; i < SHARDS; i++)
+        m += shard[i];
+    Print("merge: n=%lu mean %s stddev %s sum %s\n", m.Number(),
+          Near(m.MeanValue(), a.MeanValue(), 1e-15) ? "OK" : "BAD",
+          Near(m.StdDev(), a.StdDev(), 1e-9) ? "OK" : "BAD",
+          Near(m.Sum(), a.Sum(), 1e-15) ? "OK" : "BAD");
+
+    // Student's t quantiles (95% two-sided)
+    const unsigned long df[] = { 1, 2, 3, 5, 10, 30, 100, 1000 };
+    for(unsigned i = 0; i < sizeof(df)/sizeof(df[0]); i++) {
+        Stat t;
+        for(unsigned long j = 0; j <= df[i]; j++)
+            t(j & 1);
+        double q = t.ConfidenceInterval(0.95) * std::sqrt(double(df[i]+1))
+                   / t.StdDev();
+        Print("t(0.975, %lu) = %.4f\n", df[i], q);
+    }
+
+    // replications: confidence interval of mean value
+    Stat r("replications");
+    for(int i = 0; i < 20; i++) {
+        Stat x;
+        for(int j = 0; j < 1000; j++)
+            x(Exponential(2));
+        r(x.MeanValue());
+    }
+    Print("replications: %.4f +- %.4f\n",
+          r.MeanValue(), r.ConfidenceInterval(0.95));
+
+    // TStat: time-weighted mean and standard deviation, merge
+    TStat L("L");
+    TStat P[2];
+    for(int i = 0; i < 2; i++) {
+        Init(0, 1000);
+        L.Clear();
+        P[i].Clear();
+        (new Level(L, &P[i]))->Activate();
+        Run();
+        P[i](0);                // end of observation
+    }
+    TStat T("merged");
+    T += P[0];
+    T += P[1];
+    Print("tstat: mean %.4f stddev %.4f (uniform 0..10: 5, %.4f)\n",
+          T.MeanValue(), T.StdDev(), 10/std::sqrt(12.0));
+
+    // batch means of correlated values (waiting times in M/M/1)
+    BatchStat S("waiting", 10);
+    Init(0, 200000);
+    (new Generator(S))->Activate();
+    Run();
+    S.Output();
+
+    // BatchStat recorded and evaluated via reference to base class
+    BatchStat B1(10), B2(10);
+    Stat &base = B2;
+    for(int i = 0; i < 1000; i++) {
+        double x = Exponential(1);
+        B1(x);
+        base(x);
+    }
+    bool same = B1.Batches() == B2.Batches() &&
+                B1.BatchSize() == B2.BatchSize() &&
+                base.ConfidenceInterval() == B1.ConfidenceInterval();
+    for(unsigned i = 0; same && i < B1.Batches(); i++)
+        same = B1.BatchMean(i) == B2.BatchMean(i);
+    Print("BatchStat via Stat&: %s\n", same ? "SAME" : "DIFFERENT");
+    return 0;
+}
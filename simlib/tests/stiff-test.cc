@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////
+// stiff-test.cc
+//
+// implicit methods for stiff systems (bdf2, ros23):
+//  - Robertson's chemical kinetics (nonlinear, dense Jacobian)
+//  - heat conduction in a rod (chain of integrators, sparse Jacobian)
+//    compared with explicit rkf5, band and dense LU give the same results
+//
+#include "simlib.h"
+#include <cmath>
+
+static unsigned long evaluations = 0;   // # of model evaluations
+static double Count(double x) { evaluations++; return x; }
+
+////////////////////////////////////////////////////////////////////////////
+// Robertson: y1' = -0.04 y1 + 1e4 y2 y3
+//            y2' =  0.04 y1 - 1e4 y2 y3 - 3e7 y2^2
+//            y3' =  3e7 y2^2
+static void Robertson(const char *method)
+{
+    Integrator y1, y2, y3;
+    Expression r1(0.04*y1), r2(1e4*y2*y3), r3(3e7*y2*y2);
+    y1.SetInput(new Function1(r2 - r1, Count));
+    y2.SetInput(r1 - r2 - r3);
+    y3.SetInput(r3);
+    SetMethod(method);
+    SetStep(1e-12, 10);
+    SetAccuracy(1e-10, 1e-4);
+    y1.Init(1); y2.Init(0); y3.Init(0);
+    evaluations = 0;
+    Init(0, 40);
+    Run();
+    // reference solution (E. Hairer, G. Wanner)
+    const double ref[3] = { 0.7158270687, 9.185534764e-6, 0.2841637457 };
+    double e = std::max(std::fabs(y1.Value()/ref[0] - 1),
+               std::max(std::fabs(y2.Value()/ref[1] - 1),
+                        std::fabs(y3.Value()/ref[2] - 1)));
+    Print("robertson %-5s y=(%.4f %.4e %.4f) %s\n", method,
+          y1.Value(), y2.Value(), y3.Value(),
+          e < 1e-2 ? "OK" : "BAD");
+}
+
+////////////////////////////////////////////////////////////////////////////
+// heat conduction: u[i]' = D/dx^2 * (u[i-1] - 2 u[i] + u[i+1])
+const int N = 40;
+const double D = 1.0;
+const double dx = 1.0/(N+1);
+
+static unsigned long Heat(const char *method, double *u, bool count=true)
+{
+    Constant left(1), right(0);
+    Integrator *x[N];
+    for(int i=0; i<N; i++)
+        x[i] = new Integrator;
+    for(int i=0; i<N; i++) {
+        Input a = i>0 ? Input(*x[i-1]) : Input(left);
+        Input b = i<N-1 ? Input(*x[i+1]) : Input(right);
+        Input in = D/(dx*dx) * (a - 2*(*x[i]) + b);
+        // user function in input: dense row of Jacobian
+        x[i]->SetInput(i==0 && count ? Input(new Function1(in, Count)) : in);
+    }
+    SetMethod(method);
+    SetStep(1e-9, 0.1);
+    SetAccuracy(1e-6, 1e-4);
+    evaluations = 0;
+    Init(0, 2);
+    Run();
+    for(int i=0; i<N; i++) {
+        u[i] = x[i]->Value();
+        delete x[i];
+    }
+    return evaluations;
+}
+
+static void HeatTest(const char *method, const double *ref, unsigned long n)
+{
+    double u[N], e = 0;
+    unsigned long m = Heat(method, u);
+    for(int i=0; i<N; i++)
+        e = std::max(e, std::fabs(u[i] - ref[i]));
+    Print("heat %-5s accuracy %s, evaluations %s\n", method,
+          e < 1e-3 ? "OK" : "BAD", m < n/5 ? "OK" : "BAD");
+}
+
+int main()
+{
+    Print("stiff-test --- implicit integration methods\n");
+    Robertson("bdf2");
+    Robertson("ros23");
+
+    double ref[N], u[N], e;
+    unsigned long n = Heat("rkf5", ref);
+    Print("heat rkf5: u[N/2]=%.4f\n", ref[N/2]);
+    HeatTest("bdf2", ref, n);
+    HeatTest("ros23", ref, n);
+
+    // band LU (tridiagonal Jacobian) and dense LU (no compiled inputs)
+    Heat("ros23", ref, false);
+    SetCompiledEvaluation(false);
+    Heat("ros23", u, false);
+    SetCompiledEvaluation(true);
+    e = 0;
+    for(int i=0; i<N; i++)
+        e = std::max(e, std::fabs(u[i] - ref[i]));
+    Print("band LU: %s\n", e < 1e-6 ? "OK" : "BAD");
+
+    // the same results with dense Jacobian (no compiled inputs)
+    Heat("bdf2", ref);
+    SetCompiledEvaluation(false);
+    Heat("bdf2", u);
+    e = 0;
+    for(int i=0; i<N; i++)
+        e = std::max(e, std::fabs(u[i] - ref[i]));
+    Print("dense Jacobian: %s\n", e < 1e-6 ? "OK" : "BAD");
+    return 0;
+}
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////
+// tape-test.cc
+//
+// compiled evaluation of integrator inputs: results are the same as
+// with recursive evaluation (shared expressions, functions, variables,
+// time, user blocks with side effects, change of input after Init)
+//
+#include "simlib.h"
+#include <cmath>
+
+// user block: counts calls of Value()
+struct Counter : aContiBlock {
+    unsigned long n;
+    Counter() : n(0) {}
+    double Value() { n++; return 0.1; }
+};
+
+Variable sigma(10);
+Parameter rho(28);
+Counter cnt;
+Integrator x, y, z;                     // inputs are set in Model
+Expression xy(x*y);                     // shared by two integrators
+
+static void Model()
+{
+    x.SetInput(sigma*(y - x) + cnt);
+    y.SetInput(x*(rho - z) - y);
+    z.SetInput(xy - 8.0/3*z + 0.01*Sin(T) + cnt);
+}
+
+struct Result { double x, y, z; unsigned long calls; };
+
+static Result Experiment(bool compiled)
+{
+    SetCompiledEvaluation(compiled);
+    SetMethod("rkf5");
+    SetStep(1e-6, 0.01);
+    SetAccuracy(1e-10, 1e-8);
+    x.Init(1); y.Init(1); z.Init(1);
+    Model();
+    cnt.n = 0;
+    Init(0, 5);
+    Run();
+    // input changed between experiments
+    Result r = { x.Value(), y.Value(), z.Value(), cnt.n };
+    x.SetInput(sigma*(y - x) - 1);
+    x.Init(r.x);
+    Init(5, 6);
+    Run();
+    r.x = x.Value(); r.y = y.Value(); r.z = z.Value();
+    r.calls = cnt.n;
+    return r;
+}
+
+int main()
+{
+    Print("tape-test --- compiled evaluation of integrator inputs\n");
+    Result a = Experiment(false);
+    Result b = Experiment(true);
+    Print("x=%.10g y=%.10g z=%.10g\n", b.x, b.y, b.z);
+    Print("results: %s\n",
+          a.x == b.x && a.y == b.y && a.z == b.z ? "SAME" : "DIFFERENT");
+    Print("user block calls: %s\n", a.calls == b.calls ? "SAME" : "DIFFERENT");
+    sigma = 11;                         // variable is read by tape
+    Result c = Experiment(true);
+    Result d = Experiment(false);
+    Print("variable: %s\n", c.x == d.x && c.x != b.x ? "OK" : "BAD");
+    return 0;
+}
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////
+// transport-test.cc
+//
+// 1D transport block (Transport1D, IntegratorVector):
+//  - pulse of concentration flowing through a pipe, compared with exact
+//    solution (upwind and MUSCL schemes, several methods)
+//  - conservation of mass: integrator of inflow - outflow
+//  - negative velocity: profile leaves the pipe through cell 0
+//  - removing vector between integrators (slots are moved)
+//
+#include "simlib.h"
+#include "transport.h"
+#include <cmath>
+
+const double L = 1.0;                   // length of pipe
+const double v = 1.0;                   // velocity
+const size_t N = 200;                   // # of cells
+
+// concentration at inlet
+static double Pulse(double t) { return std::exp(-std::pow((t-0.3)/0.08, 2)); }
+
+static double Run(const char *method, Transport1D::Scheme s, double *mass)
+{
+    Transport1D pipe(v, new Function1(T, Pulse), N, L, s);
+    // mass in pipe: m' = v*(inflow - outflow)
+    Integrator m(v*(new Function1(T, Pulse) - pipe.Outlet()));
+    SetMethod(method);
+    SetStep(1e-8, 0.01);
+    SetAccuracy(1e-7, 1e-5);
+    Init(0, 0.9);
+    Run();
+    double e = 0;                       // max. error of profile
+    for(size_t i=0; i<N; i++) {
+        double x = (i + 0.5) * L/N;     // center of cell
+        e = std::max(e, std::fabs(pipe.Value(i) - Pulse(T.Value() - x/v)));
+    }
+    *mass = std::fabs(pipe.Integral() - m.Value());
+    return e;
+}
+
+// initial profile for negative velocity (zero near the right end)
+static double Profile(double x) { return std::exp(-std::pow((x-0.5)/0.08, 2)); }
+
+class BackPipe : public Transport1D {   // initial state: Profile
+  public:
+    BackPipe(Scheme s) : Transport1D(-v, 0.0, N, L, s) {}
+    void Init() {
+        double *y = State();
+        for(size_t i=0; i<N; i++)
+            y[i] = Profile((i + 0.5) * L/N);
+    }
+};
+
+static double RunBack(Transport1D::Scheme s)
+{
+    BackPipe pipe(s);
+    SetMethod("rkf5");
+    SetStep(1e-8, 0.01);
+    SetAccuracy(1e-7, 1e-5);
+    Init(0, 0.4);
+    Run();
+    double e = 0;                       // u(x,t) = Profile(x + v*t)
+    for(size_t i=0; i<N; i++) {
+        double x = (i + 0.5) * L/N;
+        e = std::max(e, std::fabs(pipe.Value(i) - Profile(x + v*T.Value())));
+    }
+    return e;
+}
+
+int main()
+{
+    Print("transport-test --- 1D transport (upwind, MUSCL)\n");
+    double mass;
+    double eu = Run("rkf5", Transport1D::UPWIND, &mass);
+    Print("upwind rkf5: accuracy %s, mass %s\n",
+          eu < 0.35 ? "OK" : "BAD", mass < 1e-6 ? "OK" : "BAD");
+    const char *methods[] = { "rke", "rkf3", "rkf5", "rkf8", "abm4", "ros23" };
+    for(unsigned i=0; i<sizeof(methods)/sizeof(*methods); i++) {
+        double em = Run(methods[i], Transport1D::MUSCL, &mass);
+        Print("muscl %-5s: accuracy %s, better than upwind %s, mass %s\n",
+              methods[i], em < 0.1 ? "OK" : "BAD", em < eu/3 ? "OK" : "BAD",
+              mass < 1e-6 ? "OK" : "BAD");
+    }
+    SetCompiledEvaluation(false);
+    double en = Run("rkf5", Transport1D::MUSCL, &mass);
+    Print("muscl without tape: accuracy %s, mass %s\n",
+          en < 0.1 ? "OK" : "BAD", mass < 1e-6 ? "OK" : "BAD");
+    SetCompiledEvaluation(true);
+
+    double bu = RunBack(Transport1D::UPWIND);
+    double bm = RunBack(Transport1D::MUSCL);
+    Print("negative velocity: upwind %s, muscl %s, better than upwind %s\n",
+          bu < 0.35 ? "OK" : "BAD", bm < 0.1 ? "OK" : "BAD",
+          bm < bu/3 ? "OK" : "BAD");
+
+    // integrators before and after removed vector
+    Integrator a(1.0);
+    Transport1D *p = new Transport1D(v, 1.0, 10, L);
+    Integrator b(2.0);
+    Integrator c(p->Outlet());
+    Init(0, 2);
+    Run();
+    Print("with vector: a=%g b=%g c=%.4f\n", a.Value(), b.Value(), c.Value());
+    c.SetInput(b);
+    delete p;
+    Init(0, 1);
+    Run();
+    Print("vector removed: a=%g b=%g c=%g\n", a.Value(), b.Value(), c.Value());
+    return 0;
+}
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////
+// waituntilon-test.cc
+//
+// WaitUntilOn: conditions are tested only after Notify() of signals
+// (user Signal, Facility, Store, Variable), processes waiting on one
+// signal are activated in FIFO order
+//
+
+#include "simlib.h"
+#include <vector>
+
+int b = 0;                      // global variable for WaitUntilOn tests
+Signal bChanged("b");           // signal of b changes
+unsigned long tests = 0;        // number of condition evaluations
+
+bool test(bool x) { tests++; return x; }
+
+Facility F("F");
+Store S("S", 3);
+Variable V(0);
+
+struct ZakaznikA : public Process {
+    int n;
+  void Behavior() {
+    Wait(Random()*10);
+    WaitUntilOn(test(b>1), bChanged); Print("A%d: %g b=%d (>1)\n", n, Time, b);
+  }
+  ZakaznikA(int x) : n(x) { Print("new A%d: %g \n", n, Time); }
+  ~ZakaznikA() { Print("delete A%d: %g \n", n, Time); }
+};
+
+struct ZakaznikB : public Process {
+    int n;
+  void Behavior() {
+    WaitUntilOn(test(b<2), bChanged); Print("B%d: %g b=%d (<2)\n", n, Time, b);
+    Wait(Random()*10);
+    // facility free and enough capacity in store
+    WaitUntilOn(test(!F.Busy() && S.Free()>=2), F.Changed, S.Changed);
+    Print("B%d: %g F free, S.Free()=%lu\n", n, Time, S.Free());
+    Seize(F);
+    Enter(S, 2);
+    Wait(Random()*5);
+    Leave(S, 2);
+    Release(F);
+    WaitUntilOn(test(V.Value()>n), V.Changed);
+    Print("B%d: %g V=%g (>%d)\n", n, Time, V.Value(), n);
+  }
+  ZakaznikB(int x) : n(x) { Print("new B%d: %g \n", n, Time); }
+  ~ZakaznikB() { Print("delete B%d: %g \n", n, Time); }
+};
+
+class Generator : public Event {
+  static int num;
+  void Behavior() {
+    b = int(Random()*4);
+    bChanged.Notify();
+    num++;
+    (new ZakaznikA(num))->Activate();
+    (new ZakaznikB(num))->Activate();
+    Activate(Time+Exponential(1e3/150));
+  }
+};
+int Generator::num = 0;
+
+class Counter : public Event {  // V = 0, 1, 2, ...
+  void Behavior() {
+    V = V.Value() + 1;
+    Activate(Time+5);
+  }
+};
+
+// wake-up order test: each waiter ends when level >= its threshold
+int level = 0;
+Signal *levelChanged;
+unsigned long levelTests = 0;
+std::vector<int> order;         // numbers of waiters in order of wake-up
+std::vector<unsigned> counts;   // levelChanged->Waiting() before Notify()
+bool woken = true;              // all waiters removed by Notify()
+
+struct Waiter : public Process {
+    int n, threshold;
+  void Behavior() {
+    WaitUntilOn((levelTests++, level>=threshold), levelChanged);
+    order.push_back(n);
+  }
+  Waiter(int x, int t) : n(x), threshold(t) {}
+};
+
+class SetLevel : public Event {
+  void Behavior() {
+    level = int(Time);          // 1, 2, 2 (no change, only Notify)
+    if(level > 2) level = 2;
+    counts.push_back(levelChanged->Waiting());
+    levelChanged->Notify();
+    woken = woken && levelChanged->Waiting() == 0;
+    if(Time < 3) Activate(Time+1);
+  }
+};
+
+void OrderTest() {
+    static const int thresholds[6] = { 2, 1, 3, 2, 1, 3 };
+    levelChanged = new Signal("level");
+    Init(0, 4);
+    for(int i = 0; i < 6; i++)
+        (new Waiter(i, thresholds[i]))->Activate();
+    (new SetLevel)->Activate(1);
+    Run();
+    static const int expected[4] = { 1, 4, 0, 3 };
+    bool ok = order.size() == 4;
+    for(unsigned i = 0; ok && i < order.size(); i++)
+        ok = order[i] == expected[i];
+    Print("wake-up order:");
+    for(unsigned i = 0; i < order.size(); i++)
+        Print(" %d", order[i]);
+    Print(" %s\n", ok ? "OK" : "BAD");
+    ok = counts.size() == 3 && counts[0] == 6 && counts[1] == 4 &&
+         counts[2] == 2 && woken && levelChanged->Waiting() == 2;
+    Print("waiting before/after Notify: %s\n", ok ? "OK" : "BAD");
+    // 6 initial tests, 6+4+2 after Notify
+    Print("condition tests: %lu %s\n", levelTests,
+          levelTests == 18 ? "OK" : "BAD");
+    // not in simulation: waiters are unregistered (deleted by next Init)
+    delete levelChanged;
+    Print("signal with waiting processes deleted after Run: OK\n");
+}
+
+int main() {                    // experiment description
+    Print("\n===== BEGIN =====\n");
+    OrderTest();
+    for (int i = 1; i <= 3; i++) {
+        Print("\n===== Init%d =====\n", i);
+        F.Clear();              // remove processes from previous run
+        S.Clear();
+        Init(0, 100);           // initialize, time 0..100
+        V = 0;
+        (new Generator)->Activate();
+        (new Counter)->Activate(50);
+        Print("\n===== Run%d =====\n", i);
+        Run();                  // simulation
+        Print("waiting: b=%u F=%u S=%u V=%u\n", bChanged.Waiting(),
+              F.Changed.Waiting(), S.Changed.Waiting(), V.Changed.Waiting());
+    }
+    Print("\n===== END =====\n");
+    Print("condition tests: %lu\n", tests);
+    return 0;
+}
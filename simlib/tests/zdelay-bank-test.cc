@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////
+// zdelay-bank-test.cc
+//
+// ZDelay blocks in register bank of ZDelayTimer:
+//  - shift register of 2000 unit delays (chain), output = input delayed
+//  - FIR filter (moving average) built from unit delays
+//  - removing blocks from bank (slots are moved)
+//
+#include "simlib.h"
+#include "zdelay.h"
+#include <cmath>
+
+const int N = 2000;                     // length of chain
+
+// input signal: tick number
+static double Ramp(double t) { return std::floor(t); }
+
+int main()
+{
+    Print("zdelay-bank-test --- register bank of ZDelay blocks\n");
+    ZDelayTimer *clk = new ZDelayTimer(1.0);
+    Function1 in(T, Ramp);
+    ZDelay *z[N], *x[N];                // x: removed before run
+    z[0] = new ZDelay(in, clk, -1);
+    x[0] = new ZDelay(in, clk);
+    for(int k=1; k<N; k++) {
+        z[k] = new ZDelay(z[k-1], clk, -1);
+        x[k] = new ZDelay(x[k-1], clk);
+    }
+    for(int k=0; k<N; k++)              // slots of z blocks are moved
+        delete x[k];
+    // moving average of 4 samples
+    ZDelay a1(in, clk), a2(a1, clk), a3(a2, clk);
+    Expression avg(0.25*(in + a1 + a2 + a3));
+    Integrator i(0.0);                  // continuous part (time)
+
+    // tick k at Time k: input in(k) = k, output of ZDelay after tick k
+    // is its input at tick k-1, so z[j] = k-1-2*j
+    const int K = 2*N + 10;
+    Init(0, K + 0.5);
+    Run();
+    Print("chain output: %g (expected %d)\n", z[N-1]->Value(), K-1-2*(N-1));
+    Print("middle: %g (expected %d)\n", z[N/2]->Value(), K-1-N);
+    Print("first: %g (expected %d)\n", z[0]->Value(), K-1);
+    Print("moving average: %g (expected %g)\n", avg.Value(),
+          0.25*(K + (K-1) + (K-3) + (K-5)));
+    for(int k=0; k<N; k++)
+        delete z[k];
+    return 0;
+}